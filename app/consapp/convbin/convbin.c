@@ -43,6 +43,11 @@
 *                           force option -scan
 *                           delete option -noscan
 *                           suppress warnings
+*           2026/10/16 1.21 add option -onepass
+*                           add option -nt, -tu
+*                           support multiple input files
+*                           reject output files without keywords for
+*                            multiple input files
 *-----------------------------------------------------------------------------*/
 #define _POSIX_C_SOURCE 199506
 #include <stdio.h>
@@ -61,7 +66,7 @@ static const char *help[]={
 "",
 " Synopsis",
 "",
-" convbin [option ...] file", 
+" convbin [option ...] file [file ...]", 
 "",
 " Description",
 "",
@@ -90,13 +95,14 @@ static const char *help[]={
 "",
 " Options [default]",
 "",
-"     file         input receiver binary log file",
+"     file         input receiver binary log file(s)",
 "     -ts y/m/d h:m:s  start time [all]",
 "     -te y/m/d h:m:s  end time [all]",
 "     -tr y/m/d h:m:s  approximated time for RTCM",
 "     -ti tint     observation data interval (s) [all]",
 "     -tt ttol     observation data epoch tolerance (s) [0.005]",
 "     -span span   time span (h) [all]",
+"     -tu unit     time unit of sessions (h) (with -ts and -te) [all]",
 "     -r format    log format type",
 "                  rtcm2= RTCM 2",
 "                  rtcm3= RTCM 3",
@@ -131,6 +137,8 @@ static const char *help[]={
 "     -ol          include leap seconds in rinex nav header [off]",
 "     -halfc       half-cycle ambiguity correction [off]",
 "     -sortsats    sort observations by the RTKLib satellite index [off]",
+"     -onepass     convert in single pass without scanning input [off]",
+"     -nt nthread  number of threads to convert files/sessions in parallel [1]",
 "     -mask   [sig[,...]] signal mask(s) (sig={G|R|E|J|S|C|I}L{1C|1P|1W|...})",
 "     -nomask [sig[,...]] signal no mask (same as above)",
 "     -x sat       exclude satellite",
@@ -156,6 +164,15 @@ static const char *help[]={
 " Without -tr option, the program obtains the week number from the time-tag file",
 " (if it exists) or the last modified time of the log file instead.",
 "",
+" Multiple input files are converted independently into separate output files.",
+" Output files specified by options -o, -n, ... must contain time or station",
+" keywords (%Y,%y,%m,%d,%h,%M,%S,%n,%W,%D,%H,%t,%r,%b) with multiple input",
+" files. If the keywords still give the same output file for several input",
+" files, the last input file is kept. All input files must be in the same",
+" format. With -nt option, input files and sessions (-tu) are converted in",
+" parallel. In parallel conversion, progress and error messages are not shown",
+" but the status of each input file is shown after the conversion.",
+"",
 " If receiver type is not specified, type is recognized by the input",
 " file extension as follows.",
 "     *.rtcm2       RTCM 2",
@@ -174,6 +191,8 @@ static const char *help[]={
 "     *.rnx         RINEX OBS",
 "     *.nav,*.*n    RINEX NAV",
 };
+static int nomsg=0;     /* suppress messages (0:off,1:on) */
+
 /* print help ----------------------------------------------------------------*/
 static void printhelp(void)
 {
@@ -185,17 +204,30 @@ static void printhelp(void)
 extern int showmsg(const char *format, ...)
 {
     va_list arg;
+    if (nomsg) return 0;
     va_start(arg,format); vfprintf(stderr,format,arg); va_end(arg);
     fprintf(stderr,*format?"\r":"\n");
     return 0;
 }
-/* convert main --------------------------------------------------------------*/
-static int convbin(int format, rnxopt_t *opt, const char *ifile, char **file,
-                   char *dir)
+/* output file path contains keywords ----------------------------------------*/
+static int haskey(const char *path)
+{
+    const char *keys[]={
+        "%Y","%y","%m","%d","%h","%M","%S","%n","%W","%D","%H","%t","%r","%b"
+    };
+    int i;
+    
+    for (i=0;i<(int)(sizeof(keys)/sizeof(*keys));i++) {
+        if (strstr(path,keys[i])) return 1;
+    }
+    return 0;
+}
+/* set output files ----------------------------------------------------------*/
+static void setofile(const rnxopt_t *opt, const char *ifile, char **file,
+                     const char *dir, char **ofile)
 {
     int i,def;
-    static char work[1024],ofile_[NOUTFILE][1024]={"","","","","","","","",""};
-    char ifile_[1024],*ofile[NOUTFILE],*p;
+    char work[1024],ifile_[1024],*p;
     char *extnav=(opt->rnxver<=299||opt->navsys==SYS_GPS)?"N":"P";
     char *extlog="sbs";
     
@@ -206,7 +238,7 @@ static int convbin(int format, rnxopt_t *opt, const char *ifile, char **file,
     def=!file[0]&&!file[1]&&!file[2]&&!file[3]&&!file[4]&&!file[5]&&!file[6]&&
         !file[7]&&!file[8];
     
-    for (i=0;i<NOUTFILE;i++) ofile[i]=ofile_[i];
+    for (i=0;i<NOUTFILE;i++) *ofile[i]='\0';
     
     if (file[0]) strcpy(ofile[0],file[0]);
     else if (*opt->staid) {
@@ -298,6 +330,10 @@ static int convbin(int format, rnxopt_t *opt, const char *ifile, char **file,
         else strcpy(work,ofile[i]);
         sprintf(ofile[i],"%s%c%s",dir,RTKLIB_FILEPATHSEP,work);
     }
+}
+/* show input and output files -----------------------------------------------*/
+static void showfiles(int format, const char *ifile, char **ofile)
+{
     fprintf(stderr,"input file  : %s (%s)\n",ifile,formatstrs[format]);
     
     if (*ofile[0]) fprintf(stderr,"->rinex obs : %s\n",ofile[0]);
@@ -309,6 +345,19 @@ static int convbin(int format, rnxopt_t *opt, const char *ifile, char **file,
     if (*ofile[6]) fprintf(stderr,"->rinex cnav: %s\n",ofile[6]);
     if (*ofile[7]) fprintf(stderr,"->rinex inav: %s\n",ofile[7]);
     if (*ofile[8]) fprintf(stderr,"->sbas log  : %s\n",ofile[8]);
+}
+/* convert main --------------------------------------------------------------*/
+static int convbin(int format, rnxopt_t *opt, const char *ifile, char **file,
+                   char *dir)
+{
+    static char ofile_[NOUTFILE][1024];
+    char *ofile[NOUTFILE];
+    int i;
+    
+    for (i=0;i<NOUTFILE;i++) ofile[i]=ofile_[i];
+    
+    setofile(opt,ifile,file,dir,ofile);
+    showfiles(format,ifile,ofile);
     
     if (!convrnx(format,opt,ifile,ofile)) {
         fprintf(stderr,"\n");
@@ -419,7 +468,7 @@ static int get_filetime(const char *file, gtime_t *time)
 }
 /* parse command line options ------------------------------------------------*/
 static int cmdopts(int argc, char **argv, rnxopt_t *opt, char **ifile,
-                   char **ofile, char **dir, int *trace)
+                   int *nfile, char **ofile, char **dir, int *trace)
 {
     double eps[]={1980,1,1,0,0,0},epe[]={2037,12,31,0,0,0};
     double epr[]={2010,1,1,0,0,0},span=0.0;
@@ -461,6 +510,9 @@ static int cmdopts(int argc, char **argv, rnxopt_t *opt, char **ifile,
         else if (!strcmp(argv[i],"-span")&&i+1<argc) {
             span=atof(argv[++i]);
         }
+        else if (!strcmp(argv[i],"-tu")&&i+1<argc) {
+            opt->tunit=atof(argv[++i])*3600.0;
+        }
         else if (!strcmp(argv[i],"-r" )&&i+1<argc) {
             fmt=argv[++i];
         }
@@ -544,6 +596,12 @@ static int cmdopts(int argc, char **argv, rnxopt_t *opt, char **ifile,
         else if (!strcmp(argv[i],"-sortsats")) {
             opt->sortsats=1;
         }
+        else if (!strcmp(argv[i],"-onepass")) {
+            opt->onepass=1;
+        }
+        else if (!strcmp(argv[i],"-nt")&&i+1<argc) {
+            opt->nthread=atoi(argv[++i]);
+        }
         else if (!strcmp(argv[i],"-mask")&&i+1<argc) {
             for (j=0;j<RNX_NUMSYS;j++) {
               for (k=0;k<MAXCODE;k++) opt->mask[j][k]='0';
@@ -594,7 +652,7 @@ static int cmdopts(int argc, char **argv, rnxopt_t *opt, char **ifile,
         }
         else if (!strncmp(argv[i],"-",1)) printhelp();
         
-        else *ifile=argv[i];
+        else ifile[(*nfile)++]=argv[i];
     }
     if (span>0.0&&opt->ts.time) {
         opt->te=timeadd(opt->ts,span*3600.0-1e-3);
@@ -608,10 +666,10 @@ static int cmdopts(int argc, char **argv, rnxopt_t *opt, char **ifile,
     if (nf>=7) opt->freqtype|=FREQTYPE_ALL;
     
     if (opt->trtcm.time == 0) {
-        // Use the start or end time if supplied. Otherwise use the file time.
+        // Use the start or end time if supplied. Otherwise the file time is
+        // used for each input file.
         if (opt->ts.time != 0) opt->trtcm = opt->ts;
         else if (opt->te.time != 0) opt->trtcm = opt->te;
-        else get_filetime(*ifile, &opt->trtcm);
     }
     if (*fmt) {
         if      (!strcmp(fmt,"rtcm2")) format=STRFMT_RTCM2;
@@ -637,7 +695,9 @@ static int cmdopts(int argc, char **argv, rnxopt_t *opt, char **ifile,
     }
     else {
         paths[0]=path;
-        if (!expath(*ifile,paths,1)||!(p=strrchr(path,'.'))) return -1;
+        if (*nfile<=0||!expath(*ifile,paths,1)||!(p=strrchr(path,'.'))) {
+            return -1;
+        }
         if      (!strcmp(p,".rtcm2"))  format=STRFMT_RTCM2;
         else if (!strcmp(p,".rtcm3"))  format=STRFMT_RTCM3;
         else if (!strcmp(p,".gps"  ))  format=STRFMT_OEM4;
@@ -667,17 +727,53 @@ static int cmdopts(int argc, char **argv, rnxopt_t *opt, char **ifile,
     }
     return format;
 }
+/* convert multiple files in parallel ----------------------------------------*/
+static int convbins(int format, const rnxopt_t *opt, char **ifile, int n,
+                    char **file, char *dir)
+{
+    rnxopt_t *opts;
+    char (*buff)[NOUTFILE][1024],**ofile_,***ofile;
+    int i,j,*stat,ret;
+    
+    if (!(opts=(rnxopt_t *)malloc(sizeof(rnxopt_t)*n))||
+        !(buff=(char (*)[NOUTFILE][1024])malloc(sizeof(*buff)*n))||
+        !(ofile_=(char **)malloc(sizeof(char *)*NOUTFILE*n))||
+        !(ofile=(char ***)malloc(sizeof(char **)*n))||
+        !(stat=(int *)malloc(sizeof(int)*n))) {
+        fprintf(stderr,"memory allocation error\n");
+        exit(EXIT_FAILURE);
+    }
+    for (i=0;i<n;i++) {
+        opts[i]=*opt;
+        if (!opt->trtcm.time) get_filetime(ifile[i],&opts[i].trtcm);
+        ofile[i]=ofile_+i*NOUTFILE;
+        for (j=0;j<NOUTFILE;j++) ofile[i][j]=buff[i][j];
+        setofile(opts+i,ifile[i],file,dir,ofile[i]);
+        showfiles(format,ifile[i],ofile[i]);
+    }
+    ret=convrnxm(format,opts,ifile,ofile,n,stat);
+    
+    for (i=0;i<n;i++) {
+        if (stat[i]>0) continue;
+        fprintf(stderr,"%s : %s\n",stat[i]<0?"abort":"error",ifile[i]);
+    }
+    fprintf(stderr,"\n");
+    free(opts); free(buff); free(ofile_); free(ofile); free(stat);
+    return ret!=0;
+}
 /* main ----------------------------------------------------------------------*/
 int main(int argc, char **argv)
 {
-    rnxopt_t opt={{0}};
-    int format,trace=0,stat;
-    char *ifile="",*ofile[NOUTFILE]={0},*dir="";
+    rnxopt_t opt={{0}},opt_;
+    int i,format,trace=0,nfile=0,stat=1;
+    char **ifile,*ofile[NOUTFILE]={0},*dir="";
+    
+    if (!(ifile=(char **)malloc(sizeof(char *)*argc))) return EXIT_FAILURE;
     
     /* parse command line options */
-    format=cmdopts(argc,argv,&opt,&ifile,ofile,&dir,&trace);
+    format=cmdopts(argc,argv,&opt,ifile,&nfile,ofile,&dir,&trace);
     
-    if (!*ifile) {
+    if (nfile<=0) {
         fprintf(stderr,"no input file\n");
         return EXIT_FAILURE;
     }
@@ -685,14 +781,32 @@ int main(int argc, char **argv)
         fprintf(stderr,"input format can not be recognized\n");
         return EXIT_FAILURE;
     }
+    /* outputs of multiple input files must be separated by keywords */
+    for (i=0;i<NOUTFILE&&nfile>1;i++) {
+        if (!ofile[i]||haskey(ofile[i])) continue;
+        fprintf(stderr,"output file without keyword for multiple input files: %s\n",
+                ofile[i]);
+        return EXIT_FAILURE;
+    }
     sprintf(opt.prog,"%s %s %s",PRGNAME,VER_RTKLIB,PATCH_LEVEL);
     if (trace>0) {
         traceopen(TRACEFILE);
         tracelevel(trace);
     }
-    stat=convbin(format,&opt,ifile,ofile,dir);
+    nomsg=opt.nthread>1;
     
+    if (nfile>1&&opt.nthread>1) {
+        stat=convbins(format,&opt,ifile,nfile,ofile,dir);
+    }
+    else {
+        for (i=0;i<nfile;i++) {
+            opt_=opt;
+            if (!opt.trtcm.time) get_filetime(ifile[i],&opt_.trtcm);
+            if (!convbin(format,&opt_,ifile[i],ofile,dir)) stat=0;
+        }
+    }
     traceclose();
+    free(ifile);
     
     return stat?0:EXIT_FAILURE;
 }
@@ -13,6 +13,7 @@
 *                           separate readsol.c file
 *           2008/07/18  1.3 support change of convkml() arguments
 *           2016/06/11  1.4 add option -gpx for gpx conversion
+*           2026/10/16  1.5 add option -stat for binary solution status
 *-----------------------------------------------------------------------------*/
 #include <stdarg.h>
 #include "rtklib.h"
@@ -42,8 +43,9 @@ static const char *help[]={
 " -n        output point name [none]",
 " -lonlat   CSV format order longitude / latitude [latitude/longitude]",
 " -f n e h  add north/east/height offset to position (m) [0 0 0]",
-" -gpx      output GPX file"
-" -csv      output CSV file"
+" -gpx      output GPX file",
+" -csv      output CSV file",
+" -stat     convert binary solution status to text file [infile + .txt]"
 };
 /* print help ----------------------------------------------------------------*/
 static void printhelp(void)
@@ -55,7 +57,7 @@ static void printhelp(void)
 /* pos2kml main --------------------------------------------------------------*/
 int main(int argc, char **argv)
 {
-    int i,j,n,outalt=0,outtime=0,qflg=0,tcolor=5,pcolor=5,gpx=0,csv=0,stat;
+    int i,j,n,outalt=0,outtime=0,qflg=0,tcolor=5,pcolor=5,gpx=0,csv=0,sst=0,stat;
     int mean=0,csvorder=0;
     char *infile[32],*outfile="",*name=NULL;
     double offset[3]={0.0},tint=0.0,es[6]={2000,1,1},ee[6]={2000,1,1};
@@ -89,6 +91,7 @@ int main(int argc, char **argv)
         else if (!strcmp(argv[i],"-n")&&i+1<argc) name=argv[++i];
         else if (!strcmp(argv[i],"-gpx")) gpx=1;
         else if (!strcmp(argv[i],"-csv")) csv=1;
+        else if (!strcmp(argv[i],"-stat")) sst=1;
         else if (!strcmp(argv[i], "--version")) {
             fprintf(stderr, "pos2kml RTKLIB %s %s\n", VER_RTKLIB, PATCH_LEVEL);
             exit(0);
@@ -105,7 +108,10 @@ int main(int argc, char **argv)
         return EXIT_FAILURE;
     }
     for (i=0;i<n;i++) {
-        if (gpx) {
+        if (sst) {
+            stat=convsolstat(infile[i],outfile);
+        }
+        else if (gpx) {
             stat=convgpx(infile[i],outfile,ts,te,tint,qflg,mean,name,offset,tcolor,pcolor,
                          outalt,outtime);
         }
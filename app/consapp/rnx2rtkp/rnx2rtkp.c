@@ -56,6 +56,10 @@ static const char *help[]={
 " -v thres  validation threshold for integer ambiguity (0.0:no AR) [3.0]",
 " -b        backward solutions [off]",
 " -c        forward/backward combined solutions [off]",
+" -cp       forward/backward combined solutions processed in parallel [off]",
+" -cache    read/write binary obs/nav cache alongside input files [off]",
+" -stream   read obs data incrementally for forward solutions [off]",
+" -spill    spill combined solutions to temporary files next to output [off]",
 " -i        instantaneous integer ambiguity resolution [off]",
 " -h        fix and hold for integer ambiguity resolution [off]",
 " -bl bl,std     baseline distance and stdev",
@@ -72,6 +76,7 @@ static const char *help[]={
 " -l lat lon hgt reference (base) receiver latitude/longitude/height (deg/m)",
 "           rover latitude/longitude/height for fixed or ppp-fixed mode",
 " -y level  output solution status (0:off,1:states,2:residuals) [0]",
+" -yb       output solution status in binary format [off]",
 " -x level  debug trace level (0:off) [0]",
 " --rover list rover names for processing, separated by a space",
 " --base list  base names for processing, separated by a space",
@@ -158,6 +163,13 @@ int main(int argc, char **argv)
         else if (!strcmp(argv[i],"-d")&&i+1<argc) solopt.timeu=atoi(argv[++i]);
         else if (!strcmp(argv[i],"-b")) prcopt.soltype=1;
         else if (!strcmp(argv[i],"-c")) prcopt.soltype=2;
+        else if (!strcmp(argv[i],"-cp")) {
+            prcopt.soltype=2;
+            prcopt.combpar=1;
+        }
+        else if (!strcmp(argv[i],"-cache")) prcopt.obscache=1;
+        else if (!strcmp(argv[i],"-stream")) prcopt.obsstream=1;
+        else if (!strcmp(argv[i],"-spill")) prcopt.solspill=1;
         else if (!strcmp(argv[i],"-i")) prcopt.modear=2;
         else if (!strcmp(argv[i],"-h")) prcopt.modear=3;
         else if (!strcmp(argv[i],"-t")) solopt.timef=1;
@@ -184,6 +196,7 @@ int main(int argc, char **argv)
         else if (!strcmp(argv[i],"--rover")&&i+1<argc) rover=argv[++i];
         else if (!strcmp(argv[i],"--base")&&i+1<argc) base=argv[++i];
         else if (!strcmp(argv[i],"-y")&&i+1<argc) solopt.sstat=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-yb")) solopt.sstatf=SSTATF_BIN;
         else if (!strcmp(argv[i],"-x")&&i+1<argc) solopt.trace=atoi(argv[++i]);
         else if (!strcmp(argv[i], "--version")) {
             fprintf(stderr, "rnx2rtkp RTKLIB %s %s\n", VER_RTKLIB, PATCH_LEVEL);
@@ -35,6 +35,11 @@
 *           2016/09/19 1.20 support multiple remote console connections
 *                           add option -w
 *           2017/09/01 1.21 add command ssr
+*           2026/10/16 1.22 add option -tb for asynchronous debug trace
+*                           add multi-rover mode (misc-roverlist,misc-nworker)
+*                           add command rover
+*                           show navidata/ssr from navigation data snapshot
+*                           reject option -r in multi-rover mode
 *-----------------------------------------------------------------------------*/
 #define _POSIX_C_SOURCE 199506
 #include <stdlib.h>
@@ -120,6 +125,9 @@ static int keepalive    =0;             /* keep alive flag */
 static int start        =0;             /* auto start */
 static int fswapmargin  =30;            /* file swap margin (s) */
 static char sta_name[256]="";           /* station name */
+static char roverlist[MAXSTR]="";       /* rover list file (multi-rover mode) */
+static int nworker      =1;             /* number of rover solver threads */
+static int outstat      =0;             /* solution status file level (-r) */
 
 static prcopt_t prcopt;                 /* processing options */
 static solopt_t solopt[2]={{0}};        /* solution options */
@@ -127,7 +135,7 @@ static filopt_t filopt  ={""};          /* file options */
 
 /* help text -----------------------------------------------------------------*/
 static const char *usage[]={
-    "usage: rtkrcv [-s][-p port][-d dev][-o file][-w pwd][-r level][-t level][-sta sta]",
+    "usage: rtkrcv [-s][-p port][-d dev][-o file][-w pwd][-r level][-t level][-tb size][-sta sta]",
     "options",
     "  -s         start RTK server on program startup",
     "  -nc        start RTK server on program startup with no console",
@@ -138,6 +146,7 @@ static const char *usage[]={
     "  -w pwd     login password for remote console (\"\": no password)",
     "  -r level   output solution status file (0:off,1:states,2:residuals)",
     "  -t level   debug trace level (0:off,1-5:on)",
+    "  -tb size   debug trace buffer per thread (kbytes) for async output (0:off)",
     "  -sta sta   station name for receiver dcb",
     "  --deamon   detach from the console",
     "  --version  print the version and exit"
@@ -153,6 +162,7 @@ static const char *helptxt[]={
     "navidata [cycle]      : show navigation data",
     "stream [cycle]        : show stream status",
     "ssr [cycle]           : show ssr corrections",
+    "rover [cycle]         : show rover status (multi-rover mode)",
     "error                 : show error/warning messages",
     "option [opt]          : show option(s)",
     "set opt [val]         : set option",
@@ -233,6 +243,8 @@ static opt_t rcvopts[]={
     {"misc-navmsgsel",  3,  (void *)&navmsgsel,          MSGOPT },
     {"misc-proxyaddr",  2,  (void *)proxyaddr,           ""     },
     {"misc-fswapmargin",0,  (void *)&fswapmargin,        "s"    },
+    {"misc-roverlist",  2,  (void *)roverlist,           ""     },
+    {"misc-nworker",    0,  (void *)&nworker,            ""     },
     
 #ifdef RTKSHELLCMDS
     {"misc-startcmd",   2,  (void *)startcmd,            ""     },
@@ -428,6 +440,67 @@ static void readant(vt_t *vt, prcopt_t *opt, nav_t *nav, pcvs_t *pcvsr) {
       vt_printf(vt, "antenna file open error %s", filopt.satantp);
   }
 }
+/* read rover list ---------------------------------------------------------------
+* read rover list file for multi-rover mode. a rover per line as:
+*   name inptype inppath format [outtype outpath [logtype logpath]]
+* types and format are values of options inpstr1-type, outstr1-type,
+* logstr1-type and inpstr1-format (ex. tcpcli, file, ubx). solution options
+* of outstr1 are used for all rovers. '#' starts a comment.
+*-----------------------------------------------------------------------------*/
+static int readrovers(vt_t *vt, const char *file)
+{
+    FILE *fp;
+    opt_t opt[]={
+        {"",3,NULL,ISTOPT},{"",3,NULL,FMTOPT},{"",3,NULL,OSTOPT},
+        {"",3,NULL,OSTOPT}
+    };
+    char buff[MAXSTR*4],name[MAXSTR],type[4][32],path[4][MAXSTR],fmt[32];
+    char *p,*paths[4];
+    int i,n,strs[4],format,nrov=0;
+    
+    trace(3,"readrovers: file=%s\n",file);
+    
+    if (!(fp=fopen(file,"r"))) {
+        vt_printf(vt,"rover list open error: %s\n",file);
+        return 0;
+    }
+    while (fgets(buff,sizeof(buff),fp)) {
+        if ((p=strchr(buff,'#'))) *p='\0';
+        for (i=0;i<4;i++) {
+            strcpy(type[i],"off");
+            *path[i]='\0';
+            paths[i]=path[i];
+        }
+        n=sscanf(buff,"%1023s %31s %1023s %31s %31s %1023s %31s %1023s",name,
+                 type[0],path[0],fmt,type[1],path[1],type[3],path[3]);
+        if (n<=0) continue;
+        opt[0].var=strs;
+        opt[1].var=&format;
+        opt[2].var=strs+1;
+        opt[3].var=strs+3;
+        strs[2]=STR_NONE;
+        if (n<4||!str2opt(opt,type[0])||!str2opt(opt+1,fmt)||
+            !str2opt(opt+2,type[1])||!str2opt(opt+3,type[3])) {
+            vt_printf(vt,"rover list error: %s %s\n",file,name);
+            fclose(fp);
+            return 0;
+        }
+        if (rtksvraddrov(&svr,name,strs,(const char **)paths,format,"",
+                         solopt)<0) {
+            vt_printf(vt,"rover add error: %s\n",name);
+            fclose(fp);
+            return 0;
+        }
+        nrov++;
+    }
+    fclose(fp);
+    
+    if (nrov<=0) {
+        vt_printf(vt,"no rover in rover list: %s\n",file);
+        return 0;
+    }
+    return 1;
+}
 /* start rtk server ----------------------------------------------------------*/
 static int startsvr(vt_t *vt)
 {
@@ -441,7 +514,7 @@ static int startsvr(vt_t *vt)
         strpath[6],strpath[7]
     };
     char errmsg[2048]="";
-    int i,stropt[8]={0};
+    int i,strs[8],stropt[8]={0};
     
     trace(3,"startsvr:\n");
     
@@ -510,8 +583,26 @@ static int startsvr(vt_t *vt)
     solopt[0].posf=strfmt[3];
     solopt[1].posf=strfmt[4];
     
+    /* read rover list for multi-rover mode (rover input stream not used) */
+    rtksvrfreerov(&svr);
+    for (i=0;i<8;i++) strs[i]=strtype[i];
+    if (*roverlist) {
+        if (outstat>0) {
+            vt_printf(vt,"status file (-r) not supported in multi-rover mode\n");
+            free_pcvs(&svr.pcvsr);
+            return 0;
+        }
+        if (!readrovers(vt,roverlist)) {
+            rtksvrfreerov(&svr);
+            free_pcvs(&svr.pcvsr);
+            return 0;
+        }
+        strs[0]=STR_NONE;
+    }
+    svr.nworker=nworker;
+    
     /* start rtk server */
-    if (!rtksvrstart(&svr,svrcycle,buffsize,strtype,(const char **)paths,strfmt,navmsgsel,
+    if (!rtksvrstart(&svr,svrcycle,buffsize,strs,(const char **)paths,strfmt,navmsgsel,
                      (const char **)cmds,(const char **)cmds_periodic,(const char **)ropts,nmeacycle,nmeareq,npos,&prcopt,
                      solopt,&moni,errmsg)) {
         trace(2,"rtk server start error (%s)\n",errmsg);
@@ -919,23 +1010,27 @@ static void probserv(vt_t *vt, int nf)
 /* print navigation data -----------------------------------------------------*/
 static void prnavidata(vt_t *vt)
 {
+    const nav_t *nav;
     eph_t eph[MAXSAT];
     geph_t geph[MAXPRNGLO];
     double ion[8],utc[8];
     gtime_t time;
     char id[8],s1[64],s2[64],s3[64];
-    int i,valid,prn;
+    int i,valid,prn,pin;
     
     trace(4,"prnavidata:\n");
     
     rtksvrlock(&svr);
     time=svr.rtk.sol.time;
-    for (i=0;i<MAXSAT;i++) eph[i]=svr.nav.eph[i];
-    for (i=0;i<MAXPRNGLO;i++) geph[i]=svr.nav.geph[i];
-    for (i=0;i<8;i++) ion[i]=svr.nav.ion_gps[i];
-    for (i=0;i<8;i++) utc[i]=svr.nav.utc_gps[i];
     rtksvrunlock(&svr);
     
+    if (!(nav=rtksvrpinnav(&svr,&pin))) return;
+    for (i=0;i<MAXSAT;i++) eph[i]=nav->eph[i];
+    for (i=0;i<MAXPRNGLO;i++) geph[i]=nav->geph[i];
+    for (i=0;i<8;i++) ion[i]=nav->ion_gps[i];
+    for (i=0;i<8;i++) utc[i]=nav->utc_gps[i];
+    rtksvrunpinnav(&svr,pin);
+    
     vt_printf(vt,"\n%s%3s %3s %3s %3s %3s %3s %3s %19s %19s %19s %3s %3s%s\n",
               ESC_BOLD,"SAT","S","IOD","IOC","FRQ","A/A","SVH","Toe","Toc",
               "Ttr/Tof","L2C","L2P",ESC_RESET);
@@ -1027,17 +1122,21 @@ static void prstream(vt_t *vt)
 static void prssr(vt_t *vt)
 {
     static char buff[128*MAXSAT];
+    const nav_t *nav;
     gtime_t time;
     ssr_t ssr[MAXSAT];
-    int i,valid;
+    int i,valid,pin;
     char tstr[40],id[8],*p=buff;
     
     rtksvrlock(&svr);
     time=svr.rtk.sol.time;
+    rtksvrunlock(&svr);
+    
+    if (!(nav=rtksvrpinnav(&svr,&pin))) return;
     for (i=0;i<MAXSAT;i++) {
-        ssr[i]=svr.nav.ssr[i];
+        ssr[i]=nav->ssr[i];
     }
-    rtksvrunlock(&svr);
+    rtksvrunpinnav(&svr,pin);
     
     p+=sprintf(p,"\n%s%3s %3s %3s %3s %3s %19s %6s %6s %6s %6s %6s %6s %8s "
                "%6s %6s %6s%s\n",
@@ -1058,6 +1157,42 @@ static void prssr(vt_t *vt)
     }
     vt_puts(vt,buff);
 }
+/* print rover status (multi-rover mode) -------------------------------------*/
+static void prrover(vt_t *vt)
+{
+    const char *sol[]={"-","fix","float","SBAS","DGPS","single","PPP",""};
+    const rtksvrrov_t *rov;
+    char tstr[40],*buff,*p;
+    int i;
+    
+    trace(4,"prrover:\n");
+    
+    rtksvrlock(&svr);
+    if (!(buff=(char *)malloc(256*(svr.nrov+2)))) {
+        rtksvrunlock(&svr);
+        return;
+    }
+    p=buff;
+    p+=sprintf(p,"\n%s%-12s %s %8s %6s %8s %3s %6s %-6s %-19s %3s %6s %6s %4s%s\n",
+               ESC_BOLD,"Rover","S","Obs","Err","Sol","Que","Miss","Stat",
+               "Time(GPST)","NS","Age","Ratio","CPU",ESC_RESET);
+    for (i=0;i<svr.nrov;i++) {
+        rov=svr.rov+i;
+        if (rov->sol.time.time) time2str(rov->sol.time,tstr,0);
+        else strcpy(tstr,"-");
+        p+=sprintf(p,"%-12.12s %s %8u %6u %8u %3d %6d %-6s %-19s %3d %6.1f %6.1f %4d\n",
+                   rov->name,rov->stream[0].state<0?"E":
+                   (rov->stream[0].state?"C":"-"),rov->nobs,rov->nerr,
+                   rov->nsol,(rov->qtail-rov->qhead+MAXROVOBSQ)%MAXROVOBSQ,
+                   rov->prcout,sol[rov->sol.stat],tstr,rov->sol.ns,rov->sol.age,
+                   rov->sol.ratio,rov->cputime);
+    }
+    if (svr.nrov<=0) p+=sprintf(p,"no rover (multi-rover mode off)\n");
+    rtksvrunlock(&svr);
+    
+    vt_puts(vt,buff);
+    free(buff);
+}
 /* start command -------------------------------------------------------------*/
 static void cmd_start(char **args, int narg, vt_t *vt)
 {
@@ -1118,6 +1253,22 @@ static void cmd_status(char **args, int narg, vt_t *vt)
     }
     vt_printf(vt,"\n");
 }
+/* rover command -------------------------------------------------------------*/
+static void cmd_rover(char **args, int narg, vt_t *vt)
+{
+    int cycle=0;
+    
+    trace(3,"cmd_rover:\n");
+    
+    if (narg>1) cycle=(int)(atof(args[1])*1000.0);
+    
+    while (!vt_chkbrk(vt)) {
+        if (cycle>0) vt_printf(vt,ESC_CLEAR);
+        prrover(vt);
+        if (cycle>0) sleepms(cycle); else return;
+    }
+    vt_printf(vt,"\n");
+}
 /* satellite command ---------------------------------------------------------*/
 static void cmd_satellite(char **args, int narg, vt_t *vt)
 {
@@ -1464,7 +1615,8 @@ static void *con_thread(void *arg)
     const char *cmds[]={
         "start","stop","restart","solution","status","satellite","observ",
         "navidata","stream","ssr","error","option","set",
-        "mark","mode","load","save","log","help","?","exit","shutdown",""
+        "mark","mode","load","save","log","help","?","exit","shutdown",
+        "rover",""
     };
     con_t *con=(con_t *)arg;
     int i,j,narg;
@@ -1541,6 +1693,7 @@ static void *con_thread(void *arg)
                     con->state=0;
                 }
                 break;
+            case 22: cmd_rover    (args,narg,con->vt); break;
             default:
                 vt_printf(con->vt,"unknown command: %s.\n",args[0]);
                 break;
@@ -1680,7 +1833,8 @@ static void deamonise(void)
 
 /* rtkrcv main -----------------------------------------------------------------
 * synopsis
-*     rtkrcv [-s][-nc][-p port][-d dev][-o file][-r level][-t level][-sta sta]
+*     rtkrcv [-s][-nc][-p port][-d dev][-o file][-r level][-t level][-tb size]
+*            [-sta sta]
 *
 * description
 *     A command line version of the real-time positioning AP by rtklib. To start
@@ -1708,6 +1862,7 @@ static void deamonise(void)
 *     -w pwd     login password for remote console ("": no password)
 *     -r level   output solution status file (0:off,1:states,2:residuals)
 *     -t level   debug trace level (0:off,1-5:on)
+*     -tb size   debug trace buffer per thread (kbytes) for async output (0:off)
 *     -sta sta   station name for receiver dcb
 *     --deamon   detach from the console
 *     --version  prints the version and exits
@@ -1794,13 +1949,14 @@ static void deamonise(void)
 *     command is distinguished according to header characters.
 *     
 *     The -r argument only affects the status file. The status output streams
-*     take their level from the out-outstat option.
+*     take their level from the out-outstat option. The status file is not
+*     supported in multi-rover mode (misc-roverlist).
 *
 *-----------------------------------------------------------------------------*/
 int main(int argc, char **argv)
 {
     con_t *con[MAXCON]={0};
-    int i,port=0,outstat=0,trace=0,sock=0;
+    int i,port=0,trace=0,tracebuf=0,sock=0;
     char *dev="",file[MAXSTR]="";
     int deamon=0;
     
@@ -1814,6 +1970,7 @@ int main(int argc, char **argv)
         else if (!strcmp(argv[i],"-w")&&i+1<argc) strcpy(passwd,argv[++i]);
         else if (!strcmp(argv[i],"-r")&&i+1<argc) outstat=atoi(argv[++i]);
         else if (!strcmp(argv[i],"-t")&&i+1<argc) trace=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-tb")&&i+1<argc) tracebuf=atoi(argv[++i]);
         else if (!strcmp(argv[i],"-sta")&&i+1<argc) strcpy(sta_name,argv[++i]);
         else if (!strcmp(argv[i], "--deamon")) deamon=1;
         else if (!strcmp(argv[i], "--version")) {
@@ -1824,6 +1981,7 @@ int main(int argc, char **argv)
     }
     if (deamon) deamonise();
     if (trace>0) {
+        traceasync(tracebuf*1024);
         traceopen(TRACEFILE);
         tracelevel(trace);
     }
@@ -1846,6 +2004,11 @@ int main(int argc, char **argv)
     if (!readnav(NAVIFILE,&svr.nav)) {
         fprintf(stderr,"no navigation data: %s\n",NAVIFILE);
     }
+    if (outstat>0&&*roverlist) {
+        fprintf(stderr,"status file (-r) not supported in multi-rover mode\n");
+        traceclose();
+        return EXIT_FAILURE;
+    }
     if (outstat>0) {
         rtkopenstat(STATFILE,outstat);
     }
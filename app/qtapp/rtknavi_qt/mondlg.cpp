@@ -417,7 +417,7 @@ void MonitorDialog::showRtk()
     double *del, *off, rt[3] = {0}, dop[4] = {0};
     double azel[MAXSAT * 2], pos[3], vel[3], rr[3] = {0}, enu[3] = {0};
     int row, j, k, cycle, state, rtkstat, nsat0, nsat1, prcout, nave;
-    int cputime, nb[3] = {0}, ne;
+    int cputime, nb[3] = {0}, ne, pin = -1;
     unsigned int nmsg[3][10] = {{0}};
     char tstr[40], id[8], s1[40] = "-", s2[40] = "-", s3[40] = "-";
     char file[1024] = "";
@@ -454,15 +454,19 @@ void MonitorDialog::showRtk()
         rt[0] = floor(runtime / 3600.0); runtime -= rt[0] * 3600.0;
         rt[1] = floor(runtime / 60.0); rt[2] = runtime - rt[1] * 60.0;
 	}
-    if ((ne = rtksvr->nav.ne) > 0) {
-        time2str(rtksvr->nav.peph[0].time, s1, 0);
-        time2str(rtksvr->nav.peph[ne - 1].time, s2, 0);
-        time2str(rtksvr->ftime[2], s3, 0);
-	}
+    if (rtksvr->nav.ne > 0) time2str(rtksvr->ftime[2], s3, 0);
     strncpy(file, rtksvr->files[2], 1023);
 
     rtksvrunlock(rtksvr); // unlock
 
+    // precise ephemeris from pinned navigation data snapshot
+    const nav_t *nav = rtksvrpinnav(rtksvr, &pin);
+    if (nav && (ne = nav->ne) > 0) {
+        time2str(nav->peph[0].time, s1, 0);
+        time2str(nav->peph[ne - 1].time, s2, 0);
+    }
+    rtksvrunpinnav(rtksvr, pin);
+
     for (j = k = 0; j < MAXSAT; j++) {
         if (rtk->opt.mode == PMODE_SINGLE && !rtk->ssat[j].vs) continue;
         if (rtk->opt.mode != PMODE_SINGLE && !rtk->ssat[j].vsat[0]) continue;
@@ -772,7 +776,7 @@ void MonitorDialog::setSat()
 void MonitorDialog::showSat()
 {
 	ssat_t *ssat;
-    int i, j, k, n, nsat, fix, nfreq, sys = sys_tbl[ui->cBSelectNavigationSystems->currentIndex()];
+    int i, j, k, n, nsat, fix, nfreq, pin = -1, sys = sys_tbl[ui->cBSelectNavigationSystems->currentIndex()];
     int vsat[MAXSAT] = {0};
 	char id[8];
     double az, el, cbias[MAXSAT][2];
@@ -782,14 +786,16 @@ void MonitorDialog::showSat()
 
     rtksvrlock(rtksvr);
     *rtk = rtksvr->rtk;
+    nfreq = rtksvr->rtk.opt.nf > NFREQ ? NFREQ : rtksvr->rtk.opt.nf;
+    rtksvrunlock(rtksvr);
 
+    const nav_t *nav = rtksvrpinnav(rtksvr, &pin);
     for (i = 0; i < MAXSAT; i++)
     {
         for (j = 0; j < 2; j++)
-            cbias[i][j] = rtksvr->nav.cbias[i][j][0];
+            cbias[i][j] = nav ? nav->cbias[i][j][0] : 0.0;
     }
-    nfreq = rtksvr->rtk.opt.nf > NFREQ ? NFREQ : rtksvr->rtk.opt.nf;
-    rtksvrunlock(rtksvr);
+    rtksvrunpinnav(rtksvr, pin);
 
     for (i = 0; i < MAXSAT; i++) {
         ssat = rtk->ssat + i;
@@ -1179,7 +1185,7 @@ void MonitorDialog::showNavigationsGPS()
 	gtime_t time;
     QString s;
     char tstr[40], id[8];
-    int i, k, n, nsat, prn, off = ui->cBSelectEphemeris->currentIndex();
+    int i, k, n, nsat, prn, pin = -1, off = ui->cBSelectEphemeris->currentIndex();
     bool valid;
     int sys = sys_tbl[ui->cBSelectSingleNavigationSystem->currentIndex() + 1];
 
@@ -1188,13 +1194,16 @@ void MonitorDialog::showNavigationsGPS()
 
     rtksvrlock(rtksvr);
     time = rtksvr->rtk.sol.time;
+    rtksvrunlock(rtksvr);
+
+    const nav_t *nav = rtksvrpinnav(rtksvr, &pin);
     for (i = 0; i < MAXSAT; i++) {
-        if (i + off * MAXSAT < rtksvr->nav.n)
-            eph[i] = rtksvr->nav.eph[i + off * MAXSAT];
+        if (nav && i + off * MAXSAT < nav->n)
+            eph[i] = nav->eph[i + off * MAXSAT];
         else
             eph[i] = eph0;
     }
-    rtksvrunlock(rtksvr);
+    rtksvrunpinnav(rtksvr, pin);
 
     for (k = 0, nsat = 0; k < MAXSAT; k++) {
         int ssys = satsys(k + 1, &prn);
@@ -1299,20 +1308,23 @@ void MonitorDialog::showGlonassNavigations()
 	gtime_t time;
     QString s;
     char tstr[40], id[8];
-    int i, n, nsat, valid, prn, off = ui->cBSelectEphemeris->currentIndex();
+    int i, n, nsat, valid, prn, pin = -1, off = ui->cBSelectEphemeris->currentIndex();
 
     geph_t geph0;
     memset(&geph0, 0, sizeof(geph_t));
 
     rtksvrlock(rtksvr);
     time = rtksvr->rtk.sol.time;
+    rtksvrunlock(rtksvr);
+
+    const nav_t *nav = rtksvrpinnav(rtksvr, &pin);
     for (i = 0; i < NSATGLO; i++) {
-        if (i + off * NSATGLO < rtksvr->nav.ng)
-            geph[i] = rtksvr->nav.geph[i + off * NSATGLO];
+        if (nav && i + off * NSATGLO < nav->ng)
+            geph[i] = nav->geph[i + off * NSATGLO];
         else
             geph[i] = geph0;
     }
-    rtksvrunlock(rtksvr);
+    rtksvrunpinnav(rtksvr, pin);
 
     for (i = 0, nsat = 0; i < NSATGLO; i++) {
         valid = geph[i].toe.time != 0 && fabs(timediff(time, geph[i].toe)) <= MAXDTOE_GLO &&
@@ -1392,7 +1404,7 @@ void MonitorDialog::showSbsNavigations()
 {
     seph_t seph[NSATSBS];
 	gtime_t time;
-    int i, n, nsat, valid, prn, off = ui->cBSelectEphemeris->currentIndex();
+    int i, n, nsat, valid, prn, pin = -1, off = ui->cBSelectEphemeris->currentIndex();
     char tstr[40], id[8];
 
     seph_t seph0;
@@ -1400,13 +1412,16 @@ void MonitorDialog::showSbsNavigations()
 
     rtksvrlock(rtksvr); // lock
     time = rtksvr->rtk.sol.time;
+    rtksvrunlock(rtksvr); // unlock
+
+    const nav_t *nav = rtksvrpinnav(rtksvr, &pin); // pin
     for (int i = 0; i < NSATSBS; i++) {
-        if (i + off * NSATSBS < rtksvr->nav.ns)
-            seph[i] = rtksvr->nav.seph[i + off * NSATSBS];
+        if (nav && i + off * NSATSBS < nav->ns)
+            seph[i] = nav->seph[i + off * NSATSBS];
         else
             seph[i] = seph0;
     }
-    rtksvrunlock(rtksvr); // unlock
+    rtksvrunpinnav(rtksvr, pin); // unpin
 
     for (i = 0, nsat = 0; i < NSATSBS; i++) {
         valid = fabs(timediff(time, seph[i].t0)) <= MAXDTOE_SBS &&
@@ -1479,30 +1494,35 @@ void MonitorDialog::setIonUtc()
 //---------------------------------------------------------------------------
 void MonitorDialog::showIonUtc()
 {
-    double utc_gps[8], utc_glo[8], utc_gal[8], utc_qzs[8], utc_cmp[8], utc_irn[9];
-    double ion_gps[8], ion_gal[4], ion_qzs[8], ion_cmp[8], ion_irn[8];
+    double utc_gps[8] = {0}, utc_glo[8] = {0}, utc_gal[8] = {0}, utc_qzs[8] = {0}, utc_cmp[8] = {0}, utc_irn[9] = {0};
+    double ion_gps[8] = {0}, ion_gal[4] = {0}, ion_qzs[8] = {0}, ion_cmp[8] = {0}, ion_irn[8] = {0};
 	gtime_t time;
     double tow = 0.0;
 	char tstr[40];
-    int i, week = 0;
+    int i, week = 0, pin = -1;
 
     Q_UNUSED(utc_glo);
 
     rtksvrlock(rtksvr);
     time = rtksvr->rtk.sol.time;
-    for (i = 0; i < 8; i++) utc_gps[i] = rtksvr->nav.utc_gps[i];
-    for (i = 0; i < 8; i++) utc_glo[i] = rtksvr->nav.utc_glo[i];
-    for (i = 0; i < 8; i++) utc_gal[i] = rtksvr->nav.utc_gal[i];
-    for (i = 0; i < 8; i++) utc_qzs[i] = rtksvr->nav.utc_qzs[i];
-    for (i = 0; i < 8; i++) utc_cmp[i] = rtksvr->nav.utc_cmp[i];
-    for (i = 0; i < 9; i++) utc_irn[i] = rtksvr->nav.utc_irn[i];
-    for (i = 0; i < 8; i++) ion_gps[i] = rtksvr->nav.ion_gps[i];
-    for (i = 0; i < 4; i++) ion_gal[i] = rtksvr->nav.ion_gal[i];
-    for (i = 0; i < 8; i++) ion_qzs[i] = rtksvr->nav.ion_qzs[i];
-    for (i = 0; i < 8; i++) ion_cmp[i] = rtksvr->nav.ion_cmp[i];
-    for (i = 0; i < 8; i++) ion_irn[i] = rtksvr->nav.ion_irn[i];
     rtksvrunlock(rtksvr);
 
+    const nav_t *nav = rtksvrpinnav(rtksvr, &pin);
+    if (nav) {
+        for (i = 0; i < 8; i++) utc_gps[i] = nav->utc_gps[i];
+        for (i = 0; i < 8; i++) utc_glo[i] = nav->utc_glo[i];
+        for (i = 0; i < 8; i++) utc_gal[i] = nav->utc_gal[i];
+        for (i = 0; i < 8; i++) utc_qzs[i] = nav->utc_qzs[i];
+        for (i = 0; i < 8; i++) utc_cmp[i] = nav->utc_cmp[i];
+        for (i = 0; i < 9; i++) utc_irn[i] = nav->utc_irn[i];
+        for (i = 0; i < 8; i++) ion_gps[i] = nav->ion_gps[i];
+        for (i = 0; i < 4; i++) ion_gal[i] = nav->ion_gal[i];
+        for (i = 0; i < 8; i++) ion_qzs[i] = nav->ion_qzs[i];
+        for (i = 0; i < 8; i++) ion_cmp[i] = nav->ion_cmp[i];
+        for (i = 0; i < 8; i++) ion_irn[i] = nav->ion_irn[i];
+    }
+    rtksvrunpinnav(rtksvr, pin);
+
     i = 0;
     time2str(timeget(), tstr, 3);
     ui->tWConsole->item(i,   0)->setText(tr("CPU Time"));
@@ -1745,16 +1765,19 @@ void MonitorDialog::setSbsLong()
 //---------------------------------------------------------------------------
 void MonitorDialog::showSbsLong()
 {
-	sbssat_t sbssat;
+	sbssat_t sbssat = {0};
 	gtime_t time;
-    int i;
+    int i, pin = -1;
     char tstr[40], id[8];
 
     rtksvrlock(rtksvr); // lock
     time = rtksvr->rtk.sol.time;
-    sbssat = rtksvr->nav.sbssat;
     rtksvrunlock(rtksvr); // unlock
 
+    const nav_t *nav = rtksvrpinnav(rtksvr, &pin); // pin
+    if (nav) sbssat = nav->sbssat;
+    rtksvrunpinnav(rtksvr, pin); // unpin
+
     ui->lblInformation->setText(tr("IODP: %1,  System Latency: %2 s").arg(sbssat.iodp).arg(sbssat.tlat));
 
     if (sbssat.nsat < 1) {
@@ -1811,14 +1834,15 @@ void MonitorDialog::showSbsIono()
     QString s0 = "-";
     sbsion_t sbsion[MAXBAND + 1];
 	char tstr[40];
-    int i, j, k, n = 0;
+    int i, j, k, n = 0, pin = -1;
 
-    rtksvrlock(rtksvr); // lock
+    const nav_t *nav = rtksvrpinnav(rtksvr, &pin); // pin
     for (i = 0; i <= MAXBAND; i++) {
-        sbsion[i] = rtksvr->nav.sbsion[i];
+        if (nav) sbsion[i] = nav->sbsion[i];
+        else memset(sbsion + i, 0, sizeof(sbsion_t));
         n += sbsion[i].nigp;
     };
-    rtksvrunlock(rtksvr); // unlock
+    rtksvrunpinnav(rtksvr, pin); // unpin
 
     if (n < 1) {
         ui->tWConsole->setRowCount(0);
@@ -1867,16 +1891,19 @@ void MonitorDialog::setSbsFast()
 void MonitorDialog::showSbsFast()
 {
     QString s0 = "-";
-	sbssat_t sbssat;
+	sbssat_t sbssat = {0};
 	gtime_t time;
-    int i;
+    int i, pin = -1;
     char tstr[40], id[8];
 
     rtksvrlock(rtksvr); // lock
     time = rtksvr->rtk.sol.time;
-    sbssat = rtksvr->nav.sbssat;
     rtksvrunlock(rtksvr); // unlock
 
+    const nav_t *nav = rtksvrpinnav(rtksvr, &pin); // pin
+    if (nav) sbssat = nav->sbssat;
+    rtksvrunpinnav(rtksvr, pin); // unpin
+
     ui->lblInformation->setText(tr("IODP: %1,  System Latency: %2 s").arg(sbssat.iodp).arg(sbssat.tlat));
 
     if (sbssat.nsat < 1) {
@@ -2033,14 +2060,20 @@ void MonitorDialog::showRtcmDgps()
 {
 	gtime_t time;
 	dgps_t dgps[MAXSAT];
-    int i;
+    int i, pin = -1;
     char tstr[40], id[8];
 
     rtksvrlock(rtksvr);
     time = rtksvr->rtk.sol.time;
-    for (i = 0; i < MAXSAT; i++) dgps[i] = rtksvr->nav.dgps[i];
     rtksvrunlock(rtksvr);
 
+    const nav_t *nav = rtksvrpinnav(rtksvr, &pin);
+    for (i = 0; i < MAXSAT; i++) {
+        if (nav) dgps[i] = nav->dgps[i];
+        else memset(dgps + i, 0, sizeof(dgps_t));
+    }
+    rtksvrunpinnav(rtksvr, pin);
+
     for (i = 0; i < ui->tWConsole->rowCount(); i++) {
         int j = 0;
         satno2id(i + 1, id);
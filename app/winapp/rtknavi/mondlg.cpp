@@ -368,7 +368,7 @@ void __fastcall TMonitorDialog::ShowRtk(void)
 	double *del,*off,runtime,rt[3]={0},dop[4]={0};
 	double azel[MAXSAT*2],pos[3],vel[3],rr[3]={0},enu[3]={0};
 	int i,j,k,thread,cycle,state,rtkstat,nsat0,nsat1,prcout,nave;
-	int cputime,nb[3]={0},nmsg[3][10]={{0}},ne;
+	int cputime,nb[3]={0},nmsg[3][10]={{0}},ne,pin=-1;
 	char tstr[40],*ant,id[8],s1[40]="-",s2[40]="-",s3[40]="-";
 	char file[1024]="";
 	const char *ionoopt[]={"OFF","Broadcast","SBAS","Dual-Frequency","Estimate STEC","IONEX TEC","QZSS LEX",""};
@@ -399,15 +399,19 @@ void __fastcall TMonitorDialog::ShowRtk(void)
 		rt[0]=floor(runtime/3600.0); runtime-=rt[0]*3600.0;
 		rt[1]=floor(runtime/60.0); rt[2]=runtime-rt[1]*60.0;
 	}
-	if ((ne=rtksvr.nav.ne)>0) {
-		time2str(rtksvr.nav.peph[   0].time,s1,0);
-		time2str(rtksvr.nav.peph[ne-1].time,s2,0);
-		time2str(rtksvr.ftime[2],s3,0);
-	}
+	if (rtksvr.nav.ne>0) time2str(rtksvr.ftime[2],s3,0);
 	strcpy(file,rtksvr.files[2]);
 
 	rtksvrunlock(&rtksvr); // unlock
 	
+	// precise ephemeris from pinned navigation data snapshot
+	const nav_t *nav=rtksvrpinnav(&rtksvr,&pin);
+	if (nav&&(ne=nav->ne)>0) {
+		time2str(nav->peph[   0].time,s1,0);
+		time2str(nav->peph[ne-1].time,s2,0);
+	}
+	rtksvrunpinnav(&rtksvr,pin);
+	
 	for (j=k=0;j<MAXSAT;j++) {
 		if (rtk->opt.mode==PMODE_SINGLE&&!rtk->ssat[j].vs) continue;
 		if (rtk->opt.mode!=PMODE_SINGLE&&!rtk->ssat[j].vsat[0]) continue;
@@ -717,7 +721,7 @@ void __fastcall TMonitorDialog::ShowSat(void)
 {
 	ssat_t *ssat;
 	AnsiString s;
-	int i,j,k,n,fix,prn,pmode,nfreq,sys=sys_tbl[SelSys->ItemIndex];
+	int i,j,k,n,fix,prn,pmode,nfreq,pin=-1,sys=sys_tbl[SelSys->ItemIndex];
 	int vsat[MAXSAT]={0};
 	char id[8];
 	double az,el,cbias[MAXSAT][2];
@@ -729,13 +733,16 @@ void __fastcall TMonitorDialog::ShowSat(void)
 
 	rtksvrlock(&rtksvr);
 	*rtk=rtksvr.rtk;
-	for (i=0;i<MAXSAT;i++) for (j=0;j<2;j++) {
-		cbias[i][j]=rtksvr.nav.cbias[i][j][0];
-	}
 	pmode=rtksvr.rtk.opt.mode;
 	nfreq=rtksvr.rtk.opt.nf;
 	rtksvrunlock(&rtksvr);
 	
+	const nav_t *nav=rtksvrpinnav(&rtksvr,&pin);
+	for (i=0;i<MAXSAT;i++) for (j=0;j<2;j++) {
+		cbias[i][j]=nav?nav->cbias[i][j][0]:0.0;
+	}
+	rtksvrunpinnav(&rtksvr,pin);
+	
 	Label->Caption="";
 	
 	for (i=0;i<MAXSAT;i++) {
@@ -1071,11 +1078,11 @@ void __fastcall TMonitorDialog::SetNav(void)
 //---------------------------------------------------------------------------
 void __fastcall TMonitorDialog::ShowNav(void)
 {
-	eph_t eph[MAXSAT];
+	eph_t eph[MAXSAT]={0};
 	gtime_t time;
 	AnsiString s;
 	char tstr[40],id[8];
-	int i,j,k,n,valid,prn,off=SelEph->ItemIndex*MAXSAT;
+	int i,j,k,n,valid,prn,pin=-1,off=SelEph->ItemIndex*MAXSAT;
 	int sys=sys_tbl[SelSys2->ItemIndex+1];
 	
 	if (sys==SYS_GLO) {
@@ -1092,8 +1099,11 @@ void __fastcall TMonitorDialog::ShowNav(void)
 	
 	rtksvrlock(&rtksvr);
 	time=rtksvr.rtk.sol.time;
-	for (i=0;i<MAXSAT;i++) eph[i]=rtksvr.nav.eph[i+off];
 	rtksvrunlock(&rtksvr);
+	
+	const nav_t *nav=rtksvrpinnav(&rtksvr,&pin);
+	if (nav) for (i=0;i<MAXSAT;i++) eph[i]=nav->eph[i+off];
+	rtksvrunpinnav(&rtksvr,pin);
 
 	if (sys==SYS_GAL) {
 	    Label->Caption=(SelEph->ItemIndex%2)?"F/NAV":"I/NAV";
@@ -1190,17 +1200,20 @@ void __fastcall TMonitorDialog::SetGnav(void)
 //---------------------------------------------------------------------------
 void __fastcall TMonitorDialog::ShowGnav(void)
 {
-	geph_t geph[NSATGLO];
+	geph_t geph[NSATGLO]={0};
 	gtime_t time;
 	AnsiString s;
 	char tstr[40],id[8];
-	int i,j,n,valid,prn,off=SelEph->ItemIndex?NSATGLO:0;
+	int i,j,n,valid,prn,pin=-1,off=SelEph->ItemIndex?NSATGLO:0;
 	
 	rtksvrlock(&rtksvr);
 	time=rtksvr.rtk.sol.time;
-	for (i=0;i<NSATGLO;i++) geph[i]=rtksvr.nav.geph[i+off];
 	rtksvrunlock(&rtksvr);
 	
+	const nav_t *nav=rtksvrpinnav(&rtksvr,&pin);
+	if (nav) for (i=0;i<NSATGLO;i++) geph[i]=nav->geph[i+off];
+	rtksvrunpinnav(&rtksvr,pin);
+	
 	Label->Caption="";
 	
 	for (i=0,n=1;i<NSATGLO;i++) {
@@ -1274,16 +1287,19 @@ void __fastcall TMonitorDialog::ShowSbsNav(void)
 	AnsiString s,s0="-";
 	seph_t seph[MAXPRNSBS-MINPRNSBS+1]={0};
 	gtime_t time;
-	int i,j,n,valid,prn,off=SelEph->ItemIndex?NSATSBS:0;
+	int i,j,n,valid,prn,pin=-1,off=SelEph->ItemIndex?NSATSBS:0;
 	char tstr[40],id[8];
 	
 	rtksvrlock(&rtksvr); // lock
 	time=rtksvr.rtk.sol.time;
-	for (int i=0;i<NSATSBS;i++) {
-		seph[i]=rtksvr.nav.seph[i+off];
-	}
 	rtksvrunlock(&rtksvr); // unlock
 	
+	const nav_t *nav=rtksvrpinnav(&rtksvr,&pin); // pin
+	if (nav) for (int i=0;i<NSATSBS;i++) {
+		seph[i]=nav->seph[i+off];
+	}
+	rtksvrunpinnav(&rtksvr,pin); // unpin
+	
 	Label->Caption="";
 	
 	for (i=0,n=1;i<NSATSBS;i++) {
@@ -1348,29 +1364,36 @@ void __fastcall TMonitorDialog::SetIonUtc(void)
 //---------------------------------------------------------------------------
 void __fastcall TMonitorDialog::ShowIonUtc(void)
 {
-	double utc_gps[8],utc_glo[8],utc_gal[8],utc_qzs[8],utc_cmp[8],utc_irn[9];
-	double ion_gps[8],ion_gal[4],ion_qzs[8],ion_cmp[8],ion_irn[8];
+	double utc_gps[8]={0},utc_glo[8]={0},utc_gal[8]={0},utc_qzs[8]={0};
+	double utc_cmp[8]={0},utc_irn[9]={0};
+	double ion_gps[8]={0},ion_gal[4]={0},ion_qzs[8]={0},ion_cmp[8]={0};
+	double ion_irn[8]={0};
 	gtime_t time;
 	AnsiString s;
 	double tow=0.0;
 	char tstr[40];
-	int i,j,k,leaps,week=0;
+	int i,j,k,leaps,week=0,pin=-1;
 	
 	rtksvrlock(&rtksvr);
 	time=rtksvr.rtk.sol.time;
-	for (i=0;i<8;i++) utc_gps[i]=rtksvr.nav.utc_gps[i];
-	for (i=0;i<8;i++) utc_glo[i]=rtksvr.nav.utc_glo[i];
-	for (i=0;i<8;i++) utc_gal[i]=rtksvr.nav.utc_gal[i];
-	for (i=0;i<8;i++) utc_qzs[i]=rtksvr.nav.utc_qzs[i];
-	for (i=0;i<8;i++) utc_cmp[i]=rtksvr.nav.utc_cmp[i];
-	for (i=0;i<9;i++) utc_irn[i]=rtksvr.nav.utc_irn[i];
-	for (i=0;i<8;i++) ion_gps[i]=rtksvr.nav.ion_gps[i];
-	for (i=0;i<4;i++) ion_gal[i]=rtksvr.nav.ion_gal[i];
-	for (i=0;i<8;i++) ion_qzs[i]=rtksvr.nav.ion_qzs[i];
-	for (i=0;i<8;i++) ion_cmp[i]=rtksvr.nav.ion_cmp[i];
-	for (i=0;i<8;i++) ion_irn[i]=rtksvr.nav.ion_irn[i];
 	rtksvrunlock(&rtksvr);
 	
+	const nav_t *nav=rtksvrpinnav(&rtksvr,&pin);
+	if (nav) {
+		for (i=0;i<8;i++) utc_gps[i]=nav->utc_gps[i];
+		for (i=0;i<8;i++) utc_glo[i]=nav->utc_glo[i];
+		for (i=0;i<8;i++) utc_gal[i]=nav->utc_gal[i];
+		for (i=0;i<8;i++) utc_qzs[i]=nav->utc_qzs[i];
+		for (i=0;i<8;i++) utc_cmp[i]=nav->utc_cmp[i];
+		for (i=0;i<9;i++) utc_irn[i]=nav->utc_irn[i];
+		for (i=0;i<8;i++) ion_gps[i]=nav->ion_gps[i];
+		for (i=0;i<4;i++) ion_gal[i]=nav->ion_gal[i];
+		for (i=0;i<8;i++) ion_qzs[i]=nav->ion_qzs[i];
+		for (i=0;i<8;i++) ion_cmp[i]=nav->ion_cmp[i];
+		for (i=0;i<8;i++) ion_irn[i]=nav->ion_irn[i];
+	}
+	rtksvrunpinnav(&rtksvr,pin);
+	
 	Label->Caption="";
 	
 	Tbl->RowCount=21;
@@ -1629,17 +1652,20 @@ void __fastcall TMonitorDialog::SetSbsLong(void)
 void __fastcall TMonitorDialog::ShowSbsLong(void)
 {
 	AnsiString s;
-	sbssat_t sbssat;
+	sbssat_t sbssat={0};
 	sbssatp_t *satp;
 	gtime_t time;
-	int i,j,n,valid;
+	int i,j,n,valid,pin=-1;
 	char tstr[40],id[8];
 	
 	rtksvrlock(&rtksvr); // lock
 	time=rtksvr.rtk.sol.time;
-	sbssat=rtksvr.nav.sbssat;
 	rtksvrunlock(&rtksvr); // unlock
 	
+	const nav_t *nav=rtksvrpinnav(&rtksvr,&pin); // pin
+	if (nav) sbssat=nav->sbssat;
+	rtksvrunpinnav(&rtksvr,pin); // unpin
+	
 	Label->Caption="";
 	Tbl->RowCount=sbssat.nsat<=0?1:sbssat.nsat+1;
 	Label->Caption=s.sprintf("IODP:%2d  System Latency:%2d s",
@@ -1685,13 +1711,13 @@ void __fastcall TMonitorDialog::SetSbsIono(void)
 void __fastcall TMonitorDialog::ShowSbsIono(void)
 {
 	AnsiString s,s0="-";
-	sbsion_t sbsion[MAXBAND+1],*ion;
+	sbsion_t sbsion[MAXBAND+1]={0},*ion;
 	char tstr[40];
-	int i,j,k,n=0;
+	int i,j,k,n=0,pin=-1;
 	
-	rtksvrlock(&rtksvr); // lock
-	for (i=0;i<=MAXBAND;i++) sbsion[i]=rtksvr.nav.sbsion[i];
-	rtksvrunlock(&rtksvr); // unlock
+	const nav_t *nav=rtksvrpinnav(&rtksvr,&pin); // pin
+	if (nav) for (i=0;i<=MAXBAND;i++) sbsion[i]=nav->sbsion[i];
+	rtksvrunpinnav(&rtksvr,pin); // unpin
 	
 	Label->Caption="";
 	for (i=0;i<MAXBAND+1;i++) {
@@ -1731,17 +1757,20 @@ void __fastcall TMonitorDialog::SetSbsFast(void)
 void __fastcall TMonitorDialog::ShowSbsFast(void)
 {
 	AnsiString s,s0="-";
-	sbssat_t sbssat;
+	sbssat_t sbssat={0};
 	sbssatp_t *satp;
 	gtime_t time;
-	int i,j,n,valid;
+	int i,j,n,valid,pin=-1;
 	char tstr[40],id[8];
 	
 	rtksvrlock(&rtksvr); // lock
 	time=rtksvr.rtk.sol.time;
-	sbssat=rtksvr.nav.sbssat;
 	rtksvrunlock(&rtksvr); // unlock
 	
+	const nav_t *nav=rtksvrpinnav(&rtksvr,&pin); // pin
+	if (nav) sbssat=nav->sbssat;
+	rtksvrunpinnav(&rtksvr,pin); // unpin
+	
 	Label->Caption="";
 	Tbl->RowCount=sbssat.nsat<=0?1:sbssat.nsat+1;
 	//Label->Caption=s.sprintf("IODP:%2d  System Latency:%2d s",sbssat.iodp,sbssat.tlat);
@@ -1881,15 +1910,18 @@ void __fastcall TMonitorDialog::ShowRtcmDgps(void)
 {
 	AnsiString s;
 	gtime_t time;
-	dgps_t dgps[MAXSAT];
-	int i,j,valid;
+	dgps_t dgps[MAXSAT]={0};
+	int i,j,valid,pin=-1;
 	char tstr[40],id[8];
 	
 	rtksvrlock(&rtksvr);
 	time=rtksvr.rtk.sol.time;
-	for (i=0;i<MAXSAT;i++) dgps[i]=rtksvr.nav.dgps[i];
 	rtksvrunlock(&rtksvr);
 	
+	const nav_t *nav=rtksvrpinnav(&rtksvr,&pin);
+	if (nav) for (i=0;i<MAXSAT;i++) dgps[i]=nav->dgps[i];
+	rtksvrunpinnav(&rtksvr,pin);
+	
 	Label->Caption="";
 	Tbl->RowCount=MAXSAT+1;
 	
@@ -43,6 +43,11 @@
 *                           fix bug on screening time in screent_ttol()
 *                           fix bug on screening QZS L1S messages as SBAS
 *                           use integer types in stdint.h
+*           2026/10/16 1.16 add single-pass conversion without scanning input
+*                           files (rnxopt_t onepass)
+*                           add parallel conversion of sessions and input
+*                           files (rnxopt_t nthread)
+*                           add API convrnxm()
 *-----------------------------------------------------------------------------*/
 #include "rtklib.h"
 
@@ -87,6 +92,41 @@ typedef struct {                /* stream file type */
     FILE   *fp;                 /* output file pointer */
 } strfile_t;
 
+typedef struct {                /* spilled observation epoch header type */
+    gtime_t time;               /* message time */
+    int n;                      /* number of observation data */
+    int flag;                   /* event flag */
+    int staid;                  /* station ID */
+} spillh_t;
+
+typedef struct {                /* conversion job type */
+    int sess;                   /* session number (0:single session) */
+    int ifile;                  /* index of input file */
+    const char *file;           /* input file */
+    char **ofile;               /* output files */
+    const rnxopt_t *opt;        /* RINEX options of input file */
+    gtime_t ts,te,trtcm;        /* time span and RTCM time of session */
+    gtime_t tstart,tend;        /* first and last observation time */
+    int stat;                   /* status (1:ok,0:error,-1:abort/not run) */
+} convjob_t;
+
+typedef struct {                /* output path of conversion job type */
+    char *path;                 /* output path */
+    int job;                    /* index of job */
+} jobpath_t;
+
+typedef struct {                /* conversion job pool type */
+    int format;                 /* receiver raw format (STRFMT_???) */
+    convjob_t *job;             /* conversion jobs */
+    int njob;                   /* number of jobs */
+    int *idx;                   /* indices of jobs sorted by chains */
+    int *chain;                 /* start of chains in idx (nchain+1) */
+    int nchain;                 /* number of chains */
+    int next;                   /* next chain to convert */
+    int abort;                  /* abort flag */
+    rtklib_lock_t lock;         /* lock flag */
+} convpool_t;
+
 /* global variables ----------------------------------------------------------*/
 static const int navsys[RNX_NUMSYS]={     /* system codes */
     SYS_GPS,SYS_GLO,SYS_GAL,SYS_QZS,SYS_SBS,SYS_CMP,SYS_IRN
@@ -308,14 +348,14 @@ static int open_strfile(strfile_t *str, const char *file)
     trace(3,"open_strfile: file=%s\n",file);
     
     if (str->format==STRFMT_RTCM2||str->format==STRFMT_RTCM3) {
-        if (!(str->fp=fopen(file,"rb"))) {
+        if (!(str->fp=fopen_fbuf(&str->rtcm.fbuf,file,"rb"))) {
             showmsg("rtcm open error: %s",file);
             return 0;
         }
         str->rtcm.time=str->time;
     }
     else if (str->format<=MAXRCVFMT) {
-        if (!(str->fp=fopen(file,"rb"))) {
+        if (!(str->fp=fopen_fbuf(&str->raw.fbuf,file,"rb"))) {
             showmsg("log open error: %s",file);
             return 0;
         }
@@ -342,10 +382,10 @@ static void close_strfile(strfile_t *str)
     trace(3,"close_strfile:\n");
     
     if (str->format==STRFMT_RTCM2||str->format==STRFMT_RTCM3) {
-        if (str->fp) fclose(str->fp);
+        fclose_fbuf(&str->rtcm.fbuf,str->fp);
     }
     else if (str->format<=MAXRCVFMT) {
-        if (str->fp) fclose(str->fp);
+        fclose_fbuf(&str->raw.fbuf,str->fp);
     }
     else if (str->format==STRFMT_RINEX) {
         if (str->fp) fclose(str->fp);
@@ -751,85 +791,60 @@ static void resolve_halfc(const strfile_t *str, obsd_t *data, int n)
         }
     }
 }
-/* scan input files ----------------------------------------------------------*/
-static int scan_file(char **files, int nf, rnxopt_t *opt, strfile_t *str,
-                     int *mask)
+/* scan message for obs-types and station info ------------------------------*/
+static void scan_msg(strfile_t *str, const rnxopt_t *opt, int type,
+                     uint8_t codes[][33], uint8_t types[][33], int *n)
 {
-    eph_t  eph0 ={0,-1,-1};
-    geph_t geph0={0,-1};
-    seph_t seph0={0};
-    uint8_t codes[RNX_NUMSYS][33]={{0}};
-    uint8_t types[RNX_NUMSYS][33]={{0}};
-    char msg[128];
-    int i,j,k,l,m,c=0,type,sys,prn,abort=0,n[RNX_NUMSYS]={0};
-    
-    trace(3,"scan_file: nf=%d\n",nf);
-    
-    for (m=0;m<nf&&!abort;m++) {
-        
-        if (!open_strfile(str,files[m])) {
-            continue;
-        }
-        while ((type=input_strfile(str))>=-1) {
-            if (opt->ts.time&&timediff(str->time,opt->ts)<-opt->ttol) continue;
-            if (opt->te.time&&timediff(str->time,opt->te)>-opt->ttol) break;
-            mask[m]=1; /* update file mask */
+    int i,j,k,l,sys;
+    
+    if (type==1) { /* observation data */
+        for (i=0;i<str->obs->n;i++) {
+            sys=satsys(str->obs->data[i].sat,NULL);
+            if (!(sys&opt->navsys)) continue;
+            /* Mapping from SYS_ to RNX_SYS_ */
+            for (l=0;l<RNX_NUMSYS;l++) if (navsys[l]==sys) break;
+            if (l>=RNX_NUMSYS) continue;
             
-            if (type==1) { /* observation data */
-                for (i=0;i<str->obs->n;i++) {
-                    sys=satsys(str->obs->data[i].sat,NULL);
-                    if (!(sys&opt->navsys)) continue;
-                    /* Mapping from SYS_ to RNX_SYS_ */
-                    for (l=0;l<RNX_NUMSYS;l++) if (navsys[l]==sys) break;
-                    if (l>=RNX_NUMSYS) continue;
-                    
-                    /* update obs-types */
-                    for (j=0;j<NFREQ+NEXOBS;j++) {
-                        int c=str->obs->data[i].code[j];
-                        if (c==CODE_NONE) continue;
-                        
-                        for (k=0;k<n[l];k++) {
-                            if (codes[l][k]==c) break;
-                        }
-                        if (k>=n[l]&&n[l]<32) {
-                            codes[l][n[l]++]=c;
-                        }
-                        if (k<n[l]) {
-                            if (str->obs->data[i].P[j]!=0.0) types[l][k]|=1;
-                            if (str->obs->data[i].L[j]!=0.0) types[l][k]|=2;
-                            if (str->obs->data[i].D[j]!=0.0) types[l][k]|=4;
-                            if (str->obs->data[i].SNR[j]!=0) types[l][k]|=8;
-                        }
-                    }
-                    /* update half-cycle ambiguity list */
-                    if (opt->halfcyc) {
-                        update_halfc(str,str->obs->data+i);
-                    }
+            /* update obs-types */
+            for (j=0;j<NFREQ+NEXOBS;j++) {
+                int c=str->obs->data[i].code[j];
+                if (c==CODE_NONE) continue;
+                
+                for (k=0;k<n[l];k++) {
+                    if (codes[l][k]==c) break;
+                }
+                if (k>=n[l]&&n[l]<32) {
+                    codes[l][n[l]++]=c;
+                }
+                if (k<n[l]) {
+                    if (str->obs->data[i].P[j]!=0.0) types[l][k]|=1;
+                    if (str->obs->data[i].L[j]!=0.0) types[l][k]|=2;
+                    if (str->obs->data[i].D[j]!=0.0) types[l][k]|=4;
+                    if (str->obs->data[i].SNR[j]!=0) types[l][k]|=8;
                 }
-                /* update station list */
-                update_stas(str);
             }
-            else if (type==5) { /* station info */
-                /* update station info */
-                update_stainf(str);
+            /* update half-cycle ambiguity list */
+            if (opt->halfcyc) {
+                update_halfc(str,str->obs->data+i);
             }
-            if (++c%11) continue;
-            
-            char tstr[40];
-            snprintf(msg,sizeof(msg),"scanning: %s %s%s%s%s%s%s%s",
-                     time2str(str->time,tstr,0),
-                     n[0]?"G":"",n[1]?"R":"",n[2]?"E":"",n[3]?"J":"",
-                     n[4]?"S":"",n[5]?"C":"",n[6]?"I":"");
-            if ((abort=showmsg(msg))) break;
         }
-        close_strfile(str);
+        /* update station list */
+        update_stas(str);
     }
-    showmsg("");
-    
-    if (abort) {
-        trace(2,"aborted in scan\n");
-        return 0;
+    else if (type==5) { /* station info */
+        /* update station info */
+        update_stainf(str);
     }
+}
+/* set scanned obs-types and station info in RINEX options -------------------*/
+static void setopt_scan(strfile_t *str, rnxopt_t *opt, uint8_t codes[][33],
+                        uint8_t types[][33], const int *n, int clear)
+{
+    eph_t  eph0 ={0,-1,-1};
+    geph_t geph0={0,-1};
+    seph_t seph0={0};
+    int i,j,prn;
+    
     for (i=0;i<RNX_NUMSYS;i++) for (j=0;j<n[i];j++) {
         trace(2,"scan_file: sys=%d code=%s type=%d\n",i,code2obs(codes[i][j]),
               types[i][j]);
@@ -851,19 +866,61 @@ static int scan_file(char **files, int nf, rnxopt_t *opt, strfile_t *str,
         setopt_phshift(opt);
     }
     /* set GLONASS FCN and clear ephemeris */
-    for (i=0;i<str->nav->n;i++) {
+    for (i=0;i<str->nav->n&&clear;i++) {
         str->nav->eph[i]=eph0;
     }
     for (i=0;i<str->nav->ng;i++) {
         if (satsys(str->nav->geph[i].sat,&prn)!=SYS_GLO) continue;
         str->nav->glo_fcn[prn-1]=str->nav->geph[i].frq+8;
-        str->nav->geph[i]=geph0;
+        if (clear) str->nav->geph[i]=geph0;
     }
-    for (i=0;i<str->nav->ns;i++) {
+    for (i=0;i<str->nav->ns&&clear;i++) {
         str->nav->seph[i]=seph0;
     }
     dump_stas(str);
     dump_halfc(str);
+}
+/* scan input files ----------------------------------------------------------*/
+static int scan_file(char **files, int nf, rnxopt_t *opt, strfile_t *str,
+                     int *mask)
+{
+    uint8_t codes[RNX_NUMSYS][33]={{0}};
+    uint8_t types[RNX_NUMSYS][33]={{0}};
+    char msg[128];
+    int m,c=0,type,abort=0,n[RNX_NUMSYS]={0};
+    
+    trace(3,"scan_file: nf=%d\n",nf);
+    
+    for (m=0;m<nf&&!abort;m++) {
+        
+        if (!open_strfile(str,files[m])) {
+            continue;
+        }
+        while ((type=input_strfile(str))>=-1) {
+            if (opt->ts.time&&timediff(str->time,opt->ts)<-opt->ttol) continue;
+            if (opt->te.time&&timediff(str->time,opt->te)>-opt->ttol) break;
+            mask[m]=1; /* update file mask */
+            
+            scan_msg(str,opt,type,codes,types,n);
+            
+            if (++c%11) continue;
+            
+            char tstr[40];
+            snprintf(msg,sizeof(msg),"scanning: %s %s%s%s%s%s%s%s",
+                     time2str(str->time,tstr,0),
+                     n[0]?"G":"",n[1]?"R":"",n[2]?"E":"",n[3]?"J":"",
+                     n[4]?"S":"",n[5]?"C":"",n[6]?"I":"");
+            if ((abort=showmsg(msg))) break;
+        }
+        close_strfile(str);
+    }
+    showmsg("");
+    
+    if (abort) {
+        trace(2,"aborted in scan\n");
+        return 0;
+    }
+    setopt_scan(str,opt,codes,types,n,1);
     return 1;
 }
 /* write RINEX header --------------------------------------------------------*/
@@ -1033,30 +1090,30 @@ static int cmpobs(const void *p1, const void *p2)
     obsd_t *obs1 = (obsd_t *)p1, *obs2 = (obsd_t *)p2;
     return obs1->sat - obs2->sat;
 }
-/* convert observation data --------------------------------------------------*/
-static void convobs(FILE **ofp, rnxopt_t *opt, strfile_t *str, int *n,
-                    gtime_t *tend, int *staid)
+/* screen observation data ---------------------------------------------------*/
+static int screenobs(rnxopt_t *opt, strfile_t *str, gtime_t *tend)
 {
-    gtime_t time;
-    int i,j;
-    
-    trace(3,"convobs :\n");
-    
-    if (!ofp[0]||str->obs->n<=0) return;
-    
-    time=str->obs->data[0].time;
+    gtime_t time=str->obs->data[0].time;
     
     /* Avoid duplicated data by multiple files handover */
-    if (tend->time&&timediff(time,*tend)<-opt->ttol) return;
+    if (tend->time&&timediff(time,*tend)<-opt->ttol) return 0;
     *tend=time;
 
     /* save cycle slips */
     save_slips(str,str->obs->data,str->obs->n);
     
-    if (!screent_ttol(time,opt->ts,opt->te,opt->tint,opt->ttol)) return;
+    if (!screent_ttol(time,opt->ts,opt->te,opt->tint,opt->ttol)) return 0;
     
     /* restore cycle slips */
     rest_slips(str,str->obs->data,str->obs->n);
+    return 1;
+}
+/* output observation data ---------------------------------------------------*/
+static void outobs(FILE **ofp, rnxopt_t *opt, strfile_t *str, int *n,
+                   int *staid)
+{
+    gtime_t time=str->obs->data[0].time;
+    int i,j;
     
     if (str->staid!=*staid) { /* station ID changed */
         
@@ -1095,6 +1152,18 @@ static void convobs(FILE **ofp, rnxopt_t *opt, strfile_t *str, int *n,
     
     n[0]++;
 }
+/* convert observation data --------------------------------------------------*/
+static void convobs(FILE **ofp, rnxopt_t *opt, strfile_t *str, int *n,
+                    gtime_t *tend, int *staid)
+{
+    trace(3,"convobs :\n");
+    
+    if (!ofp[0]||str->obs->n<=0) return;
+    
+    if (!screenobs(opt,str,tend)) return;
+    
+    outobs(ofp,opt,str,n,staid);
+}
 /* convert navigation data --------------------------------------------------*/
 static void convnav(FILE **ofp, rnxopt_t *opt, strfile_t *str, int *n)
 {
@@ -1282,6 +1351,197 @@ static int showstat(int sess, gtime_t ts, gtime_t te, int *n)
     }
     return showmsg(msg);
 }
+/* spill observation data to temporary file ----------------------------------*/
+static int spillobs(FILE *fp, rnxopt_t *opt, strfile_t *str, int *n,
+                    gtime_t *tend)
+{
+    spillh_t h;
+    
+    if (!fp||str->obs->n<=0||!screenobs(opt,str,tend)) return 0;
+    
+    h.time=str->time;
+    h.n=str->obs->n;
+    h.flag=str->obs->flag;
+    h.staid=str->staid;
+    fwrite(&h,sizeof(h),1,fp);
+    fwrite(str->obs->data,sizeof(obsd_t),h.n,fp);
+    
+    /* set to zero flag as cleared by output */
+    str->obs->flag=0;
+    n[0]++;
+    return 1;
+}
+/* restore observation data from temporary file ------------------------------*/
+static int restobs(FILE *fp, strfile_t *str)
+{
+    spillh_t h;
+    
+    if (fread(&h,sizeof(h),1,fp)<1||h.n<=0||h.n>MAXOBS||
+        fread(str->obs->data,sizeof(obsd_t),h.n,fp)<(size_t)h.n) {
+        return 0;
+    }
+    str->time=h.time;
+    str->obs->n=h.n;
+    str->obs->flag=h.flag;
+    str->staid=h.staid;
+    return 1;
+}
+/* copy temporary file up to current position --------------------------------*/
+static int copytmp(FILE *ifp, FILE *ofp)
+{
+    char buff[8192];
+    long len=ftell(ifp);
+    size_t n;
+    
+    rewind(ifp);
+    while (len>0) {
+        n=len<(long)sizeof(buff)?(size_t)len:sizeof(buff);
+        if (fread(buff,1,n,ifp)<n||fwrite(buff,1,n,ofp)<n) return 0;
+        len-=(long)n;
+    }
+    return 1;
+}
+/* close temporary files -----------------------------------------------------*/
+static void closetmp(FILE **tfp)
+{
+    int i;
+    
+    for (i=0;i<NOUTFILE;i++) {
+        if (tfp[i]) fclose(tfp[i]);
+        tfp[i]=NULL;
+    }
+}
+/* RINEX converter for single-session in single pass ---------------------------
+* decode input files once instead of scanning them before conversion. obs data
+* are spilled to a temporary file until obs-types and station info are known,
+* nav and SBAS messages are written to temporary files and copied after RINEX
+* headers.
+*-----------------------------------------------------------------------------*/
+static int convrnx_1p(int sess, int format, rnxopt_t *opt, const char *path,
+                      char **epath, int nf, strfile_t *str, char **ofile)
+{
+    FILE *ofp[NOUTFILE]={NULL},*tfp[NOUTFILE]={NULL};
+    gtime_t tend[3]={{0}};
+    uint8_t codes[RNX_NUMSYS][33]={{0}};
+    uint8_t types[RNX_NUMSYS][33]={{0}};
+    int i,j,type,n[NOUTFILE+2]={0},nc[RNX_NUMSYS]={0};
+    int mask[MAXEXFILE]={0},nspill=0,staid=-1,abort=0;
+    char *paths[NOUTFILE],s[NOUTFILE][1024];
+    char *staname=*opt->staid?opt->staid:"0000";
+    
+    trace(3,"convrnx_1p: sess=%d nf=%d\n",sess,nf);
+    
+    /* open temporary files */
+    for (i=0;i<NOUTFILE;i++) {
+        if (!*ofile[i]) continue;
+        if (!(tfp[i]=tmpfile())) {
+            showmsg("temporary file open error");
+            closetmp(tfp);
+            return 0;
+        }
+    }
+    for (i=0;i<nf&&!abort;i++) {
+        
+        /* open stream file */
+        if (!open_strfile(str,epath[i])) continue;
+        
+        /* input message */
+        for (j=0;(type=input_strfile(str))>=-1;j++) {
+            
+            if (!(j%11)&&(abort=showstat(sess,str->time,str->time,n))) break;
+            if (opt->te.time&&timediff(str->time,opt->te)>-opt->ttol) break;
+            
+            /* scan obs-types and station info */
+            if (!opt->ts.time||timediff(str->time,opt->ts)>=-opt->ttol) {
+                mask[i]=1; /* update file mask */
+                scan_msg(str,opt,type,codes,types,nc);
+            }
+            /* convert message */
+            switch (type) {
+                case  1: nspill+=spillobs(tfp[0],opt,str,n,tend); break;
+                case  2: convnav(tfp,opt,str,n); break;
+                case  3: convsbs(tfp,opt,str,n,tend+1); break;
+                case -1: n[NOUTFILE]++; break; /* error */
+            }
+            /* set approx position in rinex option */
+            if (type==1&&!opt->autopos&&norm(opt->apppos,3)<=0.0) {
+                setopt_apppos(str,opt);
+            }
+        }
+        /* close stream file */
+        close_strfile(str);
+    }
+    for (i=0;i<NOUTFILE;i++) {
+        if (!tfp[i]||!ferror(tfp[i])) continue;
+        showmsg("temporary file write error");
+        closetmp(tfp);
+        return 0;
+    }
+    if (abort) {
+        trace(2,"aborted in conversion\n");
+        closetmp(tfp);
+        return -1;
+    }
+    /* set obs-types and station info in RINEX options */
+    setopt_scan(str,opt,codes,types,nc,0);
+    
+    /* set format and file in RINEX options comments */
+    setopt_file(format,epath,nf,mask,opt);
+    
+    /* replace keywords in output file */
+    for (i=0;i<NOUTFILE;i++) {
+        paths[i]=s[i];
+        if (reppath(ofile[i],paths[i],opt->ts.time?opt->ts:str->tstart,
+                    staname,"")<0) {
+            showmsg("no time for output path: %s",ofile[i]);
+            closetmp(tfp);
+            return 0;
+        }
+    }
+    /* open output files */
+    if (!openfile(ofp,paths,path,opt,str->nav)) {
+        closetmp(tfp);
+        return 0;
+    }
+    /* copy nav and SBAS messages after RINEX headers */
+    for (i=1;i<NOUTFILE;i++) {
+        if (!ofp[i]||!tfp[i]) continue;
+        if (!copytmp(tfp[i],ofp[i])) {
+            showmsg("temporary file copy error");
+            abort=1;
+        }
+    }
+    /* output spilled obs data */
+    if (ofp[0]&&tfp[0]) {
+        rewind(tfp[0]);
+        n[0]=0;
+        for (j=0;j<nspill&&!abort;j++) {
+            if (!restobs(tfp[0],str)) {
+                showmsg("temporary file read error");
+                abort=1;
+                break;
+            }
+            if (!(j%11)&&(abort=showstat(sess,str->time,str->time,n))) break;
+            
+            outobs(ofp,opt,str,n,&staid);
+        }
+    }
+    closetmp(tfp);
+    
+    /* close output files */
+    closefile(ofp,opt,str->nav);
+    
+    /* remove empty output files */
+    for (i=0;i<NOUTFILE;i++) {
+        if (ofp[i]&&n[i]<=0) remove(ofile[i]);
+    }
+    showstat(sess,opt->tstart,opt->tend,n);
+    
+    /* unset RINEX options comments */
+    unsetopt_file(opt);
+    
+    return abort?-1:1;
+}
 /* RINEX converter for single-session ----------------------------------------*/
 static int convrnx_s(int sess, int format, rnxopt_t *opt, const char *file,
                      char **ofile)
@@ -1290,6 +1550,7 @@ static int convrnx_s(int sess, int format, rnxopt_t *opt, const char *file,
     strfile_t *str;
     gtime_t tend[3]={{0}};
     int i,j,nf,type,n[NOUTFILE+2]={0},mask[MAXEXFILE]={0},staid=-1,abort=0;
+    int stat;
     char path[1024],*paths[NOUTFILE],s[NOUTFILE][1024];
     char *epath[MAXEXFILE]={0},*staname=*opt->staid?opt->staid:"0000";
     
@@ -1327,6 +1588,13 @@ static int convrnx_s(int sess, int format, rnxopt_t *opt, const char *file,
     for (i=0;i<MAXPRNGLO;i++) {
         str->nav->glo_fcn[i]=opt->glofcn[i]; /* FCN+8 */
     }
+    /* convert input files in single pass */
+    if (opt->onepass) {
+        stat=convrnx_1p(sess,format,opt,path,epath,nf,str,ofile);
+        free_strfile(str);
+        for (i=0;i<MAXEXFILE;i++) free(epath[i]);
+        return stat;
+    }
     /* scan input files */
     if (!scan_file(epath,nf,opt,str,mask)) {
         for (i=0;i<MAXEXFILE;i++) free(epath[i]);
@@ -1438,6 +1706,267 @@ static int convrnx_s(int sess, int format, rnxopt_t *opt, const char *file,
     
     return abort?-1:1;
 }
+/* set RINEX options by RINEX version ----------------------------------------*/
+static void setopt_ver(const rnxopt_t *opt, rnxopt_t *opt_)
+{
+    int sys_GRS=SYS_GPS|SYS_GLO|SYS_SBS;
+    
+    *opt_=*opt;
+    
+    /* disable systems according to RINEX version */
+    if      (opt->rnxver<=210) opt_->navsys&=sys_GRS;
+    else if (opt->rnxver<=211) opt_->navsys&=sys_GRS|SYS_GAL;
+    else if (opt->rnxver<=212) opt_->navsys&=sys_GRS|SYS_GAL|SYS_CMP;
+    else if (opt->rnxver<=300) opt_->navsys&=sys_GRS|SYS_GAL;
+    else if (opt->rnxver<=301) opt_->navsys&=sys_GRS|SYS_GAL|SYS_CMP;
+    else if (opt->rnxver<=302) opt_->navsys&=sys_GRS|SYS_GAL|SYS_CMP|SYS_QZS;
+    
+    /* disable frequency according to RINEX version */
+    if (opt->rnxver<=210) opt_->freqtype&=0x3;
+}
+/* set time span of session ----------------------------------------------------
+* args   : rnxopt_t *opt    I   RINEX options
+*          int    sess      I   session number (1,2,...)
+*          rnxopt_t *opt_   IO  RINEX options of session (ts,te,trtcm set)
+* return : status (1:ok,0:no session)
+*-----------------------------------------------------------------------------*/
+static int setopt_sess(const rnxopt_t *opt, int sess, rnxopt_t *opt_)
+{
+    double tu,ts;
+    int week;
+    
+    tu=opt->tunit<86400.0?opt->tunit:86400.0;
+    ts=tu*(int)floor(time2gpst(opt->ts,&week)/tu);
+    
+    opt_->ts=gpst2time(week,ts+(sess-1)*tu);
+    opt_->te=timeadd(opt_->ts,tu);
+    if (opt->trtcm.time) {
+        opt_->trtcm=timeadd(opt->trtcm,timediff(opt_->ts,opt->ts));
+    }
+    if (timediff(opt_->ts,opt->te)>-opt->ttol) return 0;
+    
+    if (timediff(opt_->ts,opt->ts)<0.0) opt_->ts=opt->ts;
+    if (timediff(opt_->te,opt->te)>0.0) opt_->te=opt->te;
+    return 1;
+}
+/* add conversion jobs of input file -----------------------------------------*/
+static int addjobs(const rnxopt_t *opt, const char *file, char **ofile,
+                   int ifile, convjob_t **job, int *n, int *nmax)
+{
+    convjob_t *job_,job0={0};
+    rnxopt_t opt_=*opt;
+    int sess=0;
+    
+    do {
+        if (opt->ts.time&&opt->te.time&&opt->tunit>0.0) {
+            if (!setopt_sess(opt,++sess,&opt_)) break;
+        }
+        if (*n>=*nmax) {
+            *nmax=*nmax<=0?64:*nmax*2;
+            if (!(job_=(convjob_t *)realloc(*job,sizeof(convjob_t)**nmax))) {
+                return 0;
+            }
+            *job=job_;
+        }
+        job0.sess=sess;
+        job0.ifile=ifile;
+        job0.file=file;
+        job0.ofile=ofile;
+        job0.opt=opt;
+        job0.ts=opt_.ts;
+        job0.te=opt_.te;
+        job0.trtcm=opt_.trtcm;
+        job0.stat=-1;
+        (*job)[(*n)++]=job0;
+    } while (sess>0);
+    
+    return 1;
+}
+/* root of job chain ---------------------------------------------------------*/
+static int rootjob(int *par, int i)
+{
+    while (par[i]!=i) i=par[i]=par[par[i]];
+    return i;
+}
+/* compare job output paths --------------------------------------------------*/
+static int cmpjobpath(const void *p1, const void *p2)
+{
+    const jobpath_t *q1=(const jobpath_t *)p1,*q2=(const jobpath_t *)p2;
+    int cmp=strcmp(q1->path,q2->path);
+    return cmp?cmp:q1->job-q2->job;
+}
+/* compare job chains --------------------------------------------------------*/
+static int cmpjobchain(const void *p1, const void *p2)
+{
+    const int *q1=(const int *)p1,*q2=(const int *)p2;
+    return q1[0]!=q2[0]?q1[0]-q2[0]:q1[1]-q2[1];
+}
+/* set chains of jobs ----------------------------------------------------------
+* jobs writing to a same output path are linked into a chain and converted
+* one after another in order of the jobs. chains are sorted by the first job.
+*-----------------------------------------------------------------------------*/
+static int setchains(convpool_t *pool)
+{
+    jobpath_t *path;
+    gtime_t time0={0};
+    const convjob_t *job;
+    const char *staname;
+    char buff[1024];
+    int i,j,k,n=0,r1,r2,*par,(*key)[2];
+    
+    if (!(path=(jobpath_t *)malloc(sizeof(jobpath_t)*pool->njob*NOUTFILE))||
+        !(par=(int *)malloc(sizeof(int)*pool->njob))||
+        !(key=(int (*)[2])malloc(sizeof(int)*2*pool->njob))||
+        !(pool->idx=(int *)malloc(sizeof(int)*pool->njob))||
+        !(pool->chain=(int *)malloc(sizeof(int)*(pool->njob+1)))) {
+        free(path); free(par); free(key);
+        return 0;
+    }
+    for (i=0;i<pool->njob;i++) {
+        job=pool->job+i;
+        par[i]=i;
+        staname=*job->opt->staid?job->opt->staid:"0000";
+        
+        for (j=0;j<NOUTFILE;j++) {
+            if (!*job->ofile[j]) continue;
+            
+            /* output path with time unknown before conversion is left as is */
+            if (reppath(job->ofile[j],buff,job->ts.time?job->ts:time0,staname,
+                        "")<0) {
+                strcpy(buff,job->ofile[j]);
+            }
+            if (!(path[n].path=(char *)malloc(strlen(buff)+1))) break;
+            strcpy(path[n].path,buff);
+            path[n++].job=i;
+        }
+    }
+    qsort(path,n,sizeof(jobpath_t),cmpjobpath);
+    
+    for (i=1;i<n;i++) {
+        if (strcmp(path[i-1].path,path[i].path)) continue;
+        r1=rootjob(par,path[i-1].job);
+        r2=rootjob(par,path[i].job);
+        if (r1<r2) par[r2]=r1; else par[r1]=r2;
+    }
+    for (i=0;i<pool->njob;i++) {
+        key[i][0]=rootjob(par,i);
+        key[i][1]=i;
+    }
+    qsort(key,pool->njob,sizeof(int)*2,cmpjobchain);
+    
+    for (i=k=0;i<pool->njob;i++) {
+        if (i==0||key[i][0]!=key[i-1][0]) pool->chain[k++]=i;
+        pool->idx[i]=key[i][1];
+    }
+    pool->chain[k]=pool->njob;
+    pool->nchain=k;
+    
+    for (i=0;i<n;i++) free(path[i].path);
+    free(path); free(par); free(key);
+    return 1;
+}
+/* convert chains of jobs in pool --------------------------------------------*/
+static void convchains(convpool_t *pool)
+{
+    gtime_t t0={0};
+    rnxopt_t *opt;
+    convjob_t *job;
+    int i,k;
+    
+    if (!(opt=(rnxopt_t *)malloc(sizeof(rnxopt_t)))) return;
+    
+    for (;;) {
+        rtklib_lock(&pool->lock);
+        k=pool->abort?pool->nchain:pool->next++;
+        rtklib_unlock(&pool->lock);
+        
+        if (k>=pool->nchain) break;
+        
+        for (i=pool->chain[k];i<pool->chain[k+1];i++) {
+            job=pool->job+pool->idx[i];
+            *opt=*job->opt;
+            opt->ts=job->ts;
+            opt->te=job->te;
+            opt->trtcm=job->trtcm;
+            opt->tstart=opt->tend=t0;
+            
+            job->stat=convrnx_s(job->sess,pool->format,opt,job->file,
+                                job->ofile);
+            job->tstart=opt->tstart;
+            job->tend=opt->tend;
+            
+            if (job->stat<0) {
+                rtklib_lock(&pool->lock);
+                pool->abort=1;
+                rtklib_unlock(&pool->lock);
+                break;
+            }
+        }
+    }
+    free(opt);
+}
+/* convert chains of jobs thread ---------------------------------------------*/
+#ifdef WIN32
+static DWORD WINAPI convchainsthread(void *arg)
+#else
+static void *convchainsthread(void *arg)
+#endif
+{
+    convchains((convpool_t *)arg);
+    return 0;
+}
+/* convert jobs in parallel --------------------------------------------------*/
+static int convjobs(convpool_t *pool, int nthread)
+{
+    rtklib_thread_t *thread;
+    int i,*stat;
+    
+    if (pool->njob<=0) return 1;
+    
+    if (!setchains(pool)) return 0;
+    
+    if (nthread>pool->nchain) nthread=pool->nchain;
+    if (nthread<1) nthread=1;
+    
+    trace(3,"convjobs: njob=%d nchain=%d nthread=%d\n",pool->njob,pool->nchain,
+          nthread);
+    
+    if (!(thread=(rtklib_thread_t *)malloc(sizeof(rtklib_thread_t)*nthread))||
+        !(stat=(int *)calloc(nthread,sizeof(int)))) {
+        free(thread);
+        return 0;
+    }
+    rtklib_initlock(&pool->lock);
+    
+    for (i=1;i<nthread;i++) {
+#ifdef WIN32
+        stat[i]=(thread[i]=CreateThread(NULL,0,convchainsthread,pool,0,NULL))!=NULL;
+#else
+        stat[i]=!pthread_create(thread+i,NULL,convchainsthread,pool);
+#endif
+    }
+    convchains(pool);
+    
+    for (i=1;i<nthread;i++) {
+        if (!stat[i]) continue;
+#ifdef WIN32
+        WaitForSingleObject(thread[i],INFINITE);
+        CloseHandle(thread[i]);
+#else
+        pthread_join(thread[i],NULL);
+#endif
+    }
+    free(thread);
+    free(stat);
+    return 1;
+}
+/* free job pool -------------------------------------------------------------*/
+static void freepool(convpool_t *pool)
+{
+    free(pool->job);
+    free(pool->idx);
+    free(pool->chain);
+}
 /* RINEX converter -------------------------------------------------------------
 * convert receiver log file to RINEX obs/nav, SBAS log files
 * args   : int    format I      receiver raw format (STRFMT_???)
@@ -1460,13 +1989,17 @@ static int convrnx_s(int sess, int format, rnxopt_t *opt, const char *file,
 *          keywords in ofile[] are replaced by first observation date/time and
 *          station ID (%r)
 *          the order of wild-card expanded files must be in-order by time
+*          with opt->nthread>1, multiple sessions are converted in parallel.
+*          each session starts with the options in opt, so header information
+*          (e.g. approx position) is not carried over from previous sessions.
+*          sessions writing to a same output path are converted in order.
 *-----------------------------------------------------------------------------*/
 extern int convrnx(int format, rnxopt_t *opt, const char *file, char **ofile)
 {
     gtime_t t0={0};
-    rnxopt_t opt_=*opt;
-    double tu,ts;
-    int i,week,stat=1,sys_GRS=SYS_GPS|SYS_GLO|SYS_SBS;
+    rnxopt_t opt_;
+    convpool_t pool={0};
+    int i,nmax=0,stat=1;
     
     trace(3,"convrnx: format=%d file=%s ofile=%s %s %s %s %s %s %s %s %s\n",
           format,file,ofile[0],ofile[1],ofile[2],ofile[3],ofile[4],ofile[5],
@@ -1474,16 +2007,7 @@ extern int convrnx(int format, rnxopt_t *opt, const char *file, char **ofile)
     
     showmsg("");
     
-    /* disable systems according to RINEX version */
-    if      (opt->rnxver<=210) opt_.navsys&=sys_GRS;
-    else if (opt->rnxver<=211) opt_.navsys&=sys_GRS|SYS_GAL;
-    else if (opt->rnxver<=212) opt_.navsys&=sys_GRS|SYS_GAL|SYS_CMP;
-    else if (opt->rnxver<=300) opt_.navsys&=sys_GRS|SYS_GAL;
-    else if (opt->rnxver<=301) opt_.navsys&=sys_GRS|SYS_GAL|SYS_CMP;
-    else if (opt->rnxver<=302) opt_.navsys&=sys_GRS|SYS_GAL|SYS_CMP|SYS_QZS;
-    
-    /* disable frequency according to RINEX version */
-    if (opt->rnxver<=210) opt_.freqtype&=0x3;
+    setopt_ver(opt,&opt_);
     
     if (opt->ts.time==0||opt->te.time==0||opt->tunit<=0.0) {
         
@@ -1491,32 +2015,121 @@ extern int convrnx(int format, rnxopt_t *opt, const char *file, char **ofile)
         opt_.tstart=opt_.tend=t0;
         stat=convrnx_s(0,format,&opt_,file,ofile);
     }
-    else if (timediff(opt->ts,opt->te)<0.0) {
-        
-        /* multiple session */
-        tu=opt->tunit<86400.0?opt->tunit:86400.0;
-        ts=tu*(int)floor(time2gpst(opt->ts,&week)/tu);
+    else if (timediff(opt->ts,opt->te)>=0.0) {
+        showmsg("no period");
+        return 0;
+    }
+    else if (opt->nthread>1) {
         
-        for (i=0;;i++) { /* for each session */
-            opt_.ts=gpst2time(week,ts+i*tu);
-            opt_.te=timeadd(opt_.ts,tu);
-            if (opt->trtcm.time) {
-                opt_.trtcm=timeadd(opt->trtcm,timediff(opt_.ts,opt->ts));
-            }
-            if (timediff(opt_.ts,opt->te)>-opt->ttol) break;
-            
-            if (timediff(opt_.ts,opt->ts)<0.0) opt_.ts=opt->ts;
-            if (timediff(opt_.te,opt->te)>0.0) opt_.te=opt->te;
-            opt_.tstart=opt_.tend=t0;
-            if ((stat=convrnx_s(i+1,format,&opt_,file,ofile))<0) break;
+        /* multiple session in parallel */
+        pool.format=format;
+        if (!addjobs(&opt_,file,ofile,0,&pool.job,&pool.njob,&nmax)||
+            !convjobs(&pool,opt->nthread)) {
+            freepool(&pool);
+            return 0;
+        }
+        for (i=0;i<pool.njob;i++) {
+            if (pool.job[i].stat<0) stat=-1;
+        }
+        if (stat>=0&&pool.njob>0) stat=pool.job[pool.njob-1].stat;
+        if (pool.njob>0) {
+            opt_.tstart=pool.job[pool.njob-1].tstart;
+            opt_.tend  =pool.job[pool.njob-1].tend;
         }
+        freepool(&pool);
     }
     else {
-        showmsg("no period");
-        return 0;
+        
+        /* multiple session */
+        for (i=1;setopt_sess(opt,i,&opt_);i++) { /* for each session */
+            opt_.tstart=opt_.tend=t0;
+            if ((stat=convrnx_s(i,format,&opt_,file,ofile))<0) break;
+        }
     }
     /* output start and end time */
     opt->tstart=opt_.tstart; opt->tend=opt_.tend;
     
     return stat;
 }
+/* RINEX converter for multiple input files ------------------------------------
+* convert receiver log files to RINEX obs/nav, SBAS log files. input files
+* and their sessions are converted in parallel with opt[0].nthread threads
+* args   : int    format I      receiver raw format (STRFMT_???)
+*          rnxopt_t *opt IO     RINEX options of each input file (see convrnx())
+*          char   **file I      RTCM, receiver raw or RINEX files
+*                               (wild-cards (*) are expanded in each file)
+*          char   ***ofile I    output files of each input file
+*                               (see convrnx())
+*          int    n      I      number of input files
+*          int    *stat  O      status of each input file (NULL: no output)
+*                               (1:ok,0:error,-1:abort)
+* return : status (1:ok,0:error in any input file,-1:abort)
+* notes  : the output is the same as convrnx() for each input file with
+*          opt[i].nthread=1 except for header information carried over
+*          between sessions (see convrnx()). conversions writing to a same
+*          output path are done in order of input files and sessions, so the
+*          output does not depend on the number of threads.
+*          showmsg() is called from multiple threads with opt[0].nthread>1
+*-----------------------------------------------------------------------------*/
+extern int convrnxm(int format, rnxopt_t *opt, char **file, char ***ofile,
+                    int n, int *stat)
+{
+    rnxopt_t *opt_;
+    convpool_t pool={0};
+    int i,j,nmax=0,stat_,ret=1;
+    
+    trace(3,"convrnxm: format=%d n=%d nthread=%d\n",format,n,
+          n>0?opt[0].nthread:0);
+    
+    if (n<=0) return 0;
+    
+    /* convert input files sequentially */
+    if (opt[0].nthread<=1) {
+        for (i=0;i<n&&ret>=0;i++) {
+            stat_=convrnx(format,opt+i,file[i],ofile[i]);
+            if (stat) stat[i]=stat_;
+            if (stat_<=0) ret=stat_;
+        }
+        for (;i<n;i++) if (stat) stat[i]=-1;
+        return ret;
+    }
+    showmsg("");
+    
+    if (!(opt_=(rnxopt_t *)malloc(sizeof(rnxopt_t)*n))) return 0;
+    
+    pool.format=format;
+    
+    for (i=0;i<n;i++) {
+        setopt_ver(opt+i,opt_+i);
+        
+        if (opt[i].ts.time&&opt[i].te.time&&opt[i].tunit>0.0&&
+            timediff(opt[i].ts,opt[i].te)>=0.0) {
+            showmsg("no period");
+            free(opt_); freepool(&pool);
+            return 0;
+        }
+        if (!addjobs(opt_+i,file[i],ofile[i],i,&pool.job,&pool.njob,&nmax)) {
+            free(opt_); freepool(&pool);
+            return 0;
+        }
+    }
+    if (!convjobs(&pool,opt[0].nthread)) {
+        free(opt_); freepool(&pool);
+        return 0;
+    }
+    /* status and start and end time of last session of each input file */
+    for (i=j=0;i<n;i++) {
+        stat_=1;
+        for (;j<pool.njob&&pool.job[j].ifile==i;j++) {
+            if (stat_>=0) stat_=pool.job[j].stat;
+            opt[i].tstart=pool.job[j].tstart;
+            opt[i].tend  =pool.job[j].tend;
+        }
+        if (stat) stat[i]=stat_;
+        if (stat_<0) ret=-1;
+        else if (stat_==0&&ret>0) ret=0;
+    }
+    free(opt_);
+    freepool(&pool);
+    return ret;
+}
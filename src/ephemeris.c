@@ -70,6 +70,9 @@
 *                           fix bug on clock reference time in satpos_ssr()
 *                           fix bug on wrong value with ura=15 in var_ura()
 *                           use integer types in stdint.h
+*           2026/10/16 1.15 add API eph2poss()
+*                           compute broadcast ephemerides in batch with
+*                           analytic velocity in satposs()
 *-----------------------------------------------------------------------------*/
 #include "rtklib.h"
 
@@ -104,6 +107,7 @@
 #define STD_GAL_NAPA 500.0        /* error of galileo ephemeris for NAPA (m) */
 
 #define MAX_ITER_KEPLER 30        /* max number of iteration of Kepler */
+#define EPHBLK   32               /* block size of batched ephemerides */
 
 /* ephemeris selections ------------------------------------------------------*/
 static int eph_sel[]={ /* GPS,GLO,GAL,QZS,BDS,IRN,SBS */
@@ -291,6 +295,141 @@ extern void eph2pos(gtime_t time, const eph_t *eph, double *rs, double *dts,
     trace(4,"eph2pos: sat=%d, dts=%.10f rs=%.4f %.4f %.4f var=%.3f\n",eph->sat,
         *dts,rs[0],rs[1],rs[2],*var);
 }
+/* broadcast ephemerides to satellite positions and clocks ---------------------
+* compute satellite positions, velocities, clock biases and clock drifts of
+* multiple satellites with broadcast ephemerides (gps,galileo,qzss,beidou,
+* navic)
+* args   : int    n         I   number of satellites
+*          gtime_t *time    I   times (gpst) {time_1,...,time_n}
+*          eph_t  **eph     I   broadcast ephemerides {eph_1,...,eph_n}
+*          double *rs       O   satellite positions and velocities (ecef)
+*                               rs[(0:5)+i*6]={x,y,z,vx,vy,vz} (m|m/s)
+*          double *dts      O   satellite clocks
+*                               dts[(0:1)+i*2]={bias,drift} (s|s/s)
+*          double *var      O   satellite position and clock variances (m^2)
+* return : none
+* notes  : positions and clock biases are the same as eph2pos().
+*          velocities and clock drifts are analytic derivatives instead of
+*          differential approximation.
+*          satellites are processed as structure of arrays in blocks of
+*          EPHBLK to keep the loops free of branches and data dependencies.
+*-----------------------------------------------------------------------------*/
+extern void eph2poss(int n, const gtime_t *time, const eph_t **eph, double *rs,
+                     double *dts, double *var)
+{
+    double tk[EPHBLK],M[EPHBLK],E[EPHBLK],Ek[EPHBLK],e[EPHBLK],mu[EPHBLK];
+    double omge[EPHBLK],Edot[EPHBLK],sinE[EPHBLK],cosE[EPHBLK];
+    double u,r,i,O,Odot,sin2u,cos2u,x,y,sinO,cosO,cosi,sini,udot,rdot,idot;
+    double xdot,ydot,xg,yg,zg,xgdot,ygdot,zgdot,a,adot,sino,coso,fdot,tc;
+    int j,k,m,nk,iter,act[EPHBLK],geo[EPHBLK],sys[EPHBLK],prn;
+
+    trace(4,"eph2poss: n=%d\n",n);
+
+    for (k=0;k<n;k+=EPHBLK) {
+        m=n-k<EPHBLK?n-k:EPHBLK;
+
+        /* gather ephemeris parameters */
+        for (j=0;j<m;j++) {
+            const eph_t *p=eph[k+j];
+            tk[j]=timediff(time[k+j],p->toe);
+            switch ((sys[j]=satsys(p->sat,&prn))) {
+                case SYS_GAL: mu[j]=MU_GAL; omge[j]=OMGE_GAL; break;
+                case SYS_CMP: mu[j]=MU_CMP; omge[j]=OMGE_CMP; break;
+                default:      mu[j]=MU_GPS; omge[j]=OMGE;     break;
+            }
+            geo[j]=sys[j]==SYS_CMP&&(prn<=5||prn>=59); /* ref [9] table 4-1 */
+            act[j]=p->A>0.0;
+            e[j]=p->e;
+            M[j]=act[j]?p->M0+(sqrt(mu[j]/(p->A*p->A*p->A))+p->deln)*tk[j]:0.0;
+            E[j]=M[j]; Ek[j]=0.0;
+        }
+        /* solve Kepler's equation for all satellites of the block */
+        for (iter=0;iter<MAX_ITER_KEPLER;iter++) {
+            for (j=nk=0;j<m;j++) {
+                if (!act[j]||fabs(E[j]-Ek[j])<=RTOL_KEPLER) continue;
+                Ek[j]=E[j]; E[j]-=(E[j]-e[j]*sin(E[j])-M[j])/(1.0-e[j]*cos(E[j]));
+                nk++;
+            }
+            if (!nk) break;
+        }
+        for (j=0;j<m;j++) {
+            if (act[j]&&fabs(E[j]-Ek[j])>RTOL_KEPLER) {
+                trace(2,"eph2poss: kepler iteration overflow sat=%2d\n",
+                      eph[k+j]->sat);
+            }
+            sinE[j]=sin(E[j]); cosE[j]=cos(E[j]);
+        }
+        /* orbital plane to ecef with analytic derivatives */
+        for (j=0;j<m;j++) {
+            const eph_t *p=eph[k+j];
+            double *rsj=rs+(k+j)*6,*dtsj=dts+(k+j)*2;
+
+            if (!act[j]) {
+                rsj[0]=rsj[1]=rsj[2]=rsj[3]=rsj[4]=rsj[5]=0.0;
+                dtsj[0]=dtsj[1]=var[k+j]=0.0;
+                continue;
+            }
+            /* dE/dt=n/(1-e*cosE) with corrected mean motion n */
+            Edot[j]=(sqrt(mu[j]/(p->A*p->A*p->A))+p->deln)/(1.0-e[j]*cosE[j]);
+
+            u=atan2(sqrt(1.0-e[j]*e[j])*sinE[j],cosE[j]-e[j])+p->omg;
+            r=p->A*(1.0-e[j]*cosE[j]);
+            i=p->i0+p->idot*tk[j];
+            sin2u=sin(2.0*u); cos2u=cos(2.0*u);
+            udot=sqrt(1.0-e[j]*e[j])*Edot[j]/(1.0-e[j]*cosE[j]);
+            rdot=p->A*e[j]*sinE[j]*Edot[j]+2.0*udot*(p->crs*cos2u-p->crc*sin2u);
+            idot=p->idot+2.0*udot*(p->cis*cos2u-p->cic*sin2u);
+            udot*=1.0+2.0*(p->cus*cos2u-p->cuc*sin2u);
+            u+=p->cus*sin2u+p->cuc*cos2u;
+            r+=p->crs*sin2u+p->crc*cos2u;
+            i+=p->cis*sin2u+p->cic*cos2u;
+            x=r*cos(u); y=r*sin(u); cosi=cos(i); sini=sin(i);
+            xdot=rdot*cos(u)-y*udot;
+            ydot=rdot*sin(u)+x*udot;
+
+            if (geo[j]) { /* beidou geo satellite */
+                O=p->OMG0+p->OMGd*tk[j]-omge[j]*p->toes;
+                Odot=p->OMGd;
+            }
+            else {
+                O=p->OMG0+(p->OMGd-omge[j])*tk[j]-omge[j]*p->toes;
+                Odot=p->OMGd-omge[j];
+            }
+            sinO=sin(O); cosO=cos(O);
+            xg=x*cosO-y*cosi*sinO;
+            yg=x*sinO+y*cosi*cosO;
+            zg=y*sin(i);
+            xgdot=xdot*cosO-ydot*cosi*sinO+y*sini*sinO*idot-yg*Odot;
+            ygdot=xdot*sinO+ydot*cosi*cosO-y*sini*cosO*idot+xg*Odot;
+            zgdot=ydot*sini+y*cosi*idot;
+
+            if (geo[j]) {
+                sino=sin(omge[j]*tk[j]); coso=cos(omge[j]*tk[j]);
+                rsj[0]= xg*coso+yg*sino*COS_5+zg*sino*SIN_5;
+                rsj[1]=-xg*sino+yg*coso*COS_5+zg*coso*SIN_5;
+                rsj[2]=-yg*SIN_5+zg*COS_5;
+                a=yg*COS_5+zg*SIN_5; adot=ygdot*COS_5+zgdot*SIN_5;
+                rsj[3]= xgdot*coso+adot*sino+omge[j]*(-xg*sino+a*coso);
+                rsj[4]=-xgdot*sino+adot*coso-omge[j]*( xg*coso+a*sino);
+                rsj[5]=-ygdot*SIN_5+zgdot*COS_5;
+            }
+            else {
+                rsj[0]=xg; rsj[1]=yg; rsj[2]=zg;
+                rsj[3]=xgdot; rsj[4]=ygdot; rsj[5]=zgdot;
+            }
+            tc=timediff(time[k+j],p->toc);
+            dtsj[0]=p->f0+p->f1*tc+p->f2*tc*tc;
+            fdot=p->f1+2.0*p->f2*tc;
+
+            /* relativity correction */
+            dtsj[0]-=2.0*sqrt(mu[j]*p->A)*e[j]*sinE[j]/SQR(CLIGHT);
+            dtsj[1]=fdot-2.0*sqrt(mu[j]*p->A)*e[j]*cosE[j]*Edot[j]/SQR(CLIGHT);
+
+            /* position and clock error variance */
+            var[k+j]=var_uraeph(sys[j],p->sva);
+        }
+    }
+}
 /* glonass orbit differential equations --------------------------------------*/
 static void deq(const double *x, double *xdot, const double *acc)
 {
@@ -428,11 +567,89 @@ extern void seph2pos(gtime_t time, const seph_t *seph, double *rs, double *dts,
 
     *var=var_uraeph(SYS_SBS,seph->sva);
 }
+/* reference time of ephemeris -----------------------------------------------*/
+static gtime_t ephtoe(const nav_t *nav, int sys, int i)
+{
+    if (sys==SYS_GLO) return nav->geph[i].toe;
+    if (sys==SYS_SBS) return nav->seph[i].t0;
+    return nav->eph[i].toe;
+}
+/* test ephemeris as selection candidate -------------------------------------*/
+static int testeph(gtime_t time, int sys, int i, int iode, int sel, double tmax,
+                   const nav_t *nav, double *t)
+{
+    if (sys==SYS_GLO) {
+        if (iode>=0&&nav->geph[i].iode!=iode) return 0;
+    }
+    else if (sys!=SYS_SBS) {
+        if (iode>=0&&nav->eph[i].iode!=iode) return 0;
+        if (sys==SYS_GAL) {
+            /* this code is from 2.4.3 b34 but does not seem to be fully supported,
+               so for now I have dropped back to the b33 code */
+            /* if (sel==0&&!(nav->eph[i].code&(1<<9))) return 0; */ /* I/NAV */
+            /*if (sel==1&&!(nav->eph[i].code&(1<<8))) return 0; */ /* F/NAV */
+            if (sel==1&&!(nav->eph[i].code&(1<<9))) return 0; /* I/NAV */
+            if (sel==2&&!(nav->eph[i].code&(1<<8))) return 0; /* F/NAV */
+            if (timediff(nav->eph[i].toe,time)>=0.0) return 0; /* AOD<=0 */
+        }
+    }
+    return (*t=fabs(timediff(ephtoe(nav,sys,i),time)))<=tmax;
+}
+/* search ephemeris ------------------------------------------------------------
+* search ephemeris of satellite with toe closest to time (or first one matching
+* iode if iode>=0). the satellite ephemeris index is used if valid, otherwise
+* all ephemerides are scanned. both give the same selection.
+*-----------------------------------------------------------------------------*/
+static int searcheph(gtime_t time, int sat, int sys, int iode, int sel,
+                     double tmax, const nav_t *nav, double *tmin)
+{
+    const ephidx_t *eidx;
+    double t;
+    int i,j=-1,k,n,lo,hi,type=sys==SYS_GLO?1:(sys==SYS_SBS?2:0);
+
+    *tmin=tmax+1.0;
+
+    n=type==1?nav->ng:(type==2?nav->ns:nav->n);
+
+    if (!nav->eidx||nav->ni[type]!=n) { /* linear search */
+        for (i=0;i<n;i++) {
+            if ((type==1?nav->geph[i].sat:(type==2?nav->seph[i].sat:
+                 nav->eph[i].sat))!=sat) continue;
+            if (!testeph(time,sys,i,iode,sel,tmax,nav,&t)) continue;
+            if (iode>=0) return i;
+            if (t<=*tmin) {j=i; *tmin=t;} /* toe closest to time */
+        }
+        return j;
+    }
+    eidx=nav->eidx+sat-1;
+
+    /* binary search of first ephemeris with toe>=time */
+    for (lo=0,hi=eidx->n;lo<hi;) {
+        k=(lo+hi)/2;
+        if (timediff(ephtoe(nav,sys,eidx->idx[k]),time)<0.0) lo=k+1; else hi=k;
+    }
+    /* scan ephemerides backward and forward while |toe-time| can improve */
+    for (k=lo-1;k>=0;k--) {
+        i=eidx->idx[k];
+        if (fabs(timediff(ephtoe(nav,sys,i),time))>(iode>=0?tmax:*tmin)) break;
+        if (!testeph(time,sys,i,iode,sel,tmax,nav,&t)) continue;
+        if (iode>=0) {if (j<0||i<j) j=i; continue;} /* first in nav data */
+        if (t<*tmin||(t==*tmin&&i>j)) {j=i; *tmin=t;}
+    }
+    for (k=lo;k<eidx->n;k++) {
+        i=eidx->idx[k];
+        if (fabs(timediff(ephtoe(nav,sys,i),time))>(iode>=0?tmax:*tmin)) break;
+        if (!testeph(time,sys,i,iode,sel,tmax,nav,&t)) continue;
+        if (iode>=0) {if (j<0||i<j) j=i; continue;}
+        if (t<*tmin||(t==*tmin&&i>j)) {j=i; *tmin=t;}
+    }
+    return j;
+}
 /* select ephemeris --------------------------------------------------------*/
 static eph_t *seleph(gtime_t time, int sat, int iode, const nav_t *nav)
 {
-    double t,tmax,tmin;
-    int i,j=-1,sys,sel=0;
+    double tmax,tmin;
+    int j,sys,sel=0;
 
     char tstr[40];
     trace(4,"seleph  : time=%s sat=%2d iode=%d\n",time2str(time,tstr,3),sat,iode);
@@ -440,32 +657,15 @@ static eph_t *seleph(gtime_t time, int sat, int iode, const nav_t *nav)
     sys=satsys(sat,NULL);
     switch (sys) {
         case SYS_GPS: tmax=MAXDTOE+1.0    ; sel=eph_sel[0]; break;
-        case SYS_GAL: tmax=MAXDTOE_GAL    ; sel=eph_sel[2]; break;
+        case SYS_GAL: tmax=MAXDTOE_GAL    ; sel=getseleph(SYS_GAL); break;
         case SYS_QZS: tmax=MAXDTOE_QZS+1.0; sel=eph_sel[3]; break;
         case SYS_CMP: tmax=MAXDTOE_CMP+1.0; sel=eph_sel[4]; break;
         case SYS_IRN: tmax=MAXDTOE_IRN+1.0; sel=eph_sel[5]; break;
         default: tmax=MAXDTOE+1.0; break;
     }
-    tmin=tmax+1.0;
+    j=searcheph(time,sat,sys,iode,sel,tmax,nav,&tmin);
 
-    for (i=0;i<nav->n;i++) {
-        if (nav->eph[i].sat!=sat) continue;
-        if (iode>=0&&nav->eph[i].iode!=iode) continue;
-        if (sys==SYS_GAL) {
-            sel=getseleph(SYS_GAL);
-            /* this code is from 2.4.3 b34 but does not seem to be fully supported,
-               so for now I have dropped back to the b33 code */
-            /* if (sel==0&&!(nav->eph[i].code&(1<<9))) continue; */ /* I/NAV */
-            /*if (sel==1&&!(nav->eph[i].code&(1<<8))) continue; */ /* F/NAV */
-            if (sel==1&&!(nav->eph[i].code&(1<<9))) continue; /* I/NAV */
-            if (sel==2&&!(nav->eph[i].code&(1<<8))) continue; /* F/NAV */
-            if (timediff(nav->eph[i].toe,time)>=0.0) continue; /* AOD<=0 */
-        }
-        if ((t=fabs(timediff(nav->eph[i].toe,time)))>tmax) continue;
-        if (iode>=0) return nav->eph+i;
-        if (t<=tmin) {j=i; tmin=t;} /* toe closest to time */
-    }
-    if (iode>=0||j<0) {
+    if (j<0) {
         trace(2,"no broadcast ephemeris: %s sat=%2d iode=%3d\n",time2str(time,tstr,0),
               sat,iode);
         return NULL;
@@ -476,20 +676,15 @@ static eph_t *seleph(gtime_t time, int sat, int iode, const nav_t *nav)
 /* select glonass ephemeris --------------------------------------------------*/
 static geph_t *selgeph(gtime_t time, int sat, int iode, const nav_t *nav)
 {
-    double t,tmax=MAXDTOE_GLO,tmin=tmax+1.0;
-    int i,j=-1;
+    double tmin;
+    int j;
 
     char tstr[40];
     trace(4,"selgeph : time=%s sat=%2d iode=%2d\n",time2str(time,tstr,3),sat,iode);
 
-    for (i=0;i<nav->ng;i++) {
-        if (nav->geph[i].sat!=sat) continue;
-        if (iode>=0&&nav->geph[i].iode!=iode) continue;
-        if ((t=fabs(timediff(nav->geph[i].toe,time)))>tmax) continue;
-        if (iode>=0) return nav->geph+i;
-        if (t<=tmin) {j=i; tmin=t;} /* toe closest to time */
-    }
-    if (iode>=0||j<0) {
+    j=searcheph(time,sat,SYS_GLO,iode,0,MAXDTOE_GLO,nav,&tmin);
+
+    if (j<0) {
         trace(3,"no glonass ephemeris  : %s sat=%2d iode=%2d\n",time2str(time,tstr,0),
               sat,iode);
         return NULL;
@@ -500,17 +695,14 @@ static geph_t *selgeph(gtime_t time, int sat, int iode, const nav_t *nav)
 /* select sbas ephemeris -----------------------------------------------------*/
 static seph_t *selseph(gtime_t time, int sat, const nav_t *nav)
 {
-    double t,tmax=MAXDTOE_SBS,tmin=tmax+1.0;
-    int i,j=-1;
+    double tmin;
+    int j;
 
     char tstr[40];
     trace(4,"selseph : time=%s sat=%2d\n",time2str(time,tstr,3),sat);
 
-    for (i=0;i<nav->ns;i++) {
-        if (nav->seph[i].sat!=sat) continue;
-        if ((t=fabs(timediff(nav->seph[i].t0,time)))>tmax) continue;
-        if (t<=tmin) {j=i; tmin=t;} /* toe closest to time */
-    }
+    j=searcheph(time,sat,SYS_SBS,-1,0,MAXDTOE_SBS,nav,&tmin);
+
     if (j<0) {
         trace(3,"no sbas ephemeris     : %s sat=%2d\n",time2str(time,tstr,0),sat);
         return NULL;
@@ -785,9 +977,10 @@ extern int satpos(gtime_t time, gtime_t teph, int sat, int ephopt,
 extern void satposs(gtime_t teph, const obsd_t *obs, int n, const nav_t *nav,
                     int ephopt, double *rs, double *dts, double *var, int *svh)
 {
-    gtime_t time[2*MAXOBS]={{0}};
-    double dt,pr;
-    int i,j;
+    gtime_t time[2*MAXOBS]={{0}},tb[2*MAXOBS];
+    const eph_t *eph[2*MAXOBS];
+    double dt,pr,rsb[6*2*MAXOBS],dtsb[2*2*MAXOBS],varb[2*MAXOBS];
+    int i,j,k,sys,nb=0,idx[2*MAXOBS],stat[2*MAXOBS]={0};
 
     char tstr[40];
     trace(3,"satposs : teph=%s n=%d ephopt=%d\n",time2str(teph,tstr,3),n,ephopt);
@@ -814,22 +1007,50 @@ extern void satposs(gtime_t teph, const obsd_t *obs, int n, const nav_t *nav,
         }
         time[i]=timeadd(time[i],-dt);
 
+        /* broadcast ephemerides of gps,gal,qzs,bds and irn in batch */
+        sys=satsys(obs[i].sat,NULL);
+        if (ephopt==EPHOPT_BRDC&&(sys==SYS_GPS||sys==SYS_GAL||sys==SYS_QZS||
+                                  sys==SYS_CMP||sys==SYS_IRN)) {
+            if (!(eph[nb]=seleph(teph,obs[i].sat,-1,nav))) {
+                trace(3,"no ephemeris %s sat=%2d\n",time2str(time[i],tstr,3),obs[i].sat);
+                svh[i]=-1;
+                continue;
+            }
+            svh[i]=eph[nb]->svh;
+            tb[nb]=time[i];
+            idx[nb++]=i;
+            continue;
+        }
         /* satellite position and clock at transmission time */
         if (!satpos(time[i],teph,obs[i].sat,ephopt,nav,rs+i*6,dts+i*2,var+i,
                     svh+i)) {
             trace(3,"no ephemeris %s sat=%2d\n",time2str(time[i],tstr,3),obs[i].sat);
             continue;
         }
+        stat[i]=1;
+    }
+    /* satellite positions and clocks by broadcast ephemerides */
+    eph2poss(nb,tb,eph,rsb,dtsb,varb);
+
+    for (k=0;k<nb;k++) {
+        i=idx[k];
+        for (j=0;j<6;j++) rs [j+i*6]=rsb [j+k*6];
+        for (j=0;j<2;j++) dts[j+i*2]=dtsb[j+k*2];
+        var[i]=varb[k];
+        stat[i]=1;
+    }
+    for (i=0;i<n&&i<2*MAXOBS;i++) {
+        if (!stat[i]) continue;
+
         /* if no precise clock available, use broadcast clock instead */
         if (dts[i*2]==0.0) {
             if (!ephclk(time[i],teph,obs[i].sat,nav,dts+i*2)) continue;
             dts[1+i*2]=0.0;
             *var=SQR(STD_BRDCCLK);
         }
-        trace(4,"satposs: %d,time=%.9f dt=%.9f pr=%.3f rs=%13.3f %13.3f %13.3f dts=%12.3f var=%7.3f\n",
-            obs[i].sat,time[i].sec,dt,pr,rs[i*6],rs[1+i*6],rs[2+i*6],dts[i*2]*1E9,
+        trace(4,"satposs: %d,time=%.9f rs=%13.3f %13.3f %13.3f dts=%12.3f var=%7.3f\n",
+            obs[i].sat,time[i].sec,rs[i*6],rs[1+i*6],rs[2+i*6],dts[i*2]*1E9,
             var[i]);
-
     }
     for (i=0;i<n&&i<2*MAXOBS;i++) {
         trace(4,"%s sat=%2d rs=%13.3f %13.3f %13.3f dts=%12.3f var=%7.3f svh=%02X\n",
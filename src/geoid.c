@@ -13,13 +13,35 @@
 *           2009/12/05 1.2  added api:
 *                               opengeoid(),closegeoid()
 *           2020/11/30 1.3  use integer types in stdint.h
+*           2026/10/16 1.4  map geoid model file to memory or read it through
+*                           block cache. add api geoidh_n()
 *-----------------------------------------------------------------------------*/
+#define _POSIX_C_SOURCE 200112
 #include "rtklib.h"
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define GEOID_BLKSIZE 65536         /* block size of geoid data cache (bytes) */
+#define GEOID_NBLK  64              /* number of blocks of geoid data cache */
 
 static const double range[4];       /* embedded geoid area range {W,E,S,N} (deg) */
 static const float geoid[361][181]; /* embedded geoid heights (m) (lon x lat) */
 static FILE *fp_geoid=NULL;         /* geoid file pointer */
 static int model_geoid=GEOID_EMBEDDED; /* geoid model */
+static const uint8_t *map_geoid=NULL; /* memory-mapped geoid data */
+static long size_geoid=0;           /* size of geoid data (bytes) */
+static uint8_t *cache_geoid=NULL;   /* geoid data cache (GEOID_NBLK blocks) */
+static long blk_geoid[GEOID_NBLK];  /* block index of cache (-1:empty) */
+static rtklib_lock_t lock_geoid;    /* lock for file access and cache */
+static int initlock_geoid=0;        /* lock initialized flag */
+#ifdef WIN32
+static HANDLE fh_geoid=INVALID_HANDLE_VALUE; /* geoid file handle */
+static HANDLE mh_geoid=NULL;        /* geoid file mapping handle */
+#endif
 
 /* bilinear interpolation ----------------------------------------------------*/
 static double interpb(const double *y, double a, double b)
@@ -47,13 +69,59 @@ static double geoidh_emb(const double *pos)
     y[3]=geoid[i2][j2];
     return interpb(y,a,b);
 }
-/* get 2 byte signed integer from file ---------------------------------------*/
-static int16_t fget2b(FILE *fp, int32_t off)
+/* read geoid data block to cache -------------------------------------------*/
+static const uint8_t *readblk(long blk)
 {
-    uint8_t v[2]={0x00};
-    if (fseek(fp,off,SEEK_SET)==EOF||fread(v,2,1,fp)<1) {
+    uint8_t *p=cache_geoid+(blk%GEOID_NBLK)*GEOID_BLKSIZE;
+    size_t n;
+
+    if (blk_geoid[blk%GEOID_NBLK]==blk) return p;
+
+    if (fseek(fp_geoid,blk*GEOID_BLKSIZE,SEEK_SET)==EOF) return NULL;
+    n=fread(p,1,GEOID_BLKSIZE,fp_geoid);
+    if (n<GEOID_BLKSIZE) memset(p+n,0,GEOID_BLKSIZE-n);
+    blk_geoid[blk%GEOID_NBLK]=blk;
+    return p;
+}
+/* read geoid data -------------------------------------------------------------
+* read geoid data from memory-mapped file or through block cache
+* args   : long   off       I   offset in geoid data file (bytes)
+*          int    n         I   number of bytes
+*          uint8_t *buff    O   geoid data
+* return : status (1:ok,0:error)
+*-----------------------------------------------------------------------------*/
+static int readgeoid(long off, int n, uint8_t *buff)
+{
+    const uint8_t *p;
+    long blk;
+    int i,m,stat=1;
+
+    if (off<0||off+n>size_geoid) {
         trace(2,"geoid data file range error: off=%ld\n",off);
+        return 0;
+    }
+    if (map_geoid) {
+        memcpy(buff,map_geoid+off,n);
+        return 1;
     }
+    if (!fp_geoid||!cache_geoid) return 0;
+
+    rtklib_lock(&lock_geoid);
+    for (i=0;i<n&&stat;i+=m,off+=m) {
+        blk=off/GEOID_BLKSIZE;
+        m=GEOID_BLKSIZE-(int)(off%GEOID_BLKSIZE);
+        if (m>n-i) m=n-i;
+        if (!(p=readblk(blk))) stat=0;
+        else memcpy(buff+i,p+off%GEOID_BLKSIZE,m);
+    }
+    rtklib_unlock(&lock_geoid);
+    return stat;
+}
+/* get 2 byte signed integer from geoid data ---------------------------------*/
+static int16_t fget2b(long off)
+{
+    uint8_t v[2]={0x00};
+    readgeoid(off,2,v);
     return ((int16_t)v[0]<<8)+v[1]; /* big-endian */
 }
 /* egm96 15x15" model --------------------------------------------------------*/
@@ -64,25 +132,23 @@ static double geoidh_egm96(const double *pos)
     double a,b,y[4];
     int i1,i2,j1,j2;
     
-    if (!fp_geoid) return 0.0;
+    if (!size_geoid) return 0.0;
     
     a=(pos[1]-lon0)/dlon;
     b=(pos[0]-lat0)/dlat;
     i1=(int)a; a-=i1; i2=i1<nlon-1?i1+1:0;
     j1=(int)b; b-=j1; j2=j1<nlat-1?j1+1:j1;
-    y[0]=fget2b(fp_geoid,2L*(i1+j1*nlon))*0.01;
-    y[1]=fget2b(fp_geoid,2L*(i2+j1*nlon))*0.01;
-    y[2]=fget2b(fp_geoid,2L*(i1+j2*nlon))*0.01;
-    y[3]=fget2b(fp_geoid,2L*(i2+j2*nlon))*0.01;
+    y[0]=fget2b(2L*(i1+j1*nlon))*0.01;
+    y[1]=fget2b(2L*(i2+j1*nlon))*0.01;
+    y[2]=fget2b(2L*(i1+j2*nlon))*0.01;
+    y[3]=fget2b(2L*(i2+j2*nlon))*0.01;
     return interpb(y,a,b);
 }
-/* get 4byte float from file -------------------------------------------------*/
-static float fget4f(FILE *fp, int off)
+/* get 4byte float from geoid data ------------------------------------------*/
+static float fget4f(long off)
 {
     float v=0.0;
-    if (fseek(fp,(long)off,SEEK_SET)==EOF||fread(&v,4,1,fp)<1) {
-        trace(2,"geoid data file range error: off=%ld\n",off);
-    }
+    readgeoid(off,4,(uint8_t *)&v);
     return v; /* small-endian */
 }
 /* egm2008 model -------------------------------------------------------------*/
@@ -94,7 +160,7 @@ static double geoidh_egm08(const double *pos, int model)
     int i1,i2,j1,j2;
     int nlon,nlat;
     
-    if (!fp_geoid) return 0.0;
+    if (!size_geoid) return 0.0;
     
     if (model==GEOID_EGM2008_M25) { /* 2.5 x 2.5" grid */
         dlon= 2.5/60.0;
@@ -120,29 +186,29 @@ static double geoidh_egm08(const double *pos, int model)
     /* (2) Und_min2.5x2.5_egm2008_isw=82_WGS84_TideFree_SE.gz */
 #ifdef RTK_DISABLED
     /* not zero-inserted */
-    y[0]=fget4f(fp_geoid,4L*(i1+j1*(nlon)));
-    y[1]=fget4f(fp_geoid,4L*(i2+j1*(nlon)));
-    y[2]=fget4f(fp_geoid,4L*(i1+j2*(nlon)));
-    y[3]=fget4f(fp_geoid,4L*(i2+j2*(nlon)));
+    y[0]=fget4f(4L*(i1+j1*(nlon)));
+    y[1]=fget4f(4L*(i2+j1*(nlon)));
+    y[2]=fget4f(4L*(i1+j2*(nlon)));
+    y[3]=fget4f(4L*(i2+j2*(nlon)));
 #else
     /* zero-inserted version (2009/12/10) */
-    y[0]=fget4f(fp_geoid,4L*(i1+j1*(nlon+2)+1));
-    y[1]=fget4f(fp_geoid,4L*(i2+j1*(nlon+2)+1));
-    y[2]=fget4f(fp_geoid,4L*(i1+j2*(nlon+2)+1));
-    y[3]=fget4f(fp_geoid,4L*(i2+j2*(nlon+2)+1));
+    y[0]=fget4f(4L*(i1+j1*(nlon+2)+1));
+    y[1]=fget4f(4L*(i2+j1*(nlon+2)+1));
+    y[2]=fget4f(4L*(i1+j2*(nlon+2)+1));
+    y[3]=fget4f(4L*(i2+j2*(nlon+2)+1));
 #endif
     return interpb(y,a,b);
 }
 /* get gsi geoid data --------------------------------------------------------*/
-static double fgetgsi(FILE *fp, int nlon, int nlat, int i, int j)
+static double fgetgsi(int nlon, int nlat, int i, int j)
 {
     (void)nlat;
     const int nf=28,wf=9,nl=nf*wf+2,nr=(nlon-1)/nf+1;
     double v;
-    int off=nl+j*nr*nl+i/nf*nl+i%nf*wf;
+    long off=nl+(long)j*nr*nl+i/nf*nl+i%nf*wf;
     char buff[16]="";
     
-    if (fseek(fp,(long)off,SEEK_SET)==EOF||fread(buff,wf,1,fp)<1) {
+    if (!readgeoid(off,wf,(uint8_t *)buff)) {
         trace(2,"out of range for gsi geoid: i=%d j=%d\n",i,j);
         return 0.0;
     }
@@ -161,7 +227,7 @@ static double geoidh_gsi(const double *pos)
     double a,b,y[4];
     int i1,i2,j1,j2;
     
-    if (!fp_geoid||pos[1]<lon0||lon1<pos[1]||pos[0]<lat0||lat1<pos[0]) {
+    if (!size_geoid||pos[1]<lon0||lon1<pos[1]||pos[0]<lat0||lat1<pos[0]) {
         trace(2,"out of range for gsi geoid: lat=%.3f lon=%.3f\n",pos[0],pos[1]);
         return 0.0;
     }
@@ -169,16 +235,85 @@ static double geoidh_gsi(const double *pos)
     b=(pos[0]-lat0)/dlat;
     i1=(int)a; a-=i1; i2=i1<nlon-1?i1+1:i1;
     j1=(int)b; b-=j1; j2=j1<nlat-1?j1+1:j1;
-    y[0]=fgetgsi(fp_geoid,nlon,nlat,i1,j1);
-    y[1]=fgetgsi(fp_geoid,nlon,nlat,i2,j1);
-    y[2]=fgetgsi(fp_geoid,nlon,nlat,i1,j2);
-    y[3]=fgetgsi(fp_geoid,nlon,nlat,i2,j2);
+    y[0]=fgetgsi(nlon,nlat,i1,j1);
+    y[1]=fgetgsi(nlon,nlat,i2,j1);
+    y[2]=fgetgsi(nlon,nlat,i1,j2);
+    y[3]=fgetgsi(nlon,nlat,i2,j2);
     if (y[0]==999.0||y[1]==999.0||y[2]==999.0||y[3]==999.0) {
         trace(2,"geoidh_gsi: data outage (lat=%.3f lon=%.3f)\n",pos[0],pos[1]);
         return 0.0;
     }
     return interpb(y,a,b);
 }
+/* map geoid model file to memory --------------------------------------------*/
+static int mapgeoid(const char *file)
+{
+#ifdef WIN32
+    LARGE_INTEGER size;
+    
+    if ((fh_geoid=CreateFileA(file,GENERIC_READ,FILE_SHARE_READ,NULL,
+                              OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,NULL))==
+        INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+    if (!GetFileSizeEx(fh_geoid,&size)||size.QuadPart<=0||
+        !(mh_geoid=CreateFileMapping(fh_geoid,NULL,PAGE_READONLY,0,0,NULL))) {
+        CloseHandle(fh_geoid); fh_geoid=INVALID_HANDLE_VALUE;
+        return 0;
+    }
+    if (!(map_geoid=(const uint8_t *)MapViewOfFile(mh_geoid,FILE_MAP_READ,0,0,0))) {
+        CloseHandle(mh_geoid); mh_geoid=NULL;
+        CloseHandle(fh_geoid); fh_geoid=INVALID_HANDLE_VALUE;
+        return 0;
+    }
+    size_geoid=(long)size.QuadPart;
+#else
+    struct stat st;
+    void *p;
+    int fd;
+    
+    if ((fd=open(file,O_RDONLY))<0) return 0;
+    if (fstat(fd,&st)<0||st.st_size<=0||
+        (p=mmap(NULL,(size_t)st.st_size,PROT_READ,MAP_SHARED,fd,0))==MAP_FAILED) {
+        close(fd);
+        return 0;
+    }
+    close(fd);
+    posix_madvise(p,(size_t)st.st_size,POSIX_MADV_RANDOM);
+    map_geoid=(const uint8_t *)p;
+    size_geoid=(long)st.st_size;
+#endif
+    return 1;
+}
+/* unmap geoid model file ----------------------------------------------------*/
+static void unmapgeoid(void)
+{
+    if (!map_geoid) return;
+#ifdef WIN32
+    UnmapViewOfFile(map_geoid);
+    CloseHandle(mh_geoid); mh_geoid=NULL;
+    CloseHandle(fh_geoid); fh_geoid=INVALID_HANDLE_VALUE;
+#else
+    munmap((void *)map_geoid,(size_t)size_geoid);
+#endif
+    map_geoid=NULL;
+}
+/* open geoid model file with block cache ------------------------------------*/
+static int opencache(const char *file)
+{
+    int i;
+    
+    if (!(fp_geoid=fopen(file,"rb"))) return 0;
+    
+    if (fseek(fp_geoid,0,SEEK_END)==EOF||(size_geoid=ftell(fp_geoid))<=0||
+        !(cache_geoid=(uint8_t *)malloc(GEOID_NBLK*GEOID_BLKSIZE))) {
+        fclose(fp_geoid); fp_geoid=NULL;
+        size_geoid=0;
+        return 0;
+    }
+    for (i=0;i<GEOID_NBLK;i++) blk_geoid[i]=-1;
+    return 1;
+}
 /* open geoid model file -------------------------------------------------------
 * open geoid model file
 * args   : int    model     I   geoid model type
@@ -195,6 +330,9 @@ static double geoidh_gsi(const double *pos)
 *          Und_min1x1_egm2008_isw=82_WGS84_TideFree_SE    : EGM2008 1.0x1.0"
 *          gsigeome_ver4 : GSI geoid 2000 1.0x1.5" (japanese area)
 *          (byte-order of binary files must be compatible to cpu)
+*          the geoid model file is mapped to memory. if the file cannot be
+*          mapped, it is read through an in-memory cache of data blocks
+*          (GEOID_NBLK x GEOID_BLKSIZE bytes).
 *-----------------------------------------------------------------------------*/
 extern int opengeoid(int model, const char *file)
 {
@@ -209,10 +347,15 @@ extern int opengeoid(int model, const char *file)
         trace(2,"invalid geoid model: model=%d file=%s\n",model,file);
         return 0;
     }
-    if (!(fp_geoid=fopen(file,"rb"))) {
+    if (!initlock_geoid) {
+        rtklib_initlock(&lock_geoid);
+        initlock_geoid=1;
+    }
+    if (!mapgeoid(file)&&!opencache(file)) {
         trace(2,"geoid model file open error: model=%d file=%s\n",model,file);
         return 0;
     }
+    trace(3,"opengeoid: size=%ld mapped=%d\n",size_geoid,map_geoid!=NULL);
     model_geoid=model;
     return 1;
 }
@@ -225,8 +368,11 @@ extern void closegeoid(void)
 {
     trace(3,"closegoid:\n");
     
+    unmapgeoid();
     if (fp_geoid) fclose(fp_geoid);
     fp_geoid=NULL;
+    free(cache_geoid); cache_geoid=NULL;
+    size_geoid=0;
     model_geoid=GEOID_EMBEDDED;
 }
 /* geoid height ----------------------------------------------------------------
@@ -261,6 +407,26 @@ extern double geoidh(const double *pos)
     }
     return h;
 }
+/* geoid heights ---------------------------------------------------------------
+* get geoid heights of positions from geoid model
+* args   : double *pos      I   geodetic positions {lat,lon,h} (rad,m) (3 x n)
+*          int    n         I   number of positions
+*          double *h        O   geoid heights (m) (0.0:error) (n x 1)
+* return : number of valid geoid heights
+* notes  : same as geoidh(). the function may be called by multiple threads
+*          while the geoid model is not opened or closed.
+*-----------------------------------------------------------------------------*/
+extern int geoidh_n(const double *pos, int n, double *h)
+{
+    int i,m=0;
+    
+    trace(4,"geoidh_n: n=%d\n",n);
+    
+    for (i=0;i<n;i++) {
+        if ((h[i]=geoidh(pos+i*3))!=0.0) m++;
+    }
+    return m;
+}
 /*------------------------------------------------------------------------------
 * embedded geoid model
 * notes  : geoid heights are derived from EGM96 (1 x 1 deg grid)
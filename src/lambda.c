@@ -13,6 +13,7 @@
 * version : $Revision: 1.1 $ $Date: 2008/07/17 21:48:06 $
 * history : 2007/01/13 1.0 new
 *           2015/05/31 1.1 add api lambda_reduction(), lambda_search()
+*           2026/10/16 1.2 add api lambda_ws(), lambda_initws(), lambda_freews()
 *-----------------------------------------------------------------------------*/
 #include "rtklib.h"
 
@@ -24,13 +25,30 @@
 #define ROUND(x)    (floor((x)+0.5))
 #define SWAP(x,y)   do {double tmp_; tmp_=x; x=y; y=tmp_;} while (0)
 
+/* extend workspace ---------------------------------------------------------*/
+static int extws(lambda_ws_t *ws, int n, int m)
+{
+    double *buff;
+    int nmax,mmax;
+    
+    if (n<=ws->nmax&&m<=ws->mmax) return 1;
+    nmax=n>ws->nmax?n:ws->nmax;
+    mmax=m>ws->mmax?m:ws->mmax;
+    if (!(buff=(double *)malloc(sizeof(double)*(nmax*nmax*6+nmax*6+nmax*mmax)))) {
+        return 0;
+    }
+    free(ws->buff);
+    ws->buff=buff; ws->nmax=nmax; ws->mmax=mmax;
+    return 1;
+}
 /* LD factorization (Q=L'*diag(D)*L) -----------------------------------------*/
-static int LD(int n, const double *Q, double *L, double *D)
+static int LD(int n, const double *Q, double *L, double *D, double *A)
 {
     int i,j,k,info=0;
-    double a,*A=mat(n,n);
+    double a;
     
     memcpy(A,Q,sizeof(double)*n*n);
+    for (i=0;i<n*n;i++) L[i]=0.0;
     for (i=n-1;i>=0;i--) {
         if ((D[i]=A[i+i*n])<=0.0) {info=-1; break;}
         a=sqrt(D[i]);
@@ -38,22 +56,23 @@ static int LD(int n, const double *Q, double *L, double *D)
         for (j=0;j<=i-1;j++) for (k=0;k<=j;k++) A[j+k*n]-=L[i+k*n]*L[i+j*n];
         for (j=0;j<=i;j++) L[i+j*n]/=L[i+i*n];
     }
-    free(A);
     if (info) fprintf(stderr,"%s : LD factorization error\n",__FILE__);
     return info;
 }
-/* integer gauss transformation ----------------------------------------------*/
-static void gauss(int n, double *L, double *Z, int i, int j)
+/* integer gauss transformation (Zi: inverse of Z, NULL: no output) ----------*/
+static void gauss(int n, double *L, double *Z, double *Zi, int i, int j)
 {
     int k,mu;
     
     if ((mu=(int)ROUND(L[i+j*n]))!=0) {
         for (k=i;k<n;k++) L[k+n*j]-=(double)mu*L[k+i*n];
         for (k=0;k<n;k++) Z[k+n*j]-=(double)mu*Z[k+i*n];
+        if (Zi) for (k=0;k<n;k++) Zi[i+n*k]+=(double)mu*Zi[j+n*k];
     }
 }
 /* permutations --------------------------------------------------------------*/
-static void perm(int n, double *L, double *D, int j, double del, double *Z)
+static void perm(int n, double *L, double *D, int j, double del, double *Z,
+                 double *Zi)
 {
     int k;
     double eta,lam,a0,a1;
@@ -69,19 +88,20 @@ static void perm(int n, double *L, double *D, int j, double del, double *Z)
     L[j+1+j*n]=lam;
     for (k=j+2;k<n;k++) SWAP(L[k+j*n],L[k+(j+1)*n]);
     for (k=0;k<n;k++) SWAP(Z[k+j*n],Z[k+(j+1)*n]);
+    if (Zi) for (k=0;k<n;k++) SWAP(Zi[j+k*n],Zi[j+1+k*n]);
 }
 /* lambda reduction (z=Z'*a, Qz=Z'*Q*Z=L'*diag(D)*L) (ref.[1]) ---------------*/
-static void reduction(int n, double *L, double *D, double *Z)
+static void reduction(int n, double *L, double *D, double *Z, double *Zi)
 {
     int i,j,k;
     double del;
     
     j=n-2; k=n-2;
     while (j>=0) {
-        if (j<=k) for (i=j+1;i<n;i++) gauss(n,L,Z,i,j);
+        if (j<=k) for (i=j+1;i<n;i++) gauss(n,L,Z,Zi,i,j);
         del=D[j]+L[j+1+j*n]*L[j+1+j*n]*D[j+1];
         if (del+1E-6<D[j+1]) { /* compared considering numerical error */
-            perm(n,L,D,j,del,Z);
+            perm(n,L,D,j,del,Z,Zi);
             k=j; j=n-2;
         }
         else j--;
@@ -93,14 +113,20 @@ static void reduction(int n, double *L, double *D, double *Z)
            L,D    I  transformed covariance matrix
            zs     I  transformed double-diff phase biases
            zn     O  fixed solutions
-           s      O  sum of residuals for fixed solutions                    */
+           s      O  sum of residuals for fixed solutions
+           work   -  work buffer (2*n*n+4*n)
+* notes  : S and L are stored by row to update S in contiguous memory         */
 static int search(int n, int m, const double *L, const double *D,
-                  const double *zs, double *zn, double *s)
+                  const double *zs, double *zn, double *s, double *work)
 {
     int i,j,k,c,nn=0,imax=0;
-    double newdist,maxdist=1E99,y;
-    double *S=zeros(n,n),*dist=mat(n,1),*zb=mat(n,1),*z=mat(n,1),*step=mat(n,1);
+    double newdist,maxdist=1E99,y,d,*Sk;
+    double *S=work,*Lt=S+n*n,*dist=Lt+n*n,*zb=dist+n,*z=zb+n,*step=z+n;
     
+    for (i=0;i<n;i++) for (j=0;j<n;j++) {
+        S[j+i*n]=0.0;
+        Lt[j+i*n]=L[i+j*n];
+    }
     k=n-1; dist[k]=0.0;
     zb[k]=zs[k];
     z[k]=ROUND(zb[k]);
@@ -112,9 +138,10 @@ static int search(int n, int m, const double *L, const double *D,
             /* Case 1: move down */
             if (k!=0) {
                 dist[--k]=newdist;
-                for (i=0;i<=k;i++)
-                    S[k+i*n]=S[k+1+i*n]+(z[k+1]-zb[k+1])*L[k+1+i*n];
-                zb[k]=zs[k]+S[k+k*n];
+                d=z[k+1]-zb[k+1];
+                Sk=S+k*n;
+                for (i=0;i<=k;i++) Sk[i]=Sk[i+n]+d*Lt[i+(k+1)*n];
+                zb[k]=zs[k]+Sk[k];
                 z[k]=ROUND(zb[k]); /* next valid integer */
                 y=zb[k]-z[k];
                 step[k]=SGN(y);
@@ -157,51 +184,86 @@ static int search(int n, int m, const double *L, const double *D,
             for (k=0;k<n;k++) SWAP(zn[k+i*n],zn[k+j*n]);
         }
     }
-    free(S); free(dist); free(zb); free(z); free(step);
-    
     if (c>=LOOPMAX) {
         fprintf(stderr,"%s : search loop count overflow\n",__FILE__);
         return -2;
     }
     return 0;
 }
-/* lambda/mlambda integer least-square estimation ------------------------------
-* integer least-square estimation. reduction is performed by lambda (ref.[1]),
-* and search by mlambda (ref.[2]).
-* args   : int    n      I  number of float parameters
-*          int    m      I  number of fixed solutions
-*          double *a     I  float parameters (n x 1) (double-diff phase biases)
-*          double *Q     I  covariance matrix of float parameters (n x n)
-*          double *F     O  fixed solutions (n x m)
-*          double *s     O  sum of squared residulas of fixed solutions (1 x m)
+/* initialize/free lambda workspace --------------------------------------------
+* args   : lambda_ws_t *ws  IO  lambda workspace
+* return : none
+*-----------------------------------------------------------------------------*/
+extern void lambda_initws(lambda_ws_t *ws)
+{
+    ws->nmax=ws->mmax=0;
+    ws->buff=NULL;
+}
+extern void lambda_freews(lambda_ws_t *ws)
+{
+    free(ws->buff);
+    lambda_initws(ws);
+}
+/* lambda/mlambda integer least-square estimation with workspace ---------------
+* integer least-square estimation with persistent work buffers
+* args   : lambda_ws_t *ws  IO  lambda workspace
+*          (others)             same as lambda()
 * return : status (0:ok,other:error)
-* notes  : matrix stored by column-major order (fortran convension)
+* notes  : work buffers in ws are extended as needed and reused for next calls.
+*          the workspace should be initialized by lambda_initws() before first
+*          call and freed by lambda_freews().
 *-----------------------------------------------------------------------------*/
-extern int lambda(int n, int m, const double *a, const double *Q, double *F,
-                  double *s)
+extern int lambda_ws(lambda_ws_t *ws, int n, int m, const double *a,
+                     const double *Q, double *F, double *s)
 {
-    int info;
-    double *L,*D,*Z,*z,*E;
+    int i,j,info;
+    double *L,*D,*Z,*Zi,*z,*E,*work;
     
     if (n<=0||m<=0) return -1;
-    L=zeros(n,n); D=mat(n,1); Z=eye(n); z=mat(n,1); E=mat(n,m);
+    if (!extws(ws,n,m)) return -1;
+    L=ws->buff; Z=L+n*n; Zi=Z+n*n; D=Zi+n*n; z=D+n; E=z+n; work=E+n*m;
     
+    for (i=0;i<n;i++) for (j=0;j<n;j++) {
+        Z[i+j*n]=Zi[i+j*n]=i==j?1.0:0.0;
+    }
     /* LD (lower diagonal) factorization (Q=L'*diag(D)*L) */
-    if (!(info=LD(n,Q,L,D))) {
+    if (!(info=LD(n,Q,L,D,work))) {
         
         /* lambda reduction (z=Z'*a, Qz=Z'*Q*Z=L'*diag(D)*L) */
-        reduction(n,L,D,Z);
+        reduction(n,L,D,Z,Zi);
         matmul("TN",n,1,n,Z,a,z); /* z=Z'*a */
         
         /* mlambda search 
             z = transformed double-diff phase biases
             L,D = transformed covariance matrix */
-        if (!(info=search(n,m,L,D,z,E,s))) {  /* returns 0 if no error */
+        if (!(info=search(n,m,L,D,z,E,s,work))) {  /* returns 0 if no error */
             
-            info=solve("T",Z,E,n,m,F); /* F=Z'\E */
+            matmul("TN",n,m,n,Zi,E,F); /* F=Z'\E=Zi'*E */
         }
     }
-    free(L); free(D); free(Z); free(z); free(E);
+    return info;
+}
+/* lambda/mlambda integer least-square estimation ------------------------------
+* integer least-square estimation. reduction is performed by lambda (ref.[1]),
+* and search by mlambda (ref.[2]).
+* args   : int    n      I  number of float parameters
+*          int    m      I  number of fixed solutions
+*          double *a     I  float parameters (n x 1) (double-diff phase biases)
+*          double *Q     I  covariance matrix of float parameters (n x n)
+*          double *F     O  fixed solutions (n x m)
+*          double *s     O  sum of squared residulas of fixed solutions (1 x m)
+* return : status (0:ok,other:error)
+* notes  : matrix stored by column-major order (fortran convension)
+*-----------------------------------------------------------------------------*/
+extern int lambda(int n, int m, const double *a, const double *Q, double *F,
+                  double *s)
+{
+    lambda_ws_t ws;
+    int info;
+    
+    lambda_initws(&ws);
+    info=lambda_ws(&ws,n,m,a,Q,F,s);
+    lambda_freews(&ws);
     return info;
 }
 /* lambda reduction ------------------------------------------------------------
@@ -213,25 +275,25 @@ extern int lambda(int n, int m, const double *a, const double *Q, double *F,
 *-----------------------------------------------------------------------------*/
 extern int lambda_reduction(int n, const double *Q, double *Z)
 {
-    double *L,*D;
+    double *L,*D,*A;
     int i,j,info;
     
     if (n<=0) return -1;
     
-    L=zeros(n,n); D=mat(n,1);
+    L=mat(n,n); D=mat(n,1); A=mat(n,n);
     
     for (i=0;i<n;i++) for (j=0;j<n;j++) {
         Z[i+j*n]=i==j?1.0:0.0;
     }
     /* LD factorization */
-    if ((info=LD(n,Q,L,D))) {
-        free(L); free(D);
+    if ((info=LD(n,Q,L,D,A))) {
+        free(L); free(D); free(A);
         return info;
     }
     /* lambda reduction */
-    reduction(n,L,D,Z);
+    reduction(n,L,D,Z,NULL);
      
-    free(L); free(D);
+    free(L); free(D); free(A);
     return 0;
 }
 /* mlambda search --------------------------------------------------------------
@@ -247,21 +309,21 @@ extern int lambda_reduction(int n, const double *Q, double *Z)
 extern int lambda_search(int n, int m, const double *a, const double *Q,
                          double *F, double *s)
 {
-    double *L,*D;
+    double *L,*D,*work;
     int info;
     
     if (n<=0||m<=0) return -1;
     
-    L=zeros(n,n); D=mat(n,1);
+    L=mat(n,n); D=mat(n,1); work=mat(2*n*n+4*n,1);
     
     /* LD factorization */
-    if ((info=LD(n,Q,L,D))) {
-        free(L); free(D);
+    if ((info=LD(n,Q,L,D,work))) {
+        free(L); free(D); free(work);
         return info;
     }
     /* mlambda search */
-    info=search(n,m,L,D,a,F,s);
+    info=search(n,m,L,D,a,F,s,work);
     
-    free(L); free(D);
+    free(L); free(D); free(work);
     return info;
 }
@@ -59,6 +59,7 @@ static char snrmask_[NFREQ][1024];
 #define GEOOPT  "0:internal,1:egm96,2:egm08_2.5,3:egm08_1,4:gsi2000"
 #define STAOPT  "0:all,1:single"
 #define STSOPT  "0:off,1:state,2:residual"
+#define STFOPT  "0:text,1:binary"
 #define ARMOPT  "0:off,1:continuous,2:instantaneous,3:fix-and-hold"
 #define POSOPT  "0:llh,1:xyz,2:single,3:posfile,4:rinexhead,5:rtcm"
 #define TIDEOPT "1:solid+2:otl+4:spole"
@@ -110,6 +111,7 @@ EXPORT opt_t sysopts[]={
     {"pos2-arminfix",   0,  (void *)&prcopt_.minfix,     ""     },
     {"pos2-armaxiter",  0,  (void *)&prcopt_.armaxiter,  ""     },
     {"pos2-elmaskhold", 1,  (void *)&elmaskhold_,        "deg"  },
+    {"pos2-arpar",      3,  (void *)&prcopt_.arpar,      SWTOPT },
     {"pos2-aroutcnt",   0,  (void *)&prcopt_.maxout,     ""     },
     {"pos2-maxage",     1,  (void *)&prcopt_.maxtdiff,   "s"    },
     {"pos2-syncsol",    3,  (void *)&prcopt_.syncsol,    SWTOPT },
@@ -138,6 +140,7 @@ EXPORT opt_t sysopts[]={
     {"out-nmeaintv1",   1,  (void *)&solopt_.nmeaintv[0],"s"    },
     {"out-nmeaintv2",   1,  (void *)&solopt_.nmeaintv[1],"s"    },
     {"out-outstat",     3,  (void *)&solopt_.sstat,      STSOPT },
+    {"out-outstatfmt",  3,  (void *)&solopt_.sstatf,     STFOPT },
     {"stats-eratio1",   1,  (void *)&prcopt_.eratio[0],  ""     },
     {"stats-eratio2",   1,  (void *)&prcopt_.eratio[1],  ""     },
     {"stats-eratio5",   1,  (void *)&prcopt_.eratio[2],  ""     },
@@ -185,6 +188,10 @@ EXPORT opt_t sysopts[]={
     {"misc-rnxopt1",    2,  (void *)prcopt_.rnxopt[0],   ""     },
     {"misc-rnxopt2",    2,  (void *)prcopt_.rnxopt[1],   ""     },
     {"misc-pppopt",     2,  (void *)prcopt_.pppopt,      ""     },
+    {"misc-combpar",    3,  (void *)&prcopt_.combpar,    SWTOPT },
+    {"misc-obscache",   3,  (void *)&prcopt_.obscache,   SWTOPT },
+    {"misc-obsstream",  3,  (void *)&prcopt_.obsstream,  SWTOPT },
+    {"misc-solspill",   3,  (void *)&prcopt_.solspill,   SWTOPT },
     
     {"file-satantfile", 2,  (void *)&filopt_.satantp,    ""     },
     {"file-rcvantfile", 2,  (void *)&filopt_.rcvantp,    ""     },
@@ -43,48 +43,115 @@
 *                            fix bug on select best solution in static mode
 *                            delete function to use L2 instead of L5 PCV
 *                            writing solution file in binary mode
+*           2026/10/16  1.25 move session data into context for reentrancy
+*                            add API ppshrinit(),ppshrfree(),postpos_ctx()
+*                            use interpolation cache of precise ephemeris
+*                            add binary obs/nav cache mapped to memory
+*                             (prcopt.obscache)
+*                            add streaming obs data window for forward
+*                             solutions (prcopt.obsstream)
+*                            store combined solutions as compact records
+*                             optionally spilled to mapped files (prcopt.solspill)
+*                            output binary solution status (solopt.sstatf)
 *-----------------------------------------------------------------------------*/
+#define _POSIX_C_SOURCE 200112
+#include <stddef.h>
+#include <sys/stat.h>
 #include "rtklib.h"
+#ifndef WIN32
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #define MIN(x,y)    ((x)<(y)?(x):(y))
+#define MAX(x,y)    ((x)>(y)?(x):(y))
 #define SQRT(x)     ((x)<=0.0||(x)!=(x)?0.0:sqrt(x))
 
 #define MAXPRCDAYS  100          /* max days of continuous processing */
 #define MAXINFILE   1000         /* max number of input files */
 #define MAXINVALIDTM 100         /* max number of invalid time marks */
 
-/* constants/global variables ------------------------------------------------*/
-
-static pcvs_t pcvss={0};        /* satellite antenna parameters */
-static pcvs_t pcvsr={0};        /* receiver antenna parameters */
-static obs_t obss={0};          /* observation data */
-static nav_t navs={0};          /* navigation data */
-static sbs_t sbss={0};          /* sbas messages */
-static sta_t stas[MAXRCV];      /* station information */
-static int nepoch=0;            /* number of observation epochs */
-static int nitm  =0;            /* number of invalid time marks */
-static int iobsu =0;            /* current rover observation data index */
-static int iobsr =0;            /* current reference observation data index */
-static int isbs  =0;            /* current sbas message index */
-static int iitm  =0;            /* current invalid time mark index */
-static int reverse=0;           /* analysis direction (0:forward,1:backward) */
-static int aborts=0;            /* abort status */
-static sol_t *solf;             /* forward solutions */
-static sol_t *solb;             /* backward solutions */
-static double *rbf;             /* forward base positions */
-static double *rbb;             /* backward base positions */
-static int isolf=0;             /* current forward solutions index */
-static int isolb=0;             /* current backward solutions index */
-static char proc_rov [64]="";   /* rover for current processing */
-static char proc_base[64]="";   /* base station for current processing */
-static char rtcm_file[1024]=""; /* rtcm data file */
-static char rtcm_path[1024]=""; /* rtcm data path */
-static gtime_t invalidtm[MAXINVALIDTM]={{0}};/* invalid time marks */
-static rtcm_t rtcm;             /* rtcm control struct */
-static FILE *fp_rtcm=NULL;      /* rtcm data file pointer */
+#define OBSC_ID     "RTKOBSC"    /* obs/nav cache file id */
+#define OBSC_VER    1            /* obs/nav cache format version */
+#define OBSC_EXT    ".rtkc"      /* obs/nav cache file extension */
+#define OBSC_ALIGN  64           /* alignment of data in obs/nav cache */
+#define NNAVPAR     89           /* number of navigation parameters in cache */
+
+/* type definitions ----------------------------------------------------------*/
+
+typedef struct {        /* obs/nav cache file header type */
+    char id[8];         /* file id (OBSC_ID) */
+    uint32_t ver;       /* format version (OBSC_VER) */
+    uint32_t size[5];   /* size of {obsd_t,eph_t,geph_t,seph_t,sta_t} */
+    uint64_t key;       /* signature of input files and options */
+    int32_t n[4];       /* number of {obs,eph,geph,seph} data */
+    int32_t nepoch;     /* number of observation epochs */
+    int32_t stamask;    /* station information read (1:rover,2:base) */
+    uint64_t off[4];    /* file offset of {obs,eph,geph,seph} data */
+    sta_t sta[2];       /* station information {rover,base} */
+    double par[NNAVPAR]; /* navigation parameters (0:not set) */
+    int32_t glo_fcn[32]; /* GLONASS FCN + 8 (0:not set) */
+} obsch_t;
+
+typedef struct {        /* compact solution record type */
+    gtime_t time;       /* time (GPST) */
+    gtime_t eventime;   /* time of event (GPST) */
+    double rr[6];       /* position/velocity (m|m/s) */
+    double rb[3];       /* base position (m) */
+    float qr[6];        /* position variance/covariance (m^2) */
+    float qv[6];        /* velocity variance/covariance (m^2/s^2) */
+    float age;          /* age of differential (s) */
+    float ratio;        /* AR ratio factor for validation */
+    int32_t refstationid; /* ref station ID */
+    uint32_t flag;      /* type (bit 0),status (bit 1-4),valid sats (bit 5-12) */
+} solc_t;
+
+typedef struct {        /* post-processing session context type */
+    const ppshr_t *shr; /* shared read-only data */
+    int glob;           /* use process-wide trace/solution status/geoid */
+    obs_t obss;         /* observation data */
+    nav_t navs;         /* navigation data */
+    sbs_t sbss;         /* sbas messages */
+    sta_t stas[MAXRCV]; /* station information */
+    int nepoch;         /* number of observation epochs */
+    int nitm;           /* number of invalid time marks */
+    int iobsu;          /* current rover observation data index */
+    int iobsr;          /* current reference observation data index */
+    int isbs;           /* current sbas message index */
+    int iitm;           /* current invalid time mark index */
+    int reverse;        /* analysis direction (0:forward,1:backward) */
+    int aborts;         /* abort status */
+    solc_t *solf;       /* forward solutions */
+    solc_t *solb;       /* backward solutions */
+    size_t nsolf,nsolb; /* size of mapped forward/backward solutions (0:memory) */
+    int isolf;          /* current forward solutions index */
+    int isolb;          /* current backward solutions index */
+    char proc_rov [64]; /* rover for current processing */
+    char proc_base[64]; /* base station for current processing */
+    char rtcm_file[1024]; /* rtcm data file */
+    char rtcm_path[1024]; /* rtcm data path */
+    gtime_t invalidtm[MAXINVALIDTM]; /* invalid time marks */
+    rtcm_t rtcm;        /* rtcm control struct */
+    FILE *fp_rtcm;      /* rtcm data file pointer */
+    void *obsmap;       /* mapped obs/nav cache (NULL:no map) */
+    size_t nobsmap;     /* size of mapped obs/nav cache (bytes) */
+    int stream;         /* streaming obs data window (0:off,1:on) */
+    rnxobs_t *rnxs[2];  /* obs data streams {rover,base} (NULL:end) */
+    obs_t obsh[2];      /* next epochs of obs data streams {rover,base} */
+    gtime_t tbase[2];   /* times of last two base epochs in window */
+    int nbase;          /* number of base epochs appended to window */
+} ppctx_t;
+
+typedef struct {        /* backward pass of combined solutions type */
+    ppctx_t *ctx;       /* session context of backward pass */
+    const prcopt_t *popt; /* processing options */
+    const solopt_t *sopt; /* solution options */
+    rtk_t *rtk;         /* rtk control/result of backward pass */
+} ppbwd_t;
 
 /* show message and check break ----------------------------------------------*/
-static int checkbrk(const char *format, ...)
+static int checkbrk(const ppctx_t *ctx, const char *format, ...)
 {
     va_list arg;
     char buff[1024],*p=buff;
@@ -92,9 +159,9 @@ static int checkbrk(const char *format, ...)
     va_start(arg,format);
     p+=vsprintf(p,format,arg);
     va_end(arg);
-    if (*proc_rov&&*proc_base) sprintf(p," (%s-%s)",proc_rov,proc_base);
-    else if (*proc_rov ) sprintf(p," (%s)",proc_rov );
-    else if (*proc_base) sprintf(p," (%s)",proc_base);
+    if (*ctx->proc_rov&&*ctx->proc_base) sprintf(p," (%s-%s)",ctx->proc_rov,ctx->proc_base);
+    else if (*ctx->proc_rov ) sprintf(p," (%s)",ctx->proc_rov );
+    else if (*ctx->proc_base) sprintf(p," (%s)",ctx->proc_base);
     return showmsg(buff);
 }
 /* Solution option to field separator ----------------------------------------*/
@@ -132,8 +199,8 @@ static void outrpos(FILE *fp, const double *r, const solopt_t *opt)
     }
 }
 /* output header -------------------------------------------------------------*/
-static void outheader(FILE *fp, const char **file, int n, const prcopt_t *popt,
-                      const solopt_t *sopt)
+static void outheader(const ppctx_t *ctx, FILE *fp, const char **file, int n,
+                      const prcopt_t *popt, const solopt_t *sopt)
 {
     const char *s1[]={"GPST","UTC","JST"};
     gtime_t ts,te;
@@ -156,11 +223,11 @@ static void outheader(FILE *fp, const char **file, int n, const prcopt_t *popt,
         for (i=0;i<n;i++) {
             fprintf(fp,"%s inp file  : %s\n",COMMENTH,file[i]);
         }
-        for (i=0;i<obss.n;i++)    if (obss.data[i].rcv==1) break;
-        for (j=obss.n-1;j>=0;j--) if (obss.data[j].rcv==1) break;
+        for (i=0;i<ctx->obss.n;i++)    if (ctx->obss.data[i].rcv==1) break;
+        for (j=ctx->obss.n-1;j>=0;j--) if (ctx->obss.data[j].rcv==1) break;
         if (j<i) {fprintf(fp,"\n%s no rover obs data\n",COMMENTH); return;}
-        ts=obss.data[i].time;
-        te=obss.data[j].time;
+        ts=ctx->obss.data[i].time;
+        te=ctx->obss.data[j].time;
         t1=time2gpst(ts,&w1);
         t2=time2gpst(te,&w2);
         if (sopt->times>=1) {
@@ -216,145 +283,208 @@ static int nextobsb(const obs_t *obs, int *i, int rcv)
     return n;
 }
 /* update rtcm ssr correction ------------------------------------------------*/
-static void update_rtcm_ssr(gtime_t time)
+static void update_rtcm_ssr(ppctx_t *ctx, gtime_t time)
 {
     char path[1024];
     int i;
 
     /* open or swap rtcm file */
-    reppath(rtcm_file,path,time,"","");
+    reppath(ctx->rtcm_file,path,time,"","");
 
-    if (strcmp(path,rtcm_path)) {
-        strcpy(rtcm_path,path);
+    if (strcmp(path,ctx->rtcm_path)) {
+        strcpy(ctx->rtcm_path,path);
 
-        if (fp_rtcm) fclose(fp_rtcm);
-        fp_rtcm=fopen(path,"rb");
-        if (fp_rtcm) {
-            rtcm.time=time;
-            input_rtcm3f(&rtcm,fp_rtcm);
+        fclose_fbuf(&ctx->rtcm.fbuf,ctx->fp_rtcm);
+        ctx->fp_rtcm=fopen_fbuf(&ctx->rtcm.fbuf,path,"rb");
+        if (ctx->fp_rtcm) {
+            ctx->rtcm.time=time;
+            input_rtcm3f(&ctx->rtcm,ctx->fp_rtcm);
             trace(2,"rtcm file open: %s\n",path);
         }
     }
-    if (!fp_rtcm) return;
+    if (!ctx->fp_rtcm) return;
 
     /* read rtcm file until current time */
-    while (timediff(rtcm.time,time)<1E-3) {
-        if (input_rtcm3f(&rtcm,fp_rtcm)<-1) break;
+    while (timediff(ctx->rtcm.time,time)<1E-3) {
+        if (input_rtcm3f(&ctx->rtcm,ctx->fp_rtcm)<-1) break;
 
         /* update ssr corrections */
         for (i=0;i<MAXSAT;i++) {
-            if (!rtcm.ssr[i].update||
-                rtcm.ssr[i].iod[0]!=rtcm.ssr[i].iod[1]||
-                timediff(time,rtcm.ssr[i].t0[0])<-1E-3) continue;
-            navs.ssr[i]=rtcm.ssr[i];
-            rtcm.ssr[i].update=0;
+            if (!ctx->rtcm.ssr[i].update||
+                ctx->rtcm.ssr[i].iod[0]!=ctx->rtcm.ssr[i].iod[1]||
+                timediff(time,ctx->rtcm.ssr[i].t0[0])<-1E-3) continue;
+            ctx->navs.ssr[i]=ctx->rtcm.ssr[i];
+            ctx->rtcm.ssr[i].update=0;
         }
     }
 }
+/* input next epoch of obs data stream ---------------------------------------*/
+static void inputobss(ppctx_t *ctx, int k)
+{
+    ctx->obsh[k].n=0;
+    if (ctx->rnxs[k]&&input_rnxobs(ctx->rnxs[k],ctx->obsh+k)<=0) {
+        close_rnxobs(ctx->rnxs[k]);
+        free(ctx->rnxs[k]);
+        ctx->rnxs[k]=NULL;
+    }
+}
+/* update obs data window by streams -------------------------------------------
+* discard processed obs data and append epochs of rover and base streams in
+* the order of sortobs() until the window includes the next rover epoch and
+* two base epochs after it to select base epoch in inputobs()
+*-----------------------------------------------------------------------------*/
+static int updobsw(ppctx_t *ctx)
+{
+    obs_t *obs=&ctx->obss;
+    obsd_t *obs_data;
+    int i,k;
+
+    /* discard processed obs data */
+    if ((k=MIN(MIN(ctx->iobsu,ctx->iobsr),obs->n))>0) {
+        memmove(obs->data,obs->data+k,sizeof(obsd_t)*(obs->n-k));
+        obs->n-=k; ctx->iobsu-=k; ctx->iobsr-=k;
+    }
+    for (;;) {
+        for (i=ctx->iobsu;i<obs->n;i++) if (obs->data[i].rcv==1) break;
+        if (i<obs->n) {
+            if (ctx->obsh[1].n<=0) break;
+            if (ctx->nbase>=2&&timediff(ctx->tbase[0],obs->data[i].time)>DTTOL) break;
+        }
+        else if (ctx->obsh[0].n<=0) break;
+
+        /* append earlier epoch (rover first for same time) */
+        k=ctx->obsh[0].n>0&&(ctx->obsh[1].n<=0||
+          timediff(ctx->obsh[1].data[0].time,ctx->obsh[0].data[0].time)>=-DTTOL)?0:1;
+
+        if (obs->n+ctx->obsh[k].n>obs->nmax) {
+            obs->nmax=MAX(obs->nmax*2,obs->n+ctx->obsh[k].n);
+            if (!(obs_data=(obsd_t *)realloc(obs->data,sizeof(obsd_t)*obs->nmax))) {
+                trace(1,"updobsw: malloc error n=%d\n",obs->nmax);
+                return 0;
+            }
+            obs->data=obs_data;
+        }
+        memcpy(obs->data+obs->n,ctx->obsh[k].data,sizeof(obsd_t)*ctx->obsh[k].n);
+        obs->n+=ctx->obsh[k].n;
+
+        if (k==1) {
+            ctx->tbase[0]=ctx->tbase[1];
+            ctx->tbase[1]=ctx->obsh[1].data[0].time;
+            ctx->nbase++;
+        }
+        inputobss(ctx,k);
+    }
+    return 1;
+}
 /* Input obs data, navigation messages and sbas correction -------------------*/
-static int inputobs(obsd_t *obs, int solq, const prcopt_t *popt)
+static int inputobs(ppctx_t *ctx, obsd_t *obs, int solq, const prcopt_t *popt)
 {
-    trace(3,"\ninfunc  : dir=%d iobsu=%d iobsr=%d isbs=%d\n",reverse,iobsu,iobsr,isbs);
+    trace(3,"\ninfunc  : dir=%d iobsu=%d iobsr=%d isbs=%d\n",ctx->reverse,ctx->iobsu,ctx->iobsr,ctx->isbs);
+
+    if (ctx->stream&&!updobsw(ctx)) {
+        checkbrk(ctx,"error : insufficient memory");
+        return -1;
+    }
 
-    if (0<=iobsu&&iobsu<obss.n) {
-        gtime_t time = obss.data[iobsu].time;
+    if (0<=ctx->iobsu&&ctx->iobsu<ctx->obss.n) {
+        gtime_t time = ctx->obss.data[ctx->iobsu].time;
         settime(time);
         char tstr[40];
-        if (checkbrk("processing : %s Q=%d",time2str(time,tstr,0),solq)) {
-            aborts=1;
+        if (checkbrk(ctx,"processing : %s Q=%d",time2str(time,tstr,0),solq)) {
+            ctx->aborts=1;
             showmsg("aborted");
             return -1;
         }
     }
     int n=0;
-    if (!reverse) {
+    if (!ctx->reverse) {
         /* Input forward data */
-        int nu=nextobsf(&obss,&iobsu,1);
+        int nu=nextobsf(&ctx->obss,&ctx->iobsu,1);
         if (nu<=0) return -1;
-        for (int i=0;i<nu&&n<MAXOBS*2;i++) obs[n++]=obss.data[iobsu+i];
-        if (iobsr<obss.n) {
+        for (int i=0;i<nu&&n<MAXOBS*2;i++) obs[n++]=ctx->obss.data[ctx->iobsu+i];
+        if (ctx->iobsr<ctx->obss.n) {
             if (popt->intpref) {
                 /* For interpolation, find first base timestamp after rover timestamp */
-                int nr=nextobsf(&obss,&iobsr,2);
+                int nr=nextobsf(&ctx->obss,&ctx->iobsr,2);
                 while (nr>0) {
-                    if (timediff(obss.data[iobsr].time,obss.data[iobsu].time)>-DTTOL) break;
-                    iobsr+=nr;
-                    nr=nextobsf(&obss,&iobsr,2);
+                    if (timediff(ctx->obss.data[ctx->iobsr].time,ctx->obss.data[ctx->iobsu].time)>-DTTOL) break;
+                    ctx->iobsr+=nr;
+                    nr=nextobsf(&ctx->obss,&ctx->iobsr,2);
                 }
             } else {
                 /* If not interpolating, find the closest iobsr timestamp before or after iobsu. */
-                double dt=fabs(timediff(obss.data[iobsr].time,obss.data[iobsu].time));
-                int i=iobsr,nr=nextobsf(&obss,&i,2);
+                double dt=fabs(timediff(ctx->obss.data[ctx->iobsr].time,ctx->obss.data[ctx->iobsu].time));
+                int i=ctx->iobsr,nr=nextobsf(&ctx->obss,&i,2);
                 while (nr>0) {
-                    double dt_next=fabs(timediff(obss.data[i].time,obss.data[iobsu].time));
+                    double dt_next=fabs(timediff(ctx->obss.data[i].time,ctx->obss.data[ctx->iobsu].time));
                     if (dt_next>dt) break;
                     dt=dt_next;
-                    iobsr=i;
+                    ctx->iobsr=i;
                     i+=nr;
-                    nr=nextobsf(&obss,&i,2);
+                    nr=nextobsf(&ctx->obss,&i,2);
                 }
             }
             /* Recalculate nr for the determined iobsr. This does not change iobsr. */
-            int nr=nextobsf(&obss,&iobsr,2);
-            for (int i=0;i<nr&&n<MAXOBS*2;i++) obs[n++]=obss.data[iobsr+i];
+            int nr=nextobsf(&ctx->obss,&ctx->iobsr,2);
+            for (int i=0;i<nr&&n<MAXOBS*2;i++) obs[n++]=ctx->obss.data[ctx->iobsr+i];
         }
-        iobsu+=nu;
+        ctx->iobsu+=nu;
 
         /* Update sbas corrections */
-        while (isbs<sbss.n) {
-            gtime_t time=gpst2time(sbss.msgs[isbs].week,sbss.msgs[isbs].tow);
+        while (ctx->isbs<ctx->sbss.n) {
+            gtime_t time=gpst2time(ctx->sbss.msgs[ctx->isbs].week,ctx->sbss.msgs[ctx->isbs].tow);
 
-            if (getbitu(sbss.msgs[isbs].msg,8,6)!=9) { /* Except for geo nav */
-                sbsupdatecorr(sbss.msgs+isbs,&navs);
+            if (getbitu(ctx->sbss.msgs[ctx->isbs].msg,8,6)!=9) { /* Except for geo nav */
+                sbsupdatecorr(ctx->sbss.msgs+ctx->isbs,&ctx->navs);
             }
             if (timediff(time,obs[0].time)>-1.0-DTTOL) break;
-            isbs++;
+            ctx->isbs++;
         }
         /* Update rtcm ssr corrections */
-        if (*rtcm_file) {
-            update_rtcm_ssr(obs[0].time);
+        if (*ctx->rtcm_file) {
+            update_rtcm_ssr(ctx,obs[0].time);
         }
     } else {
         /* Input backward data */
-        int nu=nextobsb(&obss,&iobsu,1);
+        int nu=nextobsb(&ctx->obss,&ctx->iobsu,1);
         if (nu<=0) return -1;
-        for (int i=0;i<nu&&n<MAXOBS*2;i++) obs[n++]=obss.data[iobsu-nu+1+i];
-        if (iobsr>=0) {
+        for (int i=0;i<nu&&n<MAXOBS*2;i++) obs[n++]=ctx->obss.data[ctx->iobsu-nu+1+i];
+        if (ctx->iobsr>=0) {
             if (popt->intpref) {
                 /* For interpolation, find first base timestamp before rover timestamp */
-                int nr=nextobsb(&obss,&iobsr,2);
+                int nr=nextobsb(&ctx->obss,&ctx->iobsr,2);
                 while (nr>0) {
-                  if (timediff(obss.data[iobsr].time,obss.data[iobsu].time)<DTTOL) break;
-                  iobsr-=nr;
-                  nr=nextobsb(&obss,&iobsr,2);
+                  if (timediff(ctx->obss.data[ctx->iobsr].time,ctx->obss.data[ctx->iobsu].time)<DTTOL) break;
+                  ctx->iobsr-=nr;
+                  nr=nextobsb(&ctx->obss,&ctx->iobsr,2);
                 }
             } else {
                 /* If not interpolating, find the closest iobsr timestamp before or after iobsu. */
-                double dt=fabs(timediff(obss.data[iobsr].time,obss.data[iobsu].time));
-                int i=iobsr,nr=nextobsb(&obss,&i,2);
+                double dt=fabs(timediff(ctx->obss.data[ctx->iobsr].time,ctx->obss.data[ctx->iobsu].time));
+                int i=ctx->iobsr,nr=nextobsb(&ctx->obss,&i,2);
                 while (nr>0) {
-                    double dt_next=fabs(timediff(obss.data[i].time,obss.data[iobsu].time));
+                    double dt_next=fabs(timediff(ctx->obss.data[i].time,ctx->obss.data[ctx->iobsu].time));
                     if (dt_next>dt) break;
                     dt=dt_next;
-                    iobsr=i;
+                    ctx->iobsr=i;
                     i-=nr;
-                    nr=nextobsb(&obss,&i,2);
+                    nr=nextobsb(&ctx->obss,&i,2);
                 }
             }
-            int nr=nextobsb(&obss,&iobsr,2);
-            for (int i=0;i<nr&&n<MAXOBS*2;i++) obs[n++]=obss.data[iobsr-nr+1+i];
+            int nr=nextobsb(&ctx->obss,&ctx->iobsr,2);
+            for (int i=0;i<nr&&n<MAXOBS*2;i++) obs[n++]=ctx->obss.data[ctx->iobsr-nr+1+i];
         }
-        iobsu-=nu;
+        ctx->iobsu-=nu;
 
         /* Update sbas corrections */
-        while (isbs>=0) {
-            gtime_t time=gpst2time(sbss.msgs[isbs].week,sbss.msgs[isbs].tow);
+        while (ctx->isbs>=0) {
+            gtime_t time=gpst2time(ctx->sbss.msgs[ctx->isbs].week,ctx->sbss.msgs[ctx->isbs].tow);
 
-            if (getbitu(sbss.msgs[isbs].msg,8,6)!=9) { /* Except for geo nav */
-                sbsupdatecorr(sbss.msgs+isbs,&navs);
+            if (getbitu(ctx->sbss.msgs[ctx->isbs].msg,8,6)!=9) { /* Except for geo nav */
+                sbsupdatecorr(ctx->sbss.msgs+ctx->isbs,&ctx->navs);
             }
             if (timediff(time,obs[0].time)<1.0+DTTOL) break;
-            isbs--;
+            ctx->isbs--;
         }
     }
     return n;
@@ -430,9 +560,49 @@ static void corr_phase_bias_ssr(obsd_t *obs, int n, const nav_t *nav)
         obs[i].L[j]-=nav->ssr[obs[i].sat-1].pbias[code-1]*freq/CLIGHT;
     }
 }
+/* solution to compact solution record --------------------------------------*/
+static void sol2solc(const sol_t *sol, const double *rb, solc_t *solc)
+{
+    int i;
+
+    solc->time=sol->time;
+    solc->eventime=sol->eventime;
+    for (i=0;i<6;i++) solc->rr[i]=sol->rr[i];
+    for (i=0;i<3;i++) solc->rb[i]=rb[i];
+    for (i=0;i<6;i++) {
+        solc->qr[i]=sol->qr[i];
+        solc->qv[i]=sol->qv[i];
+    }
+    solc->age=sol->age;
+    solc->ratio=sol->ratio;
+    solc->refstationid=sol->refstationid;
+    solc->flag=(sol->type&1)|((sol->stat&0xF)<<1)|((uint32_t)sol->ns<<5);
+}
+/* compact solution record to solution ---------------------------------------*/
+static void solc2sol(const solc_t *solc, sol_t *sol, double *rb)
+{
+    sol_t sol0={{0}};
+    int i;
+
+    *sol=sol0;
+    sol->time=solc->time;
+    sol->eventime=solc->eventime;
+    for (i=0;i<6;i++) sol->rr[i]=solc->rr[i];
+    for (i=0;i<3;i++) rb[i]=solc->rb[i];
+    for (i=0;i<6;i++) {
+        sol->qr[i]=solc->qr[i];
+        sol->qv[i]=solc->qv[i];
+    }
+    sol->age=solc->age;
+    sol->ratio=solc->ratio;
+    sol->refstationid=solc->refstationid;
+    sol->type=(uint8_t)(solc->flag&1);
+    sol->stat=(uint8_t)((solc->flag>>1)&0xF);
+    sol->ns=(uint8_t)((solc->flag>>5)&0xFF);
+}
 /* process positioning -------------------------------------------------------*/
-static void procpos(FILE *fp, FILE *fptm, const prcopt_t *popt, const solopt_t *sopt,
-                    rtk_t *rtk, int mode)
+static void procpos(ppctx_t *ctx, FILE *fp, FILE *fptm, const prcopt_t *popt,
+                    const solopt_t *sopt, rtk_t *rtk, int mode)
 {
     gtime_t time={0};
     sol_t sol={{0}},oldsol={{0}},newsol={{0}};
@@ -449,9 +619,9 @@ static void procpos(FILE *fp, FILE *fptm, const prcopt_t *popt, const solopt_t *
     solstatic=sopt->solstatic&&
               (popt->mode==PMODE_STATIC||popt->mode==PMODE_STATIC_START||popt->mode==PMODE_PPP_STATIC);
     
-    rtcm_path[0]='\0';
+    ctx->rtcm_path[0]='\0';
 
-    while ((nobs=inputobs(obs_ptr,rtk->sol.stat,popt))>=0) {
+    while ((nobs=inputobs(ctx,obs_ptr,rtk->sol.stat,popt))>=0) {
 
         /* exclude satellites */
         for (i=n=0;i<nobs;i++) {
@@ -462,14 +632,14 @@ static void procpos(FILE *fp, FILE *fptm, const prcopt_t *popt, const solopt_t *
 
         /* carrier-phase bias correction */
         if (!strstr(popt->pppopt,"-ENA_FCB")) {
-            corr_phase_bias_ssr(obs_ptr,n,&navs);
+            corr_phase_bias_ssr(obs_ptr,n,&ctx->navs);
         }
-        if (!rtkpos(rtk, obs_ptr,n,&navs)) {
+        if (!rtkpos(rtk, obs_ptr,n,&ctx->navs)) {
             if (rtk->sol.eventime.time != 0) {
                 if (mode == SOLMODE_SINGLE_DIR) {
                     if (fptm) outinvalidtm(fptm, sopt, rtk->sol.eventime);
-                } else if (!reverse&&nitm<MAXINVALIDTM) {
-                    invalidtm[nitm++] = rtk->sol.eventime;
+                } else if (!ctx->reverse&&ctx->nitm<MAXINVALIDTM) {
+                    ctx->invalidtm[ctx->nitm++] = rtk->sol.eventime;
                 }
             }
             continue;
@@ -497,23 +667,19 @@ static void procpos(FILE *fp, FILE *fptm, const prcopt_t *popt, const solopt_t *
             }
             oldsol = rtk->sol;
         }
-        else if (!reverse) { /* combined-forward */
-            if (isolf >= nepoch) {
+        else if (!ctx->reverse) { /* combined-forward */
+            if (ctx->isolf >= ctx->nepoch) {
                 free(obs_ptr);
                 return;
             }
-            solf[isolf]=rtk->sol;
-            for (i=0;i<3;i++) rbf[i+isolf*3]=rtk->rb[i];
-            isolf++;
+            sol2solc(&rtk->sol,rtk->rb,ctx->solf+ctx->isolf++);
         }
         else { /* combined-backward */
-            if (isolb>=nepoch) {
+            if (ctx->isolb>=ctx->nepoch) {
                 free(obs_ptr);
                 return;
             }
-            solb[isolb]=rtk->sol;
-            for (i=0;i<3;i++) rbb[i+isolb*3]=rtk->rb[i];
-            isolb++;
+            sol2solc(&rtk->sol,rtk->rb,ctx->solb+ctx->isolb++);
         }
     }
     if (mode==SOLMODE_SINGLE_DIR && solstatic&&time.time!=0.0) {
@@ -523,6 +689,80 @@ static void procpos(FILE *fp, FILE *fptm, const prcopt_t *popt, const solopt_t *
 
     free(obs_ptr); /* moved from stack to heap to kill a stack overflow warning */
 }
+/* backward pass thread of combined solutions -------------------------------*/
+#ifdef WIN32
+static DWORD WINAPI procbwdthread(void *arg)
+#else
+static void *procbwdthread(void *arg)
+#endif
+{
+    ppbwd_t *bwd=(ppbwd_t *)arg;
+
+    procpos(bwd->ctx,NULL,NULL,bwd->popt,bwd->sopt,bwd->rtk,SOLMODE_COMBINED);
+    return 0;
+}
+/* process forward/backward passes of combined solutions in parallel ----------
+* the backward pass runs on a copy of the session context sharing obs/nav data.
+* sbas and ssr corrections updated in the pass are held in the copy of nav.
+* the copy has its own precise ephemeris interpolation cache.
+* return : status (1:ok,0:not processed)
+*-----------------------------------------------------------------------------*/
+static int procposfb(ppctx_t *ctx, const prcopt_t *popt, const solopt_t *sopt,
+                     rtk_t *rtk)
+{
+    rtklib_thread_t thread;
+    ppbwd_t bwd;
+    ppctx_t *ctxb;
+    rtk_t *rtkb;
+
+    trace(3,"procposfb:\n");
+
+    if (!(ctxb=(ppctx_t *)malloc(sizeof(ppctx_t)))) return 0;
+    if (!(rtkb=(rtk_t *)malloc(sizeof(rtk_t)))) {
+        free(ctxb);
+        return 0;
+    }
+    *ctxb=*ctx;
+    ctxb->reverse=1; ctxb->iobsu=ctxb->iobsr=ctx->obss.n-1; ctxb->isbs=ctx->sbss.n-1;
+
+    /* precise ephemeris interpolation cache for backward pass */
+    ctxb->navs.pephc=NULL;
+    if (ctx->navs.pephc&&!initpephc(&ctxb->navs)) {
+        free(rtkb); free(ctxb);
+        return 0;
+    }
+    rtkinit(rtkb,popt);
+    bwd.ctx=ctxb; bwd.popt=popt; bwd.sopt=sopt; bwd.rtk=rtkb;
+
+#ifdef WIN32
+    if (!(thread=CreateThread(NULL,0,procbwdthread,&bwd,0,NULL))) {
+#else
+    if (pthread_create(&thread,NULL,procbwdthread,&bwd)) {
+#endif
+        trace(2,"procposfb: thread create error\n");
+        rtkfree(rtkb);
+        freepephc(&ctxb->navs);
+        free(rtkb); free(ctxb);
+        return 0;
+    }
+    rtkinit(rtk,popt);
+    procpos(ctx,NULL,NULL,popt,sopt,rtk,SOLMODE_COMBINED); /* forward */
+    rtkfree(rtk);
+
+#ifdef WIN32
+    WaitForSingleObject(thread,INFINITE);
+    CloseHandle(thread);
+#else
+    pthread_join(thread,NULL);
+#endif
+    ctx->isolb=ctxb->isolb;
+    if (ctxb->aborts) ctx->aborts=1;
+
+    rtkfree(rtkb);
+    freepephc(&ctxb->navs);
+    free(rtkb); free(ctxb);
+    return 1;
+}
 /* validation of combined solutions ------------------------------------------*/
 static int valcomb(const sol_t *solf, const sol_t *solb, double *rbf,
         double *rbb, const prcopt_t *popt)
@@ -550,66 +790,71 @@ static int valcomb(const sol_t *solf, const sol_t *solb, double *rbf,
     return 1;
 }
 /* combine forward/backward solutions and save results ---------------------*/
-static void combres(FILE *fp, FILE *fptm, const prcopt_t *popt, const solopt_t *sopt)
+static void combres(ppctx_t *ctx, FILE *fp, FILE *fptm, const prcopt_t *popt,
+                    const solopt_t *sopt)
 {
     gtime_t time={0};
-    sol_t sols={{0}},sol={{0}},oldsol={{0}},newsol={{0}};
-    double tt,Qf[9],Qb[9],Qs[9],rbs[3]={0},rb[3]={0},rr_f[3],rr_b[3],rr_s[3];
+    sol_t sols={{0}},sol={{0}},oldsol={{0}},newsol={{0}},solf,solb;
+    double tt,Qf[9],Qb[9],Qs[9],rbs[3]={0},rb[3]={0},rbf[3],rbb[3],rr_f[3];
+    double rr_b[3],rr_s[3];
     int i,j,k,solstatic,num=0,pri[]={7,1,2,3,4,5,1,6};
 
-    trace(3,"combres : isolf=%d isolb=%d\n",isolf,isolb);
+    trace(3,"combres : isolf=%d isolb=%d\n",ctx->isolf,ctx->isolb);
 
     solstatic=sopt->solstatic&&
               (popt->mode==PMODE_STATIC||popt->mode==PMODE_STATIC_START||popt->mode==PMODE_PPP_STATIC);
 
-    for (i=0,j=isolb-1;i<isolf&&j>=0;i++,j--) {
-        if ((tt=timediff(solf[i].time,solb[j].time))<-DTTOL) {
-            sols=solf[i];
-            for (k=0;k<3;k++) rbs[k]=rbf[k+i*3];
+    for (i=0,j=ctx->isolb-1;i<ctx->isolf&&j>=0;i++,j--) {
+        solc2sol(ctx->solf+i,&solf,rbf);
+        solc2sol(ctx->solb+j,&solb,rbb);
+
+        if ((tt=timediff(solf.time,solb.time))<-DTTOL) {
+            sols=solf;
+            for (k=0;k<3;k++) rbs[k]=rbf[k];
             j++;
         }
         else if (tt>DTTOL) {
-            sols=solb[j];
-            for (k=0;k<3;k++) rbs[k]=rbb[k+j*3];
+            sols=solb;
+            for (k=0;k<3;k++) rbs[k]=rbb[k];
             i--;
         }
-        else if (pri[solf[i].stat]<pri[solb[j].stat]) {
-            sols=solf[i];
-            for (k=0;k<3;k++) rbs[k]=rbf[k+i*3];
+        else if (pri[solf.stat]<pri[solb.stat]) {
+            sols=solf;
+            for (k=0;k<3;k++) rbs[k]=rbf[k];
         }
-        else if (pri[solf[i].stat]>pri[solb[j].stat]) {
-            sols=solb[j];
-            for (k=0;k<3;k++) rbs[k]=rbb[k+j*3];
+        else if (pri[solf.stat]>pri[solb.stat]) {
+            sols=solb;
+            for (k=0;k<3;k++) rbs[k]=rbb[k];
         }
         else {
-            sols=solf[i];
+            sols=solf;
             sols.time=timeadd(sols.time,-tt/2.0);
 
             if ((popt->mode==PMODE_KINEMA||popt->mode==PMODE_MOVEB)&&
                 sols.stat==SOLQ_FIX) {
 
                 /* degrade fix to float if validation failed */
-                if (!valcomb(solf+i,solb+j,rbf+i*3,rbb+j*3,popt)) sols.stat=SOLQ_FLOAT;
+                if (!valcomb(&solf,&solb,rbf,rbb,popt)) sols.stat=SOLQ_FLOAT;
             }
             for (k=0;k<3;k++) {
-                Qf[k+k*3]=solf[i].qr[k];
-                Qb[k+k*3]=solb[j].qr[k];
+                Qf[k+k*3]=solf.qr[k];
+                Qb[k+k*3]=solb.qr[k];
             }
-            Qf[1]=Qf[3]=solf[i].qr[3];
-            Qf[5]=Qf[7]=solf[i].qr[4];
-            Qf[2]=Qf[6]=solf[i].qr[5];
-            Qb[1]=Qb[3]=solb[j].qr[3];
-            Qb[5]=Qb[7]=solb[j].qr[4];
-            Qb[2]=Qb[6]=solb[j].qr[5];
+            Qf[1]=Qf[3]=solf.qr[3];
+            Qf[5]=Qf[7]=solf.qr[4];
+            Qf[2]=Qf[6]=solf.qr[5];
+            Qb[1]=Qb[3]=solb.qr[3];
+            Qb[5]=Qb[7]=solb.qr[4];
+            Qb[2]=Qb[6]=solb.qr[5];
 
             if (popt->mode==PMODE_MOVEB) {
-                for (k=0;k<3;k++) rr_f[k]=solf[i].rr[k]-rbf[k+i*3];
-                for (k=0;k<3;k++) rr_b[k]=solb[j].rr[k]-rbb[k+j*3];
+                for (k=0;k<3;k++) rr_f[k]=solf.rr[k]-rbf[k];
+                for (k=0;k<3;k++) rr_b[k]=solb.rr[k]-rbb[k];
                 if (smoother(rr_f,Qf,rr_b,Qb,3,rr_s,Qs)) continue;
                 for (k=0;k<3;k++) sols.rr[k]=rbs[k]+rr_s[k];
             }
             else {
-                if (smoother(solf[i].rr,Qf,solb[j].rr,Qb,3,sols.rr,Qs)) continue;
+                if (smoother(solf.rr,Qf,solb.rr,Qb,3,sols.rr,Qs)) continue;
             }
             sols.qr[0]=(float)Qs[0];
             sols.qr[1]=(float)Qs[4];
@@ -621,16 +866,16 @@ static void combres(FILE *fp, FILE *fptm, const prcopt_t *popt, const solopt_t *
             /* smoother for velocity solution */
             if (popt->dynamics) {
                 for (k=0;k<3;k++) {
-                    Qf[k+k*3]=solf[i].qv[k];
-                    Qb[k+k*3]=solb[j].qv[k];
+                    Qf[k+k*3]=solf.qv[k];
+                    Qb[k+k*3]=solb.qv[k];
                 }
-                Qf[1]=Qf[3]=solf[i].qv[3];
-                Qf[5]=Qf[7]=solf[i].qv[4];
-                Qf[2]=Qf[6]=solf[i].qv[5];
-                Qb[1]=Qb[3]=solb[j].qv[3];
-                Qb[5]=Qb[7]=solb[j].qv[4];
-                Qb[2]=Qb[6]=solb[j].qv[5];
-                if (smoother(solf[i].rr+3,Qf,solb[j].rr+3,Qb,3,sols.rr+3,Qs)) continue;
+                Qf[1]=Qf[3]=solf.qv[3];
+                Qf[5]=Qf[7]=solf.qv[4];
+                Qf[2]=Qf[6]=solf.qv[5];
+                Qb[1]=Qb[3]=solb.qv[3];
+                Qb[5]=Qb[7]=solb.qv[4];
+                Qb[2]=Qb[6]=solb.qv[5];
+                if (smoother(solf.rr+3,Qf,solb.rr+3,Qb,3,sols.rr+3,Qs)) continue;
                 sols.qv[0]=(float)Qs[0];
                 sols.qv[1]=(float)Qs[4];
                 sols.qv[2]=(float)Qs[8];
@@ -649,10 +894,10 @@ static void combres(FILE *fp, FILE *fptm, const prcopt_t *popt, const solopt_t *
                 time=sols.time;
             }
         }
-        if (iitm < nitm && timediff(invalidtm[iitm],sols.time)<0.0)
+        if (ctx->iitm < ctx->nitm && timediff(ctx->invalidtm[ctx->iitm],sols.time)<0.0)
         {
-            outinvalidtm(fptm,sopt,invalidtm[iitm]);
-            iitm++;
+            outinvalidtm(fptm,sopt,ctx->invalidtm[ctx->iitm]);
+            ctx->iitm++;
         }
         if (sols.eventime.time != 0)
         {
@@ -670,9 +915,12 @@ static void combres(FILE *fp, FILE *fptm, const prcopt_t *popt, const solopt_t *
     }
 }
 /* read prec ephemeris, sbas data, tec grid and open rtcm --------------------*/
-static void readpreceph(const char **infile, int n, const prcopt_t *prcopt,
-                        nav_t *nav, sbs_t *sbs)
+static void readpreceph(ppctx_t *ctx, const char **infile, int n,
+                        const prcopt_t *prcopt)
 {
+    const ppshr_t *shr=ctx->shr;
+    nav_t *nav=&ctx->navs;
+    sbs_t *sbs=&ctx->sbss;
     int i;
     const char *ext;
 
@@ -682,16 +930,26 @@ static void readpreceph(const char **infile, int n, const prcopt_t *prcopt,
     nav->nc=nav->ncmax=0;
     sbs->n =sbs->nmax =0;
 
+    /* use shared precise ephemeris and clock */
+    if (shr->ne>0) {
+        nav->peph=shr->peph; nav->ne=nav->nemax=shr->ne;
+    }
+    if (shr->nc>0) {
+        nav->pclk=shr->pclk; nav->nc=nav->ncmax=shr->nc;
+    }
     /* read precise ephemeris files */
-    for (i=0;i<n;i++) {
+    for (i=0;i<n&&shr->ne<=0;i++) {
         if (strstr(infile[i],"%r")||strstr(infile[i],"%b")) continue;
         readsp3(infile[i],nav,0);
     }
     /* read precise clock files */
-    for (i=0;i<n;i++) {
+    for (i=0;i<n&&shr->nc<=0;i++) {
         if (strstr(infile[i],"%r")||strstr(infile[i],"%b")) continue;
         readrnxc(infile[i],nav);
     }
+    /* interpolation cache of precise ephemeris and clock */
+    if (nav->ne>0||nav->nc>0) initpephc(nav);
+
     /* read sbas message files */
     for (i=0;i<n;i++) {
         if (strstr(infile[i],"%r")||strstr(infile[i],"%b")) continue;
@@ -699,26 +957,31 @@ static void readpreceph(const char **infile, int n, const prcopt_t *prcopt,
     }
 
     /* set rtcm file and initialize rtcm struct */
-    rtcm_file[0]=rtcm_path[0]='\0'; fp_rtcm=NULL;
+    ctx->rtcm_file[0]=ctx->rtcm_path[0]='\0'; ctx->fp_rtcm=NULL;
 
     for (i=0;i<n;i++) {
         if ((ext=strrchr(infile[i],'.'))&&
             (!strcmp(ext,".rtcm3")||!strcmp(ext,".RTCM3"))) {
-            strcpy(rtcm_file,infile[i]);
-            init_rtcm(&rtcm);
+            strcpy(ctx->rtcm_file,infile[i]);
+            init_rtcm(&ctx->rtcm);
             break;
         }
     }
 }
 /* free prec ephemeris and sbas data -----------------------------------------*/
-static void freepreceph(nav_t *nav, sbs_t *sbs)
+static void freepreceph(ppctx_t *ctx)
 {
+    nav_t *nav=&ctx->navs;
+    sbs_t *sbs=&ctx->sbss;
     int i;
 
     trace(3,"freepreceph:\n");
 
-    free(nav->peph); nav->peph=NULL; nav->ne=nav->nemax=0;
-    free(nav->pclk); nav->pclk=NULL; nav->nc=nav->ncmax=0;
+    if (nav->peph!=ctx->shr->peph) free(nav->peph);
+    if (nav->pclk!=ctx->shr->pclk) free(nav->pclk);
+    nav->peph=NULL; nav->ne=nav->nemax=0;
+    nav->pclk=NULL; nav->nc=nav->ncmax=0;
+    freepephc(nav);
     free(sbs->msgs); sbs->msgs=NULL; sbs->n =sbs->nmax =0;
     for (i=0;i<nav->nt;i++) {
         free(nav->tec[i].data);
@@ -726,15 +989,447 @@ static void freepreceph(nav_t *nav, sbs_t *sbs)
     }
     free(nav->tec ); nav->tec =NULL; nav->nt=nav->ntmax=0;
 
-    if (fp_rtcm) fclose(fp_rtcm);
-    free_rtcm(&rtcm);
+    fclose_fbuf(&ctx->rtcm.fbuf,ctx->fp_rtcm);
+    ctx->fp_rtcm=NULL;
+    free_rtcm(&ctx->rtcm);
+}
+/* navigation parameters in obs/nav cache ------------------------------------*/
+static const struct {
+    size_t off;         /* offset in nav_t */
+    int n;              /* number of parameters */
+} navpar[]={
+    {offsetof(nav_t,utc_gps),8},{offsetof(nav_t,utc_glo),8},
+    {offsetof(nav_t,utc_gal),8},{offsetof(nav_t,utc_qzs),8},
+    {offsetof(nav_t,utc_cmp),8},{offsetof(nav_t,utc_irn),9},
+    {offsetof(nav_t,utc_sbs),4},{offsetof(nav_t,ion_gps),8},
+    {offsetof(nav_t,ion_gal),4},{offsetof(nav_t,ion_qzs),8},
+    {offsetof(nav_t,ion_cmp),8},{offsetof(nav_t,ion_irn),8}
+};
+/* get navigation parameters -------------------------------------------------*/
+static void getnavpar(const nav_t *nav, double *par, int32_t *fcn)
+{
+    const double *p;
+    int i,j,k=0;
+
+    for (i=0;i<(int)(sizeof(navpar)/sizeof(navpar[0]));i++) {
+        p=(const double *)((const char *)nav+navpar[i].off);
+        for (j=0;j<navpar[i].n&&k<NNAVPAR;j++) par[k++]=p[j];
+    }
+    for (i=0;i<32;i++) fcn[i]=nav->glo_fcn[i];
+}
+/* set navigation parameters (merge=1:only parameters set) -------------------*/
+static void setnavpar(nav_t *nav, const double *par, const int32_t *fcn,
+                      int merge)
+{
+    double *p;
+    int i,j,k=0;
+
+    for (i=0;i<(int)(sizeof(navpar)/sizeof(navpar[0]));i++) {
+        p=(double *)((char *)nav+navpar[i].off);
+        for (j=0;j<navpar[i].n&&k<NNAVPAR;j++,k++) {
+            if (!merge||par[k]!=0.0) p[j]=par[k];
+        }
+    }
+    for (i=0;i<32;i++) if (!merge||fcn[i]) nav->glo_fcn[i]=fcn[i];
+}
+/* hash of data (FNV-1a) -----------------------------------------------------*/
+static uint64_t hashobsc(uint64_t h, const void *data, size_t n)
+{
+    const uint8_t *p=(const uint8_t *)data;
+
+    for (;n>0;n--,p++) h=(h^*p)*1099511628211ULL;
+    return h;
+}
+/* obs/nav cache path and signature --------------------------------------------
+* path is <first input file>.<hash of input paths and options>.rtkc. the
+* signature adds sizes and modification times of the expanded input files to
+* invalidate the cache when any of them is changed
+*-----------------------------------------------------------------------------*/
+static int obsckey(const char **infile, const int *index, int n, gtime_t ts,
+                   gtime_t te, double ti, const prcopt_t *popt, char *path,
+                   uint64_t *key)
+{
+    struct stat st;
+    uint64_t hn=14695981039346656037ULL,hf=hn;
+    int64_t val[2];
+    char *files[MAXEXFILE]={0};
+    int i,j,m,ret=1;
+
+    *path='\0';
+
+    for (i=0;i<MAXEXFILE;i++) {
+        if (!(files[i]=(char *)malloc(1024))) {
+            for (i--;i>=0;i--) free(files[i]);
+            return 0;
+        }
+    }
+    for (i=0;i<n&&ret;i++) {
+        if (!*infile[i]) { /* stdin */
+            ret=0;
+            break;
+        }
+        hn=hashobsc(hn,infile[i],strlen(infile[i])+1);
+        hn=hashobsc(hn,index+i,sizeof(int));
+        m=expath(infile[i],files,MAXEXFILE);
+
+        for (j=0;j<m;j++) {
+            if (stat(files[j],&st)!=0) {
+                ret=0;
+                break;
+            }
+            if (!*path) sprintf(path,"%.1000s",files[j]);
+            val[0]=(int64_t)st.st_size;
+            val[1]=(int64_t)st.st_mtime;
+            hf=hashobsc(hf,files[j],strlen(files[j])+1);
+            hf=hashobsc(hf,val,sizeof(val));
+        }
+    }
+    for (i=0;i<MAXEXFILE;i++) free(files[i]);
+
+    if (!ret||!*path) return 0;
+
+    hn=hashobsc(hn,&ts.time,sizeof(ts.time));
+    hn=hashobsc(hn,&ts.sec ,sizeof(ts.sec ));
+    hn=hashobsc(hn,&te.time,sizeof(te.time));
+    hn=hashobsc(hn,&te.sec ,sizeof(te.sec ));
+    hn=hashobsc(hn,&ti,sizeof(ti));
+    hn=hashobsc(hn,popt->rnxopt[0],strlen(popt->rnxopt[0])+1);
+    hn=hashobsc(hn,popt->rnxopt[1],strlen(popt->rnxopt[1])+1);
+
+    sprintf(path+strlen(path),".%08x%s",(uint32_t)(hn^(hn>>32)),OBSC_EXT);
+    *key=hashobsc(hn,&hf,sizeof(hf));
+    return 1;
+}
+/* map obs/nav cache to memory (copy-on-write) -------------------------------*/
+static void *mapobsc(const char *path, size_t *size)
+{
+#ifdef WIN32
+    HANDLE fh,mh;
+    LARGE_INTEGER len;
+    void *p;
+
+    if ((fh=CreateFileA(path,GENERIC_READ,FILE_SHARE_READ,NULL,OPEN_EXISTING,
+                        FILE_ATTRIBUTE_NORMAL,NULL))==INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+    if (!GetFileSizeEx(fh,&len)||len.QuadPart<=0||
+        !(mh=CreateFileMapping(fh,NULL,PAGE_WRITECOPY,0,0,NULL))) {
+        CloseHandle(fh);
+        return NULL;
+    }
+    p=MapViewOfFile(mh,FILE_MAP_COPY,0,0,0);
+    CloseHandle(mh);
+    CloseHandle(fh);
+    if (!p) return NULL;
+    *size=(size_t)len.QuadPart;
+    return p;
+#else
+    struct stat st;
+    void *p;
+    int fd;
+
+    if ((fd=open(path,O_RDONLY))<0) return NULL;
+    if (fstat(fd,&st)<0||st.st_size<=0||
+        (p=mmap(NULL,(size_t)st.st_size,PROT_READ|PROT_WRITE,MAP_PRIVATE,fd,0))
+        ==MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+    close(fd);
+    *size=(size_t)st.st_size;
+    return p;
+#endif
+}
+/* unmap obs/nav cache -------------------------------------------------------*/
+static void unmapobsc(void *p, size_t size)
+{
+#ifdef WIN32
+    UnmapViewOfFile(p);
+#else
+    munmap(p,size);
+#endif
+}
+/* allocate solution store ---------------------------------------------------
+* allocate n compact solution records in memory or, if path is not empty, in
+* a temporary file next to path mapped to memory (deleted on unmap)
+*-----------------------------------------------------------------------------*/
+static solc_t *allocsols(int n, const char *path, size_t *size)
+{
+    char file[1040];
+    size_t len=sizeof(solc_t)*(n>0?n:1);
+    void *p;
+#ifdef WIN32
+    HANDLE fh,mh;
+    LARGE_INTEGER off;
+#else
+    int fd;
+#endif
+    *size=0;
+    if (!*path) return (solc_t *)malloc(len);
+
+    sprintf(file,"%.1023s.tmp",path);
+#ifdef WIN32
+    if ((fh=CreateFileA(file,GENERIC_READ|GENERIC_WRITE,0,NULL,CREATE_ALWAYS,
+                        FILE_ATTRIBUTE_TEMPORARY|FILE_FLAG_DELETE_ON_CLOSE,
+                        NULL))==INVALID_HANDLE_VALUE) {
+        trace(2,"solution store open error: %s\n",file);
+        return (solc_t *)malloc(len);
+    }
+    off.QuadPart=(LONGLONG)len;
+    if (!SetFilePointerEx(fh,off,NULL,FILE_BEGIN)||!SetEndOfFile(fh)||
+        !(mh=CreateFileMapping(fh,NULL,PAGE_READWRITE,0,0,NULL))) {
+        trace(2,"solution store map error: %s\n",file);
+        CloseHandle(fh);
+        return (solc_t *)malloc(len);
+    }
+    p=MapViewOfFile(mh,FILE_MAP_WRITE,0,0,0);
+    CloseHandle(mh);
+    CloseHandle(fh);
+    if (!p) return (solc_t *)malloc(len);
+#else
+    if ((fd=open(file,O_RDWR|O_CREAT|O_TRUNC,0600))<0) {
+        trace(2,"solution store open error: %s\n",file);
+        return (solc_t *)malloc(len);
+    }
+    unlink(file);
+    if (ftruncate(fd,(off_t)len)<0||
+        (p=mmap(NULL,len,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0))==MAP_FAILED) {
+        trace(2,"solution store map error: %s\n",file);
+        close(fd);
+        return (solc_t *)malloc(len);
+    }
+    close(fd);
+#endif
+    trace(3,"allocsols: n=%d file=%s\n",n,file);
+    *size=len;
+    return (solc_t *)p;
+}
+/* free solution store -------------------------------------------------------*/
+static void freesols(solc_t *p, size_t size)
+{
+    if (!p) return;
+    if (size>0) unmapobsc(p,size); else free(p);
+}
+/* read obs/nav cache ------------------------------------------------------------
+* observation data are used in place on the mapped cache. ephemerides are
+* copied to be handled by freenav() and uniqnav()
+*-----------------------------------------------------------------------------*/
+static int readobsc(ppctx_t *ctx, const char *path, uint64_t key, obs_t *obs,
+                    nav_t *nav, sta_t *sta)
+{
+    const obsch_t *h;
+    void *data[3]={0};
+    uint8_t *p;
+    size_t size;
+    int i;
+
+    trace(3,"readobsc: path=%s\n",path);
+
+    if (!(p=(uint8_t *)mapobsc(path,&size))) return 0;
+
+    h=(const obsch_t *)p;
+    if (size<sizeof(obsch_t)||strncmp(h->id,OBSC_ID,8)||h->ver!=OBSC_VER||
+        h->size[0]!=sizeof(obsd_t)||h->size[1]!=sizeof(eph_t)||
+        h->size[2]!=sizeof(geph_t)||h->size[3]!=sizeof(seph_t)||
+        h->size[4]!=sizeof(sta_t)||h->key!=key) {
+        trace(2,"obs/nav cache invalid: %s\n",path);
+        unmapobsc(p,size);
+        return 0;
+    }
+    for (i=0;i<4;i++) {
+        if (h->n[i]<0||h->off[i]>size||
+            (uint64_t)h->n[i]*h->size[i]>size-h->off[i]) {
+            trace(2,"obs/nav cache size error: %s\n",path);
+            unmapobsc(p,size);
+            return 0;
+        }
+    }
+    for (i=0;i<3;i++) {
+        if (h->n[i+1]<=0) continue;
+        if (!(data[i]=malloc((size_t)h->n[i+1]*h->size[i+1]))) {
+            for (i--;i>=0;i--) free(data[i]);
+            unmapobsc(p,size);
+            return 0;
+        }
+        memcpy(data[i],p+h->off[i+1],(size_t)h->n[i+1]*h->size[i+1]);
+    }
+    obs->data=(obsd_t *)(p+h->off[0]);
+    obs->n=h->n[0];
+    obs->nmax=0;
+    nav->eph =(eph_t  *)data[0]; nav->n =nav->nmax =h->n[1];
+    nav->geph=(geph_t *)data[1]; nav->ng=nav->ngmax=h->n[2];
+    nav->seph=(seph_t *)data[2]; nav->ns=nav->nsmax=h->n[3];
+    setnavpar(nav,h->par,h->glo_fcn,1);
+    for (i=0;i<2;i++) if (h->stamask&(1<<i)) sta[i]=h->sta[i];
+    ctx->nepoch=h->nepoch;
+    ctx->obsmap=p;
+    ctx->nobsmap=size;
+
+    /* index ephemeris by satellite */
+    uniqnav(nav);
+    return 1;
+}
+/* write data with alignment padding -----------------------------------------*/
+static int writealign(FILE *fp, const void *data, size_t size, uint64_t *off)
+{
+    static const uint8_t pad[OBSC_ALIGN]={0};
+    size_t n=(size_t)((OBSC_ALIGN-(*off+size)%OBSC_ALIGN)%OBSC_ALIGN);
+
+    if (size>0&&fwrite(data,size,1,fp)<1) return 0;
+    if (n>0&&fwrite(pad,n,1,fp)<1) return 0;
+    *off+=size+n;
+    return 1;
+}
+/* write obs/nav cache ---------------------------------------------------------
+* the cache is written to a temporary file and renamed to path so that other
+* processes never map an incomplete cache
+*-----------------------------------------------------------------------------*/
+static void writeobsc(const char *path, uint64_t key, int stamask, int nepoch,
+                      const obs_t *obs, const nav_t *nav, const sta_t *sta,
+                      const double *par, const int32_t *fcn)
+{
+    obsch_t *h;
+    const void *data[4];
+    FILE *fp;
+    char tmp[1100];
+    uint64_t off=0;
+    int i,stat;
+
+    trace(3,"writeobsc: path=%s\n",path);
+
+    if (!(h=(obsch_t *)calloc(1,sizeof(obsch_t)))) return;
+
+    strcpy(h->id,OBSC_ID);
+    h->ver=OBSC_VER;
+    h->size[0]=sizeof(obsd_t); h->size[1]=sizeof(eph_t);
+    h->size[2]=sizeof(geph_t); h->size[3]=sizeof(seph_t);
+    h->size[4]=sizeof(sta_t);
+    h->key=key;
+    h->n[0]=obs->n; h->n[1]=nav->n; h->n[2]=nav->ng; h->n[3]=nav->ns;
+    h->nepoch=nepoch;
+    h->stamask=stamask;
+    data[0]=obs->data; data[1]=nav->eph; data[2]=nav->geph; data[3]=nav->seph;
+
+    off=sizeof(obsch_t);
+    off+=(OBSC_ALIGN-off%OBSC_ALIGN)%OBSC_ALIGN;
+    for (i=0;i<4;i++) {
+        h->off[i]=off;
+        off+=(uint64_t)h->n[i]*h->size[i];
+        off+=(OBSC_ALIGN-off%OBSC_ALIGN)%OBSC_ALIGN;
+    }
+    for (i=0;i<2;i++) if (stamask&(1<<i)) h->sta[i]=sta[i];
+    memcpy(h->par,par,sizeof(h->par));
+    memcpy(h->glo_fcn,fcn,sizeof(h->glo_fcn));
+
+    sprintf(tmp,"%s.%08x.tmp",path,(uint32_t)(tickget()^(uintptr_t)h));
+
+    if (!(fp=fopen(tmp,"wb"))) {
+        trace(2,"obs/nav cache open error: %s\n",tmp);
+        free(h);
+        return;
+    }
+    off=0;
+    stat=writealign(fp,h,sizeof(obsch_t),&off);
+    for (i=0;i<4&&stat;i++) {
+        stat=writealign(fp,data[i],(size_t)h->n[i]*h->size[i],&off);
+    }
+    if (fclose(fp)!=0) stat=0;
+    free(h);
+
+    if (!stat) {
+        trace(2,"obs/nav cache write error: %s\n",tmp);
+        remove(tmp);
+        return;
+    }
+#ifdef WIN32
+    remove(path);
+#endif
+    if (rename(tmp,path)!=0) {
+        trace(2,"obs/nav cache rename error: %s\n",path);
+        remove(tmp);
+    }
+}
+/* read nav data and open obs data streams -------------------------------------
+* nav data and station info are read from all files. obs data of rover and base
+* are read later by updobsw() through the streams.
+*-----------------------------------------------------------------------------*/
+static int readobsnavs(ppctx_t *ctx, gtime_t ts, gtime_t te, double ti,
+                       const char **infile, const int *index, int n,
+                       const prcopt_t *prcopt, nav_t *nav, sta_t *sta)
+{
+    rnxobs_t *rnx;
+    int i,j,k,rcv=1;
+
+    trace(3,"readobsnavs: n=%d\n",n);
+
+    for (i=0;i<n;i=j) {
+        if (checkbrk(ctx,"")) return 0;
+
+        for (j=i+1;j<n&&index[j]==index[i];j++) ;
+
+        gtime_t tsw = ts, tew = te;
+        if (rcv > 1) {
+          // Expand the time span a little for base observations to support
+          // interpolation at the extents of the rover observations.
+          if (tsw.time >= 60) tsw = timeadd(tsw, -60);
+          if (tew.time > 0) tew = timeadd(tew, 60);
+        }
+        /* read rinex nav data and station info */
+        for (k=i;k<j;k++) {
+            if (readrnxt(infile[k],rcv,tsw,tew,ti,prcopt->rnxopt[rcv<=1?0:1],
+                         NULL,nav,rcv<=2?sta+rcv-1:NULL)<0) {
+                checkbrk(ctx,"error : insufficient memory");
+                trace(1,"insufficient memory\n");
+                return 0;
+            }
+        }
+        if (rcv>2) continue;
+
+        /* open rinex obs data stream and read first epoch */
+        if (!(rnx=(rnxobs_t *)malloc(sizeof(rnxobs_t)))) {
+            checkbrk(ctx,"error : insufficient memory");
+            return 0;
+        }
+        open_rnxobs(rnx,infile+i,j-i,rcv,tsw,tew,ti,prcopt->rnxopt[rcv<=1?0:1]);
+
+        ctx->rnxs[rcv-1]=rnx;
+        inputobss(ctx,rcv-1);
+        if (ctx->obsh[rcv-1].n>0) rcv++;
+    }
+    if (ctx->obsh[0].n<=0&&ctx->obsh[1].n<=0) {
+        checkbrk(ctx,"error : no obs data");
+        trace(1,"\n");
+        return 0;
+    }
+    if (nav->n<=0&&nav->ng<=0&&nav->ns<=0) {
+        checkbrk(ctx,"error : no nav data");
+        trace(1,"\n");
+        return 0;
+    }
+    /* delete duplicated ephemeris */
+    uniqnav(nav);
+
+    /* fill obs data window */
+    ctx->iobsu=ctx->iobsr=ctx->nbase=0;
+    if (!updobsw(ctx)) return 0;
+
+    /* set time span for progress display */
+    if (ts.time==0&&te.time!=0) {
+        for (i=0;i<ctx->obss.n;i++) if (ctx->obss.data[i].rcv==1) break;
+        if (i<ctx->obss.n) settspan(ctx->obss.data[i].time,te);
+    }
+    return 1;
 }
 /* read obs and nav data -----------------------------------------------------*/
-static int readobsnav(gtime_t ts, gtime_t te, double ti, const char **infile,
-                      const int *index, int n, const prcopt_t *prcopt,
-                      obs_t *obs, nav_t *nav, sta_t *sta)
+static int readobsnav(ppctx_t *ctx, gtime_t ts, gtime_t te, double ti,
+                      const char **infile, const int *index, int n,
+                      const prcopt_t *prcopt, obs_t *obs, nav_t *nav, sta_t *sta)
 {
-    int i,j,ind=0,nobs=0,rcv=1;
+    double par0[NNAVPAR],par[NNAVPAR]={0};
+    int32_t fcn0[32],fcn[32]={0};
+    uint64_t key=0;
+    int i,j,ind=0,nobs=0,rcv=1,cache=0,stamask=0,nc=nav->nc;
+    char path[1100]="",tmp[1024],*p=tmp;
 
     char tstr[40];
     trace(3,"readobsnav: ts=%s n=%d\n",time2str(ts,tstr,0),n);
@@ -744,10 +1439,28 @@ static int readobsnav(gtime_t ts, gtime_t te, double ti, const char **infile,
     nav->geph=NULL; nav->ng=nav->ngmax=0;
     /* free(nav->seph); */ /* is this needed to avoid memory leak??? */
     nav->seph=NULL; nav->ns=nav->nsmax=0;
-    nepoch=0;
+    ctx->nepoch=0;
 
-    for (i=0;i<n;i++) {
-        if (checkbrk("")) return 0;
+    /* read nav data and open obs data streams */
+    if (ctx->stream) {
+        return readobsnavs(ctx,ts,te,ti,infile,index,n,prcopt,nav,sta);
+    }
+
+    /* read obs and nav data from cache */
+    if (prcopt->obscache&&obsckey(infile,index,n,ts,te,ti,prcopt,path,&key)) {
+        if (readobsc(ctx,path,key,obs,nav,sta)) {
+            trace(2,"obs/nav cache used: %s\n",path);
+            cache=2;
+        }
+        else {
+            /* record only navigation parameters read from the files */
+            getnavpar(nav,par0,fcn0);
+            setnavpar(nav,par,fcn,0);
+            cache=1;
+        }
+    }
+    for (i=0;i<n&&cache<2;i++) {
+        if (checkbrk(ctx,"")) return 0;
 
         if (index[i]!=ind) {
             if (obs->n>nobs) rcv++;
@@ -760,29 +1473,44 @@ static int readobsnav(gtime_t ts, gtime_t te, double ti, const char **infile,
           if (tsw.time >= 60) tsw = timeadd(tsw, -60);
           if (tew.time > 0) tew = timeadd(tew, 60);
         }
+        if (cache&&rcv<=2&&expath(infile[i],&p,1)>0) stamask|=1<<(rcv-1);
+
         /* read rinex obs and nav file */
         if (readrnxt(infile[i],rcv,tsw,tew,ti,prcopt->rnxopt[rcv<=1?0:1],obs,nav,
                      rcv<=2?sta+rcv-1:NULL)<0) {
-            checkbrk("error : insufficient memory");
+            checkbrk(ctx,"error : insufficient memory");
             trace(1,"insufficient memory\n");
+            if (cache) setnavpar(nav,par0,fcn0,0);
             return 0;
         }
     }
+    if (cache==1) {
+        getnavpar(nav,par,fcn);
+        setnavpar(nav,par0,fcn0,0);
+        setnavpar(nav,par,fcn,1);
+    }
     if (obs->n<=0) {
-        checkbrk("error : no obs data");
+        checkbrk(ctx,"error : no obs data");
         trace(1,"\n");
         return 0;
     }
     if (nav->n<=0&&nav->ng<=0&&nav->ns<=0) {
-        checkbrk("error : no nav data");
+        checkbrk(ctx,"error : no nav data");
         trace(1,"\n");
         return 0;
     }
-    /* sort observation data */
-    nepoch=sortobs(obs);
+    if (cache<2) {
+        /* sort observation data */
+        ctx->nepoch=sortobs(obs);
 
-    /* delete duplicated ephemeris */
-    uniqnav(nav);
+        /* delete duplicated ephemeris */
+        uniqnav(nav);
+
+        /* write obs and nav data to cache */
+        if (cache==1&&nav->nc==nc) {
+            writeobsc(path,key,stamask,ctx->nepoch,obs,nav,sta,par,fcn);
+        }
+    }
 
     /* set time span for progress display */
     if (ts.time==0||te.time==0) {
@@ -797,14 +1525,29 @@ static int readobsnav(gtime_t ts, gtime_t te, double ti, const char **infile,
     return 1;
 }
 /* free obs and nav data -----------------------------------------------------*/
-static void freeobsnav(obs_t *obs, nav_t *nav)
+static void freeobsnav(ppctx_t *ctx)
 {
+    int i;
+
     trace(3,"freeobsnav:\n");
 
-    free(obs->data); obs->data=NULL; obs->n =obs->nmax =0;
-    free(nav->eph ); nav->eph =NULL; nav->n =nav->nmax =0;
-    free(nav->geph); nav->geph=NULL; nav->ng=nav->ngmax=0;
-    free(nav->seph); nav->seph=NULL; nav->ns=nav->nsmax=0;
+    if (ctx->obsmap) {
+        unmapobsc(ctx->obsmap,ctx->nobsmap);
+        ctx->obsmap=NULL; ctx->nobsmap=0;
+    }
+    else free(ctx->obss.data);
+    ctx->obss.data=NULL; ctx->obss.n=ctx->obss.nmax=0;
+
+    for (i=0;i<2;i++) {
+        if (ctx->rnxs[i]) {
+            close_rnxobs(ctx->rnxs[i]);
+            free(ctx->rnxs[i]);
+            ctx->rnxs[i]=NULL;
+        }
+        free(ctx->obsh[i].data);
+        ctx->obsh[i].data=NULL; ctx->obsh[i].n=ctx->obsh[i].nmax=0;
+    }
+    freenav(&ctx->navs,0x07);
 }
 /* average of single position ------------------------------------------------*/
 static int avepos(double *ra, int rcv, const obs_t *obs, const nav_t *nav,
@@ -892,52 +1635,22 @@ static int antpos(prcopt_t *opt, int rcvno, const obs_t *obs, const nav_t *nav,
     }
     return 1;
 }
-/* open processing session ----------------------------------------------------*/
-static int openses(const prcopt_t *popt, const solopt_t *sopt,
-                   const filopt_t *fopt, nav_t *nav, pcvs_t *pcvs, pcvs_t *pcvr)
-{
-    (void)popt; (void)nav;
-    trace(3,"openses :\n");
-
-    /* read satellite antenna parameters */
-    if (*fopt->satantp&&!(readpcv(fopt->satantp,pcvs))) {
-        showmsg("error : no sat ant pcv in %s",fopt->satantp);
-        trace(1,"sat antenna pcv read error: %s\n",fopt->satantp);
-        return 0;
-    }
-    /* read receiver antenna parameters */
-    if (*fopt->rcvantp&&!(readpcv(fopt->rcvantp,pcvr))) {
-        showmsg("error : no rec ant pcv in %s",fopt->rcvantp);
-        trace(1,"rec antenna pcv read error: %s\n",fopt->rcvantp);
-        return 0;
-    }
-    /* open geoid data */
-    if (sopt->geoid>0&&*fopt->geoid) {
-        if (!opengeoid(sopt->geoid,fopt->geoid)) {
-            showmsg("error : no geoid data %s",fopt->geoid);
-            trace(2,"no geoid data %s\n",fopt->geoid);
-        }
-    }
-    return 1;
-}
 /* close processing session ---------------------------------------------------*/
-static void closeses(nav_t *nav, pcvs_t *pcvs, pcvs_t *pcvr)
+static void closeses(ppctx_t *ctx)
 {
-    trace(3,"closeses:\n");
-
-    /* free antenna parameters */
-    free_pcvs(pcvs);
-    free_pcvs(pcvr);
+    nav_t *nav=&ctx->navs;
 
-    /* close geoid data */
-    closegeoid();
+    trace(3,"closeses:\n");
 
     /* free erp data */
-    free(nav->erp.data); nav->erp.data=NULL; nav->erp.n=nav->erp.nmax=0;
+    if (nav->erp.data!=ctx->shr->erp.data) free(nav->erp.data);
+    nav->erp.data=NULL; nav->erp.n=nav->erp.nmax=0;
 
     /* close solution statistics and debug trace */
-    rtkclosestat();
-    traceclose();
+    if (ctx->glob) {
+        rtkclosestat();
+        traceclose();
+    }
 }
 /* set antenna parameters ----------------------------------------------------*/
 static void setpcv(gtime_t time, prcopt_t *popt, nav_t *nav, const pcvs_t *pcvs,
@@ -971,7 +1684,7 @@ static void setpcv(gtime_t time, prcopt_t *popt, nav_t *nav, const pcvs_t *pcvs,
                 }
             }
             else { /* enu */
-                for (j=0;j<3;j++) popt->antdel[i][j]=stas[i].del[j];
+                for (j=0;j<3;j++) popt->antdel[i][j]=sta[i].del[j];
             }
         }
         if (!(pcv=searchpcv(0,popt->anttype[i],time,pcvr))) {
@@ -993,8 +1706,8 @@ static void readotl(prcopt_t *popt, const char *file, const sta_t *sta)
     }
 }
 /* write header to output file -----------------------------------------------*/
-static int outhead(const char *outfile, const char **infile, int n,
-                   const prcopt_t *popt, const solopt_t *sopt)
+static int outhead(const ppctx_t *ctx, const char *outfile, const char **infile,
+                   int n, const prcopt_t *popt, const solopt_t *sopt)
 {
     FILE *fp=stdout;
 
@@ -1009,7 +1722,7 @@ static int outhead(const char *outfile, const char **infile, int n,
         }
     }
     /* output header */
-    outheader(fp,infile,n,popt,sopt);
+    outheader(ctx,fp,infile,n,popt,sopt);
 
     if (*outfile) fclose(fp);
 
@@ -1040,9 +1753,10 @@ static void namefiletm(char *outfiletm, const char *outfile)
     strcat(outfiletm, "_events.pos");
 }
 /* execute processing session ------------------------------------------------*/
-static int execses(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
-                   const solopt_t *sopt, const filopt_t *fopt, int flag,
-                   const char **infile, const int *index, int n, const char *outfile)
+static int execses(ppctx_t *ctx, gtime_t ts, gtime_t te, double ti,
+                   const prcopt_t *popt, const solopt_t *sopt,
+                   const filopt_t *fopt, int flag, const char **infile,
+                   const int *index, int n, const char *outfile)
 {
     rtk_t *rtk_ptr = (rtk_t *)malloc(sizeof(rtk_t)); /* moved from stack to heap to avoid stack overflow warning */
     prcopt_t popt_=*popt;
@@ -1053,7 +1767,7 @@ static int execses(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
     trace(3,"execses : n=%d outfile=%s\n",n,outfile);
 
     /* open debug trace */
-    if (flag&&sopt->trace>0) {
+    if (ctx->glob&&flag&&sopt->trace>0) {
         if (*outfile) {
             strcpy(tracefile,outfile);
             strcat(tracefile,".trace");
@@ -1070,22 +1784,32 @@ static int execses(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
         if (strlen(ext)==4&&(ext[3]=='i'||ext[3]=='I'||
                              strcmp(ext,".INX")==0||strcmp(ext,".inx")==0)) {
             reppath(fopt->iono,path,ts,"","");
-            readtec(path,&navs,1);
+            readtec(path,&ctx->navs,1);
         }
     }
     /* read erp data */
-    if (*fopt->eop) {
-        free(navs.erp.data); navs.erp.data=NULL; navs.erp.n=navs.erp.nmax=0;
+    if (ctx->shr->erp.n>0) {
+        ctx->navs.erp=ctx->shr->erp;
+    }
+    else if (*fopt->eop) {
+        free(ctx->navs.erp.data); ctx->navs.erp.data=NULL; ctx->navs.erp.n=ctx->navs.erp.nmax=0;
         reppath(fopt->eop,path,ts,"","");
-        if (!readerp(path,&navs.erp)) {
+        if (!readerp(path,&ctx->navs.erp)) {
             showmsg("error : no erp data %s",path);
             trace(2,"no erp data %s\n",path);
         }
     }
+    /* streaming obs data for forward solutions without averaged position */
+    ctx->stream=popt_.obsstream&&
+                (popt_.mode==PMODE_SINGLE||popt_.soltype==SOLTYPE_FORWARD)&&
+                !(popt_.mode==PMODE_FIXED&&popt_.rovpos==POSOPT_SINGLE)&&
+                !(((PMODE_DGPS<=popt_.mode&&popt_.mode<=PMODE_STATIC_START)||
+                   popt_.mode==PMODE_FIXED)&&popt_.refpos==POSOPT_SINGLE);
+
     /* read obs and nav data */
-    if (!readobsnav(ts,te,ti,infile,index,n,&popt_,&obss,&navs,stas)) {
+    if (!readobsnav(ctx,ts,te,ti,infile,index,n,&popt_,&ctx->obss,&ctx->navs,ctx->stas)) {
         /* free obs and nav data */
-        freeobsnav(&obss, &navs);
+        freeobsnav(ctx);
         free(rtk_ptr);
         return 0;
     }
@@ -1094,67 +1818,68 @@ static int execses(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
     dcb_ok = 0;
     for (i=0;i<MAX_CODE_BIASES;i++) for (k=0;k<MAX_CODE_BIAS_FREQS;k++) {
         /* FIXME: cbias later initialized with 0 in readdcb()!  */
-        for (j=0;j<MAXSAT;j++) navs.cbias[j][k][i]=-1;
-        for (j=0;j<MAXRCV;j++) navs.rbias[j][k][i]=0;
+        for (j=0;j<MAXSAT;j++) ctx->navs.cbias[j][k][i]=-1;
+        for (j=0;j<MAXRCV;j++) ctx->navs.rbias[j][k][i]=0;
         }
     for (i=0;i<n;i++) {  /* first check infiles for .BIA or .BSX files */
-        if ((dcb_ok=readdcb(infile[i],&navs,stas))) break;
+        if ((dcb_ok=readdcb(infile[i],&ctx->navs,ctx->stas))) break;
     }
     if (!dcb_ok&&*fopt->dcb) {  /* then check if DCB file specified */
         reppath(fopt->dcb,path,ts,"","");
-        dcb_ok=readdcb(path,&navs,stas);
+        dcb_ok=readdcb(path,&ctx->navs,ctx->stas);
     }
     if (!dcb_ok) {
 
     }
     /* set antenna parameters */
     if (popt_.mode!=PMODE_SINGLE) {
-        setpcv(obss.n>0?obss.data[0].time:timeget(),&popt_,&navs,&pcvss,&pcvsr,
-               stas);
+        setpcv(ctx->obss.n>0?ctx->obss.data[0].time:timeget(),&popt_,&ctx->navs,&ctx->shr->pcvss,&ctx->shr->pcvsr,
+               ctx->stas);
     }
     /* read ocean tide loading parameters */
     if (popt_.mode>PMODE_SINGLE&&*fopt->blq) {
-        readotl(&popt_,fopt->blq,stas);
+        readotl(&popt_,fopt->blq,ctx->stas);
     }
     /* rover/reference fixed position */
     if (popt_.mode==PMODE_FIXED) {
-        if (!antpos(&popt_,1,&obss,&navs,stas,fopt->stapos)) {
-            freeobsnav(&obss,&navs);
+        if (!antpos(&popt_,1,&ctx->obss,&ctx->navs,ctx->stas,fopt->stapos)) {
+            freeobsnav(ctx);
             free(rtk_ptr);
             return 0;
         }
-        if (!antpos(&popt_,2,&obss,&navs,stas,fopt->stapos)) {
-            freeobsnav(&obss,&navs);
+        if (!antpos(&popt_,2,&ctx->obss,&ctx->navs,ctx->stas,fopt->stapos)) {
+            freeobsnav(ctx);
             free(rtk_ptr);
             return 0;
         }
     }
     else if (PMODE_DGPS<=popt_.mode&&popt_.mode<=PMODE_STATIC_START) {
-        if (!antpos(&popt_,2,&obss,&navs,stas,fopt->stapos)) {
-            freeobsnav(&obss,&navs);
+        if (!antpos(&popt_,2,&ctx->obss,&ctx->navs,ctx->stas,fopt->stapos)) {
+            freeobsnav(ctx);
             free(rtk_ptr);
             return 0;
         }
     }
     /* open solution statistics */
-    if (flag&&sopt->sstat>0) {
+    if (ctx->glob&&flag&&sopt->sstat>0) {
         strcpy(statfile,outfile);
         strcat(statfile,".stat");
         rtkclosestat();
-        rtkopenstat(statfile,sopt->sstat);
+        if (sopt->sstatf==SSTATF_BIN) rtkopenstatb(statfile,sopt->sstat);
+        else rtkopenstat(statfile,sopt->sstat);
     }
     /* write header to output file */
-    if (flag&&!outhead(outfile,infile,n,&popt_,sopt)) {
-        freeobsnav(&obss,&navs);
+    if (flag&&!outhead(ctx,outfile,infile,n,&popt_,sopt)) {
+        freeobsnav(ctx);
         free(rtk_ptr);
         return 0;
     }
     /* name time events file */
     namefiletm(outfiletm,outfile);
     /* write header to file with time marks */
-    outhead(outfiletm,infile,n,&popt_,sopt);
+    outhead(ctx,outfiletm,infile,n,&popt_,sopt);
 
-    iobsu=iobsr=isbs=reverse=aborts=0;
+    ctx->iobsu=ctx->iobsr=ctx->isbs=ctx->reverse=ctx->aborts=0;
 
     if (popt_.mode==PMODE_SINGLE||popt_.soltype==SOLTYPE_FORWARD) {
         FILE *fp=openfile(outfile);
@@ -1162,7 +1887,7 @@ static int execses(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
             FILE *fptm=openfile(outfiletm);
             if (fptm) {
                 rtkinit(rtk_ptr,&popt_);
-                procpos(fp,fptm,&popt_,sopt,rtk_ptr,SOLMODE_SINGLE_DIR);
+                procpos(ctx,fp,fptm,&popt_,sopt,rtk_ptr,SOLMODE_SINGLE_DIR);
                 rtkfree(rtk_ptr);
                 fclose(fptm);
             }
@@ -1174,9 +1899,9 @@ static int execses(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
         if (fp) {
             FILE *fptm=openfile(outfiletm);
             if (fptm) {
-                reverse=1; iobsu=iobsr=obss.n-1; isbs=sbss.n-1;
+                ctx->reverse=1; ctx->iobsu=ctx->iobsr=ctx->obss.n-1; ctx->isbs=ctx->sbss.n-1;
                 rtkinit(rtk_ptr,&popt_);
-                procpos(fp,fptm,&popt_,sopt,rtk_ptr,SOLMODE_SINGLE_DIR);
+                procpos(ctx,fp,fptm,&popt_,sopt,rtk_ptr,SOLMODE_SINGLE_DIR);
                 rtkfree(rtk_ptr);
                 fclose(fptm);
             }
@@ -1184,31 +1909,42 @@ static int execses(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
         }
     }
     else { /* combined or combined with no phase reset */
-        solf=(sol_t *)malloc(sizeof(sol_t)*nepoch);
-        solb=(sol_t *)malloc(sizeof(sol_t)*nepoch);
-        rbf=(double *)malloc(sizeof(double)*nepoch*3);
-        rbb=(double *)malloc(sizeof(double)*nepoch*3);
-
-        if (solf&&solb) {
-            isolf=isolb=0;
-            rtkinit(rtk_ptr,&popt_);
-            procpos(NULL,NULL,&popt_,sopt,rtk_ptr,SOLMODE_COMBINED); /* forward */
-            reverse=1; iobsu=iobsr=obss.n-1; isbs=sbss.n-1;
-            if (popt_.soltype!=SOLTYPE_COMBINED_NORESET) {
-                /* Reset */
-                rtkfree(rtk_ptr);
+        char pathf[1032]="",pathb[1032]="";
+
+        /* spill forward/backward solutions to files mapped to memory */
+        if (popt_.solspill&&*outfile) {
+            sprintf(pathf,"%.1023s.solf",outfile);
+            sprintf(pathb,"%.1023s.solb",outfile);
+        }
+        ctx->solf=allocsols(ctx->nepoch,pathf,&ctx->nsolf);
+        ctx->solb=allocsols(ctx->nepoch,pathb,&ctx->nsolb);
+
+        if (ctx->solf&&ctx->solb) {
+            ctx->isolf=ctx->isolb=0;
+
+            /* forward/backward in parallel if the passes are independent */
+            if (!popt_.combpar||popt_.soltype!=SOLTYPE_COMBINED||sopt->sstat>0||
+                ctx->sbss.n>0||*ctx->rtcm_file||
+                !procposfb(ctx,&popt_,sopt,rtk_ptr)) {
                 rtkinit(rtk_ptr,&popt_);
+                procpos(ctx,NULL,NULL,&popt_,sopt,rtk_ptr,SOLMODE_COMBINED); /* forward */
+                ctx->reverse=1; ctx->iobsu=ctx->iobsr=ctx->obss.n-1; ctx->isbs=ctx->sbss.n-1;
+                if (popt_.soltype!=SOLTYPE_COMBINED_NORESET) {
+                    /* Reset */
+                    rtkfree(rtk_ptr);
+                    rtkinit(rtk_ptr,&popt_);
+                }
+                procpos(ctx,NULL,NULL,&popt_,sopt,rtk_ptr,SOLMODE_COMBINED); /* backward */
+                rtkfree(rtk_ptr);
             }
-            procpos(NULL,NULL,&popt_,sopt,rtk_ptr,SOLMODE_COMBINED); /* backward */
-            rtkfree(rtk_ptr);
 
             /* combine forward/backward solutions */
-            if (!aborts) {
+            if (!ctx->aborts) {
                 FILE *fp=openfile(outfile);
                 if (fp) {
                     FILE *fptm=openfile(outfiletm);
                     if (fptm) {
-                        combres(fp,fptm,&popt_,sopt);
+                        combres(ctx,fp,fptm,&popt_,sopt);
                         fclose(fptm);
                     }
                     fclose(fp);
@@ -1216,21 +1952,21 @@ static int execses(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
             }
         }
         else showmsg("error : memory allocation");
-        free(solf);
-        free(solb);
-        free(rbf);
-        free(rbb);
+        freesols(ctx->solf,ctx->nsolf);
+        freesols(ctx->solb,ctx->nsolb);
+        ctx->solf=ctx->solb=NULL;
     }
     /* free rtk, obs and nav data */
     free(rtk_ptr);
-    freeobsnav(&obss,&navs);
+    freeobsnav(ctx);
 
-    return aborts?1:0;
+    return ctx->aborts?1:0;
 }
 /* execute processing session for each rover ---------------------------------*/
-static int execses_r(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
-                     const solopt_t *sopt, const filopt_t *fopt, int flag,
-                     const char **infile, const int *index, int n, const char *outfile,
+static int execses_r(ppctx_t *ctx, gtime_t ts, gtime_t te, double ti,
+                     const prcopt_t *popt, const solopt_t *sopt,
+                     const filopt_t *fopt, int flag, const char **infile,
+                     const int *index, int n, const char *outfile,
                      const char *rov)
 {
     gtime_t t0={0};
@@ -1256,9 +1992,9 @@ static int execses_r(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
             if ((q=strchr(p,' '))) *q='\0';
 
             if (*p) {
-                strcpy(proc_rov,p);
+                strcpy(ctx->proc_rov,p);
                 if (ts.time) time2str(ts,s,0); else *s='\0';
-                if (checkbrk("reading    : %s",s)) {
+                if (checkbrk(ctx,"reading    : %s",s)) {
                     stat=1;
                     break;
                 }
@@ -1266,7 +2002,7 @@ static int execses_r(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
                 reppath(outfile,ofile,t0,p,"");
 
                 /* execute processing session */
-                stat=execses(ts,te,ti,popt,sopt,fopt,flag,(const char **)ifile,index,n,ofile);
+                stat=execses(ctx,ts,te,ti,popt,sopt,fopt,flag,(const char **)ifile,index,n,ofile);
             }
             if (stat==1||!q) break;
         }
@@ -1274,14 +2010,15 @@ static int execses_r(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
     }
     else {
         /* execute processing session */
-        stat=execses(ts,te,ti,popt,sopt,fopt,flag,infile,index,n,outfile);
+        stat=execses(ctx,ts,te,ti,popt,sopt,fopt,flag,infile,index,n,outfile);
     }
     return stat;
 }
 /* execute processing session for each base station --------------------------*/
-static int execses_b(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
-                     const solopt_t *sopt, const filopt_t *fopt, int flag,
-                     const char **infile, const int *index, int n, const char *outfile,
+static int execses_b(ppctx_t *ctx, gtime_t ts, gtime_t te, double ti,
+                     const prcopt_t *popt, const solopt_t *sopt,
+                     const filopt_t *fopt, int flag, const char **infile,
+                     const int *index, int n, const char *outfile,
                      const char *rov, const char *base)
 {
     gtime_t t0={0};
@@ -1292,13 +2029,13 @@ static int execses_b(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
     trace(3,"execses_b: n=%d outfile=%s\n",n,outfile);
 
     /* read prec ephemeris and sbas data */
-    readpreceph(infile,n,popt,&navs,&sbss);
+    readpreceph(ctx,infile,n,popt);
 
     for (i=0;i<n;i++) if (strstr(infile[i],"%b")) break;
 
     if (i<n) { /* include base station keywords */
         if (!(base_=(char *)malloc(strlen(base)+1))) {
-            freepreceph(&navs,&sbss);
+            freepreceph(ctx);
             return 0;
         }
         strcpy(base_,base);
@@ -1306,7 +2043,7 @@ static int execses_b(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
         for (i=0;i<n;i++) {
             if (!(ifile[i]=(char *)malloc(1024))) {
                 free(base_); for (;i>=0;i--) free(ifile[i]);
-                freepreceph(&navs,&sbss);
+                freepreceph(ctx);
                 return 0;
             }
         }
@@ -1314,98 +2051,65 @@ static int execses_b(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
             if ((q=strchr(p,' '))) *q='\0';
 
             if (*p) {
-                strcpy(proc_base,p);
+                strcpy(ctx->proc_base,p);
                 if (ts.time) time2str(ts,s,0); else *s='\0';
-                if (checkbrk("reading    : %s",s)) {
+                if (checkbrk(ctx,"reading    : %s",s)) {
                     stat=1;
                     break;
                 }
                 for (i=0;i<n;i++) reppath(infile[i],ifile[i],t0,"",p);
                 reppath(outfile,ofile,t0,"",p);
 
-                stat=execses_r(ts,te,ti,popt,sopt,fopt,flag,(const char **)ifile,index,n,(const char *)ofile,rov);
+                stat=execses_r(ctx,ts,te,ti,popt,sopt,fopt,flag,(const char **)ifile,index,n,(const char *)ofile,rov);
             }
             if (stat==1||!q) break;
         }
         free(base_); for (i=0;i<n;i++) free(ifile[i]);
     }
     else {
-        stat=execses_r(ts,te,ti,popt,sopt,fopt,flag,infile,index,n,outfile,rov);
+        stat=execses_r(ctx,ts,te,ti,popt,sopt,fopt,flag,infile,index,n,outfile,rov);
     }
     /* free prec ephemeris and sbas data */
-    freepreceph(&navs,&sbss);
+    freepreceph(ctx);
 
     return stat;
 }
-/* post-processing positioning -------------------------------------------------
-* post-processing positioning
-* args   : gtime_t ts       I   processing start time (ts.time==0: no limit)
-*        : gtime_t te       I   processing end time   (te.time==0: no limit)
-*          double ti        I   processing interval  (s) (0:all)
-*          double tu        I   processing unit time (s) (0:all)
-*          prcopt_t *popt   I   processing options
-*          solopt_t *sopt   I   solution options
-*          filopt_t *fopt   I   file options
-*          char   **infile  I   input files (see below)
-*          int    n         I   number of input files
-*          char   *outfile  I   output file ("":stdout, see below)
-*          char   *rov      I   rover id list        (separated by " ")
-*          char   *base     I   base station id list (separated by " ")
-* return : status (0:ok,0>:error,1:aborted)
-* notes  : input files should contain observation data, navigation data, precise
-*          ephemeris/clock (optional), sbas log file (optional), ssr message
-*          log file (optional) and tec grid file (optional). only the first
-*          observation data file in the input files is recognized as the rover
-*          data.
-*
-*          the type of an input file is recognized by the file extension as ]
-*          follows:
-*              .sp3,.SP3,.eph*,.EPH*: precise ephemeris (sp3c)
-*              .sbs,.SBS,.ems,.EMS  : sbas message log files (rtklib or ems)
-*              .rtcm3,.RTCM3        : ssr message log files (rtcm3)
-*              .*i,.*I              : tec grid files (ionex)
-*              others               : rinex obs, nav, gnav, hnav, qnav or clock
-*
-*          inputs files can include wild-cards (*). if an file includes
-*          wild-cards, the wild-card expanded multiple files are used.
-*
-*          inputs files can include keywords. if an file includes keywords,
-*          the keywords are replaced by date, time, rover id and base station
-*          id and multiple session analyses run. refer reppath() for the
-*          keywords.
-*
-*          the output file can also include keywords. if the output file does
-*          not include keywords. the results of all multiple session analyses
-*          are output to a single output file.
-*
-*          ssr corrections are valid only for forward estimation.
-*-----------------------------------------------------------------------------*/
-extern int postpos(gtime_t ts, gtime_t te, double ti, double tu,
-                   const prcopt_t *popt, const solopt_t *sopt,
-                   const filopt_t *fopt, const char **infile, int n, const char *outfile,
+/* process sessions ----------------------------------------------------------*/
+static int procses(const ppshr_t *shr, int glob, gtime_t ts, gtime_t te,
+                   double ti, double tu, const prcopt_t *popt,
+                   const solopt_t *sopt, const filopt_t *fopt,
+                   const char **infile, int n, const char *outfile,
                    const char *rov, const char *base)
 {
+    ppctx_t *ctx;
     gtime_t tts,tte,ttte;
     double tunit,tss;
     int i,j,k,nf,stat=0,week,flag=1,index[MAXINFILE]={0};
     char *ifile[MAXINFILE],ofile[1024];
     const char *ext;
 
-    trace(3,"postpos : ti=%.0f tu=%.0f n=%d outfile=%s\n",ti,tu,n,outfile);
+    trace(3,"procses : ti=%.0f tu=%.0f n=%d outfile=%s\n",ti,tu,n,outfile);
 
-    /* open processing session */
-    if (!openses(popt,sopt,fopt,&navs,&pcvss,&pcvsr)) return -1;
+    /* allocate session context */
+    if (!(ctx=(ppctx_t *)calloc(1,sizeof(ppctx_t)))) {
+        showmsg("error : memory allocation");
+        return -1;
+    }
+    ctx->shr=shr;
+    ctx->glob=glob;
 
     if (ts.time!=0&&te.time!=0&&tu>=0.0) {
         if (timediff(te,ts)<0.0) {
             showmsg("error : no period");
-            closeses(&navs,&pcvss,&pcvsr);
+            closeses(ctx);
+            free(ctx);
             return 0;
         }
         for (i=0;i<MAXINFILE;i++) {
             if (!(ifile[i]=(char *)malloc(1024))) {
                 for (;i>=0;i--) free(ifile[i]);
-                closeses(&navs,&pcvss,&pcvsr);
+                closeses(ctx);
+                free(ctx);
                 return -1;
             }
         }
@@ -1421,10 +2125,10 @@ extern int postpos(gtime_t ts, gtime_t te, double ti, double tu,
             if (timediff(tts,ts)<0.0) tts=ts;
             if (timediff(tte,te)>0.0) tte=te;
 
-            strcpy(proc_rov ,"");
-            strcpy(proc_base,"");
+            strcpy(ctx->proc_rov ,"");
+            strcpy(ctx->proc_base,"");
             char tstr[40];
-            if (checkbrk("reading    : %s",time2str(tts,tstr,0))) {
+            if (checkbrk(ctx,"reading    : %s",time2str(tts,tstr,0))) {
                 stat=1;
                 break;
             }
@@ -1457,7 +2161,7 @@ extern int postpos(gtime_t ts, gtime_t te, double ti, double tu,
             if (!reppath(outfile,ofile,tts,"","")&&i>0) flag=0;
 
             /* execute processing session */
-            stat=execses_b(tts,tte,ti,popt,sopt,fopt,flag,(const char **)ifile,index,nf,(const char *)ofile,
+            stat=execses_b(ctx,tts,tte,ti,popt,sopt,fopt,flag,(const char **)ifile,index,nf,(const char *)ofile,
                            rov,base);
 
             if (stat==1) break;
@@ -1468,6 +2172,8 @@ extern int postpos(gtime_t ts, gtime_t te, double ti, double tu,
         for (i=0;i<n&&i<MAXINFILE;i++) {
             if (!(ifile[i]=(char *)malloc(1024))) {
                 for (;i>=0;i--) free(ifile[i]);
+                closeses(ctx);
+                free(ctx);
                 return -1;
             }
             reppath(infile[i],ifile[i],ts,"","");
@@ -1476,7 +2182,7 @@ extern int postpos(gtime_t ts, gtime_t te, double ti, double tu,
         reppath(outfile,ofile,ts,"","");
 
         /* execute processing session */
-        stat=execses_b(ts,te,ti,popt,sopt,fopt,1,(const char **)ifile,index,n,ofile,rov,
+        stat=execses_b(ctx,ts,te,ti,popt,sopt,fopt,1,(const char **)ifile,index,n,ofile,rov,
                        base);
 
         for (i=0;i<n&&i<MAXINFILE;i++) free(ifile[i]);
@@ -1485,11 +2191,178 @@ extern int postpos(gtime_t ts, gtime_t te, double ti, double tu,
         for (i=0;i<n;i++) index[i]=i;
 
         /* execute processing session */
-        stat=execses_b(ts,te,ti,popt,sopt,fopt,1,infile,index,n,outfile,rov,
+        stat=execses_b(ctx,ts,te,ti,popt,sopt,fopt,1,infile,index,n,outfile,rov,
                        base);
     }
     /* close processing session */
-    closeses(&navs,&pcvss,&pcvsr);
+    closeses(ctx);
+    free(ctx);
 
     return stat;
 }
+/* initialize post-processing shared data -------------------------------------
+* read data shared read-only by post-processing sessions
+* args   : ppshr_t *shr     O   post-processing shared data
+*          solopt_t *sopt   I   solution options
+*          filopt_t *fopt   I   file options
+*          char   **infile  I   precise ephemeris/clock files (NULL: none)
+*          int    n         I   number of precise ephemeris/clock files
+* return : status (1:ok,0:error)
+* notes  : satellite and receiver antenna parameters are read from
+*          fopt->satantp and fopt->rcvantp, erp from fopt->eop. the erp file
+*          with keywords is not shared and read by each session instead.
+*          precise ephemeris and clock read from infile are used by all
+*          sessions instead of those in the session input files.
+*          geoid data by fopt->geoid is opened process-wide if sopt->geoid>0.
+*-----------------------------------------------------------------------------*/
+extern int ppshrinit(ppshr_t *shr, const solopt_t *sopt, const filopt_t *fopt,
+                     const char **infile, int n)
+{
+    nav_t nav={0};
+    int i;
+
+    trace(3,"ppshrinit: n=%d\n",n);
+
+    memset(shr,0,sizeof(ppshr_t));
+
+    /* read satellite antenna parameters */
+    if (*fopt->satantp&&!(readpcv(fopt->satantp,&shr->pcvss))) {
+        showmsg("error : no sat ant pcv in %s",fopt->satantp);
+        trace(1,"sat antenna pcv read error: %s\n",fopt->satantp);
+        return 0;
+    }
+    /* read receiver antenna parameters */
+    if (*fopt->rcvantp&&!(readpcv(fopt->rcvantp,&shr->pcvsr))) {
+        showmsg("error : no rec ant pcv in %s",fopt->rcvantp);
+        trace(1,"rec antenna pcv read error: %s\n",fopt->rcvantp);
+        free_pcvs(&shr->pcvss);
+        return 0;
+    }
+    /* open geoid data */
+    if (sopt->geoid>0&&*fopt->geoid) {
+        if (!opengeoid(sopt->geoid,fopt->geoid)) {
+            showmsg("error : no geoid data %s",fopt->geoid);
+            trace(2,"no geoid data %s\n",fopt->geoid);
+        }
+        else shr->geoid=1;
+    }
+    /* read erp data */
+    if (*fopt->eop&&!strchr(fopt->eop,'%')) {
+        if (!readerp(fopt->eop,&shr->erp)) {
+            showmsg("error : no erp data %s",fopt->eop);
+            trace(2,"no erp data %s\n",fopt->eop);
+        }
+    }
+    /* read precise ephemeris and clock files */
+    for (i=0;i<n;i++) {
+        readsp3(infile[i],&nav,0);
+    }
+    for (i=0;i<n;i++) {
+        readrnxc(infile[i],&nav);
+    }
+    shr->peph=nav.peph; shr->ne=nav.ne;
+    shr->pclk=nav.pclk; shr->nc=nav.nc;
+    return 1;
+}
+/* free post-processing shared data -------------------------------------------
+* free post-processing shared data
+* args   : ppshr_t *shr     IO  post-processing shared data
+* return : none
+*-----------------------------------------------------------------------------*/
+extern void ppshrfree(ppshr_t *shr)
+{
+    trace(3,"ppshrfree:\n");
+
+    free_pcvs(&shr->pcvss);
+    free_pcvs(&shr->pcvsr);
+    if (shr->geoid) closegeoid();
+    free(shr->erp.data); shr->erp.data=NULL; shr->erp.n=shr->erp.nmax=0;
+    free(shr->peph); shr->peph=NULL; shr->ne=0;
+    free(shr->pclk); shr->pclk=NULL; shr->nc=0;
+    shr->geoid=0;
+}
+/* post-processing positioning -------------------------------------------------
+* post-processing positioning
+* args   : gtime_t ts       I   processing start time (ts.time==0: no limit)
+*        : gtime_t te       I   processing end time   (te.time==0: no limit)
+*          double ti        I   processing interval  (s) (0:all)
+*          double tu        I   processing unit time (s) (0:all)
+*          prcopt_t *popt   I   processing options
+*          solopt_t *sopt   I   solution options
+*          filopt_t *fopt   I   file options
+*          char   **infile  I   input files (see below)
+*          int    n         I   number of input files
+*          char   *outfile  I   output file ("":stdout, see below)
+*          char   *rov      I   rover id list        (separated by " ")
+*          char   *base     I   base station id list (separated by " ")
+* return : status (0:ok,0>:error,1:aborted)
+* notes  : input files should contain observation data, navigation data, precise
+*          ephemeris/clock (optional), sbas log file (optional), ssr message
+*          log file (optional) and tec grid file (optional). only the first
+*          observation data file in the input files is recognized as the rover
+*          data.
+*
+*          the type of an input file is recognized by the file extension as ]
+*          follows:
+*              .sp3,.SP3,.eph*,.EPH*: precise ephemeris (sp3c)
+*              .sbs,.SBS,.ems,.EMS  : sbas message log files (rtklib or ems)
+*              .rtcm3,.RTCM3        : ssr message log files (rtcm3)
+*              .*i,.*I              : tec grid files (ionex)
+*              others               : rinex obs, nav, gnav, hnav, qnav or clock
+*
+*          inputs files can include wild-cards (*). if an file includes
+*          wild-cards, the wild-card expanded multiple files are used.
+*
+*          inputs files can include keywords. if an file includes keywords,
+*          the keywords are replaced by date, time, rover id and base station
+*          id and multiple session analyses run. refer reppath() for the
+*          keywords.
+*
+*          the output file can also include keywords. if the output file does
+*          not include keywords. the results of all multiple session analyses
+*          are output to a single output file.
+*
+*          ssr corrections are valid only for forward estimation.
+*-----------------------------------------------------------------------------*/
+extern int postpos(gtime_t ts, gtime_t te, double ti, double tu,
+                   const prcopt_t *popt, const solopt_t *sopt,
+                   const filopt_t *fopt, const char **infile, int n, const char *outfile,
+                   const char *rov, const char *base)
+{
+    ppshr_t shr;
+    int stat;
+
+    trace(3,"postpos : ti=%.0f tu=%.0f n=%d outfile=%s\n",ti,tu,n,outfile);
+
+    /* read antenna parameters, erp and open geoid data */
+    if (!ppshrinit(&shr,sopt,fopt,NULL,0)) return -1;
+
+    stat=procses(&shr,1,ts,te,ti,tu,popt,sopt,fopt,infile,n,outfile,rov,base);
+
+    ppshrfree(&shr);
+
+    return stat;
+}
+/* post-processing positioning with shared data --------------------------------
+* post-processing positioning reentrant version
+* args   : ppshr_t *shr     I   post-processing shared data by ppshrinit()
+*          (others)             same as postpos()
+* return : status (0:ok,0>:error,1:aborted)
+* notes  : all session data are allocated in the context of the call, so
+*          multiple postpos_ctx() can be executed in parallel threads sharing
+*          the same read-only shared data.
+*          debug trace (sopt->trace) and solution status (sopt->sstat) are
+*          process-wide and not output by postpos_ctx(). callbacks showmsg(),
+*          settspan() and settime() should be thread-safe in the application.
+*          geoid data other than the embedded model is read from a shared file
+*          and should not be used by parallel sessions.
+*-----------------------------------------------------------------------------*/
+extern int postpos_ctx(const ppshr_t *shr, gtime_t ts, gtime_t te, double ti,
+                       double tu, const prcopt_t *popt, const solopt_t *sopt,
+                       const filopt_t *fopt, const char **infile, int n,
+                       const char *outfile, const char *rov, const char *base)
+{
+    trace(3,"postpos_ctx: ti=%.0f tu=%.0f n=%d outfile=%s\n",ti,tu,n,outfile);
+
+    return procses(shr,0,ts,te,ti,tu,popt,sopt,fopt,infile,n,outfile,rov,base);
+}
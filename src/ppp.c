@@ -59,6 +59,7 @@
 *           2018/10/10 1.13 support api change of satexclude()
 *           2020/11/30 1.14 use sat2freq() to get carrier frequency
 *                           use E1-E5b for Galileo iono-free LC
+*           2026/10/16 1.15 support binary solution status in pppoutstat()
 *-----------------------------------------------------------------------------*/
 #include "rtklib.h"
 
@@ -124,12 +125,12 @@ static double STD(rtk_t *rtk, int i)
     return SQRT(rtk->P[i+i*rtk->nx]);
 }
 /* write solution status for PPP ---------------------------------------------*/
-extern int pppoutstat(rtk_t *rtk, char *buff)
+extern int pppoutstat(rtk_t *rtk, int fmt, uint8_t *buff)
 {
     ssat_t *ssat;
-    double tow,pos[3],vel[3],acc[3],*x;
+    double tow,pos[3],vel[3],acc[3],*x,v[13]={0};
     int i,j,week;
-    char id[8],*p=buff;
+    uint8_t *p=buff;
 
     if (!rtk->sol.stat) return 0;
 
@@ -139,37 +140,45 @@ extern int pppoutstat(rtk_t *rtk, char *buff)
 
     x=rtk->sol.stat==SOLQ_FIX?rtk->xa:rtk->x;
 
+    p+=outsolstatrec(p,fmt,SSTAT_EPOCH,week,tow,NULL,0);
+
     /* receiver position */
-    p+=sprintf(p,"$POS,%d,%.3f,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n",week,tow,
-               rtk->sol.stat,x[0],x[1],x[2],STD(rtk,0),STD(rtk,1),STD(rtk,2));
+    v[0]=rtk->sol.stat;
+    for (i=0;i<3;i++) {
+        v[1+i]=x[i];
+        v[4+i]=STD(rtk,i);
+    }
+    p+=outsolstatrec(p,fmt,SSTAT_POS,week,tow,v,7);
 
     /* receiver velocity and acceleration */
     if (rtk->opt.dynamics) {
         ecef2pos(rtk->sol.rr,pos);
         ecef2enu(pos,rtk->x+3,vel);
         ecef2enu(pos,rtk->x+6,acc);
-        p+=sprintf(p,"$VELACC,%d,%.3f,%d,%.4f,%.4f,%.4f,%.5f,%.5f,%.5f,%.4f,%.4f,"
-                   "%.4f,%.5f,%.5f,%.5f\n",week,tow,rtk->sol.stat,vel[0],vel[1],
-                   vel[2],acc[0],acc[1],acc[2],0.0,0.0,0.0,0.0,0.0,0.0);
+        for (i=0;i<3;i++) {
+            v[1+i]=vel[i]; v[4+i]=acc[i]; v[7+i]=v[10+i]=0.0;
+        }
+        p+=outsolstatrec(p,fmt,SSTAT_VELACC,week,tow,v,13);
     }
     /* receiver clocks */
     i=IC(0,&rtk->opt);
-    p+=sprintf(p,"$CLK,%d,%.3f,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n",
-               week,tow,rtk->sol.stat,1,x[i]*1E9/CLIGHT,x[i+1]*1E9/CLIGHT,
-               x[i+2]*1E9/CLIGHT,x[i+3]*1E9/CLIGHT,STD(rtk,i)*1E9/CLIGHT,
-               STD(rtk,i+1)*1E9/CLIGHT,STD(rtk,i+2)*1E9/CLIGHT,
-               STD(rtk,i+2)*1E9/CLIGHT);
+    v[1]=1;
+    for (j=0;j<4;j++) {
+        v[2+j]=x[i+j]*1E9/CLIGHT;
+        v[6+j]=STD(rtk,i+(j<3?j:2))*1E9/CLIGHT;
+    }
+    p+=outsolstatrec(p,fmt,SSTAT_CLK,week,tow,v,10);
 
     /* tropospheric parameters */
     if (rtk->opt.tropopt==TROPOPT_EST||rtk->opt.tropopt==TROPOPT_ESTG) {
         i=IT(&rtk->opt);
-        p+=sprintf(p,"$TROP,%d,%.3f,%d,%d,%.4f,%.4f\n",week,tow,rtk->sol.stat,
-                   1,x[i],STD(rtk,i));
+        v[1]=1; v[2]=x[i]; v[3]=STD(rtk,i);
+        p+=outsolstatrec(p,fmt,SSTAT_TROP,week,tow,v,4);
     }
     if (rtk->opt.tropopt==TROPOPT_ESTG) {
         i=IT(&rtk->opt);
-        p+=sprintf(p,"$TRPG,%d,%.3f,%d,%d,%.5f,%.5f,%.5f,%.5f\n",week,tow,
-                   rtk->sol.stat,1,x[i+1],x[i+2],STD(rtk,i+1),STD(rtk,i+2));
+        v[1]=1; v[2]=x[i+1]; v[3]=x[i+2]; v[4]=STD(rtk,i+1); v[5]=STD(rtk,i+2);
+        p+=outsolstatrec(p,fmt,SSTAT_TRPG,week,tow,v,6);
     }
     /* ionosphere parameters */
     if (rtk->opt.ionoopt==IONOOPT_EST) {
@@ -178,10 +187,12 @@ extern int pppoutstat(rtk_t *rtk, char *buff)
             if (!ssat->vs) continue;
             j=II(i+1,&rtk->opt);
             if (rtk->x[j]==0.0) continue;
-            satno2id(i+1,id);
-            p+=sprintf(p,"$ION,%d,%.3f,%d,%s,%.1f,%.1f,%.4f,%.4f\n",week,tow,
-                       rtk->sol.stat,id,rtk->ssat[i].azel[0]*R2D,
-                       rtk->ssat[i].azel[1]*R2D,x[j],STD(rtk,j));
+            v[1]=i+1;
+            v[2]=ssat->azel[0]*R2D;
+            v[3]=ssat->azel[1]*R2D;
+            v[4]=x[j];
+            v[5]=STD(rtk,j);
+            p+=outsolstatrec(p,fmt,SSTAT_ION,week,tow,v,6);
         }
     }
 #ifdef OUTSTAT_AMB
@@ -190,9 +201,8 @@ extern int pppoutstat(rtk_t *rtk, char *buff)
     for (i=0;i<MAXSAT;i++) for (j=0;j<NF(&rtk->opt);j++) {
         k=IB(i+1,j,&rtk->opt);
         if (rtk->x[k]==0.0) continue;
-        satno2id(i+1,id);
-        p+=sprintf(p,"$AMB,%d,%.3f,%d,%s,%d,%.4f,%.4f\n",week,tow,
-                   rtk->sol.stat,id,j+1,x[k],STD(rtk,k));
+        v[1]=i+1; v[2]=j+1; v[3]=x[k]; v[4]=STD(rtk,k);
+        p+=outsolstatrec(p,fmt,SSTAT_AMB,week,tow,v,5);
     }
 #endif
     return (int)(p-buff);
@@ -1231,7 +1241,7 @@ extern void pppos(rtk_t *rtk, const obsd_t *obs, int n, const nav_t *nav)
             break;
         }
         /* measurement update of ekf states */
-        if ((info=filter(xp,Pp,H,v,R,rtk->nx,nv))) {
+        if ((info=filterws(&rtk->ws,xp,Pp,H,v,R,rtk->nx,nv))) {
             trace(2,"%s ppp (%d) filter error info=%d\n",str,i+1,info);
             break;
         }
@@ -48,54 +48,42 @@
 *                           LC defined GPS/QZS L1-L2, GLO G1-G2, GAL E1-E5b,
 *                            BDS B1I-B2I and IRN L5-S for API satantoff()
 *                           fix bug on reading SP3 file extension
+*           2026/10/16 1.18 add API initpephc(),freepephc()
+*                           cache interpolation windows and interval indices
+*                           of precise ephemeris and clock
+*                           use str2int() for integer fields
+*                           constant code bias index table for concurrent use
 *-----------------------------------------------------------------------------*/
 #include "rtklib.h"
 
 #define SQR(x)      ((x)*(x))
 
-#define NMAX        10              /* order of polynomial interpolation */
+#define NMAX        (NPEPHINT-1)    /* order of polynomial interpolation */
 #define MAXDTE      900.0           /* max time difference to ephem time (s) */
 #define EXTERR_CLK  1E-3            /* extrapolation error for clock (m/s) */
 #define EXTERR_EPH  5E-7            /* extrapolation error for ephem (m/s^2) */
 #define MAX_BIAS_SYS 4              /* # of constellations supported */
 
-/* table to translate code to code bias table index  */
-static int8_t code_bias_ix[MAX_BIAS_SYS][MAXCODE];
-/* initialize code bias lookup table -------------------------------------------
-*       -1 = code not supported
-*        0 = reference code (0 bias)
-*        1-3 = table index for code
+/* table to translate code to code bias table index + 1 ----------------------
+*        0 = code not supported
+*        1 = reference code (0 bias)
+*        2-4 = table index + 1 for code
 * ----------------------------------------------------------------------------*/
-static void init_bias_ix(void) {
-    int i,j;
-
-    for (i=0;i<MAX_BIAS_SYS;i++) for (j=0;j<MAXCODE;j++)
-        code_bias_ix[i][j]=-1;
-
-    /* GPS */
-    code_bias_ix[0][CODE_L1W]=0;
-    code_bias_ix[0][CODE_L1C]=1;
-    code_bias_ix[0][CODE_L1L]=2;
-    code_bias_ix[0][CODE_L1X]=3;
-    code_bias_ix[0][CODE_L2W]=0;
-    code_bias_ix[0][CODE_L2L]=1;
-    code_bias_ix[0][CODE_L2S]=2;
-    code_bias_ix[0][CODE_L2X]=3;
-    /* GLONASS */
-    code_bias_ix[1][CODE_L1P]=0;
-    code_bias_ix[1][CODE_L1C]=1;
-    code_bias_ix[1][CODE_L2P]=0;
-    code_bias_ix[1][CODE_L2C]=1;
-    /* Galileo */
-    code_bias_ix[2][CODE_L1C]=0;
-    code_bias_ix[2][CODE_L1X]=1;
-    code_bias_ix[2][CODE_L5Q]=0;
-    code_bias_ix[2][CODE_L5I]=1;
-    code_bias_ix[2][CODE_L5X]=2;
-    /* Beidou */
-    code_bias_ix[3][CODE_L2I]=0;
-    code_bias_ix[3][CODE_L6I]=0;
-}
+static const int8_t code_bias_ix[MAX_BIAS_SYS][MAXCODE]={
+    { /* GPS */
+        [CODE_L1W]=1,[CODE_L1C]=2,[CODE_L1L]=3,[CODE_L1X]=4,
+        [CODE_L2W]=1,[CODE_L2L]=2,[CODE_L2S]=3,[CODE_L2X]=4
+    },
+    { /* GLONASS */
+        [CODE_L1P]=1,[CODE_L1C]=2,[CODE_L2P]=1,[CODE_L2C]=2
+    },
+    { /* Galileo */
+        [CODE_L1C]=1,[CODE_L1X]=2,[CODE_L5Q]=1,[CODE_L5I]=2,[CODE_L5X]=3
+    },
+    { /* Beidou */
+        [CODE_L2I]=1,[CODE_L6I]=1
+    }
+};
 
 /* satellite code to satellite system ----------------------------------------*/
 static int code2sys(char code)
@@ -127,12 +115,12 @@ static int readsp3h(FILE *fp, gtime_t *time, char *type, int *sats,
         }
         else if (buff[0]=='+'&&buff[1]==' ') {
             if (i==2) {
-                ns=(int)str2num(buff,3,3);
+                ns=str2int(buff,3,3);
                 if (ns>85) nl=ns/17+(ns%17!=0);
             }
             for (j=0;j<17&&k<ns;j++) {
                 sys=code2sys(buff[9+3*j]);
-                prn=(int)str2num(buff,10+3*j,2);
+                prn=str2int(buff,10+3*j,2);
                 if (k<MAXSAT) sats[k++]=satno(sys,prn);
             }
         }
@@ -209,7 +197,7 @@ static void readsp3b(FILE *fp, char type, int *sats, int ns, double *bfact,
             if (strlen(buff)<4||(buff[0]!='P'&&buff[0]!='V')) continue;
 
             sys=buff[1]==' '?SYS_GPS:code2sys(buff[1]);
-            prn=(int)str2num(buff,2,2);
+            prn=str2int(buff,2,2);
             if      (sys==SYS_SBS) prn+=100;
             else if (sys==SYS_QZS) prn+=192; /* extension to sp3-c */
 
@@ -440,7 +428,7 @@ extern int code2bias_ix(int sys, int code) {
 
     sys_ix=sys2ix(sys);
     if (sys_ix<MAX_BIAS_SYS)
-        return code_bias_ix[sys_ix][code];
+        return code_bias_ix[sys_ix][code]-1;
     else
         return 0;
 }
@@ -519,8 +507,6 @@ extern int readdcb(const char *file, nav_t *nav, const sta_t *sta)
 
     trace(3,"readdcb : file=%s\n",file);
 
-    init_bias_ix(); /* init translation table from code to table column */
-
     for (i=0;i<MAXSAT;i++) for (j=0;j<MAX_CODE_BIAS_FREQS;j++) for (k=0;k<MAX_CODE_BIASES;k++) {
         nav->cbias[i][j][k]=0.0;
     }
@@ -555,12 +541,164 @@ static double interppol(const double *x, double *y, int n)
     }
     return y[0];
 }
+/* initialize precise ephemeris interpolation cache ----------------------------
+* initialize interpolation cache for precise ephemeris and clock
+* args   : nav_t  *nav      IO  navigation data
+* return : status (1:ok,0:error)
+* notes  : the cache holds interpolation windows of each satellite and the last
+*          interval indices of precise ephemeris and clock. they are reused by
+*          peph2pos() while time stays in the same interval and invalidated
+*          when nav->peph, nav->ne, nav->pclk or nav->nc is changed.
+*          the cache is updated by peph2pos() even for const nav, so a nav with
+*          cache should not be shared by concurrent threads.
+*-----------------------------------------------------------------------------*/
+extern int initpephc(nav_t *nav)
+{
+    trace(3,"initpephc:\n");
+
+    freepephc(nav);
+
+    if (!(nav->pephc=(pephc_t *)malloc(sizeof(pephc_t)))) {
+        trace(1,"initpephc: malloc error\n");
+        return 0;
+    }
+    nav->pephc->peph=NULL; nav->pephc->ne=0;
+    nav->pephc->pclk=NULL; nav->pephc->nc=0;
+    return 1;
+}
+/* free precise ephemeris interpolation cache ----------------------------------
+* free interpolation cache for precise ephemeris and clock
+* args   : nav_t  *nav      IO  navigation data
+* return : none
+*-----------------------------------------------------------------------------*/
+extern void freepephc(nav_t *nav)
+{
+    free(nav->pephc);
+    nav->pephc=NULL;
+}
+/* get valid interpolation cache ---------------------------------------------*/
+static pephc_t *getpephc(const nav_t *nav)
+{
+    pephc_t *c=nav->pephc;
+    int i;
+
+    if (!c) return NULL;
+
+    if (c->peph!=nav->peph||c->ne!=nav->ne||
+        (nav->ne>0&&timediff(c->te,nav->peph[0].time)!=0.0)) {
+        c->peph=nav->peph; c->ne=nav->ne;
+        if (nav->ne>0) c->te=nav->peph[0].time;
+        c->ie=-1;
+        for (i=0;i<MAXSAT;i++) c->win[i].i=-1;
+    }
+    if (c->pclk!=nav->pclk||c->nc!=nav->nc||
+        (nav->nc>0&&timediff(c->tc,nav->pclk[0].time)!=0.0)) {
+        c->pclk=nav->pclk; c->nc=nav->nc;
+        if (nav->nc>0) c->tc=nav->pclk[0].time;
+        c->ic=-1;
+    }
+    return c;
+}
+/* search interval index of precise ephemeris --------------------------------*/
+static int searchpeph(gtime_t time, const nav_t *nav, pephc_t *c)
+{
+    int i,j,k,index;
+
+    /* last interval as peph[index].time < time <= peph[index+1].time */
+    if (c&&c->ie>=0&&c->ie+1<nav->ne&&
+        timediff(nav->peph[c->ie].time,time)<0.0&&
+        timediff(nav->peph[c->ie+1].time,time)>=0.0) {
+        return c->ie;
+    }
+    /* binary search */
+    for (i=0,j=nav->ne-1;i<j;) {
+        k=(i+j)/2;
+        if (timediff(nav->peph[k].time,time)<0.0) i=k+1; else j=k;
+    }
+    index=i<=0?0:i-1;
+    if (c) c->ie=index;
+    return index;
+}
+/* search interval index of precise clock ------------------------------------*/
+static int searchpclk(gtime_t time, const nav_t *nav, pephc_t *c)
+{
+    int i,j,k,index;
+
+    /* last interval as pclk[index].time < time <= pclk[index+1].time */
+    if (c&&c->ic>=0&&c->ic+1<nav->nc&&
+        timediff(nav->pclk[c->ic].time,time)<0.0&&
+        timediff(nav->pclk[c->ic+1].time,time)>=0.0) {
+        return c->ic;
+    }
+    /* binary search */
+    for (i=0,j=nav->nc-1;i<j;) {
+        k=(i+j)/2;
+        if (timediff(nav->pclk[k].time,time)<0.0) i=k+1; else j=k;
+    }
+    index=i<=0?0:i-1;
+    if (c) c->ic=index;
+    return index;
+}
+/* set interpolation window of satellite -------------------------------------*/
+static void setpephw(const nav_t *nav, int sat, int i, pephw_t *w)
+{
+    const double *pos;
+    double sinl,cosl,d;
+    int j,k;
+
+    w->i=i;
+    w->stat=1;
+    w->t0=nav->peph[i+NMAX/2].time;
+
+    for (j=0;j<=NMAX;j++) {
+        pos=nav->peph[i+j].pos[sat-1];
+        if (norm(pos,3)<=0.0) {
+            w->stat=0;
+            return;
+        }
+        /* correction for earth rotation to reference time of window */
+        w->tau[j]=timediff(nav->peph[i+j].time,w->t0);
+        sinl=sin(OMGE*w->tau[j]);
+        cosl=cos(OMGE*w->tau[j]);
+        w->q[0][j]=cosl*pos[0]-sinl*pos[1];
+        w->q[1][j]=sinl*pos[0]+cosl*pos[1];
+        w->q[2][j]=pos[2];
+    }
+    for (j=0;j<=NMAX;j++) {
+        for (k=0,d=1.0;k<=NMAX;k++) {
+            if (k!=j) d*=w->tau[j]-w->tau[k];
+        }
+        w->w[j]=1.0/d;
+    }
+}
+/* polynomial interpolation by barycentric formula ---------------------------*/
+static void interpbary(const pephw_t *w, double dt, double *p)
+{
+    double a,sum=0.0;
+    int i,j;
+
+    for (i=0;i<3;i++) p[i]=0.0;
+
+    for (j=0;j<=NMAX;j++) {
+        if (dt==w->tau[j]) {
+            for (i=0;i<3;i++) p[i]=w->q[i][j];
+            return;
+        }
+        a=w->w[j]/(dt-w->tau[j]);
+        for (i=0;i<3;i++) p[i]+=a*w->q[i][j];
+        sum+=a;
+    }
+    for (i=0;i<3;i++) p[i]/=sum;
+}
 /* satellite position by precise ephemeris -----------------------------------*/
 static int pephpos(gtime_t time, int sat, const nav_t *nav, double *rs,
                    double *dts, double *vare, double *varc)
 {
-    double t[NMAX+1],p[3][NMAX+1],c[2],*pos,std=0.0,s[3],sinl,cosl;
-    int i,j,k,index;
+    double t[NMAX+1],p[3][NMAX+1],c[2],*pos,std=0.0,s[3],sinl,cosl,dt,q[3];
+    double t0,tn;
+    pephc_t *pc=getpephc(nav);
+    pephw_t *w;
+    int i,j,index;
 
     char tstr[40];
     trace(4,"pephpos : time=%s sat=%2d\n",time2str(time,tstr,3),sat);
@@ -573,43 +711,61 @@ static int pephpos(gtime_t time, int sat, const nav_t *nav, double *rs,
         trace(3,"no prec ephem %s sat=%2d\n",time2str(time,tstr,0),sat);
         return 0;
     }
-    /* binary search */
-    for (i=0,j=nav->ne-1;i<j;) {
-        k=(i+j)/2;
-        if (timediff(nav->peph[k].time,time)<0.0) i=k+1; else j=k;
-    }
-    index=i<=0?0:i-1;
+    index=searchpeph(time,nav,pc);
 
     /* polynomial interpolation for orbit */
     i=index-(NMAX+1)/2;
     if (i<0) i=0; else if (i+NMAX>=nav->ne) i=nav->ne-NMAX-1;
 
-    for (j=0;j<=NMAX;j++) {
-        t[j]=timediff(nav->peph[i+j].time,time);
-        if (norm(nav->peph[i+j].pos[sat-1],3)<=0.0) {
+    if (pc) { /* interpolation with cached window */
+        w=pc->win+sat-1;
+        if (w->i!=i) setpephw(nav,sat,i,w);
+        if (!w->stat) {
             trace(3,"prec ephem outage %s sat=%2d\n",time2str(time,tstr,0),sat);
             return 0;
         }
+        dt=timediff(time,w->t0);
+        interpbary(w,dt,q);
+
+        /* rotate from reference time of window to time */
+        sinl=sin(OMGE*dt);
+        cosl=cos(OMGE*dt);
+        rs[0]= cosl*q[0]+sinl*q[1];
+        rs[1]=-sinl*q[0]+cosl*q[1];
+        rs[2]=q[2];
+        t0=w->tau[0]-dt;
+        tn=w->tau[NMAX]-dt;
     }
-    for (j=0;j<=NMAX;j++) {
-        pos=nav->peph[i+j].pos[sat-1];
-        /* correction for earth rotation ver.2.4.0 */
-        sinl=sin(OMGE*t[j]);
-        cosl=cos(OMGE*t[j]);
-        p[0][j]=cosl*pos[0]-sinl*pos[1];
-        p[1][j]=sinl*pos[0]+cosl*pos[1];
-        p[2][j]=pos[2];
-    }
-    for (i=0;i<3;i++) {
-        rs[i]=interppol(t,p[i],NMAX+1);
+    else {
+        for (j=0;j<=NMAX;j++) {
+            t[j]=timediff(nav->peph[i+j].time,time);
+            if (norm(nav->peph[i+j].pos[sat-1],3)<=0.0) {
+                trace(3,"prec ephem outage %s sat=%2d\n",time2str(time,tstr,0),sat);
+                return 0;
+            }
+        }
+        for (j=0;j<=NMAX;j++) {
+            pos=nav->peph[i+j].pos[sat-1];
+            /* correction for earth rotation ver.2.4.0 */
+            sinl=sin(OMGE*t[j]);
+            cosl=cos(OMGE*t[j]);
+            p[0][j]=cosl*pos[0]-sinl*pos[1];
+            p[1][j]=sinl*pos[0]+cosl*pos[1];
+            p[2][j]=pos[2];
+        }
+        for (i=0;i<3;i++) {
+            rs[i]=interppol(t,p[i],NMAX+1);
+        }
+        t0=t[0];
+        tn=t[NMAX];
     }
     if (vare) {
         for (i=0;i<3;i++) s[i]=nav->peph[index].std[sat-1][i];
         std=norm(s,3);
 
         /* extrapolation error for orbit */
-        if      (t[0   ]>0.0) std+=EXTERR_EPH*SQR(t[0   ])/2.0;
-        else if (t[NMAX]<0.0) std+=EXTERR_EPH*SQR(t[NMAX])/2.0;
+        if      (t0>0.0) std+=EXTERR_EPH*SQR(t0)/2.0;
+        else if (tn<0.0) std+=EXTERR_EPH*SQR(tn)/2.0;
         *vare=SQR(std);
     }
     /* linear interpolation for clock */
@@ -644,7 +800,7 @@ static int pephclk(gtime_t time, int sat, const nav_t *nav, double *dts,
                    double *varc)
 {
     double t[2],c[2],std;
-    int i,j,k,index;
+    int i,index;
 
     char tstr[40];
     trace(4,"pephclk : time=%s sat=%2d\n",time2str(time,tstr,3),sat);
@@ -655,12 +811,7 @@ static int pephclk(gtime_t time, int sat, const nav_t *nav, double *dts,
         trace(3,"no prec clock %s sat=%2d\n",time2str(time,tstr,0),sat);
         return 1;
     }
-    /* binary search */
-    for (i=0,j=nav->nc-1;i<j;) {
-        k=(i+j)/2;
-        if (timediff(nav->pclk[k].time,time)<0.0) i=k+1; else j=k;
-    }
-    index=i<=0?0:i-1;
+    index=searchpclk(time,nav,getpephc(nav));
 
     /* linear interpolation for clock */
     t[0]=timediff(time,nav->pclk[index  ].time);
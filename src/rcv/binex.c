@@ -1247,12 +1247,12 @@ extern int input_bnxf(raw_t *raw, FILE *fp)
     
     if (raw->nbyte==0) {
         for (i=0;;i++) {
-            if ((data=fgetc(fp))==EOF) return -2;
+            if ((data=getc_fbuf(&raw->fbuf,fp))==EOF) return -2;
             if (sync_bnx(raw->buff,(uint8_t)data)) break;
             if (i>=4096) return 0;
         }
     }
-    if (fread(raw->buff+2,1,4,fp)<4) return -2;
+    if (read_fbuf(&raw->fbuf,fp,raw->buff+2,4)<4) return -2;
     
     len_h=getbnxi(raw->buff+2,&len);
     
@@ -1265,7 +1265,7 @@ extern int input_bnxf(raw_t *raw, FILE *fp)
     }
     len_c=(raw->len-1<128)?1:2;
     
-    if (fread(raw->buff+6,1,raw->len+len_c-6,fp)<(size_t)(raw->len+len_c-6)) {
+    if (read_fbuf(&raw->fbuf,fp,raw->buff+6,raw->len+len_c-6)<raw->len+len_c-6) {
         return -2;
     }
     raw->nbyte=0;
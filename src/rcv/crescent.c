@@ -610,12 +610,12 @@ extern int input_cresf(raw_t *raw, FILE *fp)
     /* synchronize frame */
     if (raw->nbyte==0) {
         for (i=0;;i++) {
-            if ((data=fgetc(fp))==EOF) return -2;
+            if ((data=getc_fbuf(&raw->fbuf,fp))==EOF) return -2;
             if (sync_cres(raw->buff,(uint8_t)data)) break;
             if (i>=4096) return 0;
         }
     }
-    if (fread(raw->buff+4,1,4,fp)<4) return -2;
+    if (read_fbuf(&raw->fbuf,fp,raw->buff+4,4)<4) return -2;
     raw->nbyte=8;
     
     if ((raw->len=U2(raw->buff+6)+12)>MAXRAWLEN) {
@@ -623,7 +623,7 @@ extern int input_cresf(raw_t *raw, FILE *fp)
         raw->nbyte=0;
         return -1;
     }
-    if (fread(raw->buff+8,1,raw->len-8,fp)<(size_t)(raw->len-8)) return -2;
+    if (read_fbuf(&raw->fbuf,fp,raw->buff+8,raw->len-8)<raw->len-8) return -2;
     raw->nbyte=0;
     
     /* decode crescent raw message */
@@ -1869,7 +1869,7 @@ extern int input_javadf(raw_t *raw, FILE *fp)
     /* synchronize message */
     if (raw->nbyte==0) {
         for (i=0;;i++) {
-            if ((data=fgetc(fp))==EOF) return endfile(raw);
+            if ((data=getc_fbuf(&raw->fbuf,fp))==EOF) return endfile(raw);
             if (sync_javad(raw->buff,(uint8_t)data)) break;
             if (i>=4096) return 0;
         }
@@ -1882,7 +1882,7 @@ extern int input_javadf(raw_t *raw, FILE *fp)
     raw->len=len+5;
     raw->nbyte=5;
     
-    if (fread(raw->buff+5,1,raw->len-5,fp)<(size_t)(raw->len-5)) {
+    if (read_fbuf(&raw->fbuf,fp,raw->buff+5,raw->len-5)<raw->len-5) {
         return endfile(raw);
     }
     /* decode javad raw message */
@@ -1445,12 +1445,12 @@ extern int input_oem4f(raw_t *raw, FILE *fp)
     /* synchronize frame */
     if (raw->nbyte==0) {
         for (i=0;;i++) {
-            if ((data=fgetc(fp))==EOF) return -2;
+            if ((data=getc_fbuf(&raw->fbuf,fp))==EOF) return -2;
             if (sync_oem4(raw->buff,(uint8_t)data)) break;
             if (i>=4096) return 0;
         }
     }
-    if (fread(raw->buff+3,7,1,fp)<1) return -2;
+    if (read_fbuf(&raw->fbuf,fp,raw->buff+3,7)<7) return -2;
     raw->nbyte=10;
     
     if ((raw->len=U2(raw->buff+8)+OEM4HLEN)>MAXRAWLEN-4) {
@@ -1458,7 +1458,7 @@ extern int input_oem4f(raw_t *raw, FILE *fp)
         raw->nbyte=0;
         return -1;
     }
-    if (fread(raw->buff+10,raw->len-6,1,fp)<1) return -2;
+    if (read_fbuf(&raw->fbuf,fp,raw->buff+10,raw->len-6)<raw->len-6) return -2;
     raw->nbyte=0;
     
     /* decode NovAtel OEM4/V/6/7 message */
@@ -1479,12 +1479,12 @@ extern int input_oem3f(raw_t *raw, FILE *fp)
     /* synchronize frame */
     if (raw->nbyte==0) {
         for (i=0;;i++) {
-            if ((data=fgetc(fp))==EOF) return -2;
+            if ((data=getc_fbuf(&raw->fbuf,fp))==EOF) return -2;
             if (sync_oem3(raw->buff,(uint8_t)data)) break;
             if (i>=4096) return 0;
         }
     }
-    if (fread(raw->buff+3,1,9,fp)<9) return -2;
+    if (read_fbuf(&raw->fbuf,fp,raw->buff+3,9)<9) return -2;
     raw->nbyte=12;
     
     if ((raw->len=U4(raw->buff+8))>MAXRAWLEN) {
@@ -1492,7 +1492,7 @@ extern int input_oem3f(raw_t *raw, FILE *fp)
         raw->nbyte=0;
         return -1;
     }
-    if (fread(raw->buff+12,1,raw->len-12,fp)<(size_t)(raw->len-12)) return -2;
+    if (read_fbuf(&raw->fbuf,fp,raw->buff+12,raw->len-12)<raw->len-12) return -2;
     raw->nbyte=0;
     
     /* decode oem3 message */
@@ -509,14 +509,14 @@ extern int input_nvsf(raw_t *raw, FILE *fp)
     
     /* synchronize frame */
     for (i=0;;i++) {
-        if ((data=fgetc(fp))==EOF) return -2;
+        if ((data=getc_fbuf(&raw->fbuf,fp))==EOF) return -2;
         
         /* Search a 0x10 */
         if (data==NVSSYNC) {
             
             /* Store the frame begin */
             raw->buff[0] = data;
-            if ((data=fgetc(fp))==EOF) return -2;
+            if ((data=getc_fbuf(&raw->fbuf,fp))==EOF) return -2;
             
             /* Discard double 0x10 and 0x10 0x03 */
             if ((data != NVSSYNC) && (data != NVSENDMSG)) {
@@ -528,7 +528,7 @@ extern int input_nvsf(raw_t *raw, FILE *fp)
     }
     raw->nbyte = 2;
     for (i=0;;i++) {
-        if ((data=fgetc(fp))==EOF) return -2;
+        if ((data=getc_fbuf(&raw->fbuf,fp))==EOF) return -2;
         if (data==NVSSYNC) odd=(odd+1)%2;
         if ((data!=NVSSYNC) || odd) {
             
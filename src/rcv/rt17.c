@@ -731,7 +731,7 @@ EXPORT int input_rt17f(raw_t *Raw, FILE *fp)
     
     for (i = 0; i < 4096; i++)
     {
-        if ((Data = fgetc(fp)) == EOF) return -2;
+        if ((Data = getc_fbuf(&Raw->fbuf, fp)) == EOF) return -2;
             if ((Ret = input_rt17(Raw, (uint8_t) Data))) return Ret;
     }
 
@@ -4173,7 +4173,7 @@ extern int input_sbff(raw_t *raw, FILE *fp)
     /* go to the beginning of the first block */
     if (raw->nbyte == 0) {
         for (i=0;;i++) {
-            data=fgetc(fp);
+            data=getc_fbuf(&raw->fbuf, fp);
             if (data == EOF) return -2;
             if (sync_sbf(raw->buff, (unsigned char)data)) break;
             if (i >= MAXRAWLEN) return 0;
@@ -4182,7 +4182,7 @@ extern int input_sbff(raw_t *raw, FILE *fp)
 
     /* load block header content (8 bytes) in raw->buff */
     /* since we already read the first two, we just read the next 6 bytes */
-    if (fread(raw->buff+2, 1, 6, fp) < 6) return -2;
+    if (read_fbuf(&raw->fbuf, fp, raw->buff+2, 6) < 6) return -2;
     raw->nbyte = 8;
 
     /* decode the length of the block and store it in len*/
@@ -4194,7 +4194,7 @@ extern int input_sbff(raw_t *raw, FILE *fp)
 
     /* let's store in raw->buff the whole block of length len */
     /* 8 bytes have been already read, we read raw->len-8 more */
-    if (fread(raw->buff+8, 1, raw->len-8, fp) < (size_t)(raw->len-8)) return -2;
+    if (read_fbuf(&raw->fbuf, fp, raw->buff+8, raw->len-8) < raw->len-8) return -2;
     raw->nbyte = 0;           /* this indicates where we point inside raw->buff */
 
     /* decode SBF block */
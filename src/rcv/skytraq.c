@@ -833,12 +833,12 @@ extern int input_stqf(raw_t *raw, FILE *fp)
     /* synchronize frame */
     if (raw->nbyte==0) {
         for (i=0;;i++) {
-            if ((data=fgetc(fp))==EOF) return -2;
+            if ((data=getc_fbuf(&raw->fbuf,fp))==EOF) return -2;
             if (sync_stq(raw->buff,(uint8_t)data)) break;
             if (i>=4096) return 0;
         }
     }
-    if (fread(raw->buff+2,1,2,fp)<2) return -2;
+    if (read_fbuf(&raw->fbuf,fp,raw->buff+2,2)<2) return -2;
     raw->nbyte=4;
     
     if ((raw->len=U2(raw->buff+2)+7)>MAXRAWLEN) {
@@ -846,7 +846,7 @@ extern int input_stqf(raw_t *raw, FILE *fp)
         raw->nbyte=0;
         return -1;
     }
-    if (fread(raw->buff+4,1,raw->len-4,fp)<(size_t)(raw->len-4)) return -2;
+    if (read_fbuf(&raw->fbuf,fp,raw->buff+4,raw->len-4)<raw->len-4) return -2;
     raw->nbyte=0;
     
     /* decode skytraq raw message */
@@ -9,6 +9,7 @@
  * version : $Revision: 1.0 $ $Date: 2017/01/30 09:00:00 $
  *
  * history : 2017/01/30  1.0  begin writing
+ *           2026/10/16  1.1  decode json payload to local buffer for reentrancy
   *-----------------------------------------------------------------------------*/
 #include "rtklib.h"
 
@@ -272,7 +273,6 @@ static const uint8_t decoding_table[256] = {
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
     0x00, 0x00, 0x00, 0x00};
 
-static uint8_t puPayloadTmp[256];
 
 static const gtime_t time0 = {0};
 
@@ -1476,7 +1476,7 @@ extern int input_sbpf(raw_t *raw, FILE *fp) {
   /* go to the beginning of the first block */
   if (raw->nbyte == 0) {
     for (i = 0;; i++) {
-      if ((data = fgetc(fp)) == EOF) return endfile(raw);
+      if ((data = getc_fbuf(&raw->fbuf, fp)) == EOF) return endfile(raw);
       if (sync_sbp(raw->buff, (uint8_t)data)) break;
       if (i >= MAXRAWLEN) return 0;
     }
@@ -1484,7 +1484,7 @@ extern int input_sbpf(raw_t *raw, FILE *fp) {
 
   /* load block header content (8 bytes) in raw->buff */
   /* since we already read the first byte, we just read the next 5 bytes */
-  if (fread(raw->buff + 1, 1, 5, fp) < 5) return endfile(raw);
+  if (read_fbuf(&raw->fbuf, fp, raw->buff + 1, 5) < 5) return endfile(raw);
   raw->nbyte = 6;
 
   /* decode the length of the block and store it in len */
@@ -1496,7 +1496,7 @@ extern int input_sbpf(raw_t *raw, FILE *fp) {
 
   /* let's store in raw->buff the whole block of length len */
   /* 8 bytes have been already read, we read raw->len-8 more */
-  if (fread(raw->buff + 6, 1, raw->len - 6, fp) < (size_t)(raw->len - 6))
+  if (read_fbuf(&raw->fbuf, fp, raw->buff + 6, raw->len - 6) < raw->len - 6)
     return endfile(raw);
 
   /* decode SBF block */
@@ -1518,7 +1518,7 @@ extern int input_sbpjsonf(raw_t *raw, FILE *fp) {
   const char JSON_SENDER_FIELD[] = "\"sender\":";
   const char JSON_PAYLOAD_FIELD[] = "\"payload\":";
   const char JSON_CRC_FIELD[] = "\"crc\":";
-  uint8_t *pcPayloadBeg, *pcPayloadEnd;
+  uint8_t *pcPayloadBeg, *pcPayloadEnd, puPayloadTmp[256];
   int stat, iRet;
   uint32_t uPayloadSize, uMsgType, uSender, uMsgCrc, uLength;
   char *pcTmp;
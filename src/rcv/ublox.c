@@ -75,6 +75,8 @@
 *                           support QZSS L1S (CODE_L1Z)
 *                           CODE_L1I -> CODE_L2I for BDS B1I (RINEX 3.04)
 *                           use integer types in stdint.h
+*           2026/10/16 1.29 save previous carrier phase of TRK-MEAS/TRK-D5 in
+*                           raw_t instead of static variables for reentrancy
 *-----------------------------------------------------------------------------*/
 #define _POSIX_C_SOURCE 199506
 #include "rtklib.h"
@@ -586,7 +588,7 @@ static int decode_navtime(raw_t *raw)
 /* decode UBX-TRK-MEAS: trace measurement data (unofficial) ------------------*/
 static int decode_trkmeas(raw_t *raw)
 {
-    static double adrs[MAXSAT]={0};
+    double *adrs=raw->adrs;
     uint8_t *p=raw->buff+6;
     gtime_t time;
     double ts,tr=-1.0,t,tau,utc_gpst,snr,adr,dop;
@@ -726,7 +728,7 @@ static int decode_trkmeas(raw_t *raw)
 /* decode UBX-TRKD5: trace measurement data (unofficial) ---------------------*/
 static int decode_trkd5(raw_t *raw)
 {
-    static double adrs[MAXSAT]={0};
+    double *adrs=raw->adrs;
     gtime_t time;
     double ts,tr=-1.0,t,tau,adr,dop,snr,utc_gpst;
     int i,j,n=0,type,off,len,sys,prn,sat,qi,frq,flag,week;
@@ -1473,12 +1475,12 @@ extern int input_ubxf(raw_t *raw, FILE *fp)
     /* synchronize frame */
     if (raw->nbyte==0) {
         for (i=0;;i++) {
-            if ((data=fgetc(fp))==EOF) return -2;
+            if ((data=getc_fbuf(&raw->fbuf,fp))==EOF) return -2;
             if (sync_ubx(raw->buff,(uint8_t)data)) break;
             if (i>=4096) return 0;
         }
     }
-    if (fread(raw->buff+2,1,4,fp)<4) return -2;
+    if (read_fbuf(&raw->fbuf,fp,raw->buff+2,4)<4) return -2;
     raw->nbyte=6;
     
     if ((raw->len=U2(raw->buff+4)+8)>MAXRAWLEN) {
@@ -1486,7 +1488,7 @@ extern int input_ubxf(raw_t *raw, FILE *fp)
         raw->nbyte=0;
         return -1;
     }
-    if (fread(raw->buff+6,1,raw->len-6,fp)<(size_t)(raw->len-6)) return -2;
+    if (read_fbuf(&raw->fbuf,fp,raw->buff+6,raw->len-6)<raw->len-6) return -2;
     raw->nbyte=0;
     
     /* decode ubx raw message */
@@ -926,12 +926,12 @@ extern int input_unicoref(raw_t* raw, FILE* fp)
     /* synchronize frame */
     if (raw->nbyte == 0) {
         for (i = 0;; i++) {
-            if ((data = fgetc(fp)) == EOF) return -2;
+            if ((data = getc_fbuf(&raw->fbuf, fp)) == EOF) return -2;
             if (sync_unicore(raw->buff, (uint8_t)data)) break;
             if (i >= 4096) return 0;
         }
     }
-    if (fread(raw->buff + 3, 7, 1, fp) < 1) return -2;
+    if (read_fbuf(&raw->fbuf, fp, raw->buff + 3, 7) < 7) return -2;
     raw->nbyte = 10;
 
     if ((raw->len = U2(raw->buff + 6) + HLEN) > MAXRAWLEN - 4) {
@@ -939,7 +939,7 @@ extern int input_unicoref(raw_t* raw, FILE* fp)
         raw->nbyte = 0;
         return -1;
     }
-    if (fread(raw->buff + 10, raw->len - 6, 1, fp) < 1) return -2;
+    if (read_fbuf(&raw->fbuf, fp, raw->buff + 10, raw->len - 6) < raw->len - 6) return -2;
     raw->nbyte = 0;
 
     return decode_unicore(raw);
@@ -48,6 +48,8 @@
 *                           update references [1], [3] and [4]
 *                           add reference [6]
 *                           use integer types in stdint.h
+*           2026/10/16 1.18 read file by blocks in input_rawf()
+*                           initialize raw->adrs[] in init_raw()
 *-----------------------------------------------------------------------------*/
 #include "rtklib.h"
 
@@ -1322,10 +1324,12 @@ extern int init_raw(raw_t *raw, int format)
             raw->lockflag[i][j]=0;
         }
         raw->icpp[i]=raw->off[i]=raw->prCA[i]=raw->dpCA[i]=0.0;
+        raw->adrs[i]=0.0;
     }
     for (i=0;i<MAXOBS;i++) raw->freqn[i]=0;
     raw->icpc=0.0;
     raw->nbyte=raw->len=0;
+    init_fbuf(&raw->fbuf);
     raw->iod=raw->flag=raw->tbase=raw->outtype=0;
     raw->tod=-1;
     for (i=0;i<MAXRAWLEN;i++) raw->buff[i]=0;
@@ -1339,6 +1343,7 @@ extern int init_raw(raw_t *raw, int format)
     raw->nav.alm  =NULL;
     raw->nav.geph =NULL;
     raw->nav.seph =NULL;
+    raw->nav.eidx =NULL;
     raw->rcv_data =NULL;
     
     if (!(raw->obs.data =(obsd_t *)malloc(sizeof(obsd_t)*MAXOBS))||
@@ -1407,6 +1412,7 @@ extern void free_raw(raw_t *raw)
     free(raw->nav.alm  ); raw->nav.alm  =NULL; raw->nav.na=raw->nav.namax=0;
     free(raw->nav.geph ); raw->nav.geph =NULL; raw->nav.ng=raw->nav.ngmax=0;
     free(raw->nav.seph ); raw->nav.seph =NULL; raw->nav.ns=raw->nav.nsmax=0;
+    free_fbuf(&raw->fbuf);
     
     /* free receiver dependent data */
     switch (raw->format) {
@@ -1451,6 +1457,10 @@ extern int input_raw(raw_t *raw, int format, uint8_t data)
 *          int    format I      receiver raw data format (STRFMT_???)
 *          FILE   *fp    I      file pointer
 * return : status(-2: end of file/format error, -1...31: same as above)
+* notes  : the file is read by blocks through the file input buffer
+*          (raw->fbuf). open and close the file by fopen_fbuf() and
+*          fclose_fbuf() with raw->fbuf, or call free_fbuf(&raw->fbuf) when
+*          the file is changed.
 *-----------------------------------------------------------------------------*/
 extern int input_rawf(raw_t *raw, int format, FILE *fp)
 {
@@ -116,6 +116,10 @@
 *                           use API code2idx() to get frequency index
 *                           use integer types in stdint.h
 *                           suppress warnings
+*           2026/10/16 1.31 decode RINEX 3 observation data by epoch chunks
+*                           in parallel threads
+*                           use str2int() for integer fields
+*                           add API open_rnxobs(),input_rnxobs(),close_rnxobs()
 *-----------------------------------------------------------------------------*/
 #include "rtklib.h"
 
@@ -129,6 +133,9 @@
 #define MINFREQ_GLO -7                  /* min frequency number GLONASS */
 #define MAXFREQ_GLO 13                  /* max frequency number GLONASS */
 #define NINCOBS     262144              /* incremental number of obs data */
+#define RNXNTHREAD  4                   /* number of threads to decode obs data */
+#define RNXWINSIZE  (RNXNTHREAD<<22)    /* window of obs data decoded in parallel */
+#define RNXMINPAR   (1<<20)             /* min size of obs data decoded in parallel */
 
 static const int navsys[RNX_NUMSYS]={ /* satellite systems */
     SYS_GPS,SYS_GLO,SYS_GAL,SYS_QZS,SYS_SBS,SYS_CMP,SYS_IRN
@@ -157,6 +164,45 @@ typedef struct {                        /* signal index type */
     double shift[MAXOBSTYPE];           /* phase shift (cycle) */
 } sigind_t;
 
+typedef struct {                        /* decoded observation epoch type */
+    int n;                              /* number of observation data */
+    int flag;                           /* epoch flag */
+    int t0;                             /* time of first data set (0:no,1:yes) */
+    gtime_t time;                       /* epoch time or event time */
+} rnxrec_t;
+
+typedef struct {                        /* observation data chunk type */
+    const char *p,*end;                 /* chunk of observation data body */
+    double ver;                         /* RINEX version */
+    int mask;                           /* satellite system mask */
+    sigind_t *index;                    /* signal index */
+    int last;                           /* last chunk of file (0:no,1:yes) */
+    int stat;                           /* status (1:ok,0:sequential,-1:error) */
+    int nrec,nrmax;                     /* number of epochs/allocated */
+    rnxrec_t *rec;                      /* decoded epochs */
+    int nd,ndmax;                       /* number of obs data/allocated */
+    obsd_t *data;                       /* decoded obs data */
+} rnxchunk_t;
+
+typedef struct {                        /* parallel observation data reader type */
+    int mode;                           /* read mode (0:sequential,1:parallel) */
+    int nwin;                           /* number of windows read */
+    char *buff;                         /* window buffer */
+    int nc;                             /* number of chunks in window */
+    int ic,ir,id;                       /* current chunk/epoch/data index */
+    int mask;                           /* satellite system mask */
+    sigind_t index[RNX_NUMSYS];         /* signal index */
+    rnxchunk_t c[RNXNTHREAD];           /* chunks in window */
+} rnxpar_t;
+
+typedef struct {                        /* observation epoch reader state type */
+    uint8_t slips[MAXSAT][NFREQ+NEXOBS]; /* cycle slips */
+    gtime_t time1;                      /* time of last epoch */
+    double dtime1;                      /* interval of last epoch (s) */
+    int n1;                             /* number of obs data of last epoch */
+    int nobs;                           /* number of obs data output */
+} rnxost_t;
+
 /* adjust time considering week handover -------------------------------------*/
 static gtime_t adjweek(gtime_t t, gtime_t t0)
 {
@@ -413,7 +459,7 @@ static void decode_obsh(FILE *fp, char *buff, double ver, int *tsys,
             return;
         }
         i=(int)(p-syscodes);
-        n=(int)str2num(buff,3,3);
+        n=str2int(buff,3,3);
         for (j=nt=0,k=7;j<n;j++,k+=4) {
             if (k>58) {
                 if (!fgets(buff,MAXRNXLEN,fp)) break;
@@ -450,7 +496,7 @@ static void decode_obsh(FILE *fp, char *buff, double ver, int *tsys,
     }
     else if (strstr(label,"WAVELENGTH FACT L1/2")) ; /* opt ver.2 */
     else if (strstr(label,"# / TYPES OF OBSERV" )) { /* ver.2 */
-        n=(int)str2num(buff,0,6);
+        n=str2int(buff,0,6);
         for (i=nt=0,j=10;i<n;i++,j+=6) {
             if (j>58) {
                 if (!fgets(buff,MAXRNXLEN,fp)) break;
@@ -490,8 +536,8 @@ static void decode_obsh(FILE *fp, char *buff, double ver, int *tsys,
     else if (strstr(label,"GLONASS SLOT / FRQ #")) { /* ver.3.02 */
         for (i=0;i<8;i++) {
             if (buff[4+i*7]!='R') continue;
-            prn=(int)str2num(buff,5+i*7,2);
-            fcn=(int)str2num(buff,8+i*7,2);
+            prn=str2int(buff,5+i*7,2);
+            fcn=str2int(buff,8+i*7,2);
             if (prn<1||prn>MAXPRNGLO||fcn<-7||fcn>6) continue;
             if (nav) nav->glo_fcn[prn-1]=fcn+8;
         }
@@ -722,14 +768,14 @@ static int decode_obsepoch(FILE *fp, char *buff, double ver, gtime_t *time,
 
     if (ver<=2.99) { /* ver.2 */
         /* epoch flag: 3:new site,4:header info,5:external event */
-        *flag=(int)str2num(buff,28,1);
+        *flag=str2int(buff,28,1);
 
         /* handle external event */
         if (*flag == 5) {
             str2time(buff,0,26,time);
         }
 
-        if ((n=(int)str2num(buff,29,3))<=0) return 0;
+        if ((n=str2int(buff,29,3))<=0) return 0;
 
         if (3<=*flag&&*flag<=5) return n;
 
@@ -749,14 +795,14 @@ static int decode_obsepoch(FILE *fp, char *buff, double ver, gtime_t *time,
         }
     }
     else { /* ver.3 */
-        *flag=(int)str2num(buff,31,1);
+        *flag=str2int(buff,31,1);
 
         /* handle external event */
         if (*flag == 5) {
             str2time(buff,1,28,time);
         }
 
-        if ((n=(int)str2num(buff,32,3))<=0) return 0;
+        if ((n=str2int(buff,32,3))<=0) return 0;
 
         if (3<=*flag&&*flag<=5) return n;
 
@@ -1041,20 +1087,10 @@ static void set_index(double ver, int sys, const char *opt,
     }
 #endif
 }
-/* read RINEX observation data body ------------------------------------------*/
-static int readrnxobsb(FILE *fp, const char *opt, double ver, int *tsys,
-                       char tobs[][MAXOBSTYPE][4], int *flag, obsd_t *data,
-                       sta_t *sta)
+/* set signal index of all systems ------------------------------------------*/
+static void set_indexes(double ver, const char *opt,
+                        char tobs[][MAXOBSTYPE][4], sigind_t *index)
 {
-    gtime_t time={0};
-    sigind_t index[RNX_NUMSYS]={{0}};
-    char buff[MAXRNXLEN];
-    int i=0,n=0,nsat=0,sats[MAXOBS]={0},mask;
-    
-    /* set system mask */
-    mask=set_sysmask(opt);
-
-    /* set signal index */
 #if RNX_NUMSYS>=1
     set_index(ver,SYS_GPS,opt,tobs[RNX_SYS_GPS],index  );
 #endif
@@ -1076,6 +1112,22 @@ static int readrnxobsb(FILE *fp, const char *opt, double ver, int *tsys,
 #if RNX_NUMSYS>=7
     set_index(ver,SYS_IRN,opt,tobs[RNX_SYS_IRN],index+6);
 #endif
+}
+/* read RINEX observation data body ------------------------------------------*/
+static int readrnxobsb(FILE *fp, const char *opt, double ver, int *tsys,
+                       char tobs[][MAXOBSTYPE][4], int *flag, obsd_t *data,
+                       sta_t *sta)
+{
+    gtime_t time={0};
+    sigind_t index[RNX_NUMSYS]={{0}};
+    char buff[MAXRNXLEN];
+    int i=0,n=0,nsat=0,sats[MAXOBS]={0},mask;
+    
+    /* set system mask */
+    mask=set_sysmask(opt);
+
+    /* set signal index */
+    set_indexes(ver,opt,tobs,index);
     
     /* read record */
     while (fgets(buff,MAXRNXLEN,fp)) {
@@ -1106,69 +1158,347 @@ static int readrnxobsb(FILE *fp, const char *opt, double ver, int *tsys,
     }
     return -1;
 }
-/* read RINEX observation data -----------------------------------------------*/
-static int readrnxobs(FILE *fp, gtime_t ts, gtime_t te, double tint,
-                      const char *opt, int rcv, double ver, int *tsys,
-                      char tobs[][MAXOBSTYPE][4], obs_t *obs, sta_t *sta)
+/* read line from memory as fgets() -----------------------------------------*/
+static const char *memgets(char *buff, int size, const char *p, const char *end)
 {
-    gtime_t eventime={0},time0={0},time1={0};
-    obsd_t *data;
-    uint8_t slips[MAXSAT][NFREQ+NEXOBS]={{0}};
-    int i,n,n1=0,flag=0,stat=0;
-    double dtime1=0;
+    int i=0;
 
-    trace(4,"readrnxobs: rcv=%d ver=%.2f tsys=%d\n",rcv,ver,*tsys);
+    if (p>=end) return NULL;
+    while (i<size-1&&p<end) {
+        if ((buff[i++]=*p++)=='\n') break;
+    }
+    buff[i]='\0';
+    return p;
+}
+/* add decoded observation epoch to chunk ------------------------------------*/
+static int addrnxrec(rnxchunk_t *c, int n, int flag, int t0, gtime_t time)
+{
+    rnxrec_t *rec;
 
-    if (!obs||rcv>MAXRCV) return 0;
+    if (c->nrmax<=c->nrec) {
+        c->nrmax=c->nrmax<=0?4096:c->nrmax*2;
+        if (!(rec=(rnxrec_t *)realloc(c->rec,sizeof(rnxrec_t)*c->nrmax))) {
+            c->stat=-1;
+            return 0;
+        }
+        c->rec=rec;
+    }
+    rec=c->rec+c->nrec++;
+    rec->n=n;
+    rec->flag=flag;
+    rec->t0=t0;
+    rec->time=time;
+    return 1;
+}
+/* decode observation data chunk -----------------------------------------------
+* decode epochs in a chunk of RINEX 3 observation data body as readrnxobsb().
+* the chunk is not decoded in parallel (stat=0) if it contains header records
+* (epoch flag 3 or 4) or ends in the middle of an epoch
+*-----------------------------------------------------------------------------*/
+static void decodechunk(rnxchunk_t *c)
+{
+    gtime_t time={0};
+    obsd_t *data,*d;
+    char buff[MAXRNXLEN];
+    const char *p=c->p;
+    int i=0,n=0,nsat=0,flag=0,t0=0,sats[MAXOBS]={0};
 
-    if (!(data=(obsd_t *)malloc(sizeof(obsd_t)*MAXOBS))) return 0;
+    c->nrec=c->nd=0;
+    c->stat=1;
 
-    /* read RINEX observation data body */
-    while ((n=readrnxobsb(fp,opt,ver,tsys,tobs,&flag,data,sta))>=0&&stat>=0) {
+    while ((p=memgets(buff,MAXRNXLEN,p,c->end))) {
+
+        /* decode observation epoch */
+        if (i==0) {
+            if ((nsat=decode_obsepoch(NULL,buff,c->ver,&time,&flag,sats))<=0&&
+                flag!=5) {
+                continue;
+            }
+            if (flag==5) {
+                if (!addrnxrec(c,0,flag,0,time)) return;
+                continue;
+            }
+            if (flag==3||flag==4) {
+                c->stat=0;
+                return;
+            }
+            if (c->ndmax<c->nd+MAXOBS) {
+                c->ndmax=c->nd+MAXOBS>c->ndmax*2?c->nd+MAXOBS:c->ndmax*2;
+                if (!(data=(obsd_t *)realloc(c->data,sizeof(obsd_t)*c->ndmax))) {
+                    c->stat=-1;
+                    return;
+                }
+                c->data=data;
+            }
+            n=t0=0;
+        }
+        else if ((flag<=2||flag==6)&&n<MAXOBS) {
+            d=c->data+c->nd+n;
+            memset(d,0,sizeof(obsd_t));
+            d->time=time;
+            d->sat=(uint8_t)sats[i-1];
+            if (n==0) t0=1;
 
-        if (flag == 5) {
-            eventime = data[0].eventime;
-            n = readrnxobsb(fp,opt,ver,tsys,tobs,&flag,data,sta);
-            if (fabs(timediff(data[0].time,time1)-dtime1)>=DTTOL)
-                n = readrnxobsb(fp,opt,ver,tsys,tobs,&flag,data,sta);
+            /* decode RINEX observation data */
+            if (decode_obsdata(NULL,buff,c->ver,c->mask,c->index,d)) n++;
+        }
+        if (++i>nsat) {
+            if (!addrnxrec(c,n,flag,t0,time)) return;
+            c->nd+=n;
+            i=0;
         }
+    }
+    if (i>0&&!c->last) c->stat=0;
+}
+/* decode observation data chunk thread --------------------------------------*/
+#ifdef WIN32
+static DWORD WINAPI decodechunkthread(void *arg)
+#else
+static void *decodechunkthread(void *arg)
+#endif
+{
+    decodechunk((rnxchunk_t *)arg);
+    return 0;
+}
+/* decode observation data chunks in parallel --------------------------------*/
+static void decodechunks(rnxpar_t *r)
+{
+    rtklib_thread_t thread[RNXNTHREAD];
+    int i,stat[RNXNTHREAD]={0};
 
-        if (eventime.time==0 || obs->n-n1<=0 || timediff(eventime,time1)>=0) {
-           for (i=0;i<n;i++) data[i].eventime = eventime;
-        }  else {
-           /* add event to previous epoch if delayed */
-            for (i=0;i<n1;i++) obs->data[obs->n-i-1].eventime = eventime;
-            for (i=0;i<n;i++) data[i].eventime=time0;
+    for (i=1;i<r->nc;i++) {
+#ifdef WIN32
+        stat[i]=(thread[i]=CreateThread(NULL,0,decodechunkthread,r->c+i,0,NULL))!=NULL;
+#else
+        stat[i]=!pthread_create(thread+i,NULL,decodechunkthread,r->c+i);
+#endif
+    }
+    decodechunk(r->c);
+
+    for (i=1;i<r->nc;i++) {
+        if (!stat[i]) {
+            decodechunk(r->c+i);
+            continue;
         }
-        /* set to zero eventime for the next iteration */
-        eventime.time = 0;
-        eventime.sec = 0;
+#ifdef WIN32
+        WaitForSingleObject(thread[i],INFINITE);
+        CloseHandle(thread[i]);
+#else
+        pthread_join(thread[i],NULL);
+#endif
+    }
+}
+/* read and decode window of observation data ----------------------------------
+* read a window of observation data body split at epoch records and decode it
+* by chunks in parallel. return 1:ok,0:read sequentially from the window,-1:end
+*-----------------------------------------------------------------------------*/
+static int readrnxwin(FILE *fp, double ver, rnxpar_t *r)
+{
+    const char *end;
+    long pos;
+    size_t i,len,n,k;
+    int last;
 
-        for (i=0;i<n;i++) {
+    r->nc=r->ic=r->ir=r->id=0;
+
+    if ((pos=ftell(fp))<0) return 0;
 
-            /* UTC -> GPST */
-            if (*tsys==TSYS_UTC) data[i].time=utc2gpst(data[i].time);
+    if ((len=fread(r->buff,1,RNXWINSIZE,fp))==0) return -1;
+    last=len<RNXWINSIZE;
+
+    if (last&&r->nwin==0&&len<RNXMINPAR) {
+        fseek(fp,pos,SEEK_SET);
+        return 0;
+    }
+    r->nwin++;
 
-            /* save cycle slip */
-            saveslips(slips,data+i);
+    /* cut window at last epoch record and reposition file */
+    if (!last) {
+        for (n=len-1;n>0;n--) {
+            if (r->buff[n]=='>'&&r->buff[n-1]=='\n') break;
         }
-        /* screen data by time */
-        if (n>0&&!screent(data[0].time,ts,te,tint)) continue;
+        if (n==0||fseek(fp,pos,SEEK_SET)||fread(r->buff,1,n,fp)<n) {
+            fseek(fp,pos,SEEK_SET);
+            return 0;
+        }
+        len=n;
+    }
+    end=r->buff+len;
 
-        for (i=0;i<n;i++) {
+    /* split window into chunks at epoch records */
+    for (i=k=0;k<RNXNTHREAD&&i<len;k++) {
+        r->c[k].p=r->buff+i;
+        r->c[k].ver=ver;
+        r->c[k].mask=r->mask;
+        r->c[k].index=r->index;
+        r->c[k].last=0;
+        for (i=i+len/RNXNTHREAD+1;i<len;i++) {
+            if (r->buff[i]=='>'&&r->buff[i-1]=='\n') break;
+        }
+        if (k==RNXNTHREAD-1) i=len;
+        r->c[k].end=r->buff+(i<len?i:len);
+    }
+    r->nc=(int)k;
+    r->c[r->nc-1].end=end;
+    r->c[r->nc-1].last=last;
 
-            /* restore cycle slip */
-            restslips(slips,data+i);
+    decodechunks(r);
 
-            data[i].rcv=(uint8_t)rcv;
+    for (k=0;k<(size_t)r->nc;k++) {
+        if (r->c[k].stat>0) continue;
+        trace(3,"readrnxwin: sequential read pos=%ld\n",pos);
+        r->nc=0;
+        fseek(fp,pos,SEEK_SET);
+        return 0;
+    }
+    return 1;
+}
+/* initialize parallel observation data reader -------------------------------*/
+static rnxpar_t *init_rnxpar(const char *opt, double ver,
+                             char tobs[][MAXOBSTYPE][4])
+{
+    rnxpar_t *r;
+
+    if (ver<=2.99) return NULL;
 
-            /* save obs data */
-            if ((stat=addobsdata(obs,data+i))<0) break;
+    if (!(r=(rnxpar_t *)calloc(1,sizeof(rnxpar_t)))) return NULL;
+    if (!(r->buff=(char *)malloc(RNXWINSIZE))) {
+        free(r);
+        return NULL;
+    }
+    r->mode=1;
+    r->mask=set_sysmask(opt);
+    set_indexes(ver,opt,tobs,r->index);
+    return r;
+}
+/* free parallel observation data reader -------------------------------------*/
+static void free_rnxpar(rnxpar_t *r)
+{
+    int i;
+
+    if (!r) return;
+    for (i=0;i<RNXNTHREAD;i++) {
+        free(r->c[i].rec);
+        free(r->c[i].data);
+    }
+    free(r->buff);
+    free(r);
+}
+/* read RINEX observation data body by parallel reader ---------------------------
+* return the next epoch decoded in parallel as readrnxobsb(). data[0] keeps the
+* same contents as readrnxobsb() for empty epochs and event records. after a
+* window not decodable in parallel, the rest is read by readrnxobsb()
+*-----------------------------------------------------------------------------*/
+static int readrnxobsr(FILE *fp, rnxpar_t *r, const char *opt, double ver,
+                       int *tsys, char tobs[][MAXOBSTYPE][4], int *flag,
+                       obsd_t *data, sta_t *sta)
+{
+    const rnxrec_t *rec;
+    const rnxchunk_t *c;
+    int stat;
+
+    while (r&&r->mode) {
+        if (r->ic<r->nc) {
+            c=r->c+r->ic;
+            if (r->ir>=c->nrec) {
+                r->ic++;
+                r->ir=r->id=0;
+                continue;
+            }
+            rec=c->rec+r->ir++;
+            *flag=rec->flag;
+            if (rec->flag==5) {
+                data[0].eventime=rec->time;
+                return 0;
+            }
+            if (rec->n>0) {
+                memcpy(data,c->data+r->id,sizeof(obsd_t)*rec->n);
+                r->id+=rec->n;
+            }
+            else if (rec->t0) data[0].time=rec->time;
+            return rec->n;
         }
-        n1=n;dtime1=timediff(data[0].time,time1);time1=data[0].time;
+        if ((stat=readrnxwin(fp,ver,r))<0) return -1;
+        if (stat==0) r->mode=0;
+    }
+    return readrnxobsb(fp,opt,ver,tsys,tobs,flag,data,sta);
+}
+/* read RINEX observation data epoch -----------------------------------------*/
+static int readrnxobse(FILE *fp, rnxpar_t *par, gtime_t ts, gtime_t te,
+                       double tint, const char *opt, int rcv, double ver,
+                       int *tsys, char tobs[][MAXOBSTYPE][4], rnxost_t *st,
+                       obsd_t *data, obs_t *obs, int *stat, sta_t *sta)
+{
+    gtime_t eventime={0},time0={0};
+    int i,n,flag=0;
+
+    if ((n=readrnxobsr(fp,par,opt,ver,tsys,tobs,&flag,data,sta))<0) return -1;
+
+    if (flag == 5) {
+        eventime = data[0].eventime;
+        n = readrnxobsr(fp,par,opt,ver,tsys,tobs,&flag,data,sta);
+        if (fabs(timediff(data[0].time,st->time1)-st->dtime1)>=DTTOL)
+            n = readrnxobsr(fp,par,opt,ver,tsys,tobs,&flag,data,sta);
+    }
+
+    if (eventime.time==0 || st->nobs+obs->n-st->n1<=0 ||
+        timediff(eventime,st->time1)>=0) {
+       for (i=0;i<n;i++) data[i].eventime = eventime;
+    }  else {
+       /* add event to previous epoch if delayed */
+        for (i=0;i<st->n1;i++) obs->data[obs->n-i-1].eventime = eventime;
+        for (i=0;i<n;i++) data[i].eventime=time0;
     }
+    for (i=0;i<n;i++) {
+
+        /* UTC -> GPST */
+        if (*tsys==TSYS_UTC) data[i].time=utc2gpst(data[i].time);
+
+        /* save cycle slip */
+        saveslips(st->slips,data+i);
+    }
+    /* screen data by time */
+    if (n>0&&!screent(data[0].time,ts,te,tint)) return 0;
+
+    for (i=0;i<n;i++) {
+
+        /* restore cycle slip */
+        restslips(st->slips,data+i);
+
+        data[i].rcv=(uint8_t)rcv;
+
+        /* save obs data */
+        if ((*stat=addobsdata(obs,data+i))<0) break;
+    }
+    st->n1=n;st->dtime1=timediff(data[0].time,st->time1);st->time1=data[0].time;
+    return 1;
+}
+/* read RINEX observation data -----------------------------------------------*/
+static int readrnxobs(FILE *fp, gtime_t ts, gtime_t te, double tint,
+                      const char *opt, int rcv, double ver, int *tsys,
+                      char tobs[][MAXOBSTYPE][4], obs_t *obs, sta_t *sta)
+{
+    obsd_t *data;
+    rnxpar_t *par;
+    rnxost_t st={{{0}}};
+    int stat=0;
+
+    trace(4,"readrnxobs: rcv=%d ver=%.2f tsys=%d\n",rcv,ver,*tsys);
+
+    if (!obs||rcv>MAXRCV) return 0;
+
+    if (!(data=(obsd_t *)malloc(sizeof(obsd_t)*MAXOBS))) return 0;
+
+    /* parallel reader for RINEX 3 (NULL: sequential) */
+    par=init_rnxpar(opt,ver,tobs);
+
+    /* read RINEX observation data body */
+    while (stat>=0&&readrnxobse(fp,par,ts,te,tint,opt,rcv,ver,tsys,tobs,&st,
+                                data,obs,&stat,sta)>=0) ;
+
     trace(4,"readrnxobs: nobs=%d stat=%d\n",obs->n,stat);
 
+    free_rnxpar(par);
     free(data);
 
     return stat;
@@ -1410,7 +1740,7 @@ static int readrnxnavb(FILE *fp, const char *opt, double ver, int sys,
                 }
             }
             else {
-                prn=(int)str2num(buff,0,2);
+                prn=str2int(buff,0,2);
 
                 if (sys==SYS_SBS) {
                     sat=satno(SYS_SBS,prn+100);
@@ -1772,6 +2102,206 @@ extern int readrnx(const char *file, int rcv, const char *opt, obs_t *obs,
 
     return readrnxt(file,rcv,t,t,0.0,opt,obs,nav,sta);
 }
+/* open RINEX observation data stream ------------------------------------------
+* open RINEX observation files to read observation data epoch by epoch
+* args   : rnxobs_t *rnx    IO  RINEX observation data stream
+*          char  **file     I   files (wild-card * expanded)
+*          int    n         I   number of files
+*          int    rcv       I   receiver number for obs data
+*          gtime_t ts       I   observation time start (ts.time==0: no limit)
+*          gtime_t te       I   observation time end   (te.time==0: no limit)
+*          double tint      I   observation time interval (s) (0:all)
+*          char  *opt       I   RINEX options (see readrnxt())
+* return : number of expanded files (0:no file or error)
+* notes  : the files are opened and read by input_rnxobs(). files other than
+*          observation data are skipped. observation data should be in time
+*          order through the files. close_rnxobs() should be called to free the
+*          stream even if no file is expanded.
+*-----------------------------------------------------------------------------*/
+extern int open_rnxobs(rnxobs_t *rnx, const char **file, int n, int rcv,
+                       gtime_t ts, gtime_t te, double tint, const char *opt)
+{
+    rnxobs_t rnx0={{0}};
+    char *paths[MAXEXFILE]={0},**p;
+    int i,j,m;
+
+    trace(3,"open_rnxobs: n=%d rcv=%d\n",n,rcv);
+
+    *rnx=rnx0;
+    rnx->ts=ts; rnx->te=te; rnx->tint=tint; rnx->rcv=rcv;
+    strncpy(rnx->opt,opt,sizeof(rnx->opt)-1);
+
+    if (rcv>MAXRCV) return 0;
+
+    if (!(rnx->data=(obsd_t *)malloc(sizeof(obsd_t)*MAXOBS))||
+        !(rnx->st=calloc(1,sizeof(rnxost_t)))) {
+        return 0;
+    }
+    for (i=0;i<MAXEXFILE;i++) {
+        if (!(paths[i]=(char *)malloc(1024))) break;
+    }
+    for (i=0;i<n&&paths[MAXEXFILE-1];i++) {
+
+        /* expand wild-card */
+        for (j=0,m=expath(file[i],paths,MAXEXFILE);j<m;j++) {
+            if (!(p=(char **)realloc(rnx->file,sizeof(char *)*(rnx->nfile+1)))||
+                !(p[rnx->nfile]=(char *)malloc(strlen(paths[j])+1))) {
+                if (p) rnx->file=p;
+                break;
+            }
+            rnx->file=p;
+            strcpy(rnx->file[rnx->nfile++],paths[j]);
+        }
+    }
+    for (i=0;i<MAXEXFILE;i++) free(paths[i]);
+
+    return rnx->nfile;
+}
+/* close file of RINEX observation data stream -------------------------------*/
+static void closernxobsf(rnxobs_t *rnx)
+{
+    if (rnx->fp) fclose(rnx->fp);
+    rnx->fp=NULL;
+
+    /* delete temporary file */
+    if (*rnx->tmpfile) remove(rnx->tmpfile);
+    rnx->tmpfile[0]='\0';
+}
+/* open next file of RINEX observation data stream ---------------------------*/
+static int openrnxobsf(rnxobs_t *rnx)
+{
+    rnxost_t *st=(rnxost_t *)rnx->st;
+    char type=' ';
+    int sys,cstat,nobs=st->nobs;
+
+    while (rnx->ifile<rnx->nfile) {
+        const char *file=rnx->file[rnx->ifile++];
+
+        trace(3,"openrnxobsf: file=%s\n",file);
+
+        /* uncompress file */
+        if ((cstat=rtk_uncompress(file,rnx->tmpfile))<0) {
+            trace(2,"rinex file uncompact error: %s\n",file);
+            rnx->tmpfile[0]='\0';
+            continue;
+        }
+        if (!cstat) rnx->tmpfile[0]='\0';
+
+        if (!(rnx->fp=fopen(cstat?rnx->tmpfile:file,"r"))) {
+            trace(2,"rinex file open error: %s\n",cstat?rnx->tmpfile:file);
+            closernxobsf(rnx);
+            continue;
+        }
+        init_sta(&rnx->sta);
+        rnx->tsys=TSYS_GPS;
+        memset(rnx->tobs,0,sizeof(rnx->tobs));
+
+        /* read RINEX file header */
+        if (readrnxh(rnx->fp,&rnx->ver,&type,&sys,&rnx->tsys,rnx->tobs,NULL,
+                     &rnx->sta,0)&&type=='O') {
+            memset(st,0,sizeof(rnxost_t));
+            st->nobs=nobs;
+            return 1;
+        }
+        closernxobsf(rnx);
+    }
+    return 0;
+}
+/* output epoch of RINEX observation data stream -----------------------------*/
+static int outrnxobse(rnxobs_t *rnx, int n, obs_t *obs)
+{
+    rnxost_t *st=(rnxost_t *)rnx->st;
+    obs_t tmp={0};
+    int i,n0=obs->n;
+
+    for (i=0;i<n;i++) {
+        if (addobsdata(obs,rnx->obs.data+i)<0) return -1;
+    }
+    /* sort and unique epoch data by satellite */
+    tmp.data=obs->data+n0; tmp.n=tmp.nmax=n;
+    sortobs(&tmp);
+    obs->n=n0+tmp.n;
+
+    rnx->tout=rnx->obs.data[0].time;
+    memmove(rnx->obs.data,rnx->obs.data+n,sizeof(obsd_t)*(rnx->obs.n-n));
+    rnx->obs.n-=n;
+    st->nobs+=n;
+    return tmp.n;
+}
+/* input RINEX observation data stream -----------------------------------------
+* read next epoch of RINEX observation data stream
+* args   : rnxobs_t *rnx    IO  RINEX observation data stream
+*          obs_t  *obs      IO  observation data
+* return : number of obs data appended to obs (-1:end of stream or error)
+* notes  : the epoch data are processed as readrnxt() does for a file, and the
+*          data are sorted by satellite as sortobs(). an epoch is output after
+*          the next epoch is read to attach a delayed event time. an epoch
+*          earlier than the previous one is discarded.
+*-----------------------------------------------------------------------------*/
+extern int input_rnxobs(rnxobs_t *rnx, obs_t *obs)
+{
+    rnxost_t *st=(rnxost_t *)rnx->st;
+    gtime_t time;
+    int i,n0,stat=0;
+    char tstr[40];
+
+    trace(4,"input_rnxobs: rcv=%d\n",rnx->rcv);
+
+    if (!st) return -1;
+
+    for (;;) {
+        /* output first epoch if next epoch read or end of stream */
+        if (rnx->obs.n>0) {
+            for (i=1;i<rnx->obs.n;i++) {
+                if (timediff(rnx->obs.data[i].time,rnx->obs.data[0].time)>DTTOL) break;
+            }
+            if (i<rnx->obs.n||(!rnx->fp&&rnx->ifile>=rnx->nfile)) {
+                return outrnxobse(rnx,i,obs);
+            }
+        }
+        if (!rnx->fp&&!openrnxobsf(rnx)) {
+            if (rnx->obs.n<=0) return -1;
+            continue;
+        }
+        n0=rnx->obs.n;
+
+        /* read epoch data */
+        if (readrnxobse(rnx->fp,NULL,rnx->ts,rnx->te,rnx->tint,rnx->opt,
+                        rnx->rcv,rnx->ver,&rnx->tsys,rnx->tobs,st,rnx->data,
+                        &rnx->obs,&stat,&rnx->sta)<0) {
+            closernxobsf(rnx);
+            continue;
+        }
+        if (stat<0) return -1;
+        if (rnx->obs.n<=n0) continue;
+
+        /* discard epoch earlier than previous one */
+        time=n0>0?rnx->obs.data[n0-1].time:rnx->tout;
+        if (time.time&&timediff(rnx->obs.data[n0].time,time)<-DTTOL) {
+            trace(2,"rinex obs epoch out of order: rcv=%d %s\n",rnx->rcv,
+                  time2str(rnx->obs.data[n0].time,tstr,0));
+            rnx->obs.n=n0;
+        }
+    }
+}
+/* close RINEX observation data stream -----------------------------------------
+* close RINEX observation data stream and free buffers
+* args   : rnxobs_t *rnx    IO  RINEX observation data stream
+* return : none
+*-----------------------------------------------------------------------------*/
+extern void close_rnxobs(rnxobs_t *rnx)
+{
+    int i;
+
+    trace(3,"close_rnxobs: rcv=%d\n",rnx->rcv);
+
+    closernxobsf(rnx);
+    for (i=0;i<rnx->nfile;i++) free(rnx->file[i]);
+    free(rnx->file); rnx->file=NULL; rnx->nfile=rnx->ifile=0;
+    free(rnx->obs.data); rnx->obs.data=NULL; rnx->obs.n=rnx->obs.nmax=0;
+    free(rnx->data); rnx->data=NULL;
+    free(rnx->st); rnx->st=NULL;
+}
 /* compare precise clock -----------------------------------------------------*/
 static int cmppclk(const void *p1, const void *p2)
 {
@@ -1873,6 +2403,7 @@ extern int init_rnxctr(rnxctr_t *rnx)
     rnx->nav.eph =NULL;
     rnx->nav.geph=NULL;
     rnx->nav.seph=NULL;
+    rnx->nav.eidx=NULL;
 
     if (!(rnx->obs.data=(obsd_t *)malloc(sizeof(obsd_t)*MAXOBS   ))||
         !(rnx->nav.eph =(eph_t  *)malloc(sizeof(eph_t )*MAXSAT*2 ))||
@@ -44,6 +44,7 @@
 *                           delete references [2]-[6],[8],[9],[11]-[14]
 *                           update reference [17]
 *                           use integer types in stdint.h
+*           2026/10/16 1.13 read file by blocks in input_rtcm2f(),input_rtcm3f()
 *-----------------------------------------------------------------------------*/
 #include "rtklib.h"
 
@@ -97,6 +98,7 @@ extern int init_rtcm(rtcm_t *rtcm)
         rtcm->lltime[i][j]=time0;
     }
     rtcm->nbyte=rtcm->nbit=rtcm->len=0;
+    init_fbuf(&rtcm->fbuf);
     rtcm->word=0;
     for (i=0;i<100;i++) rtcm->nmsg2[i]=0;
     for (i=0;i<400;i++) rtcm->nmsg3[i]=0;
@@ -105,6 +107,7 @@ extern int init_rtcm(rtcm_t *rtcm)
     rtcm->nav.eph =NULL;
     rtcm->nav.geph=NULL;
     rtcm->nav.seph=NULL;
+    rtcm->nav.eidx=NULL;
     
     // Allocate memory for observation and ephemeris buffer.
     if (!(rtcm->obs.data=(obsd_t *)malloc(sizeof(obsd_t)*MAXOBS))||
@@ -144,6 +147,7 @@ extern void free_rtcm(rtcm_t *rtcm)
     free(rtcm->obs.data); rtcm->obs.data=NULL; rtcm->obs.n=0;
     free(rtcm->nav.eph ); rtcm->nav.eph =NULL; rtcm->nav.n=rtcm->nav.nmax=0;
     free(rtcm->nav.geph); rtcm->nav.geph=NULL; rtcm->nav.ng=rtcm->nav.ngmax=0;
+    free_fbuf(&rtcm->fbuf);
 }
 /* input RTCM 2 message from stream --------------------------------------------
 * fetch next RTCM 2 message and input a message from byte stream
@@ -309,6 +313,9 @@ extern int input_rtcm3(rtcm_t *rtcm, uint8_t data)
 *          FILE  *fp    I    file pointer
 * return : status (-2: end of file, -1...10: same as above)
 * notes  : same as above
+*          the file is read by blocks through the file input buffer
+*          (rtcm->fbuf). open and close the file by fopen_fbuf() and
+*          fclose_fbuf() with rtcm->fbuf
 *-----------------------------------------------------------------------------*/
 extern int input_rtcm2f(rtcm_t *rtcm, FILE *fp)
 {
@@ -317,7 +324,7 @@ extern int input_rtcm2f(rtcm_t *rtcm, FILE *fp)
     trace(4,"input_rtcm2f: data=%02x\n",data);
     
     for (i=0;i<4096;i++) {
-        if ((data=fgetc(fp))==EOF) return -2;
+        if ((data=getc_fbuf(&rtcm->fbuf,fp))==EOF) return -2;
         if ((ret=input_rtcm2(rtcm,(uint8_t)data))) return ret;
     }
     return 0; /* return at every 4k bytes */
@@ -328,22 +335,58 @@ extern int input_rtcm2f(rtcm_t *rtcm, FILE *fp)
 *          FILE  *fp    I    file pointer
 * return : status (-2: end of file, -1...10: same as above)
 * notes  : same as above
+*          the file is read by blocks through the file input buffer
+*          (rtcm->fbuf). a block is scanned for the preamble and a complete
+*          frame is checked for parity in the buffer before decoding. in case
+*          of parity error, the scan restarts at the preamble+1.
+*          open and close the file by fopen_fbuf() and fclose_fbuf() with
+*          rtcm->fbuf
 *-----------------------------------------------------------------------------*/
 extern int input_rtcm3f(rtcm_t *rtcm, FILE *fp)
 {
-    int i,data=0,ret;
+    fbuf_t *fb=&rtcm->fbuf;
+    uint8_t *p,*q;
+    int i,n,len,data,ret;
     
-    trace(4,"input_rtcm3f: data=%02x\n",data);
+    trace(4,"input_rtcm3f:\n");
     
-    for (i=0;i<4096;i++) {
-        if ((data=fgetc(fp))==EOF) return -2;
-        if ((ret=input_rtcm3(rtcm,(uint8_t)data))) return ret;   /* ret!=0 indicates message complete */
-        if (rtcm->nbyte_invalid!=0) {               /* if last message had error: */
-            fseek(fp,-rtcm->nbyte_invalid+1,SEEK_CUR);  /* rewind to last preamble+1 */
-            i -= rtcm->nbyte_invalid-1;
-            trace(4,"rewind buff %3d bytes, i=%d\n",rtcm->nbyte_invalid-1,i);
-            rtcm->nbyte_invalid=0;
+    /* complete frame partially input by input_rtcm3() */
+    while (rtcm->nbyte>0) {
+        if ((data=getc_fbuf(fb,fp))==EOF) return -2;
+        if ((ret=input_rtcm3(rtcm,(uint8_t)data))) return ret;
+    }
+    for (i=0;i<4096;) {
+        if ((n=fill_fbuf(fb,fp,6))<=0) return -2;
+        p=fb->buff+fb->p;
+        
+        /* synchronize frame */
+        if (!(q=(uint8_t *)memchr(p,RTCM3PREAMB,n))) {
+            fb->p+=n; i+=n;
+            continue;
         }
+        fb->p+=(int)(q-p); i+=(int)(q-p);
+        
+        if (fill_fbuf(fb,fp,3)<3) return -2;
+        len=getbitu(fb->buff+fb->p,14,10)+3; /* length without parity */
+        
+        if (fill_fbuf(fb,fp,len+3)<len+3) { /* frame not complete */
+            fb->p++; i++;
+            continue;
+        }
+        p=fb->buff+fb->p;
+        
+        /* check parity */
+        if (rtk_crc24q(p,len)!=getbitu(p,len*8,24)) {
+            trace(2,"rtcm3 parity error: len=%d\n",len);
+            fb->p++; i++; /* restart at preamble+1 */
+            continue;
+        }
+        memcpy(rtcm->buff,p,len+3);
+        rtcm->len=len;
+        fb->p+=len+3; i+=len+3;
+        
+        /* decode rtcm3 message */
+        if ((ret=decode_rtcm3(rtcm))) return ret;
     }
     return 0; /* return at every 4k bytes */
 }
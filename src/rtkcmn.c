@@ -142,6 +142,16 @@
 *                           update obs code strings and priority table
 *                           use integer types in stdint.h
 *                           suppress warnings
+*           2026/10/16 1.46 add API init_fbuf(),free_fbuf(),fopen_fbuf(),
+*                           fclose_fbuf(),fill_fbuf(),getc_fbuf(),read_fbuf()
+*                           for block-buffered input
+*                           free precise ephemeris cache in freenav()
+*                           add hashed antenna parameters index set by
+*                            readpcv() and used by searchpcv()
+*                           str2num() and str2time() parse fields in place
+*                            without copy, strtod() or sscanf()
+*                           add API str2int()
+*                           rebuild ephemeris index in readnav()
 *-----------------------------------------------------------------------------*/
 #define _POSIX_C_SOURCE 199506
 #include <stdarg.h>
@@ -163,6 +173,7 @@
 
 #define SQR(x)      ((x)*(x))
 #define MAX_VAR_EPH SQR(300.0)  /* max variance eph to reject satellite (m^2) */
+#define FBUFSIZE    65536       /* block size of file input buffer (bytes) */
 
 static const double gpst0[]={1980,1, 6,0,0,0}; /* gps time reference */
 static const double gst0 []={1999,8,22,0,0,0}; /* galileo system time reference */
@@ -1439,52 +1450,140 @@ extern int lsq(const double *A, const double *y, int n, int m, double *x,
     free(Ay);
     return info;
 }
-/* kalman filter ---------------------------------------------------------------
-* kalman filter state update as follows:
-*
-*   K=P*H*(H'*P*H+R)^-1, xp=x+K*v, Pp=(I-K*H')*P
-*
-* args   : double *x        I   states vector (n x 1)
-*          double *P        I   covariance matrix of states (n x n)
-*          double *H        I   transpose of design matrix (n x m)
-*          double *v        I   innovation (measurement - model) (m x 1)
-*          double *R        I   covariance matrix of measurement error (m x m)
-*          int    n,m       I   number of states and measurements
-*          double *xp       O   states vector after update (n x 1)
-*          double *Pp       O   covariance matrix of states after update (n x n)
-* return : status (0:ok,<0:error)
-* notes  : matrix stored by column-major order (fortran convention)
-*          if state x[i]==0.0, not updates state x[i]/P[i+i*n]
-*-----------------------------------------------------------------------------*/
-static int filter_(const double *x, const double *P, const double *H,
-                   const double *v, const double *R, int n, int m,
-                   double *xp, double *Pp)
+/* cholesky decomposition (A=L*L', L stored in lower triangle of A) ----------*/
+static int choldc(double *A, int n)
 {
-    double *F=mat(n,m),*Q=mat(m,m),*K=mat(n,m),*I=eye(n);
-    int info;
+    double s;
+    int i,j,k;
 
-    matcpy(Q,R,m,m);
-    matcpy(xp,x,n,1);
-    matmul("NN",n,m,n,P,H,F);       /* Q=H'*P*H+R */
-    matmulp("TN",m,m,n,H,F,Q);
-    if (!(info=matinv(Q,m))) {
-        matmul("NN",n,m,m,F,Q,K);   /* K=P*H*Q^-1 */
-        matmulp("NN",n,1,m,K,v,xp);  /* xp=x+K*v */
-        matmulm("NT",n,n,m,K,H,I);  /* Pp=(I-K*H')*P */
-        matmul("NN",n,n,n,I,P,Pp);
-    }
-    free(F); free(Q); free(K); free(I);
-    return info;
+    for (j=0;j<n;j++) {
+        s=A[j+j*n]; for (k=0;k<j;k++) s-=A[j+k*n]*A[j+k*n];
+        if (s<=0.0) return -1;
+        A[j+j*n]=sqrt(s);
+        for (i=j+1;i<n;i++) {
+            s=A[i+j*n]; for (k=0;k<j;k++) s-=A[i+k*n]*A[j+k*n];
+            A[i+j*n]=s/A[j+j*n];
+        }
+    }
+    return 0;
 }
-extern int filter(double *x, double *P, const double *H, const double *v,
-                  const double *R, int n, int m)
+/* kalman gain K=F*Q^-1 (F=P*H, Q=H'*P*H+R) ----------------------------------*/
+static int kfgain(const double *F, double *Q, int n, int m, double *K)
+{
+    double s;
+    int i,j,k;
+
+    if (choldc(Q,m)) return -1;
+
+    /* solve K*L*L'=F by columns of K */
+    for (j=0;j<m;j++) {
+        for (i=0;i<n;i++) K[i+j*n]=F[i+j*n];
+        for (k=0;k<j;k++) {
+            s=Q[j+k*m]; for (i=0;i<n;i++) K[i+j*n]-=K[i+k*n]*s;
+        }
+        s=1.0/Q[j+j*m]; for (i=0;i<n;i++) K[i+j*n]*=s;
+    }
+    for (j=m-1;j>=0;j--) {
+        for (k=j+1;k<m;k++) {
+            s=Q[k+j*m]; for (i=0;i<n;i++) K[i+j*n]-=K[i+k*n]*s;
+        }
+        s=1.0/Q[j+j*m]; for (i=0;i<n;i++) K[i+j*n]*=s;
+    }
+    return 0;
+}
+/* kalman filter state update on compressed arrays ---------------------------*/
+static int filter_(double *x, double *P, const double *H, const double *v,
+                   const double *R, int n, int m, double *F, double *Q,
+                   double *K)
 {
-    double *x_,*xp_,*P_,*Pp_,*H_;
-    int i,j,k,info,*ix;
+    double s;
+    int i,j,k,info=0;
+
+    /* F=P*H, Q=H'*P*H+R (skip zero elements of sparse design matrix) */
+    for (j=0;j<m;j++) {
+        for (i=0;i<n;i++) F[i+j*n]=0.0;
+        for (k=0;k<n;k++) {
+            if ((s=H[k+j*n])==0.0) continue;
+            for (i=0;i<n;i++) F[i+j*n]+=P[i+k*n]*s;
+        }
+    }
+    for (j=0;j<m;j++) for (i=0;i<m;i++) {
+        s=0.0;
+        for (k=0;k<n;k++) if (H[k+i*n]!=0.0) s+=H[k+i*n]*F[k+j*n];
+        Q[i+j*m]=R[i+j*m]+s;
+    }
+    if (kfgain(F,Q,n,m,K)) {        /* K=P*H*Q^-1 */
 
+        /* not positive definite: fall back to general inverse */
+        matcpy(Q,R,m,m);
+        matmulp("TN",m,m,n,H,F,Q);
+        if ((info=matinv(Q,m))) return info;
+        matmul("NN",n,m,m,F,Q,K);
+    }
+    matmulp("NN",n,1,m,K,v,x);      /* xp=x+K*v */
+
+    for (j=0;j<n;j++) { /* Pp=P-K*(H'*P) (lower triangle) */
+        for (k=0;k<m;k++) {
+            if ((s=F[j+k*n])==0.0) continue;
+            for (i=j;i<n;i++) P[i+j*n]-=K[i+k*n]*s;
+        }
+        for (i=j+1;i<n;i++) P[j+i*n]=P[i+j*n];
+    }
+    return info;
+}
+/* initialize/free kalman filter workspace -------------------------------------
+* args   : filtws_t *ws     IO  kalman filter workspace
+* return : none
+*-----------------------------------------------------------------------------*/
+extern void initfiltws(filtws_t *ws)
+{
+    ws->nmax=ws->mmax=0;
+    ws->buff=NULL;
+    ws->ix=NULL;
+}
+extern void freefiltws(filtws_t *ws)
+{
+    free(ws->buff);
+    free(ws->ix);
+    initfiltws(ws);
+}
+/* kalman filter with workspace ------------------------------------------------
+* kalman filter state update with persistent work buffers
+* args   : filtws_t *ws     IO  kalman filter workspace
+*          (others)             same as filter()
+* return : status (0:ok,<0:error)
+* notes  : work buffers in ws are extended as needed and reused for next calls.
+*          the workspace should be initialized by initfiltws() before first call
+*          and freed by freefiltws().
+*-----------------------------------------------------------------------------*/
+extern int filterws(filtws_t *ws, double *x, double *P, const double *H,
+                    const double *v, const double *R, int n, int m)
+{
+    double *x_,*P_,*H_,*F,*Q,*K,*buff;
+    int i,j,k,nmax,mmax,*ix;
+
+    if (n<=0||m<=0) return 0;
+
+    /* extend work buffers */
+    if (n>ws->nmax||m>ws->mmax) {
+        nmax=n>ws->nmax?n:ws->nmax;
+        mmax=m>ws->mmax?m:ws->mmax;
+        if (!(buff=(double *)malloc(sizeof(double)*(nmax+nmax*nmax+nmax*mmax*3+
+                                                    mmax*mmax)))||
+            !(ix=(int *)malloc(sizeof(int)*nmax))) {
+            free(buff);
+            trace(1,"filterws: memory allocation error n=%d m=%d\n",n,m);
+            return -1;
+        }
+        freefiltws(ws);
+        ws->buff=buff; ws->ix=ix; ws->nmax=nmax; ws->mmax=mmax;
+    }
     /* create list of non-zero states */
-    ix=imat(n,1); for (i=k=0;i<n;i++) if (x[i]!=0.0&&P[i+i*n]>0.0) ix[k++]=i;
-    x_=mat(k,1); xp_=mat(k,1); P_=mat(k,k); Pp_=mat(k,k); H_=mat(k,m);
+    for (i=k=0;i<n;i++) if (x[i]!=0.0&&P[i+i*n]>0.0) ws->ix[k++]=i;
+    if (k<=0) return 0;
+    ix=ws->ix;
+    x_=ws->buff; P_=x_+k; H_=P_+k*k; F=H_+k*m; Q=F+k*m; K=Q+m*m;
+
     /* compress array by removing zero elements to save computation time */
     for (i=0;i<k;i++) {
         x_[i]=x[ix[i]];
@@ -1492,13 +1591,41 @@ extern int filter(double *x, double *P, const double *H, const double *v,
         for (j=0;j<m;j++) H_[i+j*k]=H[ix[i]+j*n];
     }
     /* do kalman filter state update on compressed arrays */
-    info=filter_(x_,P_,H_,v,R,k,m,xp_,Pp_);
+    if (filter_(x_,P_,H_,v,R,k,m,F,Q,K)) return -1;
+
     /* copy values from compressed arrays back to full arrays */
     for (i=0;i<k;i++) {
-        x[ix[i]]=xp_[i];
-        for (j=0;j<k;j++) P[ix[i]+ix[j]*n]=Pp_[i+j*k];
+        x[ix[i]]=x_[i];
+        for (j=0;j<k;j++) P[ix[i]+ix[j]*n]=P_[i+j*k];
     }
-    free(ix); free(x_); free(xp_); free(P_); free(Pp_); free(H_);
+    return 0;
+}
+/* kalman filter ---------------------------------------------------------------
+* kalman filter state update as follows:
+*
+*   K=P*H*(H'*P*H+R)^-1, xp=x+K*v, Pp=P-K*(H'*P)
+*
+* args   : double *x        IO  states vector (n x 1)
+*          double *P        IO  covariance matrix of states (n x n)
+*          double *H        I   transpose of design matrix (n x m)
+*          double *v        I   innovation (measurement - model) (m x 1)
+*          double *R        I   covariance matrix of measurement error (m x m)
+*          int    n,m       I   number of states and measurements
+* return : status (0:ok,<0:error)
+* notes  : matrix stored by column-major order (fortran convention)
+*          if state x[i]==0.0, not updates state x[i]/P[i+i*n]
+*          filter() allocates work buffers for each call. use filterws() with
+*          a persistent workspace for repeated updates.
+*-----------------------------------------------------------------------------*/
+extern int filter(double *x, double *P, const double *H, const double *v,
+                  const double *R, int n, int m)
+{
+    filtws_t ws;
+    int info;
+
+    initfiltws(&ws);
+    info=filterws(&ws,x,P,H,v,R,n,m);
+    freefiltws(&ws);
     return info;
 }
 /* smoother --------------------------------------------------------------------
@@ -1567,28 +1694,103 @@ extern void setstr(char *dst, const char *src, int n)
     *p--='\0';
     while (p>=dst&&(*p==' '||*p=='\r'||*p=='\n'||*p=='\t')) *p--='\0';
 }
+/* parse number in field -------------------------------------------------------
+* parse a number in field [p,q) without locale after skipping white spaces.
+* 'D' or 'd' is accepted as exponent character. mantissa <= 2^53 with
+* |exponent| <= 22 is exactly converted and other cases are passed to strtod()
+* to keep the results identical to strtod().
+*-----------------------------------------------------------------------------*/
+static const char *parsenum(const char *p, const char *q, double *val)
+{
+    static const double pow10[]={
+        1E0,1E1,1E2,1E3,1E4,1E5,1E6,1E7,1E8,1E9,1E10,1E11,1E12,1E13,1E14,
+        1E15,1E16,1E17,1E18,1E19,1E20,1E21,1E22
+    };
+    const char *s,*r;
+    char str[256],*end;
+    uint64_t m=0;
+    int i,nd=0,nc=0,e=0,ee=0,sgn=0,esgn=0;
+
+    for (;p<q&&(*p==' '||('\t'<=*p&&*p<='\r'));p++) ;
+    s=p;
+    if (p<q&&(*p=='+'||*p=='-')) sgn=*p++=='-';
+
+    for (;p<q&&'0'<=*p&&*p<='9';p++,nc++) {
+        if (!m&&*p=='0') continue;
+        if (++nd>19) break;
+        m=m*10+(uint64_t)(*p-'0');
+    }
+    if (nd<=19&&p<q&&*p=='.') {
+        for (p++;p<q&&'0'<=*p&&*p<='9';p++,nc++,e--) {
+            if (!m&&*p=='0') continue;
+            if (++nd>19) break;
+            m=m*10+(uint64_t)(*p-'0');
+        }
+    }
+    if (!nc) return NULL;
+
+    if (nd<=19&&p<q&&((*p|0x20)=='e'||(*p|0x20)=='d')) {
+        r=p+1;
+        if (r<q&&(*r=='+'||*r=='-')) esgn=*r++=='-';
+        if (r<q&&'0'<=*r&&*r<='9') {
+            for (;r<q&&'0'<=*r&&*r<='9';r++) {
+                if (ee<10000) ee=ee*10+(*r-'0');
+            }
+            e+=esgn?-ee:ee;
+            p=r;
+        }
+    }
+    if (nd<=19&&m<=((uint64_t)1<<53)&&-22<=e&&e<=22) {
+        *val=!m?0.0:(e<0?(double)m/pow10[-e]:(double)m*pow10[e]);
+        if (sgn) *val=-*val;
+        return p;
+    }
+    /* fallback to strtod() */
+    for (i=0;s+i<q&&s[i]&&i<(int)sizeof(str)-1;i++) {
+        str[i]=((s[i]|0x20)=='d')?'E':s[i];
+    }
+    str[i]='\0';
+    *val=strtod(str,&end);
+    return s+(end-str);
+}
 /* string to number ------------------------------------------------------------
 * convert substring in string to number
 * args   : char   *s        I   string ("... nnn.nnn ...")
 *          int    i,n       I   substring position and width
 * return : converted number (0.0:error)
+* notes  : the substring is parsed in place without locale and 'D' or 'd' is
+*          accepted as exponent character
 *-----------------------------------------------------------------------------*/
 extern double str2num(const char *s, int i, int n)
 {
-    char str[256],*p=str;
+    double val;
 
-    if (i<0||(int)sizeof(str)-1<n) return 0.0;
-    /* Special case i==0, skipping the strlen check.
-     * Note: Could usefully use strnlen(s,i) here */
-    if (i>0&&(int)strlen(s)<i) return 0.0;
+    if (i<0||255<n) return 0.0;
+    if (i>0&&memchr(s,'\0',i)) return 0.0;
 
-    for (s+=i;--n>=0;s++) {
-        char c=*s;
-        if (!c) break;
-        *p++=((c|0x20)=='d')?'E':c;
+    return parsenum(s+i,s+i+n,&val)?val:0.0;
+}
+/* string to integer -----------------------------------------------------------
+* convert substring in string to integer
+* args   : char   *s        I   string ("... nnn ...")
+*          int    i,n       I   substring position and width
+* return : converted integer (0:error)
+* notes  : conversion stops at the first non-digit character in the field
+*-----------------------------------------------------------------------------*/
+extern int str2int(const char *s, int i, int n)
+{
+    const char *p,*q;
+    int val=0,sgn=0;
+
+    if (i<0||n<=0) return 0;
+    if (i>0&&memchr(s,'\0',i)) return 0;
+
+    for (p=s+i,q=p+n;p<q&&(*p==' '||('\t'<=*p&&*p<='\r'));p++) ;
+    if (p<q&&(*p=='+'||*p=='-')) sgn=*p++=='-';
+    for (;p<q&&'0'<=*p&&*p<='9';p++) {
+        if (val<100000000) val=val*10+(*p-'0');
     }
-    *p='\0';
-    return strtod(str,NULL);
+    return sgn?-val:val;
 }
 /* string to time --------------------------------------------------------------
 * convert substring in string to gtime_t struct
@@ -1600,13 +1802,13 @@ extern double str2num(const char *s, int i, int n)
 extern int str2time(const char *s, int i, int n, gtime_t *t)
 {
     double ep[6];
-    char str[256],*p=str;
+    const char *p,*q;
+    int j;
 
-    if (i<0||(int)strlen(s)<i||(int)sizeof(str)-1<i) return -1;
-    for (s+=i;*s&&--n>=0;) *p++=*s++;
-    *p='\0';
-    if (sscanf(str,"%lf %lf %lf %lf %lf %lf",ep,ep+1,ep+2,ep+3,ep+4,ep+5)<6)
-        return -1;
+    if (i<0||255<i||(i>0&&memchr(s,'\0',i))) return -1;
+    for (p=s+i,q=p+n,j=0;j<6;j++) {
+        if (!(p=parsenum(p,q,ep+j))) return -1;
+    }
     if (ep[0]<100.0) ep[0]+=ep[0]<80.0?2000.0:1900.0;
     *t=epoch2time(ep);
     return 0;
@@ -2604,6 +2806,110 @@ static int readantex(const char *file, pcvs_t *pcvs)
 
     return 1;
 }
+/* split antenna type to antenna and radome --------------------------------*/
+static int anttypes(const char *type, char *buff, char **types)
+{
+    char *p,*q;
+    int n=0;
+
+    sprintf(buff,"%.*s",MAXANT-1,type);
+    for (p=strtok_r(buff," ",&q);p&&n<2;p=strtok_r(NULL," ",&q)) types[n++]=p;
+    return n;
+}
+/* hash of antenna type ------------------------------------------------------*/
+static uint32_t hashant(const char *ant, const char *rad)
+{
+    uint32_t h=2166136261u;
+
+    for (;*ant;ant++) h=(h^(uint8_t)*ant)*16777619u;
+    if (!rad) return h;
+    h=(h^(uint8_t)' ')*16777619u;
+    for (;*rad;rad++) h=(h^(uint8_t)*rad)*16777619u;
+    return h;
+}
+/* compare antenna type with antenna and radome (rad=NULL: any radome) -------*/
+static int matchant(const pcv_t *pcv, const char *ant, const char *rad)
+{
+    char buff[MAXANT],*types[2];
+    int n=anttypes(pcv->type,buff,types);
+
+    if (n<=0||strcmp(types[0],ant)) return 0;
+    return !rad||(n>=2&&!strcmp(types[1],rad));
+}
+/* search or insert antenna type in hash table -------------------------------*/
+static int hashpcv(int *h, int nh, const pcvs_t *pcvs, const char *ant,
+                   const char *rad, int ins)
+{
+    uint32_t k=hashant(ant,rad)&(uint32_t)(nh-1);
+
+    for (;h[k]>=0;k=(k+1)&(uint32_t)(nh-1)) {
+        if (matchant(pcvs->pcv+h[k],ant,rad)) return h[k];
+    }
+    if (ins>=0) h[k]=ins;
+    return -1;
+}
+/* free antenna parameters index ---------------------------------------------*/
+static void freepcvidx(pcvs_t *pcvs)
+{
+    if (!pcvs->idx) return;
+    free(pcvs->idx->sidx);
+    free(pcvs->idx->hrad);
+    free(pcvs->idx->hant);
+    free(pcvs->idx);
+    pcvs->idx=NULL;
+}
+/* set antenna parameters index ------------------------------------------------
+* index satellite antennas by satellite (soff[sat-1] to soff[sat]-1 in sidx)
+* and receiver antennas by hashed type {antenna,radome} and {antenna}. entries
+* keep the order in the file to return the same one as the linear search.
+*-----------------------------------------------------------------------------*/
+static void setpcvidx(pcvs_t *pcvs)
+{
+    pcvidx_t *idx;
+    char buff[MAXANT],*types[2];
+    int i,k,n,nh,off[MAXSAT+1];
+
+    freepcvidx(pcvs);
+    if (pcvs->n<=0) return;
+
+    for (nh=16;nh<pcvs->n*2;nh<<=1) ;
+
+    if (!(idx=(pcvidx_t *)calloc(1,sizeof(pcvidx_t)))||
+        !(idx->sidx=(int *)malloc(sizeof(int)*pcvs->n))||
+        !(idx->hrad=(int *)malloc(sizeof(int)*nh))||
+        !(idx->hant=(int *)malloc(sizeof(int)*nh))) {
+        trace(1,"setpcvidx: memory allocation error\n");
+        if (idx) {
+            free(idx->sidx); free(idx->hrad); free(idx->hant); free(idx);
+        }
+        return;
+    }
+    idx->n=pcvs->n;
+    idx->nh=nh;
+
+    /* satellite antennas sorted by satellite (stable) */
+    for (i=0;i<pcvs->n;i++) {
+        k=pcvs->pcv[i].sat;
+        if (k>=1&&k<=MAXSAT) idx->soff[k]++;
+    }
+    for (k=1;k<=MAXSAT;k++) {
+        idx->soff[k]+=idx->soff[k-1];
+        off[k]=idx->soff[k-1];
+    }
+    for (i=0;i<pcvs->n;i++) {
+        k=pcvs->pcv[i].sat;
+        if (k>=1&&k<=MAXSAT) idx->sidx[off[k]++]=i;
+    }
+    /* receiver antennas hashed by type (first entry in file order) */
+    for (i=0;i<nh;i++) idx->hrad[i]=idx->hant[i]=-1;
+
+    for (i=0;i<pcvs->n;i++) {
+        if ((n=anttypes(pcvs->pcv[i].type,buff,types))<=0) continue;
+        if (n>=2) hashpcv(idx->hrad,nh,pcvs,types[0],types[1],i);
+        hashpcv(idx->hant,nh,pcvs,types[0],NULL,i);
+    }
+    pcvs->idx=idx;
+}
 /* read antenna parameters ------------------------------------------------------
 * read antenna parameters
 * args   : char   *file       I   antenna parameter file (antex)
@@ -2636,6 +2942,7 @@ extern int readpcv(const char *file, pcvs_t *pcvs)
               pcv->sat,pcv->type,pcv->code,pcv->off[0][0],pcv->off[0][1],
               pcv->off[0][2],pcv->off[1][0],pcv->off[1][1],pcv->off[1][2]);
     }
+    setpcvidx(pcvs);
     return stat;
 }
 /* search antenna parameter ----------------------------------------------------
@@ -2645,19 +2952,26 @@ extern int readpcv(const char *file, pcvs_t *pcvs)
 *          gtime_t time       I   time to search parameters
 *          pcvs_t *pcvs       IO  antenna parameters
 * return : antenna parameter (NULL: no antenna)
+* notes  : the index set by readpcv() is used if available. receiver antenna
+*          type is searched by substrings with radome at first and without
+*          radome next in file order. the first entry of the exact names in
+*          the index ends each search as it matches the substrings as well.
 *-----------------------------------------------------------------------------*/
 extern pcv_t *searchpcv(int sat, const char *type, gtime_t time,
                         const pcvs_t *pcvs)
 {
+    const pcvidx_t *idx=pcvs->idx&&pcvs->idx->n==pcvs->n?pcvs->idx:NULL;
     pcv_t *pcv;
-    char buff[MAXANT],*types[2],*p;
-    int i,j,n=0;
+    char buff[MAXANT],*types[2];
+    int i,j,m,n;
 
     trace(4,"searchpcv: sat=%2d type=%s\n",sat,type);
 
     if (sat) { /* search satellite antenna */
-        for (i=0;i<pcvs->n;i++) {
-            pcv=pcvs->pcv+i;
+        if (idx&&(sat<1||sat>MAXSAT)) return NULL;
+
+        for (i=idx?idx->soff[sat-1]:0;i<(idx?idx->soff[sat]:pcvs->n);i++) {
+            pcv=pcvs->pcv+(idx?idx->sidx[i]:i);
             if (pcv->sat!=sat) continue;
             if (pcv->ts.time!=0&&timediff(pcv->ts,time)>0.0) continue;
             if (pcv->te.time!=0&&timediff(pcv->te,time)<0.0) continue;
@@ -2665,25 +2979,31 @@ extern pcv_t *searchpcv(int sat, const char *type, gtime_t time,
         }
     }
     else {
-        strcpy(buff,type);
-        char *q;
-        for (p=strtok_r(buff," ",&q);p&&n<2;p=strtok_r(NULL," ",&q)) types[n++]=p;
-        if (n<=0) return NULL;
+        if ((n=anttypes(type,buff,types))<=0) return NULL;
 
         /* search receiver antenna with radome at first */
-        for (i=0;i<pcvs->n;i++) {
+        m=idx?hashpcv(n>=2?idx->hrad:idx->hant,idx->nh,pcvs,types[0],
+                      n>=2?types[1]:NULL,-1):-1;
+        for (i=0;i<(m>=0?m:pcvs->n);i++) {
             pcv=pcvs->pcv+i;
             for (j=0;j<n;j++) if (!strstr(pcv->type,types[j])) break;
             if (j>=n) return pcv;
         }
+        if (m>=0) return pcvs->pcv+m;
+
         /* search receiver antenna without radome */
-        for (i=0;i<pcvs->n;i++) {
+        m=idx?hashpcv(idx->hant,idx->nh,pcvs,types[0],NULL,-1):-1;
+        for (i=0;i<(m>=0?m:pcvs->n);i++) {
             pcv=pcvs->pcv+i;
             if (strstr(pcv->type,types[0])!=pcv->type) continue;
 
             trace(2,"pcv without radome is used type=%s\n",type);
             return pcv;
         }
+        if (m>=0) {
+            trace(2,"pcv without radome is used type=%s\n",type);
+            return pcvs->pcv+m;
+        }
     }
     return NULL;
 }
@@ -3068,6 +3388,121 @@ extern void uniqnav(nav_t *nav)
     uniqeph (nav);
     uniqgeph(nav);
     uniqseph(nav);
+
+    /* index ephemeris by satellite */
+    idxnav(nav);
+}
+/* free ephemeris index ------------------------------------------------------*/
+static void freeidx(nav_t *nav)
+{
+    int i;
+
+    if (nav->eidx) {
+        for (i=0;i<MAXSAT;i++) free(nav->eidx[i].idx);
+        free(nav->eidx);
+    }
+    nav->eidx=NULL;
+    nav->ni[0]=nav->ni[1]=nav->ni[2]=0;
+}
+/* satellite and reference time of indexed ephemeris -------------------------*/
+static gtime_t idxtime(const nav_t *nav, int sys, int i, int *sat)
+{
+    if (sys==SYS_GLO) {*sat=nav->geph[i].sat; return nav->geph[i].toe;}
+    if (sys==SYS_SBS) {*sat=nav->seph[i].sat; return nav->seph[i].t0;}
+    *sat=nav->eph[i].sat;
+    return nav->eph[i].toe;
+}
+/* insert ephemeris into satellite index (sorted by toe and entry) -----------*/
+static int insidx(nav_t *nav, int sys, int i)
+{
+    ephidx_t *eidx;
+    gtime_t toe;
+    double dt;
+    int *idx,j,sat,s;
+
+    toe=idxtime(nav,sys,i,&sat);
+    if (sat<=0||sat>MAXSAT) return 1;
+    s=satsys(sat,NULL);
+    if (s!=SYS_GLO&&s!=SYS_SBS) s=SYS_GPS;
+    if (s!=sys) return 1; /* ephemeris type mismatch */
+    eidx=nav->eidx+sat-1;
+
+    if (eidx->n>=eidx->nmax) {
+        eidx->nmax=eidx->nmax<=0?8:eidx->nmax*2;
+        if (!(idx=(int *)realloc(eidx->idx,sizeof(int)*eidx->nmax))) {
+            trace(1,"insidx: malloc error n=%d\n",eidx->nmax);
+            return 0;
+        }
+        eidx->idx=idx;
+    }
+    /* entries are mostly added in time order */
+    for (j=eidx->n;j>0;j--) {
+        dt=timediff(idxtime(nav,sys,eidx->idx[j-1],&s),toe);
+        if (dt<0.0||(dt==0.0&&eidx->idx[j-1]<i)) break;
+        eidx->idx[j]=eidx->idx[j-1];
+    }
+    eidx->idx[j]=i;
+    eidx->n++;
+    return 1;
+}
+/* index ephemerides -----------------------------------------------------------
+* index ephemerides in navigation data by satellite sorted by toe to accelerate
+* ephemeris selection
+* args   : nav_t *nav    IO     navigation data
+* return : status (1:ok,0:error)
+* notes  : the index is valid as long as nav->n, nav->ng and nav->ns are not
+*          changed. call updidxnav() for ephemeris overwritten in place.
+*          selection falls back to linear search without a valid index.
+*-----------------------------------------------------------------------------*/
+extern int idxnav(nav_t *nav)
+{
+    int i;
+
+    trace(3,"idxnav: neph=%d ngeph=%d nseph=%d\n",nav->n,nav->ng,nav->ns);
+
+    freeidx(nav);
+
+    if (!(nav->eidx=(ephidx_t *)calloc(MAXSAT,sizeof(ephidx_t)))) {
+        trace(1,"idxnav: malloc error\n");
+        return 0;
+    }
+    for (i=0;i<nav->n;i++) {
+        if (!insidx(nav,SYS_GPS,i)) {freeidx(nav); return 0;}
+    }
+    for (i=0;i<nav->ng;i++) {
+        if (!insidx(nav,SYS_GLO,i)) {freeidx(nav); return 0;}
+    }
+    for (i=0;i<nav->ns;i++) {
+        if (!insidx(nav,SYS_SBS,i)) {freeidx(nav); return 0;}
+    }
+    nav->ni[0]=nav->n; nav->ni[1]=nav->ng; nav->ni[2]=nav->ns;
+    return 1;
+}
+/* update ephemeris index ------------------------------------------------------
+* update ephemeris index for an ephemeris overwritten in place
+* args   : nav_t *nav    IO     navigation data
+*          int    sat    I      satellite number of updated ephemeris
+*          int    i      I      index of updated ephemeris in nav->eph,
+*                               nav->geph (glonass) or nav->seph (sbas)
+* return : none
+*-----------------------------------------------------------------------------*/
+extern void updidxnav(nav_t *nav, int sat, int i)
+{
+    ephidx_t *eidx;
+    int j,k,sys;
+
+    if (!nav->eidx||sat<=0||sat>MAXSAT) return;
+
+    sys=satsys(sat,NULL);
+    if (sys!=SYS_GLO&&sys!=SYS_SBS) sys=SYS_GPS;
+    eidx=nav->eidx+sat-1;
+
+    for (j=k=0;j<eidx->n;j++) {
+        if (eidx->idx[j]!=i) eidx->idx[k++]=eidx->idx[j];
+    }
+    eidx->n=k;
+
+    if (!insidx(nav,sys,i)) freeidx(nav);
 }
 /* compare observation data -------------------------------------------------*/
 static int cmpobs(const void *p1, const void *p2)
@@ -3129,6 +3564,7 @@ extern int screent(gtime_t time, gtime_t ts, gtime_t te, double tint)
 * args   : char    file  I      file path
 *          nav_t   nav   O/I    navigation data
 * return : status (1:ok,0:no file)
+* notes  : ephemeris index of nav is rebuilt if exists
 *-----------------------------------------------------------------------------*/
 extern int readnav(const char *file, nav_t *nav)
 {
@@ -3195,6 +3631,9 @@ extern int readnav(const char *file, nav_t *nav)
         }
     }
     fclose(fp);
+
+    /* rebuild index for ephemerides overwritten in place */
+    if (nav->eidx) idxnav(nav);
     return 1;
 }
 extern int savenav(const char *file, const nav_t *nav)
@@ -3268,10 +3707,12 @@ extern void freeobs(obs_t *obs)
 *-----------------------------------------------------------------------------*/
 extern void freenav(nav_t *nav, int opt)
 {
+    if (opt&0x07) freeidx(nav);
     if (opt&0x01) {free(nav->eph ); nav->eph =NULL; nav->n =nav->nmax =0;}
     if (opt&0x02) {free(nav->geph); nav->geph=NULL; nav->ng=nav->ngmax=0;}
     if (opt&0x04) {free(nav->seph); nav->seph=NULL; nav->ns=nav->nsmax=0;}
     if (opt&0x08) {free(nav->peph); nav->peph=NULL; nav->ne=nav->nemax=0;}
+    if (opt&0x18) {free(nav->pephc); nav->pephc=NULL;}
     if (opt&0x10) {free(nav->pclk); nav->pclk=NULL; nav->nc=nav->ncmax=0;}
     if (opt&0x20) {free(nav->alm ); nav->alm =NULL; nav->na=nav->namax=0;}
     if (opt&0x40) {free(nav->tec ); nav->tec =NULL; nav->nt=nav->ntmax=0;}
@@ -3438,6 +3879,104 @@ extern void createdir(const char *path)
 
     mkdir_r(buff);
 }
+/* initialize/free file input buffer -------------------------------------------
+* initialize or free block-buffered file input
+* args   : fbuf_t *fb       IO  file input buffer
+* return : none
+* notes  : data read ahead from the file are held in the buffer. open and close
+*          the file by fopen_fbuf() and fclose_fbuf(), or call free_fbuf()
+*          when the file is closed or the position is changed.
+*-----------------------------------------------------------------------------*/
+extern void init_fbuf(fbuf_t *fb)
+{
+    fb->fp=NULL; fb->buff=NULL;
+    fb->nmax=fb->n=fb->p=0;
+}
+extern void free_fbuf(fbuf_t *fb)
+{
+    free(fb->buff);
+    init_fbuf(fb);
+}
+/* open/close file with file input buffer --------------------------------------
+* open or close a file read through the file input buffer
+* args   : fbuf_t *fb       IO  file input buffer
+*          char   *file     I   file path (fopen_fbuf())
+*          char   *mode     I   open mode as fopen() (fopen_fbuf())
+*          FILE   *fp       I   file pointer (fclose_fbuf())
+* return : file pointer (NULL: error) (fopen_fbuf())
+* notes  : the buffered data are discarded on both open and close, so that a
+*          new file with the same file pointer as a closed one never gets the
+*          data of the closed file. the buffer memory is kept for reuse.
+*-----------------------------------------------------------------------------*/
+extern FILE *fopen_fbuf(fbuf_t *fb, const char *file, const char *mode)
+{
+    fb->fp=NULL; fb->n=fb->p=0;
+    return fb->fp=fopen(file,mode);
+}
+extern void fclose_fbuf(fbuf_t *fb, FILE *fp)
+{
+    if (fp) fclose(fp);
+    fb->fp=NULL; fb->n=fb->p=0;
+}
+/* fill file input buffer ------------------------------------------------------
+* read a block from the file to make the next n bytes available in the buffer
+* args   : fbuf_t *fb       IO  file input buffer
+*          FILE   *fp       I   file pointer
+*          int    n         I   number of bytes required
+* return : number of bytes available from fb->buff+fb->p (<n: end of file)
+*-----------------------------------------------------------------------------*/
+extern int fill_fbuf(fbuf_t *fb, FILE *fp, int n)
+{
+    uint8_t *buff;
+    int nmax;
+
+    if (fb->fp!=fp) { /* discard data of other file */
+        fb->fp=fp; fb->n=fb->p=0;
+    }
+    if (fb->n-fb->p>=n) return fb->n-fb->p;
+
+    if (fb->p>0) { /* shift unread data to the top */
+        memmove(fb->buff,fb->buff+fb->p,fb->n-fb->p);
+        fb->n-=fb->p; fb->p=0;
+    }
+    if (fb->nmax<n+FBUFSIZE) {
+        nmax=n+FBUFSIZE;
+        if (!(buff=(uint8_t *)realloc(fb->buff,nmax))) {
+            trace(1,"fill_fbuf: malloc error n=%d\n",nmax);
+            return fb->n;
+        }
+        fb->buff=buff; fb->nmax=nmax;
+    }
+    while (fb->n<n) {
+        if ((nmax=(int)fread(fb->buff+fb->n,1,fb->nmax-fb->n,fp))<=0) break;
+        fb->n+=nmax;
+    }
+    return fb->n;
+}
+/* get a byte/read bytes from file input buffer --------------------------------
+* same as fgetc()/fread() with file input buffer
+* args   : fbuf_t *fb       IO  file input buffer
+*          FILE   *fp       I   file pointer
+*          uint8_t *buff    O   read data (read_fbuf())
+*          int    n         I   number of bytes to read (read_fbuf())
+* return : input byte (EOF: end of file) or number of bytes read
+*-----------------------------------------------------------------------------*/
+extern int getc_fbuf(fbuf_t *fb, FILE *fp)
+{
+    if (fb->p<fb->n&&fb->fp==fp) return fb->buff[fb->p++];
+    if (fill_fbuf(fb,fp,1)<1) return EOF;
+    return fb->buff[fb->p++];
+}
+extern int read_fbuf(fbuf_t *fb, FILE *fp, uint8_t *buff, int n)
+{
+    if (n<=0) return 0;
+    if (fill_fbuf(fb,fp,n)<n) n=fb->n-fb->p;
+    if (n>0) {
+        memcpy(buff,fb->buff+fb->p,n);
+        fb->p+=n;
+    }
+    return n;
+}
 /* replace string ------------------------------------------------------------*/
 static int repstr(char *str, const char *pat, const char *rep)
 {
@@ -3931,6 +4470,7 @@ extern void antmodel_s(const pcv_t *pcv, double nadir, double *dant)
 }
 // Free the pcv array.
 void free_pcvs(pcvs_t *pcvs) {
+  freepcvidx(pcvs);
   free(pcvs->pcv);
   pcvs->pcv = NULL;
   pcvs->n = pcvs->nmax = 0;
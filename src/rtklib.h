@@ -283,9 +283,13 @@ extern "C" {
 #define MAXSOLMSG   32768               /* max length of solution messages */
 #define MAXRAWLEN   16384               /* max length of receiver raw message */
 #define MAXERRMSG   4096                /* max length of error/warning message */
+#define MAXARWORK   3                   /* max number of partial ar workers */
 #define MAXANT      64                  /* max length of station name/antenna type */
 #define MAXSOLBUF   256                 /* max number of solution buffer */
 #define MAXOBSBUF   128                 /* max number of observation data buffer */
+#define MAXROVOBSQ  16                  /* max number of queued epochs per rover in RTK server */
+#define MAXNAVPIN   64                  /* max number of pinned nav snapshots in RTK server */
+#define NPEPHINT    11                  /* number of precise ephemeris interpolation points */
 #define MAXNRPOS    16                  /* max number of reference positions */
 #define MAXLEAPS    64                  /* max number of leap seconds table */
 #define MAXGISLAYER 32                  /* max number of GIS data layers */
@@ -401,6 +405,20 @@ extern "C" {
 #define SOLF_STAT   4                   /* solution format: solution status */
 #define SOLF_GSIF   5                   /* solution format: GSI F1/F2 */
 
+#define SSTATF_TEXT 0                   /* solution status format: text */
+#define SSTATF_BIN  1                   /* solution status format: binary */
+
+#define SSTAT_EPOCH 0                   /* solution status record: epoch */
+#define SSTAT_POS   1                   /* solution status record: $POS */
+#define SSTAT_VELACC 2                  /* solution status record: $VELACC */
+#define SSTAT_CLK   3                   /* solution status record: $CLK */
+#define SSTAT_ION   4                   /* solution status record: $ION */
+#define SSTAT_TROP  5                   /* solution status record: $TROP */
+#define SSTAT_TRPG  6                   /* solution status record: $TRPG */
+#define SSTAT_HWBIAS 7                  /* solution status record: $HWBIAS */
+#define SSTAT_SAT   8                   /* solution status record: $SAT */
+#define SSTAT_AMB   9                   /* solution status record: $AMB */
+
 #define SOLQ_NONE   0                   /* solution status: no solution */
 #define SOLQ_FIX    1                   /* solution status: fix */
 #define SOLQ_FLOAT  2                   /* solution status: float */
@@ -625,9 +643,19 @@ typedef struct {        /* antenna parameter type */
                         /* el=90,85,...,0 or nadir=0,1,2,3,... (deg) */
 } pcv_t;
 
+typedef struct {        /* antenna parameters index type */
+    int n;              /* number of indexed antenna parameters */
+    int soff[MAXSAT+1]; /* offset of satellite entries in sidx by satellite */
+    int *sidx;          /* satellite antenna indices sorted by satellite */
+    int nh;             /* size of antenna type hash tables (power of 2) */
+    int *hrad;          /* hash table by antenna and radome (-1:empty) */
+    int *hant;          /* hash table by antenna without radome (-1:empty) */
+} pcvidx_t;
+
 typedef struct {        /* antenna parameters type */
     int n,nmax;         /* number of data/allocated */
     pcv_t *pcv;         /* antenna parameters data */
+    pcvidx_t *idx;      /* antenna parameters index (NULL:no index) */
 } pcvs_t;
 
 typedef struct {        /* almanac type */
@@ -714,6 +742,29 @@ typedef struct {        /* SBAS ephemeris type */
     double af0,af1;     /* satellite clock-offset/drift (s,s/s) */
 } seph_t;
 
+typedef struct {        /* ephemeris index type */
+    int n,nmax;         /* number of indexed ephemeris */
+    int *idx;           /* ephemeris indices sorted by toe */
+} ephidx_t;
+
+typedef struct {        /* precise ephemeris interpolation window type */
+    int i;              /* start index of window in nav->peph (-1:none) */
+    int stat;           /* window status (0:ephemeris outage,1:ok) */
+    gtime_t t0;         /* reference time of window (gpst) */
+    double tau[NPEPHINT]; /* interpolation point times - t0 (s) */
+    double w[NPEPHINT]; /* barycentric interpolation weights */
+    double q[3][NPEPHINT]; /* interpolation point positions rotated to t0 (m) */
+} pephw_t;
+
+typedef struct {        /* precise ephemeris interpolation cache type */
+    const peph_t *peph; /* cached precise ephemeris */
+    const pclk_t *pclk; /* cached precise clock */
+    int ne,nc;          /* number of cached precise ephemeris/clock */
+    gtime_t te,tc;      /* first time of cached precise ephemeris/clock */
+    int ie,ic;          /* last interval index of precise ephemeris/clock */
+    pephw_t win[MAXSAT]; /* interpolation windows by satellite */
+} pephc_t;
+
 typedef struct {        /* NORAD TLE data type */
     char name [32];     /* common name */
     char alias[32];     /* alias name */
@@ -855,6 +906,9 @@ typedef struct {        /* navigation data type */
     pclk_t *pclk;       /* precise clock */
     alm_t *alm;         /* almanac data */
     tec_t *tec;         /* tec grid data */
+    int ni[3];          /* number of indexed ephemeris {eph,geph,seph} */
+    ephidx_t *eidx;     /* ephemeris index by satellite [MAXSAT] (NULL:no index) */
+    pephc_t *pephc;     /* precise ephemeris interpolation cache (NULL:no cache) */
     erp_t  erp;         /* earth rotation parameters */
     double utc_gps[8];  /* GPS delta-UTC parameters {A0,A1,Tot,WNt,dt_LS,WN_LSF,DN,dt_LSF} */
     double utc_glo[8];  /* GLONASS UTC time parameters {tau_C,tau_GPS} */
@@ -920,6 +974,16 @@ typedef struct {        /* solution type */
     int refstationid;   /* ref station ID */
 } sol_t;
 
+typedef struct {        /* post-processing shared data type */
+    pcvs_t pcvss;       /* satellite antenna parameters */
+    pcvs_t pcvsr;       /* receiver antenna parameters */
+    erp_t erp;          /* earth rotation parameters (n=0: read by session) */
+    int ne,nc;          /* number of precise ephemeris/clock (0: read by session) */
+    peph_t *peph;       /* precise ephemeris */
+    pclk_t *pclk;       /* precise clock */
+    int geoid;          /* geoid data opened (0:no,1:yes) */
+} ppshr_t;
+
 typedef struct {        /* solution buffer type */
     int n,nmax;         /* number of solution/max number of buffer */
     int cyclic;         /* cyclic buffer flag */
@@ -951,6 +1015,12 @@ typedef struct {        /* solution status buffer type */
     solstat_t *data;    /* solution status data */
 } solstatbuf_t;
 
+typedef struct {        /* block-buffered file input type */
+    FILE *fp;           /* file pointer of buffered data */
+    uint8_t *buff;      /* input buffer */
+    int nmax,n,p;       /* buffer size, bytes in buffer, read position */
+} fbuf_t;
+
 typedef struct {        /* RTCM control struct type */
     int staid;          /* station id */
     int stah;           /* station health */
@@ -982,6 +1052,7 @@ typedef struct {        /* RTCM control struct type */
     uint32_t nmsg2[100]; /* message count of RTCM 2 (1-99:1-99,0:other) */
     uint32_t nmsg3[400]; /* message count of RTCM 3 (1-299:1001-1299,300-329:4070-4099,0:other) */
     char opt[256];      /* RTCM dependent options */
+    fbuf_t fbuf;        /* file input buffer */
 } rtcm_t;
 
 typedef struct {        /* RINEX control struct type */
@@ -999,6 +1070,25 @@ typedef struct {        /* RINEX control struct type */
     char   opt[256];    /* rinex dependent options */
 } rnxctr_t;
 
+typedef struct {        /* RINEX observation data stream type */
+    gtime_t ts,te;      /* observation time start/end (time==0: no limit) */
+    double tint;        /* observation time interval (s) (0:all) */
+    char   opt[256];    /* rinex dependent options */
+    int    rcv;         /* receiver number */
+    int    nfile,ifile; /* number of files/index of next file */
+    char   **file;      /* expanded files */
+    FILE   *fp;         /* current file (NULL: closed) */
+    char   tmpfile[1024]; /* uncompressed current file ("": none) */
+    double ver;         /* RINEX version of current file */
+    int    tsys;        /* time system of current file */
+    char   tobs[RNX_NUMSYS][MAXOBSTYPE][4]; /* rinex obs types of current file */
+    sta_t  sta;         /* station info of current file */
+    gtime_t tout;       /* time of last output epoch */
+    obsd_t *data;       /* epoch data buffer */
+    obs_t  obs;         /* observation data buffer */
+    void   *st;         /* epoch reader state */
+} rnxobs_t;
+
 typedef struct {        /* download URL type */
     char type[32];      /* data type */
     char path[1024];    /* URL path */
@@ -1082,6 +1172,11 @@ typedef struct {        /* processing options type */
     double odisp[2][2][11][3]; // Ocean tide loading parameters {rov,base}{amp,phase}
     int  freqopt;       /* disable L2-AR */
     char pppopt[256];   /* ppp option */
+    int  combpar;       /* forward/backward of combined in parallel (0:off,1:on) */
+    int  arpar;         /* partial ar candidates in parallel (0:off,1:on) */
+    int  obscache;      /* binary obs/nav cache of input files (0:off,1:on) */
+    int  obsstream;     /* streaming obs data in forward solution (0:off,1:on) */
+    int  solspill;      /* spill combined solutions to mapped files (0:off,1:on) */
 } prcopt_t;
 
 typedef struct {        /* solution options type */
@@ -1104,6 +1199,7 @@ typedef struct {        /* solution options type */
     char sep[64];       /* field separator */
     char prog[64];      /* program name */
     double maxsolstd;   /* max std-dev for solution output (m) (0:all) */
+    int sstatf;         /* solution statistics format (SSTATF_???) */
 } solopt_t;
 
 typedef struct {        /* file options type */
@@ -1158,6 +1254,8 @@ typedef struct {        /* RINEX options type */
     int halfcyc;        /* half cycle correction */
     int sortsats;       /* Sort by satellite index */
     int sep_nav;        /* separated nav files */
+    int onepass;        /* single-pass conversion without scan (0:off,1:on) */
+    int nthread;        /* number of threads for parallel conversion (0,1:off) */
     gtime_t tstart;     /* first obs time */
     gtime_t tend;       /* last obs time */
     gtime_t trtcm;      /* approx log start time for rtcm */
@@ -1200,6 +1298,17 @@ typedef struct {        /* ambiguity control type */
     char flags[MAXSAT]; /* fix flags */
 } ambc_t;
 
+typedef struct {        /* lambda workspace type */
+    int nmax,mmax;      /* max number of float parameters/fixed solutions */
+    double *buff;       /* work buffer */
+} lambda_ws_t;
+
+typedef struct {        /* kalman filter workspace type */
+    int nmax,mmax;      /* max number of states/measurements of buffers */
+    double *buff;       /* work buffer */
+    int *ix;            /* index of non-zero states */
+} filtws_t;
+
 typedef struct {        /* RTK control/result type */
     sol_t  sol;         /* RTK solution */
     double rb[6];       /* base position/velocity (ecef) (m|m/s) */
@@ -1220,6 +1329,10 @@ typedef struct {        /* RTK control/result type */
     int epoch;          /* epoch number */
     int intpres_nb;     // Time interpolation of residuals, number of previous base observations.
     obsd_t intpres_obsb[MAXOBS]; // Time interpolation of residuals, previous base observations.
+    filtws_t ws;        /* kalman filter workspace */
+    lambda_ws_t lws;    /* lambda workspace */
+    lambda_ws_t arws[MAXARWORK]; /* lambda workspaces of partial ar workers */
+    void *arpool;       /* partial ar worker pool (prcopt.arpar) */
 } rtk_t;
 
 typedef struct {        /* receiver raw data control type */
@@ -1238,6 +1351,7 @@ typedef struct {        /* receiver raw data control type */
     unsigned char lockflag[MAXSAT][NFREQ+NEXOBS]; /* used for carrying forward cycle slip */
     double icpp[MAXSAT],off[MAXSAT],icpc; /* carrier params for ss2 */
     double prCA[MAXSAT],dpCA[MAXSAT]; /* L1/CA pseudorange/doppler for javad */
+    double adrs[MAXSAT]; /* previous carrier phase for u-blox TRK (cyc) */
     uint8_t halfc[MAXSAT][NFREQ+NEXOBS]; /* half-cycle resolved */
     char freqn[MAXOBS]; /* frequency number for javad */
     int nbyte;          /* number of bytes in message buffer */
@@ -1252,6 +1366,7 @@ typedef struct {        /* receiver raw data control type */
     int format;         /* receiver stream format */
     int rcvtype;        /* receiver type within format */
     void *rcv_data;     /* receiver dependent data */
+    fbuf_t fbuf;        /* file input buffer */
 } raw_t;
 
 typedef struct {        /* stream type */
@@ -1303,6 +1418,29 @@ typedef struct {        /* stream server type */
     rtklib_lock_t lock; /* lock flag */
 } strsvr_t;
 
+typedef struct {        /* RTK server rover type (multi-rover mode) */
+    char name[MAXANT];  /* rover name */
+    int format;         /* input format (STRFMT_???) */
+    int strs[4];        /* stream types {input,sol1,sol2,log} */
+    char paths[4][MAXSTRPATH]; /* stream paths {input,sol1,sol2,log} */
+    char rcvopt[256];   /* receiver option */
+    solopt_t solopt[2]; /* output solution options {sol1,sol2} */
+    rtk_t rtk;          /* RTK control/result struct (solver only) */
+    sol_t sol;          /* latest solution */
+    int nb;             /* bytes in input buffer */
+    uint8_t *buff;      /* input buffer */
+    raw_t raw;          /* receiver raw control */
+    rtcm_t rtcm;        /* RTCM control */
+    obs_t obsq[MAXROVOBSQ]; /* observation queue to solver */
+    int qhead,qtail;    /* observation queue head/tail */
+    int busy;           /* solver busy flag */
+    stream_t stream[4]; /* streams {input,sol1,sol2,log} */
+    uint32_t nobs,nerr; /* input observation/error message counts */
+    uint32_t nsol;      /* number of solutions */
+    int prcout;         /* missing observation data count */
+    int cputime;        /* CPU time (ms) for last epoch */
+} rtksvrrov_t;
+
 typedef struct {        /* RTK server type */
     int state;          /* server state (0:stop,1:running) */
     int cycle;          /* processing cycle (ms) */
@@ -1335,6 +1473,13 @@ typedef struct {        /* RTK server type */
     stream_t *moni;     /* monitor stream */
     uint32_t tick;      /* start tick */
     rtklib_thread_t thread; /* server thread */
+    rtklib_thread_t ithread[3]; /* input/decode threads {rov,base,corr} */
+    rtklib_thread_t othread; /* solution output thread */
+    obs_t obsq[MAXOBSBUF]; /* rover observation queue to solver */
+    uint32_t tickq[MAXOBSBUF]; /* rover observation queue input ticks */
+    int qhead,qtail;    /* rover observation queue head/tail */
+    uint8_t *obuf[3];   /* solution output queues {sol1,sol2,moni} */
+    int nob[3];         /* bytes in solution output queues */
     int cputime;        /* CPU time (ms) for a processing cycle */
     int prcout;         /* missing observation data count */
     int nave;           /* number of averaging base pos */
@@ -1343,6 +1488,16 @@ typedef struct {        /* RTK server type */
     char cmd_reset[MAXRCVCMD]; /* reset command */
     double bl_reset;    /* baseline length to reset (km) */
     pcvs_t pcvsr;       // Receiver antenna parameters.
+    rtksvrrov_t *rov;   /* rovers of multi-rover mode (NULL: single rover) */
+    int nrov;           /* number of rovers */
+    int nworker;        /* number of solver threads for rovers */
+    int irov;           /* next rover index to schedule */
+    void *volatile navsnap; /* current navigation data snapshot */
+    void *navret;       /* retired navigation data snapshots */
+    void *navfree;      /* recycled navigation data snapshots */
+    volatile uint32_t navver; /* version of current navigation data snapshot */
+    volatile uint32_t navpin[MAXNAVPIN]; /* pinned snapshot versions (0:free) */
+    int navupd;         /* navigation data updated flag */
     rtklib_lock_t lock; /* lock flag */
 } rtksvr_t;
 
@@ -1427,6 +1582,10 @@ EXPORT int  lsq   (const double *A, const double *y, int n, int m, double *x,
                    double *Q);
 EXPORT int  filter(double *x, double *P, const double *H, const double *v,
                    const double *R, int n, int m);
+EXPORT int  filterws(filtws_t *ws, double *x, double *P, const double *H,
+                     const double *v, const double *R, int n, int m);
+EXPORT void initfiltws(filtws_t *ws);
+EXPORT void freefiltws(filtws_t *ws);
 EXPORT int  smoother(const double *xf, const double *Qf, const double *xb,
                      const double *Qb, int n, double *xs, double *Qs);
 EXPORT void matprint (const double *A, int n, int m, int p, int q);
@@ -1437,6 +1596,7 @@ EXPORT void add_fatal(fatalfunc_t *func);
 /* time and string functions -------------------------------------------------*/
 EXPORT void    setstr(char *dst, const char *src, int n);
 EXPORT double  str2num(const char *s, int i, int n);
+EXPORT int     str2int(const char *s, int i, int n);
 EXPORT int     str2time(const char *s, int i, int n, gtime_t *t);
 EXPORT char    *time2str(gtime_t t, char str[40], int n);
 EXPORT gtime_t epoch2time(const double *ep);
@@ -1487,6 +1647,8 @@ EXPORT double dms2deg(const double *dms);
 EXPORT void readpos(const char *file, const char *rcv, double *pos);
 EXPORT int  sortobs(obs_t *obs);
 EXPORT void uniqnav(nav_t *nav);
+EXPORT int  idxnav (nav_t *nav);
+EXPORT void updidxnav(nav_t *nav, int sat, int i);
 EXPORT int  screent(gtime_t time, gtime_t ts, gtime_t te, double tint);
 EXPORT int  readnav(const char *file, nav_t *nav);
 EXPORT int  savenav(const char *file, const nav_t *nav);
@@ -1513,6 +1675,7 @@ EXPORT void traceopen(const char *file);
 EXPORT void traceclose(void);
 EXPORT void tracelevel(int level);
 EXPORT int gettracelevel(void);
+EXPORT void traceasync(int size);
 
 EXPORT void trace_impl    (int level, const char *format, ...);
 EXPORT void tracet_impl   (int level, const char *format, ...);
@@ -1531,6 +1694,7 @@ EXPORT void traceb_impl   (int level, const uint8_t *p, int n);
 #define traceclose()          ((void)0)
 #define tracelevel(level)     ((void)0)
 #define gettracelevel() 0
+#define traceasync(size)      ((void)0)
 
 #define trace(level, ...)     ((void)0)
 #define tracet(level, ...)    ((void)0)
@@ -1549,6 +1713,13 @@ EXPORT void traceb_impl   (int level, const uint8_t *p, int n);
 EXPORT int execcmd(const char *cmd);
 EXPORT int expath (const char *path, char *paths[], int nmax);
 EXPORT void createdir(const char *path);
+EXPORT void init_fbuf(fbuf_t *fb);
+EXPORT void free_fbuf(fbuf_t *fb);
+EXPORT FILE *fopen_fbuf(fbuf_t *fb, const char *file, const char *mode);
+EXPORT void fclose_fbuf(fbuf_t *fb, FILE *fp);
+EXPORT int  fill_fbuf(fbuf_t *fb, FILE *fp, int n);
+EXPORT int  getc_fbuf(fbuf_t *fb, FILE *fp);
+EXPORT int  read_fbuf(fbuf_t *fb, FILE *fp, uint8_t *buff, int n);
 
 /* positioning models --------------------------------------------------------*/
 EXPORT double satazel(const double *pos, const double *e, double *azel);
@@ -1593,6 +1764,7 @@ EXPORT void tidedisp(gtime_t tutc, const double *rr, int opt, const erp_t *erp,
 EXPORT int opengeoid(int model, const char *file);
 EXPORT void closegeoid(void);
 EXPORT double geoidh(const double *pos);
+EXPORT int geoidh_n(const double *pos, int n, double *h);
 
 /* datum transformation ------------------------------------------------------*/
 EXPORT int loaddatump(const char *file);
@@ -1622,10 +1794,16 @@ EXPORT int outrnxhnavb(FILE *fp, const rnxopt_t *opt, const seph_t *seph);
 EXPORT int rnxcomment(rnxopt_t *opt, const char *format, ...);
 EXPORT int rtk_uncompress(const char *file, char *uncfile);
 EXPORT int convrnx(int format, rnxopt_t *opt, const char *file, char **ofile);
+EXPORT int convrnxm(int format, rnxopt_t *opt, char **file, char ***ofile,
+                    int n, int *stat);
 EXPORT int  init_rnxctr (rnxctr_t *rnx);
 EXPORT void free_rnxctr (rnxctr_t *rnx);
 EXPORT int  open_rnxctr (rnxctr_t *rnx, FILE *fp);
 EXPORT int  input_rnxctr(rnxctr_t *rnx, FILE *fp);
+EXPORT int  open_rnxobs (rnxobs_t *rnx, const char **file, int n, int rcv,
+                         gtime_t ts, gtime_t te, double tint, const char *opt);
+EXPORT int  input_rnxobs(rnxobs_t *rnx, obs_t *obs);
+EXPORT void close_rnxobs(rnxobs_t *rnx);
 
 /* ephemeris and clock functions ---------------------------------------------*/
 EXPORT double eph2clk (gtime_t time, const eph_t  *eph);
@@ -1637,6 +1815,10 @@ EXPORT void geph2pos(gtime_t time, const geph_t *geph, double *rs, double *dts,
                      double *var);
 EXPORT void seph2pos(gtime_t time, const seph_t *seph, double *rs, double *dts,
                      double *var);
+EXPORT void eph2poss(int n, const gtime_t *time, const eph_t **eph,
+                     double *rs, double *dts, double *var);
+EXPORT int  initpephc(nav_t *nav);
+EXPORT void freepephc(nav_t *nav);
 EXPORT int  peph2pos(gtime_t time, int sat, const nav_t *nav, int opt,
                      double *rs, double *dts, double *var);
 EXPORT void satantoff(gtime_t time, const double *rs, int sat, const nav_t *nav,
@@ -1747,6 +1929,7 @@ EXPORT int readsolt(const char *files[], int nfile, gtime_t ts, gtime_t te,
 EXPORT int readsolstat(const char *files[], int nfile, solstatbuf_t *statbuf);
 EXPORT int readsolstatt(const char *files[], int nfile, gtime_t ts, gtime_t te,
                         double tint, solstatbuf_t *statbuf);
+EXPORT int convsolstat(const char *infile, const char *outfile);
 EXPORT int inputsol(uint8_t data, gtime_t ts, gtime_t te, double tint,
                     int qflag, const solopt_t *opt, solbuf_t *solbuf);
 
@@ -1756,6 +1939,9 @@ EXPORT int outsols  (uint8_t *buff, const sol_t *sol, const double *rb,
                      const solopt_t *opt);
 EXPORT int outsolexs(uint8_t *buff, const sol_t *sol, const ssat_t *ssat,
                      const solopt_t *opt);
+EXPORT int outsolstatrec(uint8_t *buff, int fmt, int type, int week, double tow,
+                         const double *val, int n);
+EXPORT int outsolstathb(uint8_t *buff);
 EXPORT void outprcopt(FILE *fp, const prcopt_t *opt);
 EXPORT void outsolhead(FILE *fp, const solopt_t *opt);
 EXPORT void outsol  (FILE *fp, const sol_t *sol, const double *rb,
@@ -1825,6 +2011,7 @@ EXPORT void strsync  (stream_t *stream1, stream_t *stream2);
 EXPORT int  strstat  (stream_t *stream, char *msg);
 EXPORT int  strstatx (stream_t *stream, char *msg);
 EXPORT void strsum   (stream_t *stream, int *inb, int *inr, int *outb, int *outr);
+EXPORT int  strwait  (stream_t *stream, int n, int tmax);
 EXPORT void strsetopt(const int *opt);
 EXPORT gtime_t strgettime(stream_t *stream);
 EXPORT void strsendnmea(stream_t *stream, const sol_t *sol);
@@ -1839,6 +2026,10 @@ EXPORT int lambda(int n, int m, const double *a, const double *Q, double *F,
 EXPORT int lambda_reduction(int n, const double *Q, double *Z);
 EXPORT int lambda_search(int n, int m, const double *a, const double *Q,
                          double *F, double *s);
+EXPORT int lambda_ws(lambda_ws_t *ws, int n, int m, const double *a,
+                     const double *Q, double *F, double *s);
+EXPORT void lambda_initws(lambda_ws_t *ws);
+EXPORT void lambda_freews(lambda_ws_t *ws);
 
 /* standard positioning ------------------------------------------------------*/
 EXPORT int pntpos(const obsd_t *obs, int n, const nav_t *nav,
@@ -1850,13 +2041,15 @@ EXPORT void rtkinit(rtk_t *rtk, const prcopt_t *opt);
 EXPORT void rtkfree(rtk_t *rtk);
 EXPORT int  rtkpos (rtk_t *rtk, const obsd_t *obs, int nobs, const nav_t *nav);
 EXPORT int  rtkopenstat(const char *file, int level);
+EXPORT int  rtkopenstatb(const char *file, int level);
 EXPORT void rtkclosestat(void);
 EXPORT int  rtkoutstat(rtk_t *rtk, int level, char *buff);
+EXPORT int  rtkoutstatb(rtk_t *rtk, int level, uint8_t *buff);
 
 /* precise point positioning -------------------------------------------------*/
 EXPORT void pppos(rtk_t *rtk, const obsd_t *obs, int n, const nav_t *nav);
 EXPORT int pppnx(const prcopt_t *opt);
-EXPORT int pppoutstat(rtk_t *rtk, char *buff);
+EXPORT int pppoutstat(rtk_t *rtk, int fmt, uint8_t *buff);
 
 EXPORT int ppp_ar(rtk_t *rtk, const obsd_t *obs, int n, int *exc,
                   const nav_t *nav, const double *azel, double *x, double *P);
@@ -1866,6 +2059,13 @@ EXPORT int postpos(gtime_t ts, gtime_t te, double ti, double tu,
                    const prcopt_t *popt, const solopt_t *sopt,
                    const filopt_t *fopt, const char **infile, int n, const char *outfile,
                    const char *rov, const char *base);
+EXPORT int  ppshrinit(ppshr_t *shr, const solopt_t *sopt, const filopt_t *fopt,
+                      const char **infile, int n);
+EXPORT void ppshrfree(ppshr_t *shr);
+EXPORT int postpos_ctx(const ppshr_t *shr, gtime_t ts, gtime_t te, double ti,
+                       double tu, const prcopt_t *popt, const solopt_t *sopt,
+                       const filopt_t *fopt, const char **infile, int n,
+                       const char *outfile, const char *rov, const char *base);
 EXPORT int getstapos(const char *file, const char *name, double *r);
 
 /* stream server functions ---------------------------------------------------*/
@@ -1898,6 +2098,12 @@ EXPORT int  rtksvrostat (rtksvr_t *svr, int type, gtime_t *time, int *sat,
                          double *az, double *el, int **snr, int *vsat);
 EXPORT void rtksvrsstat (rtksvr_t *svr, int *sstat, char *msg);
 EXPORT int  rtksvrmark(rtksvr_t *svr, const char *name, const char *comment);
+EXPORT int  rtksvraddrov(rtksvr_t *svr, const char *name, const int *strs,
+                         const char **paths, int format, const char *rcvopt,
+                         const solopt_t *solopt);
+EXPORT void rtksvrfreerov(rtksvr_t *svr);
+EXPORT const nav_t *rtksvrpinnav(rtksvr_t *svr, int *pin);
+EXPORT void rtksvrunpinnav(rtksvr_t *svr, int pin);
 
 /* downloader functions ------------------------------------------------------*/
 EXPORT int dl_readurls(const char *file, const char **types, int ntype, url_t *urls,
@@ -46,6 +46,13 @@
 *                           add detecting cycle slips by L1-Lx GF phase jump
 *                           delete GLONASS IFB correction in ddres()
 *                           use integer types in stdint.h
+*           2026/10/16 1.17 add option to evaluate partial ar candidates in
+*                           parallel (prcopt.arpar)
+*                           add binary solution status output
+*                           add api rtkopenstatb(),rtkoutstatb()
+*                           evaluate partial ar candidates by worker pool kept
+*                           in rtk control and apply them in sequential order
+*                           lock solution status file for concurrent rtkpos()
 *-----------------------------------------------------------------------------*/
 #include <stdarg.h>
 #include "rtklib.h"
@@ -72,6 +79,8 @@
 
 #define GAP_RESION  120      /* gap to reset ionosphere parameters (epochs) */
 
+#define MAXARCAND   (MAXARWORK+1) /* max number of partial ar candidates */
+
 #define TTOL_MOVEB  (1.0+2*DTTOL)
                              /* time sync tolerance for moving-baseline (s) */
 
@@ -100,10 +109,44 @@ static double ar_poly_coeffs[3][5] = {
 
 /* global variables ----------------------------------------------------------*/
 static int statlevel=0;          /* rtk status output level (0:off) */
+static int statfmt=SSTATF_TEXT;  /* rtk status output format (SSTATF_???) */
 static FILE *fp_stat=NULL;       /* rtk status file pointer */
 static char file_stat[1024]="";  /* rtk status file original path */
 static gtime_t time_stat={0};    /* rtk status file time */
+static rtklib_lock_t lock_stat;  /* lock for rtk status file */
+static int initlock_stat=0;      /* lock initialized flag */
 
+/* open solution status file in text or binary format ------------------------*/
+static int openstat(const char *file, int level, int fmt)
+{
+    gtime_t time=utc2gpst(timeget());
+    uint8_t head[16];
+    char path[1024];
+
+    trace(3,"rtkopenstat: file=%s level=%d fmt=%d\n",file,level,fmt);
+
+    if (level<=0) return 0;
+
+    if (!initlock_stat) {
+        rtklib_initlock(&lock_stat);
+        initlock_stat=1;
+    }
+    reppath(file,path,time,"","");
+
+    rtklib_lock(&lock_stat);
+    if (!(fp_stat=fopen(path,fmt==SSTATF_BIN?"wb":"w"))) {
+        rtklib_unlock(&lock_stat);
+        trace(1,"rtkopenstat: file open error path=%s\n",path);
+        return 0;
+    }
+    if (fmt==SSTATF_BIN) fwrite(head,outsolstathb(head),1,fp_stat);
+    strcpy(file_stat,file);
+    time_stat=time;
+    statlevel=level;
+    statfmt=fmt;
+    rtklib_unlock(&lock_stat);
+    return 1;
+}
 /* open solution status file ---------------------------------------------------
 * open solution status file and set output level
 * args   : char     *file   I   rtk status file
@@ -181,23 +224,18 @@ static gtime_t time_stat={0};    /* rtk status file time */
 *-----------------------------------------------------------------------------*/
 extern int rtkopenstat(const char *file, int level)
 {
-    gtime_t time=utc2gpst(timeget());
-    char path[1024];
-
-    trace(3,"rtkopenstat: file=%s level=%d\n",file,level);
-
-    if (level<=0) return 0;
-
-    reppath(file,path,time,"","");
-
-    if (!(fp_stat=fopen(path,"w"))) {
-        trace(1,"rtkopenstat: file open error path=%s\n",path);
-        return 0;
-    }
-    strcpy(file_stat,file);
-    time_stat=time;
-    statlevel=level;
-    return 1;
+    return openstat(file,level,SSTATF_TEXT);
+}
+/* open binary solution status file --------------------------------------------
+* open solution status file in binary format and set output level
+* args   : char     *file   I   rtk status file
+*          int      level   I   rtk status level (0: off)
+* return : status (1:ok,0:error)
+* notes  : binary file can be converted to text by convsolstat()
+*-----------------------------------------------------------------------------*/
+extern int rtkopenstatb(const char *file, int level)
+{
+    return openstat(file,level,SSTATF_BIN);
 }
 /* close solution status file --------------------------------------------------
 * close solution status file
@@ -208,22 +246,27 @@ extern void rtkclosestat(void)
 {
     trace(3,"rtkclosestat:\n");
 
+    if (!initlock_stat) return;
+
+    rtklib_lock(&lock_stat);
     if (fp_stat) fclose(fp_stat);
     fp_stat=NULL;
     file_stat[0]='\0';
     statlevel=0;
+    statfmt=SSTATF_TEXT;
+    rtklib_unlock(&lock_stat);
 }
-/* Write solution status to buffer -------------------------------------------*/
-extern int rtkoutstat(rtk_t *rtk, int level, char *buff)
+/* write solution status to buffer in text or binary format ------------------*/
+static int outstat(rtk_t *rtk, int level, int fmt, uint8_t *buff)
 {
     if (level<=0||rtk->sol.stat==SOLQ_NONE) {
         return 0;
     }
 
     ssat_t *ssat;
-    double pos[3],vel[3],acc[3],vela[3]={0},acca[3]={0},xa[3];
+    double pos[3],vel[3],acc[3],vela[3]={0},acca[3]={0},v[17];
     int week,nf=NF(&rtk->opt);
-    char id[8],*p=buff;
+    uint8_t *p=buff;
 
     int est=rtk->opt.mode>=PMODE_DGPS;
     int nfreq=est?nf:1;
@@ -231,73 +274,72 @@ extern int rtkoutstat(rtk_t *rtk, int level, char *buff)
 
     if (rtk->opt.mode>=PMODE_PPP_KINEMA) {
         /* Write ppp solution status to buffer */
-        p+=pppoutstat(rtk,buff);
+        p+=pppoutstat(rtk,fmt,buff);
     } else {
+        p+=outsolstatrec(p,fmt,SSTAT_EPOCH,week,tow,NULL,0);
+
         /* Receiver position */
-        if (est) {
-            for (int i=0;i<3;i++) xa[i]=i<rtk->na?rtk->xa[i]:0.0;
-            p+=sprintf(p,"$POS,%d,%.3f,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n",week,tow,
-                       rtk->sol.stat,rtk->x[0],rtk->x[1],rtk->x[2],xa[0],xa[1],
-                       xa[2]);
-        }
-        else {
-            p+=sprintf(p,"$POS,%d,%.3f,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n",week,tow,
-                       rtk->sol.stat,rtk->sol.rr[0],rtk->sol.rr[1],rtk->sol.rr[2],
-                       0.0,0.0,0.0);
+        v[0]=rtk->sol.stat;
+        for (int i=0;i<3;i++) {
+            v[1+i]=est?rtk->x[i]:rtk->sol.rr[i];
+            v[4+i]=est&&i<rtk->na?rtk->xa[i]:0.0;
         }
+        p+=outsolstatrec(p,fmt,SSTAT_POS,week,tow,v,7);
+
         /* Receiver velocity and acceleration */
+        ecef2pos(rtk->sol.rr,pos);
         if (est&&rtk->opt.dynamics) {
-            ecef2pos(rtk->sol.rr,pos);
             ecef2enu(pos,rtk->x+3,vel);
             ecef2enu(pos,rtk->x+6,acc);
             if (rtk->na>=6) ecef2enu(pos,rtk->xa+3,vela);
             if (rtk->na>=9) ecef2enu(pos,rtk->xa+6,acca);
-            p+=sprintf(p,"$VELACC,%d,%.3f,%d,%.4f,%.4f,%.4f,%.5f,%.5f,%.5f,%.4f,%.4f,%.4f,%.5f,%.5f,%.5f\n",
-                       week,tow,rtk->sol.stat,vel[0],vel[1],vel[2],acc[0],acc[1],
-                       acc[2],vela[0],vela[1],vela[2],acca[0],acca[1],acca[2]);
         }
         else {
-            ecef2pos(rtk->sol.rr,pos);
             ecef2enu(pos,rtk->sol.rr+3,vel);
-            p+=sprintf(p,"$VELACC,%d,%.3f,%d,%.4f,%.4f,%.4f,%.5f,%.5f,%.5f,%.4f,%.4f,%.4f,%.5f,%.5f,%.5f\n",
-                       week,tow,rtk->sol.stat,vel[0],vel[1],vel[2],
-                       0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0);
+            for (int i=0;i<3;i++) acc[i]=0.0;
+        }
+        for (int i=0;i<3;i++) {
+            v[1+i]=vel[i]; v[4+i]=acc[i]; v[7+i]=vela[i]; v[10+i]=acca[i];
         }
+        p+=outsolstatrec(p,fmt,SSTAT_VELACC,week,tow,v,13);
+
         /* Receiver clocks */
-        p+=sprintf(p,"$CLK,%d,%.3f,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n",
-                   week,tow,rtk->sol.stat,1,rtk->sol.dtr[0]*1E9,rtk->sol.dtr[1]*1E9,
-                   rtk->sol.dtr[2]*1E9,rtk->sol.dtr[3]*1E9,
-                   rtk->sol.dtr[4]*1E9,rtk->sol.dtr[5]*1E9);
+        v[1]=1;
+        for (int i=0;i<6;i++) v[2+i]=rtk->sol.dtr[i]*1E9;
+        p+=outsolstatrec(p,fmt,SSTAT_CLK,week,tow,v,8);
 
         /* Ionospheric parameters */
         if (est&&rtk->opt.ionoopt==IONOOPT_EST) {
             for (int i=0;i<MAXSAT;i++) {
                 ssat=rtk->ssat+i;
                 if (!ssat->vs) continue;
-                satno2id(i+1,id);
                 int j=II(i+1,&rtk->opt);
-                xa[0]=j<rtk->na?rtk->xa[j]:0.0;
-                p+=sprintf(p,"$ION,%d,%.3f,%d,%s,%.1f,%.1f,%.4f,%.4f\n",week,tow,
-                           rtk->sol.stat,id,ssat->azel[0]*R2D,ssat->azel[1]*R2D,
-                           rtk->x[j],xa[0]);
+                v[1]=i+1;
+                v[2]=ssat->azel[0]*R2D;
+                v[3]=ssat->azel[1]*R2D;
+                v[4]=rtk->x[j];
+                v[5]=j<rtk->na?rtk->xa[j]:0.0;
+                p+=outsolstatrec(p,fmt,SSTAT_ION,week,tow,v,6);
             }
         }
         /* Tropospheric parameters */
         if (est&&(rtk->opt.tropopt>=TROPOPT_EST)) {
             for (int i=0;i<2;i++) {
                 int j=IT(i,&rtk->opt);
-                xa[0]=j<rtk->na?rtk->xa[j]:0.0;
-                p+=sprintf(p,"$TROP,%d,%.3f,%d,%d,%.4f,%.4f\n",week,tow,
-                           rtk->sol.stat,i+1,rtk->x[j],xa[0]);
+                v[1]=i+1;
+                v[2]=rtk->x[j];
+                v[3]=j<rtk->na?rtk->xa[j]:0.0;
+                p+=outsolstatrec(p,fmt,SSTAT_TROP,week,tow,v,4);
             }
         }
         /* Receiver h/w bias */
         if (est&&rtk->opt.glomodear==GLO_ARMODE_AUTOCAL) {
             for (int i=0;i<nfreq;i++) {
                 int j=IL(i,&rtk->opt);
-                xa[0]=j<rtk->na?rtk->xa[j]:0.0;
-                p+=sprintf(p,"$HWBIAS,%d,%.3f,%d,%d,%.4f,%.4f\n",week,tow,
-                           rtk->sol.stat,i+1,rtk->x[j],xa[0]);
+                v[1]=i+1;
+                v[2]=rtk->x[j];
+                v[3]=j<rtk->na?rtk->xa[j]:0.0;
+                p+=outsolstatrec(p,fmt,SSTAT_HWBIAS,week,tow,v,4);
             }
         }
     }
@@ -308,20 +350,47 @@ extern int rtkoutstat(rtk_t *rtk, int level, char *buff)
     for (int i=0;i<MAXSAT;i++) {
         ssat=rtk->ssat+i;
         if (!ssat->vs) continue;
-        satno2id(i+1,id);
         for (int j=0;j<nfreq;j++) {
             int k=IB(i+1,j,&rtk->opt);
-            p+=sprintf(p,"$SAT,%d,%.3f,%s,%d,%.1f,%.1f,%.4f,%.4f,%d,%.0f,%d,%d,%d,%u,%u,%u,%.2f,%.6f,%.5f\n",
-                       week,tow,id,j+1,ssat->azel[0]*R2D,ssat->azel[1]*R2D,
-                       ssat->resp[j],ssat->resc[j],ssat->vsat[j],ssat->snr_rover[j],
-                       ssat->fix[j],ssat->slip[j]&(LLI_SLIP|LLI_HALFC),ssat->lock[j],ssat->outc[j],
-                       ssat->slipc[j],ssat->rejc[j],k<rtk->nx?rtk->x[k]:0,
-                       k<rtk->nx?rtk->P[k+k*rtk->nx]:0,ssat->icbias[j]);
+            v[ 0]=i+1;
+            v[ 1]=j+1;
+            v[ 2]=ssat->azel[0]*R2D;
+            v[ 3]=ssat->azel[1]*R2D;
+            v[ 4]=ssat->resp[j];
+            v[ 5]=ssat->resc[j];
+            v[ 6]=ssat->vsat[j];
+            v[ 7]=ssat->snr_rover[j];
+            v[ 8]=ssat->fix[j];
+            v[ 9]=ssat->slip[j]&(LLI_SLIP|LLI_HALFC);
+            v[10]=ssat->lock[j];
+            v[11]=ssat->outc[j];
+            v[12]=ssat->slipc[j];
+            v[13]=ssat->rejc[j];
+            v[14]=k<rtk->nx?rtk->x[k]:0;
+            v[15]=k<rtk->nx?rtk->P[k+k*rtk->nx]:0;
+            v[16]=ssat->icbias[j];
+            p+=outsolstatrec(p,fmt,SSTAT_SAT,week,tow,v,17);
         }
     }
 
     return (int)(p-buff);
 }
+/* Write solution status to buffer -------------------------------------------*/
+extern int rtkoutstat(rtk_t *rtk, int level, char *buff)
+{
+    return outstat(rtk,level,SSTATF_TEXT,(uint8_t *)buff);
+}
+/* Write binary solution status to buffer --------------------------------------
+* write solution status records in binary format (see outsolstatrec())
+* args   : rtk_t   *rtk     I   rtk control/result struct
+*          int     level    I   output level (1:position,2:with satellites)
+*          uint8_t *buff    O   output buffer
+* return : number of output bytes
+*-----------------------------------------------------------------------------*/
+extern int rtkoutstatb(rtk_t *rtk, int level, uint8_t *buff)
+{
+    return outstat(rtk,level,SSTATF_BIN,buff);
+}
 /* swap solution status file -------------------------------------------------*/
 static void swapsolstat(void)
 {
@@ -339,29 +408,43 @@ static void swapsolstat(void)
     }
     if (fp_stat) fclose(fp_stat);
 
-    if (!(fp_stat=fopen(path,"w"))) {
+    if (!(fp_stat=fopen(path,statfmt==SSTATF_BIN?"wb":"w"))) {
         trace(2,"swapsolstat: file open error path=%s\n",path);
         return;
     }
+    if (statfmt==SSTATF_BIN) {
+        uint8_t head[16];
+        fwrite(head,outsolstathb(head),1,fp_stat);
+    }
     trace(3,"swapsolstat: path=%s\n",path);
 }
-/* output solution status ----------------------------------------------------*/
+/* output solution status -------------------------------------------------------
+* the status file is shared by all rtk controls, so swap and write are locked
+* for rtkpos() called in parallel. records are not tagged by rtk control.
+*-----------------------------------------------------------------------------*/
 static void outsolstat(rtk_t *rtk,const nav_t *nav)
 {
+    uint8_t buff[MAXSOLMSG+1];
+    int n;
+
     (void)nav;
-    if (statlevel<=0||!fp_stat||!rtk->sol.stat) return;
+    if (!initlock_stat||!rtk->sol.stat) return;
 
+    rtklib_lock(&lock_stat);
+    if (statlevel<=0||!fp_stat) {
+        rtklib_unlock(&lock_stat);
+        return;
+    }
     trace(3,"outsolstat:\n");
 
     /* swap solution status file */
     swapsolstat();
 
     /* write solution status */
-    char buff[MAXSOLMSG+1];
-    int n=rtkoutstat(rtk,statlevel,buff);
-    buff[n]='\0';
+    n=outstat(rtk,statlevel,statfmt,buff);
     
-    fputs(buff,fp_stat);
+    if (fp_stat) fwrite(buff,n,1,fp_stat);
+    rtklib_unlock(&lock_stat);
 }
 /* save error message --------------------------------------------------------*/
 static void errmsg(rtk_t *rtk, const char *format, ...)
@@ -462,6 +545,33 @@ static inline void initx(rtk_t *rtk, double xi, double var, int i)
     for (j=0;j<rtk->nx;j++) rtk->P[j+i*rtk->nx]=0.0;
     rtk->P[i+i*rtk->nx]=var;
 }
+/* save valid states and covariance -----------------------------------------*/
+static double *savex(const rtk_t *rtk, int *ix, int *n)
+{
+    double *xs;
+    int i,j,k,nx=rtk->nx;
+
+    for (i=k=0;i<nx;i++) {
+        if (rtk->x[i]!=0.0&&rtk->P[i+i*nx]>0.0) ix[k++]=i;
+    }
+    if (!(xs=mat(k+k*k,1))) {*n=0; return NULL;}
+    for (i=0;i<k;i++) {
+        xs[i]=rtk->x[ix[i]];
+        for (j=0;j<k;j++) xs[k+i+j*k]=rtk->P[ix[i]+ix[j]*nx];
+    }
+    *n=k;
+    return xs;
+}
+/* restore valid states and covariance ---------------------------------------*/
+static void loadx(rtk_t *rtk, const int *ix, int n, const double *xs)
+{
+    int i,j,nx=rtk->nx;
+
+    for (i=0;i<n;i++) {
+        rtk->x[ix[i]]=xs[i];
+        for (j=0;j<n;j++) rtk->P[ix[i]+ix[j]*nx]=xs[n+i+j*n];
+    }
+}
 /* select common satellites between rover and reference station --------------*/
 static int selsat(const obsd_t *obs, double *azel, int nu, int nr,
                   const prcopt_t *opt, int *sat, int *iu, int *ir)
@@ -483,7 +593,7 @@ static int selsat(const obsd_t *obs, double *azel, int nu, int nr,
 /* temporal update of position/velocity/acceleration -------------------------*/
 static void udpos(rtk_t *rtk, double tt)
 {
-    double *F,*P,*FP,*x,*xp,pos[3],Q[9]={0},Qv[9],var=0.0;
+    double F[2],*P,pos[3],Q[9]={0},Qv[9],var=0.0;
     int i,j,*ix,nx;
 
     trace(3,"udpos   : tt=%.3f\n",tt);
@@ -529,33 +639,31 @@ static void udpos(rtk_t *rtk, double tt)
         if (i<9||(rtk->x[i]!=0.0&&rtk->P[i+i*rtk->nx]>0.0)) ix[nx++]=i;
     }
     /* state transition of position/velocity/acceleration */
-    F=eye(nx); P=mat(nx,nx); FP=mat(nx,nx); x=mat(nx,1); xp=mat(nx,1);
+    F[0]=tt; F[1]=0.0;
 
-    for (i=0;i<6;i++) {
-        F[i+(i+3)*nx]=tt;
-    }
     /* include accel terms if filter is converged */
     if (var<rtk->opt.thresar[1]) {
-        for (i=0;i<3;i++) {
-            F[i+(i+6)*nx]=(tt>=0?1:-1)*SQR(tt)/2.0;
-        }
+        F[1]=(tt>=0?1:-1)*SQR(tt)/2.0;
     }
     else trace(3,"pos var too high for accel term: %.4f\n", var);
-    for (i=0;i<nx;i++) {
-        x[i]=rtk->x[ix[i]];
-        for (j=0;j<nx;j++) {
-            P[i+j*nx]=rtk->P[ix[i]+ix[j]*rtk->nx];
+
+    /* x=F*x, P=F*P*F' (F=I except pos/vel rows, only valid states) */
+    for (i=0;i<6;i++) {
+        rtk->x[i]+=F[0]*rtk->x[i+3];
+        if (i<3&&F[1]!=0.0) rtk->x[i]+=F[1]*rtk->x[i+6];
+    }
+    for (j=0;j<nx;j++) {
+        P=rtk->P+ix[j]*rtk->nx; /* F*P */
+        for (i=0;i<6;i++) {
+            P[i]+=F[0]*P[i+3];
+            if (i<3&&F[1]!=0.0) P[i]+=F[1]*P[i+6];
         }
     }
-    /* x=F*x, P=F*P*F' */
-    matmul("NN",nx,1,nx,F,x,xp);
-    matmul("NN",nx,nx,nx,F,P,FP);
-    matmul("NT",nx,nx,nx,FP,F,P);
-    
-    for (i=0;i<nx;i++) {
-        rtk->x[ix[i]]=xp[i];
-        for (j=0;j<nx;j++) {
-            rtk->P[ix[i]+ix[j]*rtk->nx]=P[i+j*nx];
+    for (j=0;j<nx;j++) {
+        P=rtk->P+ix[j]; /* (F*P)*F' */
+        for (i=0;i<6;i++) {
+            P[i*rtk->nx]+=F[0]*P[(i+3)*rtk->nx];
+            if (i<3&&F[1]!=0.0) P[i*rtk->nx]+=F[1]*P[(i+6)*rtk->nx];
         }
     }
     /* process noise added to only acceleration  P=P+Q */
@@ -566,7 +674,7 @@ static void udpos(rtk_t *rtk, double tt)
     for (i=0;i<3;i++) for (j=0;j<3;j++) {
         rtk->P[i+6+(j+6)*rtk->nx]+=Qv[i+j*3];
     }
-    free(ix); free(F); free(P); free(FP); free(x); free(xp);
+    free(ix);
 }
 /* temporal update of ionospheric parameters ---------------------------------*/
 static void udion(rtk_t *rtk, double tt, double bl, const int *sat, int ns)
@@ -1502,17 +1610,33 @@ static double intpres(gtime_t time, const obsd_t *obs, int n, const nav_t *nav,
   }
   return fabs(ttb) < fabs(tt) ? ttb : tt;
 }
+typedef struct {        /* ambiguity resolution candidate type */
+    const rtk_t *rtk;   /* rtk control/result (read only) */
+    lambda_ws_t *lws;   /* lambda workspace */
+    int gps,glo,sbs;    /* ambiguity resolution enabled for gps/glonass/sbas */
+    int lock[MAXSAT][NFREQ]; /* lock counters for selection of ambiguities */
+    uint8_t fix[MAXSAT][NFREQ]; /* ambiguity fix flags (1:float,2:fix) */
+    int stat;           /* status (0:fixed,1:not enough dd,2:lambda error,
+                           3:validation failed) */
+    int nb,info;        /* number of dd ambiguities, lambda status */
+    double s[2];        /* sum of squared residuals {best,second} */
+    float ratio,thres;  /* ratio-test factor and threshold */
+    int *ix;            /* state index pairs of dd ambiguities */
+    double *y,*b,*Qb,*Qab; /* float/fixed dd ambiguities and covariances */
+} arcand_t;
+
 /* index for single to double-difference transformation matrix (D') --------------------*/
-static int ddidx(rtk_t *rtk, int *ix, int gps, int glo, int sbs)
+static int ddidx(const rtk_t *rtk, arcand_t *c)
 {
     int i,j,k,m,f,n,nb=0,na=rtk->na,nf=NF(&rtk->opt),nofix;
+    int gps=c->gps,glo=c->glo,sbs=c->sbs,*ix=c->ix;
     double fix[MAXSAT],ref[MAXSAT];
 
     trace(3,"ddidx: gps=%d/%d glo=%d/%d sbs=%d\n",gps,rtk->opt.gpsmodear,glo,rtk->opt.glomodear,sbs);
 
     /* clear fix flag for all sats (1=float, 2=fix) */
     for (i=0;i<MAXSAT;i++) for (j=0;j<NFREQ;j++) {
-        rtk->ssat[i].fix[j]=0;
+        c->fix[i][j]=0;
     }
     for (m=0;m<6;m++) { /* m=0:GPS/SBS,1:GLO,2:GAL,3:BDS,4:QZS,5:IRN */
 
@@ -1530,15 +1654,15 @@ static int ddidx(rtk_t *rtk, int *ix, int gps, int glo, int sbs)
                     continue;
                 }
                 /* set sat to use for fixing ambiguity if meets criteria */
-                if (rtk->ssat[i-k].lock[f]>=0&&!(rtk->ssat[i-k].slip[f]&LLI_HALFC)&&
+                if (c->lock[i-k][f]>=0&&!(rtk->ssat[i-k].slip[f]&LLI_HALFC)&&
                     rtk->ssat[i-k].azel[1]>=rtk->opt.elmaskar&&!nofix) {
-                    rtk->ssat[i-k].fix[f]=2; /* fix */
+                    c->fix[i-k][f]=2; /* fix */
                     break;/* break out of loop if find good sat */
                 }
                 /* else don't use this sat for fixing ambiguity */
-                else rtk->ssat[i-k].fix[f]=1;
+                else c->fix[i-k][f]=1;
             }
-            if (i>=k+MAXSAT||rtk->ssat[i-k].fix[f]!=2) continue;  /* no good sat found */
+            if (i>=k+MAXSAT||c->fix[i-k][f]!=2) continue;  /* no good sat found */
             /* step through all sats (j=state index, j-k=sat index, i-k=first good sat) */
             for (n=0,j=k;j<k+MAXSAT;j++) {
                 if (i==j||rtk->x[j]==0.0||!test_sys(rtk->ssat[j-k].sys,m)||
@@ -1546,7 +1670,7 @@ static int ddidx(rtk_t *rtk, int *ix, int gps, int glo, int sbs)
                     continue;
                 }
                 if (sbs==0 && satsys(j-k+1,NULL)==SYS_SBS) continue;
-                if (rtk->ssat[j-k].lock[f]>=0&&!(rtk->ssat[j-k].slip[f]&LLI_HALFC)&&
+                if (c->lock[j-k][f]>=0&&!(rtk->ssat[j-k].slip[f]&LLI_HALFC)&&
                     rtk->ssat[j-k].vsat[f]&&
                     rtk->ssat[j-k].azel[1]>=rtk->opt.elmaskar&&!nofix) {
                     /* set D coeffs to subtract sat j from sat i */
@@ -1555,14 +1679,14 @@ static int ddidx(rtk_t *rtk, int *ix, int gps, int glo, int sbs)
                     /* inc # of sats used for fix */
                     ref[nb]=i-k+1;
                     fix[nb++]=j-k+1;
-                    rtk->ssat[j-k].fix[f]=2; /* fix */
+                    c->fix[j-k][f]=2; /* fix */
                     n++; /* count # of sat pairs for this freq/constellation */
                 }
                 /* else don't use this sat for fixing ambiguity */
-                else rtk->ssat[j-k].fix[f]=1;
+                else c->fix[j-k][f]=1;
             }
             /* don't use ref sat if no sat pairs */
-            if (n==0) rtk->ssat[i-k].fix[f]=1;
+            if (n==0) c->fix[i-k][f]=1;
         }
     }
 
@@ -1645,7 +1769,7 @@ static void holdamb(rtk_t *rtk, const double *xa)
     for (i=0;i<nv;i++) R[i+i*nv]=rtk->opt.varholdamb;
 
     /* update states with constraints */
-    if ((info=filter(rtk->x,rtk->P,H,v,R,rtk->nx,nv))) {
+    if ((info=filterws(&rtk->ws,rtk->x,rtk->P,H,v,R,rtk->nx,nv))) {
         errmsg(rtk,"filter error (info=%d)\n",info);
     }
     free(R);free(v); free(H);
@@ -1697,136 +1821,415 @@ static void holdamb(rtk_t *rtk, const double *xa)
         }
     }
 }
-/* resolve integer ambiguity by LAMBDA ---------------------------------------*/
-static int resamb_LAMBDA(rtk_t *rtk, double *bias, double *xa,int gps,int glo,int sbs)
+/* initialize ambiguity resolution candidate ---------------------------------*/
+static void initcand(const rtk_t *rtk, arcand_t *c, int gps, int glo, int sbs)
 {
-    prcopt_t *opt=&rtk->opt;
-    int i,j,nb,nb1,info,nx=rtk->nx,na=rtk->na;
-    double *DP,*y,*b,*db,*Qb,*Qab,*QQ,s[2];
-    int *ix;
-    double coeff[3];
+    int i,j;
 
-    trace(3,"resamb_LAMBDA : nx=%d\n",nx);
+    c->rtk=rtk; c->lws=NULL;
+    c->gps=gps; c->glo=glo; c->sbs=sbs;
+    for (i=0;i<MAXSAT;i++) for (j=0;j<NFREQ;j++) {
+        c->lock[i][j]=rtk->ssat[i].lock[j];
+        c->fix [i][j]=0;
+    }
+    c->stat=1; c->nb=c->info=0;
+    c->s[0]=c->s[1]=0.0;
+    c->ratio=0.0f; c->thres=rtk->sol.thres;
+    c->ix=NULL; c->y=c->b=c->Qb=c->Qab=NULL;
+}
+/* free ambiguity resolution candidate ---------------------------------------*/
+static void freecand(arcand_t *c)
+{
+    free(c->ix); free(c->y); free(c->b); free(c->Qb); free(c->Qab);
+    c->ix=NULL; c->y=c->b=c->Qb=c->Qab=NULL;
+}
+/* evaluate ambiguity resolution candidate -----------------------------------
+* select double-differenced ambiguities of the candidate, solve them by lambda
+* and apply the ratio-test. rtk is not modified, so candidates sharing the
+* float solution can be evaluated concurrently.
+* args   : arcand_t *c      IO  candidate (c->rtk and c->lws set)
+* return : number of dd ambiguities (-1: not enough valid dd)
+* notes  : dd ambiguities already selected by ddidx() (c->ix set) are reused
+*-----------------------------------------------------------------------------*/
+static int evalamb(arcand_t *c)
+{
+    const rtk_t *rtk=c->rtk;
+    const prcopt_t *opt=&rtk->opt;
+    int i,j,nb,nb1,nx=rtk->nx,na=rtk->na;
+    double *DP,coeff[3];
 
-    rtk->sol.ratio=0.0;
-    rtk->nb_ar=0;
     /* Create index of single to double-difference transformation matrix (D')
           used to translate phase biases to double difference */
-    ix=imat(nx,2);
-    if ((nb=ddidx(rtk,ix,gps,glo,sbs))<(rtk->opt.minfixsats-1)) {  /* nb is sat pairs */
-        errmsg(rtk,"not enough valid double-differences\n");
-        free(ix);
-        return -1; /* flag abort */
+    if (!c->ix) {
+        c->ix=imat(nx,2);
+        c->nb=ddidx(rtk,c);
+    }
+    if ((nb=c->nb)<(opt->minfixsats-1)) {  /* nb is sat pairs */
+        c->stat=1;
+        return -1;
     }
-    rtk->nb_ar=nb;
     /* nx=# of float states, na=# of fixed states, nb=# of double-diff phase biases */
-    y=mat(nb,1); DP=mat(nb,nx-na); b=mat(nb,2); db=mat(nb,1); Qb=mat(nb,nb);
-    Qab=mat(na,nb); QQ=mat(na,nb);
+    c->y=mat(nb,1); DP=mat(nb,nx-na); c->b=mat(nb,2); c->Qb=mat(nb,nb);
+    c->Qab=mat(na,nb);
 
     /* phase-bias covariance (Qb) and real-parameters to bias covariance (Qab) */
     /* y=D*xc, Qb=D*Qc*D', Qab=Qac*D' */
     for (i=0;i<nb;i++) {
-        y[i]=rtk->x[ix[i*2]]-rtk->x[ix[i*2+1]];
+        c->y[i]=rtk->x[c->ix[i*2]]-rtk->x[c->ix[i*2+1]];
     }
     for (j=0;j<nx-na;j++) for (i=0;i<nb;i++) {
-        DP[i+j*nb]=rtk->P[ix[i*2]+(na+j)*nx]-rtk->P[ix[i*2+1]+(na+j)*nx];
+        DP[i+j*nb]=rtk->P[c->ix[i*2]+(na+j)*nx]-rtk->P[c->ix[i*2+1]+(na+j)*nx];
     }
     for (j=0;j<nb;j++) for (i=0;i<nb;i++) {
-        Qb[i+j*nb]=DP[i+(ix[j*2]-na)*nb]-DP[i+(ix[j*2+1]-na)*nb];
+        c->Qb[i+j*nb]=DP[i+(c->ix[j*2]-na)*nb]-DP[i+(c->ix[j*2+1]-na)*nb];
     }
     for (j=0;j<nb;j++) for (i=0;i<na;i++) {
-        Qab[i+j*na]=rtk->P[i+ix[j*2]*nx]-rtk->P[i+ix[j*2+1]*nx];
+        c->Qab[i+j*na]=rtk->P[i+c->ix[j*2]*nx]-rtk->P[i+c->ix[j*2+1]*nx];
     }
+    free(DP);
 
 #ifdef TRACE
     double QQb[MAXSAT];
-    for (i=0;i<nb;i++) QQb[i]=1000*Qb[i+i*nb];
-    trace(3,"N(0)=     "); tracemat(3,y,1,nb,7,2);
+    for (i=0;i<nb;i++) QQb[i]=1000*c->Qb[i+i*nb];
+    trace(3,"N(0)=     "); tracemat(3,c->y,1,nb,7,2);
     trace(3,"Qb*1000=  "); tracemat(3,QQb,1,nb,7,4);
 #endif
 
     /* lambda/mlambda integer least-square estimation */
     /* return best integer solutions */
     /* b are best integer solutions, s are residuals */
-    if (!(info=lambda(nb,2,y,Qb,b,s))) {
-        trace(3,"N(1)=     "); tracemat(3,b   ,1,nb,7,2);
-        trace(3,"N(2)=     "); tracemat(3,b+nb,1,nb,7,2);
-
-        rtk->sol.ratio=s[0]>0?(float)(s[1]/s[0]):0.0f;
-        if (rtk->sol.ratio>999.9) rtk->sol.ratio=999.9f;
-
-        /* adjust AR ratio based on # of sats, unless minAR==maxAR */
-        if (opt->thresar[5]!=opt->thresar[6]) {
-            nb1=nb<50?nb:50; /* poly only fitted for upto 50 sat pairs */
-            /* generate poly coeffs based on nominal AR ratio */
-            for ((i=0);i<3;i++) {
-                 coeff[i] = ar_poly_coeffs[i][0];
-                 for ((j=1);j<5;j++)
-                    coeff[i] = coeff[i]*opt->thresar[0]+ar_poly_coeffs[i][j];
-            }
-            /* generate adjusted AR ratio based on # of sat pairs */
-            rtk->sol.thres = coeff[0];
-            for (i=1;i<3;i++) {
-                rtk->sol.thres = rtk->sol.thres*1.0/(nb1+1.0)+coeff[i];
-            }
-            rtk->sol.thres = MIN(MAX(rtk->sol.thres,opt->thresar[5]),opt->thresar[6]);
-        } else
-            rtk->sol.thres=(float)opt->thresar[0];
-        /* validation by popular ratio-test of residuals*/
-        if (s[0]<=0.0||s[1]/s[0]>=rtk->sol.thres) {
-
-            /* init non phase-bias states and covariances with float solution values */
-            /* transform float to fixed solution (xa=x-Qab*Qb\(b0-b)) */
-            for (i=0;i<na;i++) {
-                rtk->xa[i]=rtk->x[i];
-                for (j=0;j<na;j++) rtk->Pa[i+j*na]=rtk->P[i+j*nx];
-            }
-            /* y = differences between float and fixed dd phase-biases
-               bias = fixed dd phase-biases   */
-            for (i=0;i<nb;i++) {
-                bias[i]=b[i];
-                y[i]-=b[i];
-            }
-            /* adjust non phase-bias states and covariances using fixed solution values */
-            if (!matinv(Qb,nb)) {  /* returns 0 if inverse successful */
-                /* rtk->xa = rtk->x-Qab*Qb^-1*(b0-b) */
-                matmul("NN",nb,1,nb,Qb ,y,db); /* db = Qb^-1*(b0-b) */
-                matmulm("NN",na,1,nb,Qab,db,rtk->xa); /* rtk->xa = rtk->x-Qab*db */
-                
-                /* rtk->Pa=rtk->P-Qab*Qb^-1*Qab') */
-                /* covariance of fixed solution (Qa=Qa-Qab*Qb^-1*Qab') */
-                matmul("NN",na,nb,nb,Qab,Qb ,QQ);  /* QQ = Qab*Qb^-1 */
-                matmulm("NT",na,na,nb,QQ ,Qab,rtk->Pa); /* rtk->Pa = rtk->P-QQ*Qab' */
-                
-                trace(3,"resamb : validation ok (nb=%d ratio=%.2f thresh=%.2f s=%.2f/%.2f)\n",
-                      nb,s[0]==0.0?0.0:s[1]/s[0],rtk->sol.thres,s[0],s[1]);
-
-                /* translate double diff fixed phase-bias values to single diff
-                fix phase-bias values, result in xa */
-                restamb(rtk,bias,nb,xa);
-            }
-            else nb=0;
-        }
-        else { /* validation failed */
-            errmsg(rtk,"ambiguity validation failed (nb=%d ratio=%.2f thresh=%.2f s=%.2f/%.2f)\n",
-                   nb,s[1]/s[0],rtk->sol.thres,s[0],s[1]);
-            nb=0;
-        }
+    if ((c->info=lambda_ws(c->lws,nb,2,c->y,c->Qb,c->b,c->s))) {
+        c->stat=2;
+        return nb;
+    }
+    trace(3,"N(1)=     "); tracemat(3,c->b   ,1,nb,7,2);
+    trace(3,"N(2)=     "); tracemat(3,c->b+nb,1,nb,7,2);
+
+    c->ratio=c->s[0]>0?(float)(c->s[1]/c->s[0]):0.0f;
+    if (c->ratio>999.9) c->ratio=999.9f;
+
+    /* adjust AR ratio based on # of sats, unless minAR==maxAR */
+    if (opt->thresar[5]!=opt->thresar[6]) {
+        nb1=nb<50?nb:50; /* poly only fitted for upto 50 sat pairs */
+        /* generate poly coeffs based on nominal AR ratio */
+        for ((i=0);i<3;i++) {
+             coeff[i] = ar_poly_coeffs[i][0];
+             for ((j=1);j<5;j++)
+                coeff[i] = coeff[i]*opt->thresar[0]+ar_poly_coeffs[i][j];
+        }
+        /* generate adjusted AR ratio based on # of sat pairs */
+        c->thres = coeff[0];
+        for (i=1;i<3;i++) {
+            c->thres = c->thres*1.0/(nb1+1.0)+coeff[i];
+        }
+        c->thres = MIN(MAX(c->thres,opt->thresar[5]),opt->thresar[6]);
+    } else
+        c->thres=(float)opt->thresar[0];
+
+    /* validation by popular ratio-test of residuals*/
+    c->stat=c->s[0]<=0.0||c->s[1]/c->s[0]>=c->thres?0:3;
+    return nb;
+}
+/* apply ambiguity resolution candidate --------------------------------------*/
+static int applyamb(rtk_t *rtk, const arcand_t *c, double *bias, double *xa)
+{
+    int i,j,nb=c->nb,nx=rtk->nx,na=rtk->na;
+    double *y,*db,*QQ;
+
+    rtk->sol.ratio=0.0;
+    rtk->nb_ar=0;
+    for (i=0;i<MAXSAT;i++) for (j=0;j<NFREQ;j++) {
+        rtk->ssat[i].fix[j]=c->fix[i][j];
     }
-    else {
-        errmsg(rtk,"lambda error (info=%d)\n",info);
-        nb=0;
+    if (c->stat==1) {
+        errmsg(rtk,"not enough valid double-differences\n");
+        return -1; /* flag abort */
     }
-    free(ix);
-    free(y); free(DP); free(b); free(db); free(Qb); free(Qab); free(QQ);
+    rtk->nb_ar=nb;
+
+    if (c->stat==2) {
+        errmsg(rtk,"lambda error (info=%d)\n",c->info);
+        return 0;
+    }
+    rtk->sol.ratio=c->ratio;
+    rtk->sol.thres=c->thres;
+
+    if (c->stat==3) { /* validation failed */
+        errmsg(rtk,"ambiguity validation failed (nb=%d ratio=%.2f thresh=%.2f s=%.2f/%.2f)\n",
+               nb,c->s[1]/c->s[0],rtk->sol.thres,c->s[0],c->s[1]);
+        return 0;
+    }
+    /* init non phase-bias states and covariances with float solution values */
+    /* transform float to fixed solution (xa=x-Qab*Qb\(b0-b)) */
+    for (i=0;i<na;i++) {
+        rtk->xa[i]=rtk->x[i];
+        for (j=0;j<na;j++) rtk->Pa[i+j*na]=rtk->P[i+j*nx];
+    }
+    y=mat(nb,1); db=mat(nb,1); QQ=mat(na,nb);
+
+    /* y = differences between float and fixed dd phase-biases
+       bias = fixed dd phase-biases   */
+    for (i=0;i<nb;i++) {
+        bias[i]=c->b[i];
+        y[i]=c->y[i]-c->b[i];
+    }
+    /* adjust non phase-bias states and covariances using fixed solution values */
+    if (!matinv(c->Qb,nb)) {  /* returns 0 if inverse successful */
+        /* rtk->xa = rtk->x-Qab*Qb^-1*(b0-b) */
+        matmul("NN",nb,1,nb,c->Qb,y,db); /* db = Qb^-1*(b0-b) */
+        matmulm("NN",na,1,nb,c->Qab,db,rtk->xa); /* rtk->xa = rtk->x-Qab*db */
+
+        /* rtk->Pa=rtk->P-Qab*Qb^-1*Qab') */
+        /* covariance of fixed solution (Qa=Qa-Qab*Qb^-1*Qab') */
+        matmul("NN",na,nb,nb,c->Qab,c->Qb,QQ);  /* QQ = Qab*Qb^-1 */
+        matmulm("NT",na,na,nb,QQ,c->Qab,rtk->Pa); /* rtk->Pa = rtk->P-QQ*Qab' */
 
+        trace(3,"resamb : validation ok (nb=%d ratio=%.2f thresh=%.2f s=%.2f/%.2f)\n",
+              nb,c->s[0]==0.0?0.0:c->s[1]/c->s[0],rtk->sol.thres,c->s[0],c->s[1]);
+
+        /* translate double diff fixed phase-bias values to single diff
+        fix phase-bias values, result in xa */
+        restamb(rtk,bias,nb,xa);
+    }
+    else nb=0;
+
+    free(y); free(db); free(QQ);
     return nb; /* number of ambiguities */
 }
+/* resolve integer ambiguity by LAMBDA ---------------------------------------
+* candidates evaluated in advance (cand) are applied if they match the current
+* selection of ambiguities, otherwise the ambiguities are evaluated here.
+*-----------------------------------------------------------------------------*/
+static int resamb_LAMBDA(rtk_t *rtk, double *bias, double *xa, int gps, int glo,
+                         int sbs, const arcand_t *cand, int ncand)
+{
+    arcand_t c;
+    int i,nb;
+
+    trace(3,"resamb_LAMBDA : nx=%d\n",rtk->nx);
+
+    initcand(rtk,&c,gps,glo,sbs);
+
+    for (i=0;i<ncand;i++) {
+        if (cand[i].gps!=gps||cand[i].glo!=glo||cand[i].sbs!=sbs) continue;
+        if (!memcmp(cand[i].lock,c.lock,sizeof(c.lock))) break;
+    }
+    if (i<ncand) {
+        nb=applyamb(rtk,cand+i,bias,xa);
+    }
+    else {
+        c.lws=&rtk->lws;
+        evalamb(&c);
+        nb=applyamb(rtk,&c,bias,xa);
+    }
+    freecand(&c);
+
+    return nb;
+}
+/* partial ambiguity resolution worker pool ----------------------------------
+* worker threads kept in rtk control (rtk->arpool) over epochs. worker i
+* evaluates candidate job[i] with lambda workspace rtk->arws[i].
+*-----------------------------------------------------------------------------*/
+#ifdef WIN32
+#define arcond_t            CONDITION_VARIABLE
+#define arcond_init(c)      InitializeConditionVariable(c)
+#define arcond_wait(c,l)    SleepConditionVariableCS(c,l,INFINITE)
+#define arcond_signal(c)    WakeAllConditionVariable(c)
+#define arcond_free(c)
+#else
+#define arcond_t            pthread_cond_t
+#define arcond_init(c)      pthread_cond_init(c,NULL)
+#define arcond_wait(c,l)    pthread_cond_wait(c,l)
+#define arcond_signal(c)    pthread_cond_broadcast(c)
+#define arcond_free(c)      pthread_cond_destroy(c)
+#endif
+
+typedef struct arpool_tag arpool_t;
+
+typedef struct {        /* partial ar worker type */
+    arpool_t *pool;     /* worker pool */
+    int id;             /* worker index */
+} arwork_t;
+
+struct arpool_tag {     /* partial ar worker pool type */
+    rtklib_thread_t thread[MAXARWORK]; /* worker threads */
+    arwork_t work[MAXARWORK]; /* workers */
+    int nthread;        /* number of worker threads */
+    arcand_t *job[MAXARWORK]; /* candidates of workers (NULL: no job) */
+    uint32_t gen;       /* generation of jobs */
+    int npend;          /* number of workers not done */
+    int state;          /* state (1:running,0:exit) */
+    rtklib_lock_t lock; /* lock flag */
+    arcond_t cjob,cdone; /* conditions of jobs set and done */
+};
+
+#ifdef WIN32
+static DWORD WINAPI arworker(void *arg)
+#else
+static void *arworker(void *arg)
+#endif
+{
+    arwork_t *work=(arwork_t *)arg;
+    arpool_t *pool=work->pool;
+    arcand_t *c;
+    uint32_t gen=0;
+
+    for (;;) {
+        rtklib_lock(&pool->lock);
+        while (pool->state&&pool->gen==gen) arcond_wait(&pool->cjob,&pool->lock);
+        if (!pool->state) {
+            rtklib_unlock(&pool->lock);
+            break;
+        }
+        gen=pool->gen;
+        c=pool->job[work->id];
+        rtklib_unlock(&pool->lock);
+
+        if (c) evalamb(c);
+
+        rtklib_lock(&pool->lock);
+        if (--pool->npend<=0) arcond_signal(&pool->cdone);
+        rtklib_unlock(&pool->lock);
+    }
+    return 0;
+}
+/* free worker pool ----------------------------------------------------------*/
+static void freearpool(rtk_t *rtk)
+{
+    arpool_t *pool=(arpool_t *)rtk->arpool;
+    int i;
+
+    if (!pool) return;
+
+    rtklib_lock(&pool->lock);
+    pool->state=0;
+    arcond_signal(&pool->cjob);
+    rtklib_unlock(&pool->lock);
+
+    for (i=0;i<pool->nthread;i++) {
+#ifdef WIN32
+        WaitForSingleObject(pool->thread[i],INFINITE);
+        CloseHandle(pool->thread[i]);
+#else
+        pthread_join(pool->thread[i],NULL);
+#endif
+    }
+#ifdef WIN32
+    DeleteCriticalSection(&pool->lock);
+#else
+    pthread_mutex_destroy(&pool->lock);
+#endif
+    arcond_free(&pool->cjob);
+    arcond_free(&pool->cdone);
+    free(pool);
+    rtk->arpool=NULL;
+}
+/* start worker pool ---------------------------------------------------------*/
+static arpool_t *initarpool(rtk_t *rtk)
+{
+    arpool_t *pool;
+    int i;
+
+    if (rtk->arpool) return (arpool_t *)rtk->arpool;
+
+    if (!(pool=(arpool_t *)calloc(1,sizeof(arpool_t)))) return NULL;
+
+    pool->state=1;
+    rtklib_initlock(&pool->lock);
+    arcond_init(&pool->cjob);
+    arcond_init(&pool->cdone);
+    rtk->arpool=pool;
+
+    for (i=0;i<MAXARWORK;i++) {
+        pool->work[i].pool=pool;
+        pool->work[i].id=i;
+#ifdef WIN32
+        if (!(pool->thread[i]=CreateThread(NULL,0,arworker,pool->work+i,0,NULL))) break;
+#else
+        if (pthread_create(pool->thread+i,NULL,arworker,pool->work+i)) break;
+#endif
+        pool->nthread++;
+    }
+    if (pool->nthread<MAXARWORK) {
+        trace(2,"initarpool: thread create error\n");
+        freearpool(rtk);
+        return NULL;
+    }
+    return pool;
+}
+/* evaluate partial fix candidates in parallel ---------------------------------
+* the candidates tried one after another by manage_amb_LAMBDA() are built up
+* front from the float solution and evaluated concurrently:
+*   0: all enabled satellites
+*   1: newly locked satellites removed (pos2-arfilter=on)
+*   2: glonass and sbas off (pos2-gloarmode=fix-and-hold)
+*   3: glonass and sbas off with newly locked satellites removed
+* candidate 0 is evaluated by the calling thread and the others by the worker
+* pool. manage_amb_LAMBDA() then applies them in the sequential order through
+* resamb_LAMBDA(), so the fixed solution is the same as without pos2-arpar.
+* return : number of candidates (0: sequential evaluation)
+*-----------------------------------------------------------------------------*/
+static int evalcands(rtk_t *rtk, arcand_t *c, const int *sat, int nf, int ns,
+                     int gps1, int glo1, int sbas1)
+{
+    arpool_t *pool;
+    int i,f,n=1,s,dly;
+
+    initcand(rtk,c,gps1,glo1,sbas1);
+    c[0].lws=&rtk->lws;
+
+    /* newly locked satellites selected by candidate 0 removed with stagger */
+    if (rtk->opt.arfilter) {
+        c[0].ix=imat(rtk->nx,2);
+        c[0].nb=ddidx(rtk,c);
+        initcand(rtk,c+n,gps1,glo1,sbas1);
+        for (i=0,dly=2;i<ns;i++) for (f=0;f<nf;f++) {
+            s=sat[i]-1;
+            if (c[0].fix[s][f]!=2||c[n].lock[s][f]!=0) continue;
+            c[n].lock[s][f]=-rtk->opt.minlock-dly;
+            dly+=2;
+        }
+        if (dly>2) n++;
+    }
+    /* glonass and sbas off for each lock state above */
+    if ((rtk->opt.navsys&SYS_GLO)&&rtk->opt.glomodear==GLO_ARMODE_FIXHOLD&&glo1) {
+        for (i=0,s=n;i<s;i++) {
+            initcand(rtk,c+n,1,0,0);
+            memcpy(c[n++].lock,c[i].lock,sizeof(c[i].lock));
+        }
+    }
+    if (n<=1||!(pool=initarpool(rtk))) {
+        for (i=0;i<n;i++) freecand(c+i);
+        return 0;
+    }
+    /* evaluate candidates by workers and candidate 0 by this thread */
+    rtklib_lock(&pool->lock);
+    for (i=0;i<MAXARWORK;i++) {
+        pool->job[i]=i+1<n?c+i+1:NULL;
+        if (i+1<n) c[i+1].lws=rtk->arws+i;
+    }
+    pool->npend=pool->nthread;
+    pool->gen++;
+    arcond_signal(&pool->cjob);
+    rtklib_unlock(&pool->lock);
 
+    evalamb(c);
+
+    rtklib_lock(&pool->lock);
+    while (pool->npend>0) arcond_wait(&pool->cdone,&pool->lock);
+    rtklib_unlock(&pool->lock);
+
+    for (i=0;i<n;i++) {
+        trace(3,"AR candidate %d: nb=%d stat=%d ratio=%.2f\n",i,c[i].nb,c[i].stat,
+              c[i].ratio);
+    }
+    return n;
+}
 /* resolve integer ambiguity by LAMBDA using partial fix techniques and multiple attempts -----------------------*/
 static int manage_amb_LAMBDA(rtk_t *rtk, double *bias, double *xa, const int *sat, int nf, int ns)
 {
-    int gps1=-1,glo1=-1,sbas1=-1,gps2,glo2,sbas2,nb,rerun,dly;
+    arcand_t cand[MAXARCAND];
+    int gps1=-1,glo1=-1,sbas1=-1,gps2,glo2,sbas2,nb,rerun,dly,ncand=0;
     float ratio1,posvar=0;
 
     /* calc position variance, will skip AR if too high to avoid false fix */
@@ -1887,8 +2290,13 @@ static int manage_amb_LAMBDA(rtk_t *rtk, double *bias, double *xa, const int *sa
     gps1=1;    /* always enable gps for initial pass */
     glo1=(rtk->opt.navsys&SYS_GLO)?(((rtk->opt.glomodear==GLO_ARMODE_FIXHOLD)&&!rtk->holdamb)?0:1):0;
     sbas1=(rtk->opt.navsys&SYS_GLO)?glo1:((rtk->opt.navsys&SYS_SBS)?1:0);
+
+    /* evaluate partial fix candidates in parallel */
+    if (rtk->opt.arpar) {
+        ncand=evalcands(rtk,cand,sat,nf,ns,gps1,glo1,sbas1);
+    }
     /* first attempt to resolve ambiguities */
-    nb=resamb_LAMBDA(rtk,bias,xa,gps1,glo1,sbas1);
+    nb=resamb_LAMBDA(rtk,bias,xa,gps1,glo1,sbas1,cand,ncand);
     ratio1=rtk->sol.ratio;
     /* reject bad satellites if AR filtering enabled */
     if (rtk->opt.arfilter) {
@@ -1913,7 +2321,7 @@ static int manage_amb_LAMBDA(rtk_t *rtk, double *bias, double *xa, const int *sa
         if (rerun) {
             trace(3,"rerun AR with new sats removed\n");
             /* try again with new sats removed */
-            nb=resamb_LAMBDA(rtk,bias,xa,gps1,glo1,sbas1);
+            nb=resamb_LAMBDA(rtk,bias,xa,gps1,glo1,sbas1,cand,ncand);
         }
     }
     rtk->sol.prev_ratio1=ratio1;
@@ -1927,7 +2335,7 @@ static int manage_amb_LAMBDA(rtk_t *rtk, double *bias, double *xa, const int *sa
 
         /* if modes changed since initial AR run or haven't run yet,re-run with new modes */
         if (glo1!=glo2||gps1!=gps2)
-            nb=resamb_LAMBDA(rtk,bias,xa,gps2,glo2,sbas2);
+            nb=resamb_LAMBDA(rtk,bias,xa,gps2,glo2,sbas2,cand,ncand);
     }
     /* Restore excluded sat if still no fix or significant increase in ar ratio */
     if (excsat && (rtk->sol.ratio < rtk->sol.thres) &&
@@ -1939,6 +2347,8 @@ static int manage_amb_LAMBDA(rtk_t *rtk, double *bias, double *xa, const int *sa
     rtk->sol.prev_ratio1=ratio1>0?ratio1:rtk->sol.ratio;
     rtk->sol.prev_ratio2=rtk->sol.ratio;
 
+    for (int i=0;i<ncand;i++) freecand(cand+i);
+
     return nb;
 }
 
@@ -1977,8 +2387,8 @@ static int relpos(rtk_t *rtk, const obsd_t *obs, int nu, int nr,
 {
     prcopt_t *opt=&rtk->opt;
     gtime_t time=obs[0].time;
-    double *rs,*dts,*var,*y,*e,*azel,*freq,*v,*H,*R,*xp,*Pp,*xa,*bias,dt;
-    int i,j,f,n=nu+nr,ns,ny,nv,sat[MAXSAT],iu[MAXSAT],ir[MAXSAT];
+    double *rs,*dts,*var,*y,*e,*azel,*freq,*v,*H,*R,*xp,*Pp,*xa,*bias,*xs,dt;
+    int i,j,f,n=nu+nr,ns,ny,nv,sat[MAXSAT],iu[MAXSAT],ir[MAXSAT],*ix,nxs,upd=0;
     int info,vflg[MAXOBS*NFREQ*2+1],svh[MAXOBS*2];
     int stat=rtk->opt.mode<=PMODE_DGPS?SOLQ_DGPS:SOLQ_FLOAT;
     int nf=opt->ionoopt==IONOOPT_IFLC?1:opt->nf;
@@ -2051,10 +2461,10 @@ static int relpos(rtk_t *rtk, const obsd_t *obs, int nu, int nr,
         rtk->ssat[sat[i]-1].snr_base[j] =obs[ir[i]].SNR[j];
     }
 
-    /* initialize Pp,xa to zero, xp to rtk->x */
-    xp=mat(rtk->nx,1); Pp=zeros(rtk->nx,rtk->nx); xa=mat(rtk->nx,1);
-    matcpy(xp,rtk->x,rtk->nx,1);
-    matcpy(Pp,rtk->P,rtk->nx,rtk->nx);
+    /* update states in place, save valid states to restore on rejection */
+    xp=rtk->x; Pp=rtk->P; xa=mat(rtk->nx,1);
+    ix=imat(rtk->nx,1);
+    xs=savex(rtk,ix,&nxs);
 
     ny=ns*nf*2+2;
     v=mat(ny,1); H=zeros(rtk->nx,ny); R=mat(ny,ny); bias=mat(rtk->nx,1);
@@ -2101,7 +2511,7 @@ static int relpos(rtk_t *rtk, const obsd_t *obs, int nu, int nr,
                 xp=x+K*v
                 Pp=(I-K*H')*P                  */
         trace(3,"before filter x=");tracemat(3,rtk->x,1,9,13,6);
-        if ((info=filter(xp,Pp,H,v,R,rtk->nx,nv))) {
+        if ((info=filterws(&rtk->ws,xp,Pp,H,v,R,rtk->nx,nv))) {
             errmsg(rtk,"filter error (info=%d)\n",info);
             stat=SOLQ_NONE;
             break;
@@ -2118,9 +2528,8 @@ static int relpos(rtk_t *rtk, const obsd_t *obs, int nu, int nr,
         /* validation of float solution, always returns 1, msg to trace file if large residual */
         if (valpos(rtk,v,R,vflg,nv,4.0)) {
 
-            /* copy states */
-            matcpy(rtk->x,xp,rtk->nx,1);
-            matcpy(rtk->P,Pp,rtk->nx,rtk->nx);
+            /* keep updated states */
+            upd=1;
 
             /* update valid satellite status for ambiguity control */
             rtk->sol.ns=0;
@@ -2134,6 +2543,9 @@ static int relpos(rtk_t *rtk, const obsd_t *obs, int nu, int nr,
         }
         else stat=SOLQ_NONE;
     }
+    /* restore states if float solution not accepted */
+    if (!upd) loadx(rtk,ix,nxs,xs);
+
     /* resolve integer ambiguity by LAMBDA */
     if (stat==SOLQ_FLOAT) {
         /* if valid fixed solution, process it */
@@ -2224,7 +2636,7 @@ static int relpos(rtk_t *rtk, const obsd_t *obs, int nu, int nr,
             rtk->ssat[i].lock[j]++;
     }
     free(rs); free(dts); free(var); free(y); free(e); free(azel); free(freq);
-    free(xp); free(Pp);  free(xa);  free(v); free(H); free(R); free(bias);
+    free(ix); free(xs);  free(xa);  free(v); free(H); free(R); free(bias);
 
     if (stat!=SOLQ_NONE) rtk->sol.stat=stat;
 
@@ -2255,6 +2667,10 @@ extern void rtkinit(rtk_t *rtk, const prcopt_t *opt)
     rtk->P=zeros(rtk->nx,rtk->nx);
     rtk->xa=zeros(rtk->na,1);
     rtk->Pa=zeros(rtk->na,rtk->na);
+    initfiltws(&rtk->ws);
+    lambda_initws(&rtk->lws);
+    for (i=0;i<MAXARWORK;i++) lambda_initws(rtk->arws+i);
+    rtk->arpool=NULL;
     rtk->nfix=rtk->neb=0;
     for (i=0;i<MAXSAT;i++) {
         rtk->ambc[i]=ambc0;
@@ -2276,6 +2692,8 @@ extern void rtkinit(rtk_t *rtk, const prcopt_t *opt)
 *-----------------------------------------------------------------------------*/
 extern void rtkfree(rtk_t *rtk)
 {
+    int i;
+
     trace(3,"rtkfree :\n");
 
     rtk->nx=rtk->na=0;
@@ -2283,6 +2701,10 @@ extern void rtkfree(rtk_t *rtk)
     free(rtk->P ); rtk->P =NULL;
     free(rtk->xa); rtk->xa=NULL;
     free(rtk->Pa); rtk->Pa=NULL;
+    freefiltws(&rtk->ws);
+    lambda_freews(&rtk->lws);
+    freearpool(rtk);
+    for (i=0;i<MAXARWORK;i++) lambda_freews(rtk->arws+i);
 }
 /* precise positioning ---------------------------------------------------------
 * input observation data and navigation message, compute rover position by
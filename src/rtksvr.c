@@ -42,10 +42,191 @@
 *                            handle multiple ephemeris sets in updatesvr()
 *                            use API sat2freq() to get carrier frequency
 *                            use integer types in stdint.h
+*           2026/10/16  1.23 split server into input/decode, solver and
+*                            output threads
+*                            add multi-rover mode sharing base/correction
+*                            streams and navigation data among rovers
+*                            add api rtksvraddrov(),rtksvrfreerov()
+*                            add versioned navigation data snapshots read
+*                            without lock instead of locking svr->nav
+*                            add api rtksvrpinnav(),rtksvrunpinnav()
+*                            run rtkpos() on private rtk control out of lock
+*                            index ephemerides loaded before rtksvrstart()
+*                            evaluate partial ar of rovers sequentially
 *-----------------------------------------------------------------------------*/
 #include "rtklib.h"
 
 #define MIN_INT_RESET   30000   /* mininum interval of reset command (ms) */
+#define MAXNAVFREE      2       /* max number of recycled nav snapshots */
+#define MAXDECLOCK      1024    /* max bytes decoded per lock of server */
+
+#if defined(__GNUC__)
+#define LOAD_SC(p)      __atomic_load_n(p,__ATOMIC_SEQ_CST)
+#define STORE_SC(p,v)   __atomic_store_n(p,v,__ATOMIC_SEQ_CST)
+#define CAS_SC(p,o,n)   __sync_bool_compare_and_swap(p,o,n)
+#else /* volatile access with full barriers (msvc) */
+#define LOAD_SC(p)      (MemoryBarrier(),*(p))
+#define STORE_SC(p,v)   do {MemoryBarrier(); *(p)=(v); MemoryBarrier();} while (0)
+#define CAS_SC(p,o,n)   (InterlockedCompareExchange((volatile LONG *)(p),\
+                         (LONG)(n),(LONG)(o))==(LONG)(o))
+#endif
+
+typedef struct navsnap_tag {    /* navigation data snapshot type */
+    nav_t nav;                  /* navigation data (immutable once published) */
+    uint32_t ver;               /* snapshot version */
+    peph_t *peph;               /* precise ephemeris freed with snapshot */
+    pclk_t *pclk;               /* precise clock freed with snapshot */
+    int *idx;                   /* ephemeris index buffer */
+    struct navsnap_tag *next;   /* next retired/free snapshot */
+} navsnap_t;
+
+/* navigation data snapshots ---------------------------------------------------
+* svr->nav is the working copy of navigation data updated in place by the
+* input/decode threads under svr->lock. after a decode pass changing it, the
+* decode thread publishes an immutable copy as a new snapshot version
+* (svr->navsnap, svr->navver). readers pin the current snapshot by writing
+* its version to a free slot of svr->navpin[] and release it by clearing the
+* slot, without svr->lock. retired snapshots are reclaimed by the publisher
+* once no slot pins a version older than or equal to their version.
+* precise ephemeris/clock arrays are shared between svr->nav and snapshots
+* and freed with the last snapshot referencing them.
+*-----------------------------------------------------------------------------*/
+static void freesnap(navsnap_t *snap)
+{
+    if (!snap) return;
+    free(snap->nav.eph);
+    free(snap->nav.geph);
+    free(snap->nav.seph);
+    free(snap->nav.eidx);
+    free(snap->idx);
+    free(snap->peph);
+    free(snap->pclk);
+    free(snap);
+}
+static navsnap_t *newsnap(const nav_t *nav)
+{
+    navsnap_t *snap;
+    int nidx=nav->nmax+nav->ngmax+nav->nsmax;
+    
+    if (!(snap=(navsnap_t *)calloc(1,sizeof(navsnap_t)))) return NULL;
+    
+    if ((nav->nmax >0&&!(snap->nav.eph =(eph_t  *)malloc(sizeof(eph_t )*nav->nmax )))||
+        (nav->ngmax>0&&!(snap->nav.geph=(geph_t *)malloc(sizeof(geph_t)*nav->ngmax)))||
+        (nav->nsmax>0&&!(snap->nav.seph=(seph_t *)malloc(sizeof(seph_t)*nav->nsmax)))||
+        !(snap->nav.eidx=(ephidx_t *)malloc(sizeof(ephidx_t)*MAXSAT))||
+        (nidx>0&&!(snap->idx=(int *)malloc(sizeof(int)*nidx)))) {
+        freesnap(snap);
+        return NULL;
+    }
+    return snap;
+}
+/* copy navigation data to snapshot ------------------------------------------*/
+static void copysnap(navsnap_t *snap, const nav_t *nav)
+{
+    eph_t *eph=snap->nav.eph;
+    geph_t *geph=snap->nav.geph;
+    seph_t *seph=snap->nav.seph;
+    ephidx_t *eidx=snap->nav.eidx;
+    int i,n=0;
+    
+    snap->nav=*nav;
+    snap->nav.eph =eph;
+    snap->nav.geph=geph;
+    snap->nav.seph=seph;
+    snap->nav.eidx=nav->eidx?eidx:NULL;
+    snap->nav.pephc=NULL;
+    if (nav->n >0) memcpy(eph ,nav->eph ,sizeof(eph_t )*nav->n );
+    if (nav->ng>0) memcpy(geph,nav->geph,sizeof(geph_t)*nav->ng);
+    if (nav->ns>0) memcpy(seph,nav->seph,sizeof(seph_t)*nav->ns);
+    
+    if (!nav->eidx) return;
+    
+    for (i=0;i<MAXSAT;i++) {
+        eidx[i].n=eidx[i].nmax=nav->eidx[i].n;
+        eidx[i].idx=snap->idx+n;
+        if (nav->eidx[i].n>0) {
+            memcpy(eidx[i].idx,nav->eidx[i].idx,sizeof(int)*nav->eidx[i].n);
+        }
+        n+=nav->eidx[i].n;
+    }
+}
+/* reclaim retired snapshots not pinned by readers ---------------------------*/
+static void reclaimnav(rtksvr_t *svr)
+{
+    navsnap_t *snap,*next,**p=(navsnap_t **)&svr->navret;
+    uint32_t ver,minver=0xFFFFFFFF;
+    int i,nfree=0;
+    
+    for (i=0;i<MAXNAVPIN;i++) {
+        if ((ver=LOAD_SC(svr->navpin+i))!=0&&ver<minver) minver=ver;
+    }
+    for (snap=(navsnap_t *)svr->navfree;snap;snap=snap->next) nfree++;
+    
+    for (snap=*p;snap;snap=next) {
+        next=snap->next;
+        if (snap->ver>=minver) { /* pinned */
+            p=&snap->next;
+            continue;
+        }
+        *p=next;
+        free(snap->peph); snap->peph=NULL;
+        free(snap->pclk); snap->pclk=NULL;
+        if (nfree<MAXNAVFREE) { /* recycle */
+            snap->next=(navsnap_t *)svr->navfree;
+            svr->navfree=snap;
+            nfree++;
+        }
+        else freesnap(snap);
+    }
+}
+/* publish navigation data snapshot --------------------------------------------
+* publish a copy of svr->nav as a new snapshot version. the caller is expected
+* to hold svr->lock.
+*-----------------------------------------------------------------------------*/
+static int publishnav(rtksvr_t *svr)
+{
+    navsnap_t *snap,*cur=(navsnap_t *)svr->navsnap;
+    
+    tracet(4,"publishnav: ver=%u\n",svr->navver+1);
+    
+    if ((snap=(navsnap_t *)svr->navfree)) {
+        svr->navfree=snap->next;
+    }
+    else if (!(snap=newsnap(&svr->nav))) {
+        tracet(1,"publishnav: malloc error\n");
+        return 0;
+    }
+    copysnap(snap,&svr->nav);
+    snap->ver=svr->navver+1;
+    snap->next=NULL;
+    
+    STORE_SC(&svr->navsnap,(void *)snap);
+    STORE_SC(&svr->navver,snap->ver);
+    svr->navupd=0;
+    
+    if (cur) { /* retire previous snapshot */
+        cur->next=(navsnap_t *)svr->navret;
+        svr->navret=cur;
+    }
+    reclaimnav(svr);
+    return 1;
+}
+/* free all navigation data snapshots ----------------------------------------*/
+static void freenavsnap(rtksvr_t *svr)
+{
+    navsnap_t *snap,*next;
+    
+    for (snap=(navsnap_t *)svr->navret;snap;snap=next) {
+        next=snap->next;
+        freesnap(snap);
+    }
+    for (snap=(navsnap_t *)svr->navfree;snap;snap=next) {
+        next=snap->next;
+        freesnap(snap);
+    }
+    freesnap((navsnap_t *)svr->navsnap);
+    svr->navsnap=svr->navret=svr->navfree=NULL;
+}
 
 /* write solution header to output stream ------------------------------------*/
 static void writesolhead(stream_t *stream, const solopt_t *solopt, const prcopt_t *prcopt)
@@ -86,6 +267,17 @@ static void saveoutbuf(rtksvr_t *svr, uint8_t *buff, int n, int index)
     memcpy(svr->sbuf[index]+svr->nsb[index],buff,n);
     svr->nsb[index]+=n;
 }
+/* queue solution output ----------------------------------------------------*/
+// The caller is expected to hold the rtksvr lock.
+static void queueout(rtksvr_t *svr, const uint8_t *buff, int n, int index)
+{
+    if (n>svr->buffsize-svr->nob[index]) {
+        tracet(2,"solution output queue overflow: index=%d\n",index);
+        n=svr->buffsize-svr->nob[index];
+    }
+    memcpy(svr->obuf[index]+svr->nob[index],buff,n);
+    svr->nob[index]+=n;
+}
 /* write solution to output stream -------------------------------------------*/
 static void writesol(rtksvr_t *svr, int index)
 {
@@ -95,44 +287,52 @@ static void writesol(rtksvr_t *svr, int index)
     
     tracet(4,"writesol: index=%d\n",index);
     
+    rtksvrlock(svr);
+    
     for (i=0;i<2;i++) {
         
         if (svr->solopt[i].posf==SOLF_STAT) {
             /* output solution status */
-            rtksvrlock(svr);
             n=rtkoutstat(&svr->rtk,svr->solopt[i].sstat,(char *)buff);
-            rtksvrunlock(svr);
         }
         else {
             /* output solution */
             n=outsols(buff,&svr->rtk.sol,svr->rtk.rb,svr->solopt+i);
         }
-        strwrite(svr->stream+i+3,buff,n);
-
-        /* save output buffer */
-        rtksvrlock(svr);
+        queueout(svr,buff,n,i);
         saveoutbuf(svr,buff,n,i);
-        rtksvrunlock(svr);
 
         /* output extended solution */
         n=outsolexs(buff,&svr->rtk.sol,svr->rtk.ssat,svr->solopt+i);
-        strwrite(svr->stream+i+3,buff,n);
-        
-        /* save output buffer */
-        rtksvrlock(svr);
+        queueout(svr,buff,n,i);
         saveoutbuf(svr,buff,n,i);
-        rtksvrunlock(svr);
     }
     /* output solution to monitor port */
     if (svr->moni) {
         n=outsols(buff,&svr->rtk.sol,svr->rtk.rb,&solopt);
-        strwrite(svr->moni,buff,n);
+        queueout(svr,buff,n,2);
     }
     /* save solution buffer */
     if (svr->nsol<MAXSOLBUF) {
-        rtksvrlock(svr);
         svr->solbuf[svr->nsol++]=svr->rtk.sol;
+    }
+    rtksvrunlock(svr);
+}
+/* write queued solutions to output streams ----------------------------------*/
+static void writeout(rtksvr_t *svr, uint8_t *buff)
+{
+    int i,n;
+    
+    for (i=0;i<3;i++) {
+        rtksvrlock(svr);
+        n=svr->nob[i];
+        memcpy(buff,svr->obuf[i],n);
+        svr->nob[i]=0;
         rtksvrunlock(svr);
+        
+        if (n<=0) continue;
+        if (i<2) strwrite(svr->stream+i+3,buff,n);
+        else if (svr->moni) strwrite(svr->moni,buff,n);
     }
 }
 /* update glonass frequency channel number in raw data struct ----------------*/
@@ -157,22 +357,35 @@ static void update_glofcn(rtksvr_t *svr)
     }
 }
 /* update observation data ---------------------------------------------------*/
-static void update_obs(rtksvr_t *svr, obs_t *obs, int index, int iobs)
+static void update_obs(rtksvr_t *svr, obs_t *obs, int index)
 {
-    int i,n=0,sat,sys;
+    int i,n=0,sat,sys,next;
     
-        if (iobs<MAXOBSBUF) {
-            for (i=0;i<obs->n;i++) {
+        for (i=0;i<obs->n;i++) {
             sat=obs->data[i].sat;
             sys=satsys(sat,NULL);
             if (svr->rtk.opt.exsats[sat-1]==1||!(sys&svr->rtk.opt.navsys)) {
                 continue;
             }
-                svr->obs[index][iobs].data[n]=obs->data[i];
-                svr->obs[index][iobs].data[n++].rcv=index+1;
+            svr->obs[index][0].data[n]=obs->data[i];
+            svr->obs[index][0].data[n++].rcv=index+1;
+        }
+        svr->obs[index][0].n=n;
+        sortobs(&svr->obs[index][0]);
+        
+        /* push rover observation data to solver queue */
+        if (index==0) {
+            next=(svr->qtail+1)%MAXOBSBUF;
+            if (next==svr->qhead) { /* queue full */
+                svr->prcout++;
+            }
+            else {
+                memcpy(svr->obsq[svr->qtail].data,svr->obs[0][0].data,
+                       sizeof(obsd_t)*n);
+                svr->obsq[svr->qtail].n=n;
+                svr->tickq[svr->qtail]=tickget();
+                svr->qtail=next;
             }
-            svr->obs[index][iobs].n=n;
-            sortobs(&svr->obs[index][iobs]);
         }
         svr->nmsg[index][0]++;
     }
@@ -197,6 +410,11 @@ static void update_eph(rtksvr_t *svr, nav_t *nav, int ephsat, int ephset,
                  timediff(eph1->toc,eph2->toc)!=0.0)) {
                 *eph3=*eph2; /* current ->previous */
                 *eph2=*eph1; /* received->current */
+                svr->navupd=1;
+                if (satsys(ephsat,NULL)!=SYS_SBS) { /* sbas uses nav->seph */
+                    updidxnav(&svr->nav,ephsat,ephsat-1+MAXSAT*ephset);
+                    updidxnav(&svr->nav,ephsat,ephsat-1+MAXSAT*(2+ephset));
+                }
                 }
             }
             svr->nmsg[index][1]++;
@@ -211,6 +429,9 @@ static void update_eph(rtksvr_t *svr, nav_t *nav, int ephsat, int ephset,
                    (geph1->iode!=geph3->iode&&geph1->iode!=geph2->iode)) {
                    *geph3=*geph2;
                    *geph2=*geph1;
+                   svr->navupd=1;
+                   updidxnav(&svr->nav,ephsat,prn-1);
+                   updidxnav(&svr->nav,ephsat,prn-1+MAXPRNGLO);
                 update_glofcn(svr);
                }
            }
@@ -232,6 +453,7 @@ static void update_sbs(rtksvr_t *svr, sbsmsg_t *sbsmsg, int index)
                 svr->sbsmsg[i]=*sbsmsg;
             }
             sbsupdatecorr(sbsmsg,&svr->nav);
+            svr->navupd=1;
         }
         svr->nmsg[index][3]++;
     }
@@ -251,6 +473,7 @@ static void update_ionutc(rtksvr_t *svr, nav_t *nav, int index)
         matcpy(svr->nav.ion_qzs,nav->ion_qzs,8,1);
         matcpy(svr->nav.ion_cmp,nav->ion_cmp,8,1);
         matcpy(svr->nav.ion_irn,nav->ion_irn,8,1);
+        svr->navupd=1;
         }
         svr->nmsg[index][2]++;
     }
@@ -340,19 +563,19 @@ static void update_ssr(rtksvr_t *svr, int index)
                 }
             }
             svr->nav.ssr[i]=svr->rtcm[index].ssr[i];
+            svr->navupd=1;
         }
         svr->nmsg[index][7]++;
     }
 /* update rtk server struct --------------------------------------------------*/
 static void update_svr(rtksvr_t *svr, int ret, obs_t *obs, nav_t *nav,
-                       int ephsat, int ephset, sbsmsg_t *sbsmsg, int index,
-                       int iobs)
+                       int ephsat, int ephset, sbsmsg_t *sbsmsg, int index)
 {
     tracet(4,"updatesvr: ret=%d ephsat=%d ephset=%d index=%d\n",ret,ephsat,
            ephset,index);
     
     if (ret==1) { /* observation data */
-        update_obs(svr,obs,index,iobs);
+        update_obs(svr,obs,index);
     }
     else if (ret==2) { /* ephemeris */
         update_eph(svr,nav,ephsat,ephset,index);
@@ -382,7 +605,7 @@ static int decoderaw(rtksvr_t *svr, int index)
     obs_t *obs;
     nav_t *nav;
     sbsmsg_t *sbsmsg=NULL;
-    int i,ret,ephsat,ephset,fobs=0;
+    int i,ret,ephsat,ephset,fobs=0,nlock=0;
     
     tracet(4,"decoderaw: index=%d\n",index);
     
@@ -390,6 +613,14 @@ static int decoderaw(rtksvr_t *svr, int index)
     
     for (i=0;i<svr->nb[index];i++) {
         
+        /* release lock per message or bytes to let solver and monitor in */
+        if (nlock>=MAXDECLOCK) {
+            rtksvrunlock(svr);
+            rtksvrlock(svr);
+            nlock=0;
+        }
+        nlock++;
+        
         /* input rtcm/receiver raw data from stream */
         if (svr->format[index]==STRFMT_RTCM2) {
             ret=input_rtcm2(svr->rtcm+index,svr->buff[index][i]);
@@ -428,15 +659,18 @@ static int decoderaw(rtksvr_t *svr, int index)
 #endif
         /* update rtk server */
         if (ret>0) {
-            update_svr(svr,ret,obs,nav,ephsat,ephset,sbsmsg,index,fobs);
+            update_svr(svr,ret,obs,nav,ephsat,ephset,sbsmsg,index);
         }
+        if (ret!=0) nlock=MAXDECLOCK;
+        
         /* observation data received */
-        if (ret==1) {
-            if (fobs<MAXOBSBUF) fobs++; else svr->prcout++;
-        }
+        if (ret==1) fobs++;
     }
     svr->nb[index]=0;
     
+    /* publish updated navigation data */
+    if (svr->navupd) publishnav(svr);
+    
     rtksvrunlock(svr);
     
     return fobs;
@@ -444,6 +678,8 @@ static int decoderaw(rtksvr_t *svr, int index)
 /* decode download file ------------------------------------------------------*/
 static void decodefile(rtksvr_t *svr, int index)
 {
+    navsnap_t *cur;
+    
     tracet(4,"decodefile: index=%d\n",index);
 
     nav_t *nav = (nav_t *)calloc(1, sizeof(nav_t));
@@ -480,13 +716,17 @@ static void decodefile(rtksvr_t *svr, int index)
         /* update precise ephemeris */
         rtksvrlock(svr);
         
-        if (svr->nav.peph) free(svr->nav.peph);
+        /* free previous one with the last snapshot referencing it */
+        cur=(navsnap_t *)svr->navsnap;
+        if (cur&&cur->nav.peph==svr->nav.peph) cur->peph=svr->nav.peph;
+        else free(svr->nav.peph);
         svr->nav.ne = nav->ne;
         svr->nav.nemax = nav->nemax;
         svr->nav.peph=nav->peph;
         svr->ftime[index]=utc2gpst(timeget());
         strcpy(svr->files[index],file);
         
+        publishnav(svr);
         rtksvrunlock(svr);
     }
     else if (svr->format[index]==STRFMT_RNXCLK) { /* precise clock */
@@ -500,13 +740,16 @@ static void decodefile(rtksvr_t *svr, int index)
         /* update precise clock */
         rtksvrlock(svr);
         
-        if (svr->nav.pclk) free(svr->nav.pclk);
+        cur=(navsnap_t *)svr->navsnap;
+        if (cur&&cur->nav.pclk==svr->nav.pclk) cur->pclk=svr->nav.pclk;
+        else free(svr->nav.pclk);
         svr->nav.nc = nav->nc;
         svr->nav.ncmax = nav->ncmax;
         svr->nav.pclk=nav->pclk;
         svr->ftime[index]=utc2gpst(timeget());
         strcpy(svr->files[index],file);
         
+        publishnav(svr);
         rtksvrunlock(svr);
     }
     free(nav);
@@ -551,27 +794,33 @@ static void periodic_cmd(int cycle, const char *cmd, stream_t *stream)
     }
 }
 /* baseline length -----------------------------------------------------------*/
-static double baseline_len(const rtk_t *rtk)
+static double baseline_len(const double *rr, const double *rb)
 {
     double dr[3];
     int i;
 
-    if (norm(rtk->sol.rr,3)<=0.0||norm(rtk->rb,3)<=0.0) return 0.0;
+    if (norm(rr,3)<=0.0||norm(rb,3)<=0.0) return 0.0;
 
     for (i=0;i<3;i++) {
-        dr[i]=rtk->sol.rr[i]-rtk->rb[i];
+        dr[i]=rr[i]-rb[i];
     }
     return norm(dr,3)*0.001; /* (km) */
 }
 /* send nmea request to base/nrtk input stream -------------------------------*/
 static void send_nmea(rtksvr_t *svr, uint32_t *tickreset)
 {
-    sol_t sol_nmea={{0}};
-    double vel,bl;
+    sol_t sol_nmea={{0}},sol;
+    double vel,bl,rb[3];
     uint32_t tick=tickget();
     int i;
 
     if (svr->stream[1].state!=1) return;
+
+    /* current solution and base position updated by solver thread */
+    rtksvrlock(svr);
+    sol=svr->rtk.sol;
+    matcpy(rb,svr->rtk.rb,3,1);
+    rtksvrunlock(svr);
     sol_nmea.ns=10; /* Some servers don't like when ns = 0 */
 
     if (svr->nmeareq==1) { /* lat-lon-hgt mode */
@@ -581,33 +830,33 @@ static void send_nmea(rtksvr_t *svr, uint32_t *tickreset)
         strsendnmea(svr->stream+1,&sol_nmea);
     }
     else if (svr->nmeareq==2) { /* single-solution mode */
-        if (norm(svr->rtk.sol.rr,3)<=0.0) return;
+        if (norm(sol.rr,3)<=0.0) return;
         sol_nmea.stat=SOLQ_SINGLE;
         sol_nmea.time=utc2gpst(timeget());
-        matcpy(sol_nmea.rr,svr->rtk.sol.rr,3,1);
+        matcpy(sol_nmea.rr,sol.rr,3,1);
         strsendnmea(svr->stream+1,&sol_nmea);
     }
     else if (svr->nmeareq==3) { /* reset-and-single-sol mode */
 
         /* send reset command if baseline over threshold */
-        bl=baseline_len(&svr->rtk);
+        bl=baseline_len(sol.rr,rb);
         if (bl>=svr->bl_reset&&(int)(tick-*tickreset)>MIN_INT_RESET) {
             strsendcmd(svr->stream+1,svr->cmd_reset);
             
             tracet(2,"send reset: bl=%.3f rr=%.3f %.3f %.3f rb=%.3f %.3f %.3f\n",
-                   bl,svr->rtk.sol.rr[0],svr->rtk.sol.rr[1],svr->rtk.sol.rr[2],
-                   svr->rtk.rb[0],svr->rtk.rb[1],svr->rtk.rb[2]);
+                   bl,sol.rr[0],sol.rr[1],sol.rr[2],
+                   rb[0],rb[1],rb[2]);
             *tickreset=tick;
         }
-        if (norm(svr->rtk.sol.rr,3)<=0.0) return;
+        if (norm(sol.rr,3)<=0.0) return;
         sol_nmea.stat=SOLQ_SINGLE;
         sol_nmea.time=utc2gpst(timeget());
-        matcpy(sol_nmea.rr,svr->rtk.sol.rr,3,1);
+        matcpy(sol_nmea.rr,sol.rr,3,1);
 
         /* set predicted position if velocity > 36km/h */
-        if ((vel=norm(svr->rtk.sol.rr+3,3))>10.0) {
+        if ((vel=norm(sol.rr+3,3))>10.0) {
             for (i=0;i<3;i++) {
-                sol_nmea.rr[i]+=svr->rtk.sol.rr[i+3]/vel*svr->bl_reset*0.8;
+                sol_nmea.rr[i]+=sol.rr[i+3]/vel*svr->bl_reset*0.8;
             }
         }
         strsendnmea(svr->stream+1,&sol_nmea);
@@ -616,7 +865,493 @@ static void send_nmea(rtksvr_t *svr, uint32_t *tickreset)
                sol_nmea.rr[2]);
     }
 }
-/* rtk server thread ---------------------------------------------------------*/
+/* thread argument of input/decode thread ------------------------------------*/
+typedef struct {
+    rtksvr_t *svr;      /* rtk server */
+    int index;          /* input stream index (0:rover,1:base,2:corr) */
+} inputarg_t;
+
+/* averaging single base pos -------------------------------------------------*/
+static void ave_basepos(rtksvr_t *svr)
+{
+    sol_t sol={{0}};
+    char msg[128];
+    int i;
+    
+    rtksvrlock(svr);
+    
+    if (svr->rtcm[1].staid>0) sol.refstationid=svr->rtcm[1].staid;
+    
+    if ((svr->rtk.opt.maxaveep<=0||svr->nave<svr->rtk.opt.maxaveep)&&
+        pntpos(svr->obs[1][0].data,svr->obs[1][0].n,&svr->nav,&svr->rtk.opt,
+               &sol,NULL,NULL,msg)) {
+        svr->nave++;
+        for (i=0;i<3;i++) {
+            svr->rb_ave[i]+=(sol.rr[i]-svr->rb_ave[i])/svr->nave;
+        }
+    }
+    for (i=0;i<3;i++) svr->rtk.opt.rb[i]=svr->rb_ave[i];
+    
+    rtksvrunlock(svr);
+}
+/* input/decode thread -------------------------------------------------------*/
+#ifdef WIN32
+static DWORD WINAPI inputthread(void *arg)
+#else
+static void *inputthread(void *arg)
+#endif
+{
+    rtksvr_t *svr=((inputarg_t *)arg)->svr;
+    int index=((inputarg_t *)arg)->index;
+    uint32_t tick,ticknmea,tickreset;
+    uint8_t *p,*q;
+    int n,cycle,cputime;
+    
+    tracet(3,"inputthread: index=%d\n",index);
+    
+    ticknmea=svr->tick-1000;
+    tickreset=svr->tick-MIN_INT_RESET;
+    
+    for (cycle=0;svr->state;cycle++) {
+        tick=tickget();
+        p=svr->buff[index]+svr->nb[index]; q=svr->buff[index]+svr->buffsize;
+        
+        /* read receiver raw/rtcm data from input stream */
+        if ((n=strread(svr->stream+index,p,q-p))>0) {
+            
+            /* write receiver raw/rtcm data to log stream */
+            strwrite(svr->stream+index+5,p,n);
+            svr->nb[index]+=n;
+            
+            /* save peek buffer */
+            rtksvrlock(svr);
+            n=n<svr->buffsize-svr->npb[index]?n:svr->buffsize-svr->npb[index];
+            memcpy(svr->pbuf[index]+svr->npb[index],p,n);
+            svr->npb[index]+=n;
+            rtksvrunlock(svr);
+        }
+        if (svr->format[index]==STRFMT_SP3||svr->format[index]==STRFMT_RNXCLK) {
+            /* decode download file */
+            decodefile(svr,index);
+        }
+        else if (decoderaw(svr,index)>0&&index==1&&
+                 svr->rtk.opt.refpos==POSOPT_SINGLE) {
+            /* averaging single base pos */
+            ave_basepos(svr);
+        }
+        /* write periodic command to input stream */
+        periodic_cmd(cycle*svr->cycle,svr->cmds_periodic[index],
+                     svr->stream+index);
+        
+        /* send nmea request to base/nrtk input stream */
+        if (index==1&&svr->nmeacycle>0&&(int)(tick-ticknmea)>=svr->nmeacycle) {
+            send_nmea(svr,&tickreset);
+            ticknmea=tick;
+        }
+        cputime=(int)(tickget()-tick);
+        
+        /* sleep until next cycle */
+        sleepms(svr->cycle-cputime);
+    }
+    return 0;
+}
+/* solution output thread ----------------------------------------------------*/
+#ifdef WIN32
+static DWORD WINAPI outputthread(void *arg)
+#else
+static void *outputthread(void *arg)
+#endif
+{
+    rtksvr_t *svr=(rtksvr_t *)arg;
+    uint8_t *buff;
+    
+    tracet(3,"outputthread:\n");
+    
+    if (!(buff=(uint8_t *)malloc(svr->buffsize))) {
+        tracet(1,"outputthread: malloc error\n");
+        return 0;
+    }
+    while (svr->state) {
+        writeout(svr,buff);
+        sleepms(svr->cycle);
+    }
+    free(buff);
+    return 0;
+}
+/* create/join server sub-thread ---------------------------------------------*/
+#ifdef WIN32
+static int createthread(rtklib_thread_t *thread,
+                        DWORD (WINAPI *func)(void *), void *arg)
+{
+    return (*thread=CreateThread(NULL,0,func,arg,0,NULL))!=NULL;
+}
+static void jointhread(rtklib_thread_t thread)
+{
+    WaitForSingleObject(thread,INFINITE);
+    CloseHandle(thread);
+}
+#else
+static int createthread(rtklib_thread_t *thread, void *(*func)(void *),
+                        void *arg)
+{
+    return !pthread_create(thread,NULL,func,arg);
+}
+static void jointhread(rtklib_thread_t thread)
+{
+    pthread_join(thread,NULL);
+}
+#endif
+/* set glonass frequency channel number from shared navigation data ----------*/
+static void setglofcn(const nav_t *nav, nav_t *dst)
+{
+    int i,sat,frq;
+    
+    if (!dst->geph) return;
+    
+    for (i=0;i<MAXPRNGLO;i++) {
+        sat=satno(SYS_GLO,i+1);
+        if (nav->geph[i].sat!=sat||dst->geph[i].sat==sat) continue;
+        if ((frq=nav->geph[i].frq)<-7||frq>6) continue;
+        dst->geph[i].sat=sat;
+        dst->geph[i].frq=frq;
+    }
+}
+/* decode rover raw/rtcm data ------------------------------------------------*/
+static void decoderov(rtksvr_t *svr, rtksvrrov_t *rov)
+{
+    obs_t *obs,*obsq;
+    int i,j,n,ret,sat,next;
+    
+    tracet(4,"decoderov: name=%s\n",rov->name);
+    
+    rtksvrlock(svr);
+    setglofcn(&svr->nav,&rov->raw.nav);
+    setglofcn(&svr->nav,&rov->rtcm.nav);
+    rtksvrunlock(svr);
+    
+    for (i=0;i<rov->nb;i++) {
+        
+        /* input rtcm/receiver raw data from stream */
+        if (rov->format==STRFMT_RTCM2) {
+            ret=input_rtcm2(&rov->rtcm,rov->buff[i]);
+            obs=&rov->rtcm.obs;
+        }
+        else if (rov->format==STRFMT_RTCM3) {
+            ret=input_rtcm3(&rov->rtcm,rov->buff[i]);
+            if (rov->rtcm.nbyte_invalid!=0) { /* rewind to last preamble+1 */
+                i-=rov->rtcm.nbyte_invalid-1;
+                i=i>=0?i:0;
+                rov->rtcm.nbyte_invalid=0;
+            }
+            obs=&rov->rtcm.obs;
+        }
+        else {
+            ret=input_raw(&rov->raw,rov->format,rov->buff[i]);
+            obs=&rov->raw.obs;
+        }
+        if (ret==-1) rov->nerr++;
+        if (ret!=1) continue; /* navigation data of rovers not used */
+        
+        /* push rover observation data to solver queue */
+        rtksvrlock(svr);
+        
+        next=(rov->qtail+1)%MAXROVOBSQ;
+        if (next==rov->qhead) { /* queue full */
+            rov->prcout++;
+        }
+        else {
+            obsq=rov->obsq+rov->qtail;
+            for (j=n=0;j<obs->n&&n<MAXOBS;j++) {
+                sat=obs->data[j].sat;
+                if (svr->rtk.opt.exsats[sat-1]==1||
+                    !(satsys(sat,NULL)&svr->rtk.opt.navsys)) {
+                    continue;
+                }
+                obsq->data[n]=obs->data[j];
+                obsq->data[n++].rcv=1;
+            }
+            obsq->n=n;
+            sortobs(obsq);
+            rov->qtail=next;
+        }
+        rov->nobs++;
+        
+        rtksvrunlock(svr);
+    }
+    rov->nb=0;
+}
+/* rover input/decode thread (multi-rover mode) ------------------------------*/
+#ifdef WIN32
+static DWORD WINAPI rovinputthread(void *arg)
+#else
+static void *rovinputthread(void *arg)
+#endif
+{
+    rtksvr_t *svr=(rtksvr_t *)arg;
+    rtksvrrov_t *rov;
+    uint32_t tick;
+    int i,n,cputime;
+    
+    tracet(3,"rovinputthread: nrov=%d\n",svr->nrov);
+    
+    while (svr->state) {
+        tick=tickget();
+        
+        for (i=0;i<svr->nrov;i++) {
+            rov=svr->rov+i;
+            
+            /* read receiver raw/rtcm data from rover input stream */
+            n=strread(rov->stream,rov->buff+rov->nb,svr->buffsize-rov->nb);
+            if (n<=0) continue;
+            
+            /* write receiver raw/rtcm data to rover log stream */
+            strwrite(rov->stream+3,rov->buff+rov->nb,n);
+            rov->nb+=n;
+            
+            decoderov(svr,rov);
+        }
+        cputime=(int)(tickget()-tick);
+        
+        /* sleep until next cycle */
+        sleepms(svr->cycle-cputime);
+    }
+    return 0;
+}
+/* set base station position/antenna of rover --------------------------------*/
+static void setbaserov(const rtksvr_t *svr, rtk_t *rtk)
+{
+    int i;
+    
+    if (rtk->opt.mode==PMODE_MOVEB) return;
+    
+    /* single-averaged or rtcm base position updated by decode threads */
+    for (i=0;i<3;i++) rtk->opt.rb[i]=svr->rtk.opt.rb[i];
+    if (svr->rtk.opt.refpos==POSOPT_RTCM) {
+        for (i=0;i<6;i++) rtk->rb[i]=svr->rtk.rb[i];
+    }
+    rtk->opt.pcvr[1]=svr->rtk.opt.pcvr[1];
+    for (i=0;i<3;i++) rtk->opt.antdel[1][i]=svr->rtk.opt.antdel[1][i];
+}
+/* set options and base position of solver -----------------------------------*/
+static void syncrtk(const rtksvr_t *svr, rtk_t *rtk)
+{
+    /* options updated by decode threads and applications */
+    rtk->opt=svr->rtk.opt;
+    
+    if (rtk->opt.mode!=PMODE_MOVEB&&rtk->opt.refpos==POSOPT_RTCM) {
+        matcpy(rtk->rb,svr->rtk.rb,6,1);
+    }
+}
+/* publish solver state to rtk server ------------------------------------------
+* copy the state of the private rtk control of the solver to svr->rtk read by
+* output and monitor. options and base position of svr->rtk, updated by
+* decode threads and applications, are kept. the caller is expected to hold
+* svr->lock.
+*-----------------------------------------------------------------------------*/
+static void publishrtk(rtksvr_t *svr, const rtk_t *rtk)
+{
+    rtk_t *dst=&svr->rtk;
+    
+    dst->sol=rtk->sol;
+    if (dst->opt.mode==PMODE_MOVEB||dst->opt.refpos!=POSOPT_RTCM) {
+        matcpy(dst->rb,rtk->rb,6,1);
+    }
+    dst->tt=rtk->tt;
+    if (dst->nx==rtk->nx) {
+        matcpy(dst->x,rtk->x,rtk->nx,1);
+        matcpy(dst->P,rtk->P,rtk->nx,rtk->nx);
+    }
+    if (dst->na==rtk->na) {
+        matcpy(dst->xa,rtk->xa,rtk->na,1);
+        matcpy(dst->Pa,rtk->Pa,rtk->na,rtk->na);
+    }
+    dst->nfix=rtk->nfix;
+    dst->excsat=rtk->excsat;
+    dst->nb_ar=rtk->nb_ar;
+    dst->holdamb=rtk->holdamb;
+    memcpy(dst->ambc,rtk->ambc,sizeof(rtk->ambc));
+    memcpy(dst->ssat,rtk->ssat,sizeof(rtk->ssat));
+    dst->neb=rtk->neb;
+    memcpy(dst->errbuf,rtk->errbuf,rtk->neb);
+    dst->epoch=rtk->epoch;
+}
+/* write rover solution to rover output streams ------------------------------*/
+static void writesolrov(rtksvrrov_t *rov)
+{
+    uint8_t buff[MAXSOLMSG+1];
+    int i,n;
+    
+    tracet(4,"writesolrov: name=%s\n",rov->name);
+    
+    for (i=0;i<2;i++) {
+        if (rov->solopt[i].posf==SOLF_STAT) {
+            n=rtkoutstat(&rov->rtk,rov->solopt[i].sstat,(char *)buff);
+        }
+        else {
+            n=outsols(buff,&rov->rtk.sol,rov->rtk.rb,rov->solopt+i);
+        }
+        strwrite(rov->stream+i+1,buff,n);
+        
+        n=outsolexs(buff,&rov->rtk.sol,rov->rtk.ssat,rov->solopt+i);
+        strwrite(rov->stream+i+1,buff,n);
+    }
+}
+/* rover solver thread (multi-rover mode) --------------------------------------
+* worker of the rover solver pool. each worker takes the next rover with
+* queued epochs in round-robin order and solves one epoch against the shared
+* base observation data and a pinned navigation data snapshot. a rover is solved by only one worker
+* at a time (rov->busy), so epochs of a rover are processed in order.
+*-----------------------------------------------------------------------------*/
+#ifdef WIN32
+static DWORD WINAPI rovsolverthread(void *arg)
+#else
+static void *rovsolverthread(void *arg)
+#endif
+{
+    rtksvr_t *svr=(rtksvr_t *)arg;
+    rtksvrrov_t *rov;
+    const nav_t *nav;
+    obs_t obs={0};
+    uint32_t tick;
+    int i,j,pin;
+    
+    tracet(3,"rovsolverthread:\n");
+    
+    if (!(obs.data=(obsd_t *)malloc(sizeof(obsd_t)*MAXOBS*2))) {
+        tracet(1,"rovsolverthread: malloc error\n");
+        return 0;
+    }
+    obs.nmax=MAXOBS*2;
+    
+    while (svr->state) {
+        rtksvrlock(svr);
+        
+        /* select next rover with queued observation data */
+        for (i=0,rov=NULL;i<svr->nrov&&!rov;i++) {
+            j=(svr->irov+i)%svr->nrov;
+            if (svr->rov[j].busy||svr->rov[j].qhead==svr->rov[j].qtail) {
+                continue;
+            }
+            rov=svr->rov+j;
+            svr->irov=(j+1)%svr->nrov;
+        }
+        if (!rov) {
+            rtksvrunlock(svr);
+            sleepms(svr->cycle);
+            continue;
+        }
+        rov->busy=1;
+        
+        /* rover and current base observation data */
+        obs.n=0;
+        for (j=0;j<rov->obsq[rov->qhead].n&&obs.n<MAXOBS*2;j++) {
+            obs.data[obs.n++]=rov->obsq[rov->qhead].data[j];
+        }
+        for (j=0;j<svr->obs[1][0].n&&obs.n<MAXOBS*2;j++) {
+            obs.data[obs.n++]=svr->obs[1][0].data[j];
+        }
+        rov->qhead=(rov->qhead+1)%MAXROVOBSQ;
+        setbaserov(svr,&rov->rtk);
+        
+        rtksvrunlock(svr);
+        
+        tick=tickget();
+        
+        /* rtk positioning with pinned navigation data snapshot */
+        if ((nav=rtksvrpinnav(svr,&pin))) {
+            if (!strstr(rov->rtk.opt.pppopt,"-DIS_FCB")) {
+                corr_phase_bias(obs.data,obs.n,nav);
+            }
+            rtkpos(&rov->rtk,obs.data,obs.n,nav);
+            rtksvrunpinnav(svr,pin);
+        }
+        
+        /* write solution */
+        if (rov->rtk.sol.stat!=SOLQ_NONE) {
+            writesolrov(rov);
+        }
+        rtksvrlock(svr);
+        if (rov->rtk.sol.stat!=SOLQ_NONE) {
+            rov->sol=rov->rtk.sol;
+            rov->nsol++;
+        }
+        rov->cputime=(int)(tickget()-tick);
+        rov->busy=0;
+        rtksvrunlock(svr);
+    }
+    free(obs.data);
+    return 0;
+}
+/* open/close rover of multi-rover mode --------------------------------------*/
+static int openrov(rtksvr_t *svr, rtksvrrov_t *rov, const prcopt_t *prcopt,
+                   char *errmsg)
+{
+    sol_t sol0={{0}};
+    gtime_t time;
+    int i,rw;
+    
+    tracet(3,"openrov: name=%s\n",rov->name);
+    
+    for (i=0;i<4;i++) strinit(rov->stream+i);
+    rov->nb=rov->qhead=rov->qtail=rov->busy=rov->prcout=rov->cputime=0;
+    rov->nobs=rov->nerr=rov->nsol=0;
+    rov->sol=sol0;
+    rtkfree(&rov->rtk);
+    rtkinit(&rov->rtk,prcopt);
+    
+    /* partial ar sequentially, rovers are solved in parallel by the pool */
+    rov->rtk.opt.arpar=0;
+    
+    if (!(rov->buff=(uint8_t *)malloc(svr->buffsize))||
+        !init_raw(&rov->raw,rov->format)||!init_rtcm(&rov->rtcm)) {
+        sprintf(errmsg,"rtk server malloc error");
+        return 0;
+    }
+    strcpy(rov->raw .opt,rov->rcvopt);
+    strcpy(rov->rtcm.opt,rov->rcvopt);
+    
+    for (i=0;i<4;i++) {
+        rw=i==0?STR_MODE_R:STR_MODE_W;
+        if (rov->strs[i]!=STR_FILE) rw|=STR_MODE_W;
+        if (!stropen(rov->stream+i,rov->strs[i],rw,rov->paths[i])) {
+            sprintf(errmsg,"rover %s str%d open error path=%s",rov->name,i+1,
+                    rov->paths[i]);
+            return 0;
+        }
+    }
+    /* set initial time for rtcm and raw */
+    time=utc2gpst(timeget());
+    if (rov->strs[0]==STR_FILE) time=strgettime(rov->stream);
+    rov->raw.time=rov->rtcm.time=time;
+    
+    /* write solution header to rover solution streams */
+    for (i=1;i<3;i++) {
+        writesolhead(rov->stream+i,rov->solopt+(i-1),prcopt);
+    }
+    return 1;
+}
+static void closerov(rtksvrrov_t *rov)
+{
+    int i;
+    
+    tracet(3,"closerov: name=%s\n",rov->name);
+    
+    for (i=0;i<4;i++) strclose(rov->stream+i);
+    free(rov->buff); rov->buff=NULL;
+    rov->nb=0;
+    free_raw (&rov->raw);
+    free_rtcm(&rov->rtcm);
+}
+/* rtk server thread -----------------------------------------------------------
+* solver stage of the rtk server. input/decode threads for rover, base and
+* correction streams push decoded rover epochs into the observation queue
+* (svr->obsq) and the output thread writes queued solutions to the solution
+* and monitor streams, so slow streams and rtkpos() don't stall each other.
+* rtkpos() runs on a private rtk control with a pinned navigation data snapshot
+* and the lock is held only to dequeue an epoch and to publish the solution to
+* svr->rtk. in multi-rover mode (svr->nrov>0), a rover input thread decodes the rover
+* streams and a pool of rover solver threads solves the rovers instead.
+*-----------------------------------------------------------------------------*/
 #ifdef WIN32
 static DWORD WINAPI rtksvrthread(void *arg)
 #else
@@ -624,13 +1359,14 @@ static void *rtksvrthread(void *arg)
 #endif
 {
     rtksvr_t *svr=(rtksvr_t *)arg;
+    inputarg_t args[3];
+    const nav_t *nav;
     obs_t obs;
-    sol_t sol={{0}};
+    rtk_t *rtk=NULL;
+    rtklib_thread_t rthread,*wthread=NULL;
     double tt;
-    uint32_t tick,ticknmea,tick1hz,tickreset;
-    uint8_t *p,*q;
-    char msg[128];
-    int i,j,n,cycle,cputime;
+    uint32_t tick,tickq,tick1hz;
+    int i,j,n,stat[4]={0},rstat=0,nw=0,cputime,pin;
     
     tracet(3,"rtksvrthread:\n");
     
@@ -642,112 +1378,135 @@ static void *rtksvrthread(void *arg)
     obs.data = data;
     obs.n = 0;
     obs.nmax = MAXOBS * 2;
-
+    
+    /* private rtk control of solver */
+    if (svr->nrov<=0) {
+        if (!(rtk=(rtk_t *)malloc(sizeof(rtk_t)))) {
+            trace(1,"rtksvrthread: rtk alloc failed\n");
+            free(data);
+            return 0;
+        }
+        rtksvrlock(svr);
+        rtkinit(rtk,&svr->rtk.opt);
+        matcpy(rtk->rb,svr->rtk.rb,6,1);
+        rtksvrunlock(svr);
+    }
     svr->state=1;
     svr->tick=tickget();
-    ticknmea=tick1hz=svr->tick-1000;
-    tickreset=svr->tick-MIN_INT_RESET;
-
-    for (cycle=0;svr->state;cycle++) {
-        tick=tickget();
-        for (i=0;i<3;i++) {
-            p=svr->buff[i]+svr->nb[i]; q=svr->buff[i]+svr->buffsize;
-            
-            /* read receiver raw/rtcm data from input stream */
-            if ((n=strread(svr->stream+i,p,q-p))<=0) {
-                continue;
-            }
-            /* write receiver raw/rtcm data to log stream */
-            strwrite(svr->stream+i+5,p,n);
-            svr->nb[i]+=n;
-            
-            /* save peek buffer */
-            rtksvrlock(svr);
-            n=n<svr->buffsize-svr->npb[i]?n:svr->buffsize-svr->npb[i];
-            memcpy(svr->pbuf[i]+svr->npb[i],p,n);
-            svr->npb[i]+=n;
-            rtksvrunlock(svr);
+    tick1hz=svr->tick-1000;
+    
+    /* create input/decode and output threads */
+    for (i=0;i<3;i++) {
+        args[i].svr=svr;
+        args[i].index=i;
+        if (!(stat[i]=createthread(svr->ithread+i,inputthread,args+i))) {
+            tracet(1,"rtksvrthread: input thread create error index=%d\n",i);
         }
-        int fobs[3]={0};
-        for (i=0;i<3;i++) {
-            if (svr->format[i]==STRFMT_SP3||svr->format[i]==STRFMT_RNXCLK) {
-                /* decode download file */
-                decodefile(svr,i);
-            }
-            else {
-                /* decode receiver raw/rtcm data */
-                fobs[i]=decoderaw(svr,i);
-                if (1==i&&svr->rtcm[1].staid>0) sol.refstationid=svr->rtcm[1].staid; 
-            }
+    }
+    if (!(stat[3]=createthread(&svr->othread,outputthread,svr))) {
+        tracet(1,"rtksvrthread: output thread create error\n");
+    }
+    /* create rover input and solver threads for multi-rover mode */
+    if (svr->nrov>0) {
+        if (!(rstat=createthread(&rthread,rovinputthread,svr))) {
+            tracet(1,"rtksvrthread: rover input thread create error\n");
         }
-        /* averaging single base pos */
-        if (fobs[1]>0&&svr->rtk.opt.refpos==POSOPT_SINGLE) {
-            if ((svr->rtk.opt.maxaveep<=0||svr->nave<svr->rtk.opt.maxaveep)&&
-                pntpos(svr->obs[1][0].data,svr->obs[1][0].n,&svr->nav,
-                       &svr->rtk.opt,&sol,NULL,NULL,msg)) {
-                svr->nave++;
-                for (i=0;i<3;i++) {
-                    svr->rb_ave[i]+=(sol.rr[i]-svr->rb_ave[i])/svr->nave;
-                }
+        n=svr->nworker>1?svr->nworker:1;
+        if (!(wthread=(rtklib_thread_t *)malloc(sizeof(rtklib_thread_t)*n))) {
+            tracet(1,"rtksvrthread: malloc error\n");
+            n=0;
+        }
+        for (nw=0;nw<n;nw++) {
+            if (!createthread(wthread+nw,rovsolverthread,svr)) {
+                tracet(1,"rtksvrthread: rover solver thread create error\n");
+                break;
             }
-            for (i=0;i<3;i++) svr->rtk.opt.rb[i]=svr->rb_ave[i];
         }
-        for (i=0;i<fobs[0];i++) { /* for each rover observation data */
+    }
+    while (svr->state) {
+        tick=tickget();
+        
+        for (n=0;rtk;n++) { /* for each queued rover observation data */
+            rtksvrlock(svr);
+            
+            if (svr->qhead==svr->qtail) {
+                rtksvrunlock(svr);
+                break;
+            }
             obs.n=0;
-            for (j=0;j<svr->obs[0][i].n&&obs.n<MAXOBS*2;j++) {
-                obs.data[obs.n++]=svr->obs[0][i].data[j];
+            for (j=0;j<svr->obsq[svr->qhead].n&&obs.n<MAXOBS*2;j++) {
+                obs.data[obs.n++]=svr->obsq[svr->qhead].data[j];
             }
             for (j=0;j<svr->obs[1][0].n&&obs.n<MAXOBS*2;j++) {
                 obs.data[obs.n++]=svr->obs[1][0].data[j];
             }
-            /* carrier phase bias correction */
-            if (!strstr(svr->rtk.opt.pppopt,"-DIS_FCB")) {
-                corr_phase_bias(obs.data,obs.n,&svr->nav);
+            tickq=svr->tickq[svr->qhead];
+            svr->qhead=(svr->qhead+1)%MAXOBSBUF;
+            syncrtk(svr,rtk);
+            
+            rtksvrunlock(svr);
+            
+            /* rtk positioning with pinned navigation data snapshot */
+            if ((nav=rtksvrpinnav(svr,&pin))) {
+                
+                /* carrier phase bias correction */
+                if (!strstr(rtk->opt.pppopt,"-DIS_FCB")) {
+                    corr_phase_bias(obs.data,obs.n,nav);
+                }
+                rtkpos(rtk,obs.data,obs.n,nav);
+                rtksvrunpinnav(svr,pin);
             }
-            /* rtk positioning */
+            
+            /* publish solver state */
             rtksvrlock(svr);
-            rtkpos(&svr->rtk,obs.data,obs.n,&svr->nav);
+            publishrtk(svr,rtk);
             rtksvrunlock(svr);
             
-            if (svr->rtk.sol.stat!=SOLQ_NONE) {
+            if (rtk->sol.stat!=SOLQ_NONE) {
                 
                 /* adjust current time */
-                tt=(int)(tickget()-tick)/1000.0+DTTOL;
-                timeset(gpst2utc(timeadd(svr->rtk.sol.time,tt)));
+                tt=(int)(tickget()-tickq)/1000.0+DTTOL;
+                timeset(gpst2utc(timeadd(rtk->sol.time,tt)));
                 
                 /* write solution */
-                writesol(svr,i);
-            }
-            /* if cpu overload, increment obs outage counter and break */
-            if ((int)(tickget()-tick)>=svr->cycle) {
-                svr->prcout+=fobs[0]-i-1;
+                writesol(svr,n);
             }
         }
         /* send null solution if no solution (1hz) */
-        if (svr->rtk.sol.stat==SOLQ_NONE&&(int)(tick-tick1hz)>=1000) {
+        if (rtk&&rtk->sol.stat==SOLQ_NONE&&(int)(tick-tick1hz)>=1000) {
             writesol(svr,0);
             tick1hz=tick;
         }
-        /* write periodic command to input stream */
-        for (i=0;i<3;i++) {
-            periodic_cmd(cycle*svr->cycle,svr->cmds_periodic[i],svr->stream+i);
-        }
-        /* send nmea request to base/nrtk input stream */
-        if (svr->nmeacycle>0&&(int)(tick-ticknmea)>=svr->nmeacycle) {
-            send_nmea(svr,&tickreset);
-            ticknmea=tick;
-        }
         if ((cputime=(int)(tickget()-tick))>0) svr->cputime=cputime;
         
         /* sleep until next cycle */
         sleepms(svr->cycle-cputime);
     }
+    for (i=0;i<3;i++) if (stat[i]) jointhread(svr->ithread[i]);
+    if (stat[3]) jointhread(svr->othread);
+    if (rstat) jointhread(rthread);
+    for (i=0;i<nw;i++) jointhread(wthread[i]);
+    free(wthread);
+    if (rtk) {
+        rtkfree(rtk);
+        free(rtk);
+    }
+    /* flush solutions remaining in output queues */
+    if (svr->buffsize>0) {
+        uint8_t *buff=(uint8_t *)malloc(svr->buffsize);
+        if (buff) {
+            writeout(svr,buff);
+            free(buff);
+        }
+    }
     free(data);
     for (i=0;i<MAXSTRRTK;i++) strclose(svr->stream+i);
+    for (i=0;i<svr->nrov;i++) closerov(svr->rov+i);
     for (i=0;i<3;i++) {
-        svr->nb[i]=svr->npb[i]=0;
+        svr->nb[i]=svr->npb[i]=svr->nob[i]=0;
         free(svr->buff[i]); svr->buff[i]=NULL;
         free(svr->pbuf[i]); svr->pbuf[i]=NULL;
+        free(svr->obuf[i]); svr->obuf[i]=NULL;
         free_raw (svr->raw +i);
         free_rtcm(svr->rtcm+i);
     }
@@ -755,6 +1514,7 @@ static void *rtksvrthread(void *arg)
         svr->nsb[i]=0;
         free(svr->sbuf[i]); svr->sbuf[i]=NULL;
     }
+    svr->qhead=svr->qtail=0;
     return 0;
 }
 /* initialize rtk server -------------------------------------------------------
@@ -785,6 +1545,9 @@ extern int rtksvrinit(rtksvr_t *svr)
     for (i=0;i<3;i++) svr->buff[i]=NULL;
     for (i=0;i<2;i++) svr->sbuf[i]=NULL;
     for (i=0;i<3;i++) svr->pbuf[i]=NULL;
+    for (i=0;i<3;i++) svr->obuf[i]=NULL;
+    for (i=0;i<3;i++) svr->nob[i]=0;
+    svr->qhead=svr->qtail=0;
     for (i=0;i<MAXSOLBUF;i++) svr->solbuf[i]=sol0;
     for (i=0;i<3;i++) for (j=0;j<10;j++) svr->nmsg[i][j]=0;
     for (i=0;i<3;i++) svr->ftime[i]=time0;
@@ -794,9 +1557,16 @@ extern int rtksvrinit(rtksvr_t *svr)
     svr->thread=0;
     svr->cputime=svr->prcout=svr->nave=0;
     for (i=0;i<3;i++) svr->rb_ave[i]=0.0;
+    svr->rov=NULL;
+    svr->nrov=svr->nworker=svr->irov=0;
+    svr->navsnap=svr->navret=svr->navfree=NULL;
+    svr->navver=0;
+    for (i=0;i<MAXNAVPIN;i++) svr->navpin[i]=0;
+    svr->navupd=0;
     
     memset(&svr->nav,0,sizeof(nav_t));
     memset(&svr->obs,0,sizeof(svr->obs));
+    memset(&svr->obsq,0,sizeof(svr->obsq));
     if (!(svr->nav.eph =(eph_t  *)malloc(sizeof(eph_t )*MAXSAT*4 ))||
         !(svr->nav.seph=(seph_t *)malloc(sizeof(seph_t)*NSATSBS*2))) {
         tracet(1,"rtksvrinit: malloc error\n");
@@ -820,6 +1590,12 @@ extern int rtksvrinit(rtksvr_t *svr)
     }
     svr->nav.ng = svr->nav.ngmax = MAXPRNGLO * 2;
 
+    if (!idxnav(&svr->nav)) {
+        tracet(1,"rtksvrinit: malloc error\n");
+        rtksvrfree(svr);
+        return 0;
+    }
+
     for (i=0;i<3;i++) for (j=0;j<MAXOBSBUF;j++) {
         if (!(svr->obs[i][j].data=(obsd_t *)malloc(sizeof(obsd_t)*MAXOBS))) {
             tracet(1,"rtksvrinit: malloc error\n");
@@ -827,6 +1603,13 @@ extern int rtksvrinit(rtksvr_t *svr)
             return 0;
         }
     }
+    for (i=0;i<MAXOBSBUF;i++) {
+        if (!(svr->obsq[i].data=(obsd_t *)malloc(sizeof(obsd_t)*MAXOBS))) {
+            tracet(1,"rtksvrinit: malloc error\n");
+            rtksvrfree(svr);
+            return 0;
+        }
+    }
     for (i=0;i<3;i++) {
         memset(svr->raw +i,0,sizeof(raw_t ));
         memset(svr->rtcm+i,0,sizeof(rtcm_t));
@@ -838,6 +1621,11 @@ extern int rtksvrinit(rtksvr_t *svr)
     svr->bl_reset=10.0;
     rtklib_initlock(&svr->lock);
     
+    /* publish initial navigation data snapshot */
+    if (!publishnav(svr)) {
+        rtksvrfree(svr);
+        return 0;
+    }
     return 1;
 }
 /* free rtk server -------------------------------------------------------------
@@ -849,13 +1637,16 @@ extern void rtksvrfree(rtksvr_t *svr)
 {
     int i,j;
     
-    free(svr->nav.eph );
-    free(svr->nav.geph);
-    free(svr->nav.seph);
+    freenav(&svr->nav,0x07);
     for (i=0;i<3;i++) for (j=0;j<MAXOBSBUF;j++) {
         free(svr->obs[i][j].data);
     }
+    for (i=0;i<MAXOBSBUF;i++) {
+        free(svr->obsq[i].data);
+    }
     rtkfree(&svr->rtk);
+    rtksvrfreerov(svr);
+    freenavsnap(svr);
 }
 /* lock/unlock rtk server ------------------------------------------------------
 * lock/unlock rtk server
@@ -937,6 +1728,7 @@ extern int rtksvrstart(rtksvr_t *svr, int cycle, int buffsize, int *strs,
     svr->nsbs=0;
     svr->nsol=0;
     svr->prcout=0;
+    svr->qhead=svr->qtail=0;
     rtkfree(&svr->rtk);
     rtkinit(&svr->rtk,prcopt);
     
@@ -974,6 +1766,14 @@ extern int rtksvrstart(rtksvr_t *svr, int cycle, int buffsize, int *strs,
             return 0;
         }
     }
+    for (i=0;i<3;i++) { /* solution output queue {sol1,sol2,moni} */
+        svr->nob[i]=0;
+        if (!(svr->obuf[i]=(uint8_t *)malloc(svr->buffsize))) {
+            tracet(1,"rtksvrstart: malloc error\n");
+            sprintf(errmsg,"rtk server malloc error");
+            return 0;
+        }
+    }
     /* set solution options */
     for (i=0;i<2;i++) {
         svr->solopt[i]=solopt[i];
@@ -989,6 +1789,16 @@ extern int rtksvrstart(rtksvr_t *svr, int cycle, int buffsize, int *strs,
     for (i=0;i<MAXPRNGLO*2;i++) svr->nav.geph[i].tof=time0;
     for (i=0;i<NSATSBS*2;i++) svr->nav.seph[i].tof=time0;
     
+    /* publish navigation data set before start (antenna, dcb, ...) */
+    rtksvrlock(svr);
+    
+    /* index ephemerides loaded into svr->nav in place by applications */
+    if (!idxnav(&svr->nav)) {
+        tracet(1,"rtksvrstart: ephemeris index error\n");
+    }
+    publishnav(svr);
+    rtksvrunlock(svr);
+    
     /* set monitor stream */
     svr->moni=moni;
     
@@ -1008,6 +1818,15 @@ extern int rtksvrstart(rtksvr_t *svr, int cycle, int buffsize, int *strs,
             svr->rtcm[i].time=strs[i]==STR_FILE?strgettime(svr->stream+i):time;
         }
     }
+    /* open rover streams for multi-rover mode */
+    for (i=0;i<svr->nrov;i++) {
+        if (openrov(svr,svr->rov+i,prcopt,errmsg)) continue;
+        for (;i>=0;i--) closerov(svr->rov+i);
+        for (i=0;i<MAXSTRRTK;i++) strclose(svr->stream+i);
+        return 0;
+    }
+    svr->irov=0;
+    
     /* sync input streams */
     strsync(svr->stream,svr->stream+1);
     strsync(svr->stream,svr->stream+2);
@@ -1030,6 +1849,7 @@ extern int rtksvrstart(rtksvr_t *svr, int cycle, int buffsize, int *strs,
     if (pthread_create(&svr->thread,NULL,rtksvrthread,svr)) {
 #endif
         for (i=0;i<MAXSTRRTK;i++) strclose(svr->stream+i);
+        for (i=0;i<svr->nrov;i++) closerov(svr->rov+i);
         sprintf(errmsg,"thread create error\n");
         return 0;
     }
@@ -1245,3 +2065,122 @@ extern int rtksvrmark(rtksvr_t *svr, const char *name, const char *comment)
     rtksvrunlock(svr);
     return 1;
 }
+/* add rover to multi-rover mode ------------------------------------------------
+* add a rover to rtk server. with one or more rovers added, the rtk server
+* runs in multi-rover mode: the rover input stream (strs[0] of rtksvrstart())
+* is not used, the base and correction streams and navigation data decoded
+* from them are shared by all rovers and each rover is solved by its own rtk
+* control struct in a pool of svr->nworker solver threads
+* args   : rtksvr_t *svr    IO rtk server
+*          char   *name     I  rover name
+*          int    *strs     I  stream types (STR_???)
+*                              strs[0]=input stream rover
+*                              strs[1]=output stream solution 1
+*                              strs[2]=output stream solution 2
+*                              strs[3]=log stream rover
+*          char   **paths   I  stream paths {input,sol1,sol2,log}
+*          int    format    I  input stream format (STRFMT_???)
+*          char   *rcvopt   I  receiver option
+*          solopt_t *solopt I  solution options {sol1,sol2}
+* return : rover index (-1:error)
+* notes  : rovers can be added or freed only while rtk server is stopped.
+*          partial ar candidates of rovers are evaluated sequentially
+*          (prcopt.arpar ignored) not to start threads per rover.
+*-----------------------------------------------------------------------------*/
+extern int rtksvraddrov(rtksvr_t *svr, const char *name, const int *strs,
+                        const char **paths, int format, const char *rcvopt,
+                        const solopt_t *solopt)
+{
+    rtksvrrov_t *rov;
+    int i,j;
+    
+    tracet(3,"rtksvraddrov: name=%s format=%d\n",name,format);
+    
+    if (svr->state) return -1;
+    
+    if (!(rov=(rtksvrrov_t *)realloc(svr->rov,sizeof(rtksvrrov_t)*
+                                     (svr->nrov+1)))) {
+        tracet(1,"rtksvraddrov: malloc error\n");
+        return -1;
+    }
+    svr->rov=rov;
+    rov=svr->rov+svr->nrov;
+    memset(rov,0,sizeof(rtksvrrov_t));
+    
+    for (i=0;i<MAXROVOBSQ;i++) {
+        if (!(rov->obsq[i].data=(obsd_t *)malloc(sizeof(obsd_t)*MAXOBS))) {
+            tracet(1,"rtksvraddrov: malloc error\n");
+            for (j=0;j<i;j++) free(rov->obsq[j].data);
+            return -1;
+        }
+        rov->obsq[i].nmax=MAXOBS;
+    }
+    rtkinit(&rov->rtk,&prcopt_default);
+    snprintf(rov->name,sizeof(rov->name),"%s",name);
+    snprintf(rov->rcvopt,sizeof(rov->rcvopt),"%s",rcvopt?rcvopt:"");
+    rov->format=format;
+    for (i=0;i<4;i++) {
+        rov->strs[i]=strs[i];
+        snprintf(rov->paths[i],MAXSTRPATH,"%s",paths[i]?paths[i]:"");
+    }
+    for (i=0;i<2;i++) rov->solopt[i]=solopt[i];
+    
+    return svr->nrov++;
+}
+/* free rovers of multi-rover mode ---------------------------------------------
+* free all rovers added by rtksvraddrov()
+* args   : rtksvr_t *svr    IO rtk server
+* return : none
+*-----------------------------------------------------------------------------*/
+extern void rtksvrfreerov(rtksvr_t *svr)
+{
+    int i,j;
+    
+    tracet(3,"rtksvrfreerov: nrov=%d\n",svr->nrov);
+    
+    if (svr->state) return;
+    
+    for (i=0;i<svr->nrov;i++) {
+        for (j=0;j<MAXROVOBSQ;j++) free(svr->rov[i].obsq[j].data);
+        rtkfree(&svr->rov[i].rtk);
+    }
+    free(svr->rov);
+    svr->rov=NULL;
+    svr->nrov=0;
+}
+/* pin/unpin navigation data snapshot ------------------------------------------
+* pin current navigation data snapshot of rtk server without svr->lock. the
+* snapshot is immutable and stays valid until unpinned
+* args   : rtksvr_t *svr    IO rtk server
+*          int    *pin      O  pin slot (passed to rtksvrunpinnav())
+* return : navigation data snapshot (NULL: no snapshot)
+* notes  : pin a snapshot for a processing epoch or a monitor update only.
+*          pinned snapshots delay reclaiming of retired snapshots.
+*          a pinned snapshot may be older than svr->nav by updates of the
+*          current decode pass.
+*-----------------------------------------------------------------------------*/
+extern const nav_t *rtksvrpinnav(rtksvr_t *svr, int *pin)
+{
+    navsnap_t *snap;
+    uint32_t ver;
+    int i;
+    
+    for (;;) {
+        if (!(ver=LOAD_SC(&svr->navver))) return NULL;
+        
+        for (i=0;i<MAXNAVPIN;i++) {
+            if (!LOAD_SC(svr->navpin+i)&&CAS_SC(svr->navpin+i,0,ver)) break;
+        }
+        if (i<MAXNAVPIN) break;
+        sleepms(1); /* wait for free pin slot */
+    }
+    /* snapshot not older than pinned version */
+    snap=(navsnap_t *)LOAD_SC(&svr->navsnap);
+    *pin=i;
+    return &snap->nav;
+}
+extern void rtksvrunpinnav(rtksvr_t *svr, int pin)
+{
+    if (pin<0||pin>=MAXNAVPIN) return;
+    STORE_SC(svr->navpin+pin,0);
+}
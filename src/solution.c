@@ -53,6 +53,10 @@
 *                            add reading age information in NMEA GGA
 *                            use integer types in stdint.h
 *                            suppress warnings
+*           2026/10/16  1.19 add binary solution status format
+*                            add api outsolstatrec(),outsolstathb(),
+*                            convsolstat()
+*                            support binary solution status in readsolstatt()
 *-----------------------------------------------------------------------------*/
 #include <ctype.h>
 #include "rtklib.h"
@@ -86,6 +90,11 @@
 
 #define KNOT2M     0.514444444  /* m/sec --> knot */
 
+#define SSTB_MAGIC "RTKSTATB"   /* binary solution status: magic */
+#define SSTB_VER   1            /* binary solution status: format version */
+#define SSTB_HLEN  12           /* binary solution status: header length */
+#define SSTB_MAXV  4E18         /* binary solution status: max scaled value */
+
 static const int nmea_sys[]={ /* NMEA systems */
     SYS_GPS|SYS_SBS,SYS_GLO,SYS_GAL,SYS_CMP,SYS_QZS,SYS_IRN,0
 };
@@ -108,6 +117,23 @@ static const int nmea_solq[]={  /* NMEA GPS quality indicator [1] */
     SOLQ_NONE ,SOLQ_SINGLE, SOLQ_DGPS, SOLQ_PPP , SOLQ_FIX,
     SOLQ_FLOAT,SOLQ_DR    , SOLQ_NONE, SOLQ_NONE, SOLQ_NONE
 };
+static const struct {   /* solution status records (SSTAT_???) */
+    const char *id;     /* record id */
+    const char *fld;    /* fields after time ('s':satellite,'0'-'9':digits */
+} sstat_rec[]={         /* under decimal point, last one is repeated) */
+    {""       ,"03"               }, /* epoch: week,tow */
+    {"$POS"   ,"0444444"          }, /* stat,x,y,z,xa,ya,za */
+    {"$VELACC","0444555444555"    }, /* stat,vel,acc,vela,acca */
+    {"$CLK"   ,"003"              }, /* stat,rcv,clk... */
+    {"$ION"   ,"0s1144"           }, /* stat,sat,az,el,ion,iona */
+    {"$TROP"  ,"0044"             }, /* stat,rcv,ztd,ztda */
+    {"$TRPG"  ,"005555"           }, /* stat,rcv,grad,std */
+    {"$HWBIAS","0044"             }, /* stat,frq,bias,biasa */
+    {"$SAT"   ,"s0114400000000265"}, /* sat,frq,az,el,resp,resc,vsat,snr,fix,
+                                        slip,lock,outc,slipc,rejc,amb,var,
+                                        icbias */
+    {"$AMB"   ,"0s044"            }  /* stat,sat,frq,amb,std */
+};
 /* solution option to field separator ----------------------------------------*/
 static const char *opt2sep(const solopt_t *opt)
 {
@@ -1133,6 +1159,213 @@ static void addsolstat(solstatbuf_t *statbuf, const solstat_t *stat)
     }
     statbuf->data[statbuf->n++]=*stat;
 }
+/* field type of solution status record --------------------------------------*/
+static int sstatfld(int type, int i)
+{
+    const char *fld=sstat_rec[type].fld;
+    int n=(int)strlen(fld);
+    return fld[i<n?i:n-1];
+}
+/* set/get unsigned LEB128 variable-length integer ---------------------------*/
+static uint8_t *setvarint(uint8_t *p, uint64_t u)
+{
+    for (;u>=0x80;u>>=7) *p++=(uint8_t)(u|0x80);
+    *p++=(uint8_t)u;
+    return p;
+}
+static const uint8_t *getvarint(const uint8_t *p, const uint8_t *q, uint64_t *u)
+{
+    int i;
+    
+    for (*u=0,i=0;p<q&&i<64;i+=7) {
+        *u|=(uint64_t)(*p&0x7F)<<i;
+        if (!(*p++&0x80)) return p;
+    }
+    return NULL;
+}
+/* set/get value scaled to digits under decimal point --------------------------
+* value is encoded as (|round(val*10^dig)|<<2)+(sign<<1)+nonfinite so that
+* output with "%.*f" is reproduced including negative zero, nan and inf
+*-----------------------------------------------------------------------------*/
+static uint8_t *setsval(uint8_t *p, double val, int dig)
+{
+    static const double pw[]={1E0,1E1,1E2,1E3,1E4,1E5,1E6,1E7,1E8,1E9};
+    double a=fabs(rint(val*pw[dig]));
+    uint64_t u;
+    
+    if (val!=val) u=1;
+    else if (!(a<SSTB_MAXV)) u=5;
+    else u=(uint64_t)a<<2;
+    if (signbit(val)) u|=2;
+    return setvarint(p,u);
+}
+static double getsval(uint64_t u, int dig)
+{
+    static const double pw[]={1E0,1E1,1E2,1E3,1E4,1E5,1E6,1E7,1E8,1E9};
+    double val;
+    
+    if (u&1) val=(u>>2)?INFINITY:NAN;
+    else val=(double)(u>>2)/pw[dig];
+    return (u&2)?-val:val;
+}
+/* output solution status record -----------------------------------------------
+* output solution status record as text or binary
+* args   : uint8_t *buff    O   output buffer
+*          int    fmt       I   format (SSTATF_TEXT:text,SSTATF_BIN:binary)
+*          int    type      I   record type (SSTAT_???)
+*          int    week      I   gps week
+*          double tow       I   time of week (s)
+*          double *val      I   field values (satellite number for 's' field)
+*          int    n         I   number of field values
+* return : number of output bytes
+* notes  : binary record consists of type (1 byte), number of fields (1 byte),
+*          payload length (2 bytes little-endian) and fields in LEB128. record
+*          SSTAT_EPOCH sets time of following records and has no text output.
+*-----------------------------------------------------------------------------*/
+extern int outsolstatrec(uint8_t *buff, int fmt, int type, int week, double tow,
+                         const double *val, int n)
+{
+    uint8_t *p=buff+4;
+    char *q=(char *)buff,id[8];
+    double ep[2];
+    int i,c,len;
+    
+    if (type<0||type>=(int)(sizeof(sstat_rec)/sizeof(*sstat_rec))||n>255) {
+        return 0;
+    }
+    if (fmt==SSTATF_BIN) {
+        if (type==SSTAT_EPOCH) {
+            ep[0]=week; ep[1]=tow; val=ep; n=2;
+        }
+        for (i=0;i<n;i++) {
+            if ((c=sstatfld(type,i))=='s') p=setvarint(p,(uint64_t)val[i]);
+            else p=setsval(p,val[i],c-'0');
+        }
+        len=(int)(p-buff-4);
+        buff[0]=(uint8_t)type;
+        buff[1]=(uint8_t)n;
+        buff[2]=(uint8_t)(len&0xFF);
+        buff[3]=(uint8_t)(len>>8);
+        return (int)(p-buff);
+    }
+    if (type==SSTAT_EPOCH) return 0;
+    
+    q+=sprintf(q,"%s,%d,%.3f",sstat_rec[type].id,week,tow);
+    for (i=0;i<n;i++) {
+        if ((c=sstatfld(type,i))=='s') {
+            satno2id((int)val[i],id);
+            q+=sprintf(q,",%s",id);
+        }
+        else q+=sprintf(q,",%.*f",c-'0',val[i]);
+    }
+    q+=sprintf(q,"\n");
+    return (int)(q-(char *)buff);
+}
+/* output binary solution status header ----------------------------------------
+* output header of binary solution status file
+* args   : uint8_t *buff    O   output buffer
+* return : number of output bytes
+*-----------------------------------------------------------------------------*/
+extern int outsolstathb(uint8_t *buff)
+{
+    memcpy(buff,SSTB_MAGIC,8);
+    buff[8]=(uint8_t)(SSTB_VER&0xFF);
+    buff[9]=(uint8_t)(SSTB_VER>>8);
+    buff[10]=buff[11]=0;
+    return SSTB_HLEN;
+}
+/* test binary solution status header ----------------------------------------*/
+static int test_solstatb(FILE *fp)
+{
+    uint8_t buff[SSTB_HLEN];
+    
+    if (fread(buff,SSTB_HLEN,1,fp)==1&&!memcmp(buff,SSTB_MAGIC,8)) {
+        if (buff[8]+(buff[9]<<8)>SSTB_VER) {
+            trace(2,"unsupported binary solution status version\n");
+            return -1;
+        }
+        return 1;
+    }
+    rewind(fp);
+    return 0;
+}
+/* read binary solution status record ------------------------------------------
+* read binary solution status record
+* args   : FILE   *fp       I   file pointer
+*          int    *week,*tow IO time of record (updated by SSTAT_EPOCH)
+*          double *val      O   field values
+*          int    *n        O   number of field values
+* return : record type (-1:end of file,-2:format error)
+*-----------------------------------------------------------------------------*/
+static int readsolstatb(FILE *fp, int *week, double *tow, double *val, int *n)
+{
+    uint8_t buff[65536];
+    const uint8_t *p=buff+4,*q;
+    uint64_t u;
+    int i,c,type,len;
+    
+    if (fread(buff,4,1,fp)<1) return -1;
+    type=buff[0];
+    *n=buff[1];
+    len=buff[2]+(buff[3]<<8);
+    if (len>0&&fread(buff+4,len,1,fp)<1) return -2;
+    q=buff+4+len;
+    
+    /* skip unknown record type */
+    if (type>=(int)(sizeof(sstat_rec)/sizeof(*sstat_rec))) {
+        *n=0;
+        return type;
+    }
+    for (i=0;i<*n;i++) {
+        if (!(p=getvarint(p,q,&u))) return -2;
+        c=sstatfld(type,i);
+        val[i]=c=='s'?(double)u:getsval(u,c-'0');
+    }
+    if (type==SSTAT_EPOCH) {
+        if (*n<2) return -2;
+        *week=(int)val[0];
+        *tow=val[1];
+    }
+    return type;
+}
+/* read binary solution status data ------------------------------------------*/
+static int readsolstatdatab(FILE *fp, gtime_t ts, gtime_t te, double tint,
+                            solstatbuf_t *statbuf)
+{
+    static const solstat_t stat0={{0}};
+    solstat_t stat;
+    double tow=0.0,v[256];
+    int type,week=0,n;
+    
+    trace(3,"readsolstatdatab:\n");
+    
+    while ((type=readsolstatb(fp,&week,&tow,v,&n))>=0) {
+        
+        if (type!=SSTAT_SAT||n<14||v[0]<=0.0||v[0]>MAXSAT) continue;
+        
+        stat=stat0;
+        stat.time=gpst2time(week,tow);
+        stat.sat  =(uint8_t)v[0];
+        stat.frq  =(uint8_t)v[1];
+        stat.az   =(float)(v[2]*D2R);
+        stat.el   =(float)(v[3]*D2R);
+        stat.resp =(float)v[4];
+        stat.resc =(float)v[5];
+        stat.flag =(uint8_t)(((int)v[6]<<5)+((int)v[9]<<3)+(int)v[8]);
+        stat.snr  =(float)v[7];
+        stat.lock =(uint16_t)(int64_t)v[10];
+        stat.outc =(uint16_t)(int64_t)v[11];
+        stat.slipc=(uint16_t)(int64_t)v[12];
+        stat.rejc =(uint16_t)(int64_t)v[13];
+        
+        /* add solution to solution buffer */
+        if (screent(stat.time,ts,te,tint)) {
+            addsolstat(statbuf,&stat);
+        }
+    }
+    if (type==-2) trace(2,"binary solution status format error\n");
+    return statbuf->n>0;
+}
 /* read solution status data -------------------------------------------------*/
 static int readsolstatdata(FILE *fp, gtime_t ts, gtime_t te, double tint,
                            solstatbuf_t *statbuf)
@@ -1169,7 +1402,7 @@ extern int readsolstatt(const char *files[], int nfile, gtime_t ts, gtime_t te,
 {
     FILE *fp;
     char path[1024],*p;
-    int i;
+    int i,stat;
     
     trace(3,"readsolstatt: nfile=%d\n",nfile);
     
@@ -1183,12 +1416,14 @@ extern int readsolstatt(const char *files[], int nfile, gtime_t ts, gtime_t te,
         else {
         sprintf(path,"%s.stat",files[i]);
         }
-        if (!(fp=fopen(path,"r"))) {
+        if (!(fp=fopen(path,"rb"))) {
             trace(2,"readsolstatt: file open error %s\n",path);
             continue;
         }
-        /* read solution status data */
-        if (!readsolstatdata(fp,ts,te,tint,statbuf)) {
+        /* read solution status data (text or binary) */
+        if ((stat=test_solstatb(fp))<0||
+            !(stat?readsolstatdatab(fp,ts,te,tint,statbuf):
+                   readsolstatdata(fp,ts,te,tint,statbuf))) {
             trace(2,"readsolstatt: no solution in %s\n",path);
         }
         fclose(fp);
@@ -1203,6 +1438,54 @@ extern int readsolstat(const char *files[], int nfile, solstatbuf_t *statbuf)
     
     return readsolstatt(files,nfile,time,time,0.0,statbuf);
 }
+/* convert binary solution status to text --------------------------------------
+* convert binary solution status file to text solution status file
+* args   : char   *infile   I   input binary solution status file
+*          char   *outfile  I   output text file ("": infile + ".txt")
+* return : status (0:ok,-1:file read,-2:file format,-3:no data,-4:file write)
+*-----------------------------------------------------------------------------*/
+extern int convsolstat(const char *infile, const char *outfile)
+{
+    FILE *ifp,*ofp;
+    uint8_t buff[MAXSOLMSG+1];
+    double tow=0.0,v[256];
+    char file[1024];
+    int type,week=0,n,nrec=0;
+    
+    trace(3,"convsolstat: infile=%s outfile=%s\n",infile,outfile);
+    
+    if (!*outfile) {
+        sprintf(file,"%.1019s.txt",infile);
+        outfile=file;
+    }
+    if (!(ifp=fopen(infile,"rb"))) {
+        trace(2,"convsolstat: file open error %s\n",infile);
+        return -1;
+    }
+    if (test_solstatb(ifp)<=0) {
+        fclose(ifp);
+        return -2;
+    }
+    if (!(ofp=fopen(outfile,"wb"))) {
+        trace(2,"convsolstat: file open error %s\n",outfile);
+        fclose(ifp);
+        return -4;
+    }
+    while ((type=readsolstatb(ifp,&week,&tow,v,&n))>=0) {
+        if (type==SSTAT_EPOCH||
+            type>=(int)(sizeof(sstat_rec)/sizeof(*sstat_rec))) continue;
+        n=outsolstatrec(buff,SSTATF_TEXT,type,week,tow,v,n);
+        if (fwrite(buff,n,1,ofp)<1) {
+            fclose(ifp); fclose(ofp);
+            return -4;
+        }
+        nrec++;
+    }
+    fclose(ifp);
+    fclose(ofp);
+    if (type==-2) return -2;
+    return nrec>0?0:-3;
+}
 /* output solution as the form of x/y/z-ecef ---------------------------------*/
 static int outecef(uint8_t *buff, const char *s, const sol_t *sol,
                    const solopt_t *opt)
@@ -5,6 +5,8 @@
 *
 * options : -DWIN32    use WIN32 API
 *           -DSVR_REUSEADDR reuse tcp server address
+*           -DSTR_NOEPOLL disable epoll backend of tcp server/ntrip caster
+*                      (linux)
 *
 * references :
 *     [1] RTCM Recommendaed Standards for Networked Transport for RTCM via
@@ -74,6 +76,12 @@
 *                           accept HTTP/1.1 as protocol for NTRIP caster
 *                           suppress warning for buffer overflow by sprintf()
 *                           use integer types in stdint.h
+*           2026/10/16 1.30 add epoll backend for tcp server and ntrip caster
+*                           (linux) with per-client output queues
+*                           expand tcp server clients up to MAXCLI_EP
+*                           add api strwait()
+*                           reject connection with spare descriptor if no
+*                            descriptor is left
 *-----------------------------------------------------------------------------*/
 #define _POSIX_C_SOURCE 199506
 #include <ctype.h>
@@ -94,6 +102,11 @@
 #include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <netdb.h>
+#include <poll.h>
+#if defined(__linux__)&&!defined(STR_NOEPOLL)
+#define STR_EPOLL
+#include <sys/epoll.h>
+#endif
 #endif
 
 /* constants -----------------------------------------------------------------*/
@@ -102,6 +115,11 @@
 #define SERIBUFFSIZE        4096        /* serial buffer size (bytes) */
 #define TIMETAGH_LEN        64          /* time tag file header length */
 #define MAXCLI              32          /* max client connection for tcp svr */
+#define MAXCLI_EP           8192        /* max client connection for tcp svr (epoll) */
+#define MAXEPEV             256         /* max events per epoll wait */
+#define EPEV_SVR            0xFFFFFFFFu /* epoll event data for server socket */
+#define MAXWAITSTR          32          /* max streams to wait in strwait() */
+#define TISVRWAIT           1000        /* wait to accept without descriptor (ms) */
 #define MAXSTATMSG          32          /* max length of status message */
 #define DEFAULT_MEMBUF_SIZE 4096        /* default memory buffer size (bytes) */
 
@@ -172,11 +190,21 @@ typedef struct {            /* tcp control type */
     int tcon;               /* reconnect time (ms) (-1:never,0:now) */
     uint32_t tact;          /* data active tick */
     uint32_t tdis;          /* disconnect tick */
+    uint8_t *oq;            /* output queue (tcp server client with epoll) */
+    int oqsize;             /* output queue size (bytes) */
+    int oqr,oqn;            /* output queue read pointer/queued bytes */
+    int oqpeak;             /* output queue peak depth (bytes) */
 } tcp_t;
 
 typedef struct tcpsvr_tag { /* tcp server type */
     tcp_t svr;              /* tcp server control */
-    tcp_t cli[MAXCLI];      /* tcp client controls */
+    tcp_t *cli;             /* tcp client controls */
+    int ncli,nmax;          /* number of client slots/max clients */
+    int icli,nrdy;          /* next/number of ready clients */
+    int rdy[MAXEPEV];       /* ready client indexes (epoll) */
+    int epfd;               /* epoll descriptor (-1:none) */
+    int spare;              /* spare descriptor to reject connection (-1:none) */
+    uint32_t toff;          /* tick server socket removed from epoll (0:no) */
 } tcpsvr_t;
 
 typedef struct {            /* tcp cilent type */
@@ -216,7 +244,7 @@ typedef struct {            /* ntrip client/server connection type */
     char mntpnt[256];       /* mountpoint */
     char str[NTRIP_MAXSTR]; /* mountpoint string for server */
     int nb;                 /* request buffer size */
-    uint8_t buff[NTRIP_MAXRSP]; /* request buffer */
+    uint8_t *buff;          /* request buffer (NTRIP_MAXRSP bytes) */
 } ntripc_con_t;
 
 typedef struct {            /* ntrip caster control type */
@@ -227,7 +255,8 @@ typedef struct {            /* ntrip caster control type */
     char passwd[256];       /* password */
     char srctbl[NTRIP_MAXSTR]; /* source table */
     tcpsvr_t *tcp;          /* tcp server */
-    ntripc_con_t con[MAXCLI]; /* ntrip client/server connections */
+    ntripc_con_t *con;      /* ntrip client/server connections */
+    int ncon;               /* number of connections */
 } ntripc_t;
 
 typedef struct {            /* udp type */
@@ -1040,6 +1069,7 @@ static int setsock(socket_t sock, char *msg)
     }
     return 1;
 }
+#ifndef STR_EPOLL
 /* non-block accept ----------------------------------------------------------*/
 static socket_t accept_nb(socket_t sock, struct sockaddr *addr, socklen_t *len, int *err)
 {
@@ -1063,6 +1093,7 @@ static socket_t accept_nb(socket_t sock, struct sockaddr *addr, socklen_t *len,
     *err = 0;
     return nsock;
 }
+#endif
 /* non-block connect ---------------------------------------------------------*/
 static int connect_nb(socket_t sock, struct sockaddr *addr, socklen_t len, int *err)
 {
@@ -1195,7 +1226,11 @@ static int gentcp(tcp_t *tcp, int type, char *msg)
             tcp->state=-1;
             return 0;
         }
+#ifdef STR_EPOLL
+        listen(tcp->sock,SOMAXCONN);
+#else
         listen(tcp->sock,5);
+#endif
     }
     else { /* client socket */
         if (!(hp=gethostbyname(tcp->saddr))) {
@@ -1224,17 +1259,132 @@ static void discontcp(tcp_t *tcp, int tcon)
     tcp->state=0;
     tcp->tcon=tcon;
     tcp->tdis=tickget();
+    free(tcp->oq);
+    tcp->oq=NULL;
+    tcp->oqsize=tcp->oqr=tcp->oqn=0;
+}
+#ifdef STR_EPOLL
+/* set non-blocking socket ---------------------------------------------------*/
+static int setnonblock(socket_t sock)
+{
+    int flag=fcntl(sock,F_GETFL,0);
+    
+    return flag!=-1&&fcntl(sock,F_SETFL,flag|O_NONBLOCK)!=-1;
+}
+/* set epoll events of tcp server client -------------------------------------*/
+static void setevcli(tcpsvr_t *tcpsvr, int i, int op)
+{
+    struct epoll_event ev={0};
+    tcp_t *cli=tcpsvr->cli+i;
+    
+    ev.events=EPOLLIN|(cli->oqn>0?EPOLLOUT:0);
+    ev.data.u32=(uint32_t)i;
+    if (epoll_ctl(tcpsvr->epfd,op,cli->sock,&ev)==-1) {
+        tracet(2,"setevcli: epoll_ctl error sock=%d err=%d\n",cli->sock,errsock());
+    }
+}
+/* test no data or interrupted socket error ----------------------------------*/
+static int is_again(int err)
+{
+    return err==EAGAIN||err==EWOULDBLOCK||err==EINTR;
+}
+/* flush output queue of tcp server client -----------------------------------*/
+static int flushcli(tcpsvr_t *tcpsvr, int i, int *err)
+{
+    tcp_t *cli=tcpsvr->cli+i;
+    int n,ns,nq=cli->oqn;
+    
+    *err=0;
+    while (cli->oqn>0) {
+        n=MIN(cli->oqn,cli->oqsize-cli->oqr);
+        if ((ns=send(cli->sock,(char *)cli->oq+cli->oqr,n,0))<0) {
+            if (is_again(errsock())) break;
+            *err=errsock();
+            return -1;
+        }
+        cli->oqr=(cli->oqr+ns)%cli->oqsize;
+        cli->oqn-=ns;
+    }
+    if (nq>0&&cli->oqn<=0) setevcli(tcpsvr,i,EPOLL_CTL_MOD);
+    return cli->oqn;
+}
+#endif
+/* receive from tcp server client --------------------------------------------*/
+static int recvcli(tcpsvr_t *tcpsvr, int i, uint8_t *buff, int n, int *err)
+{
+#ifdef STR_EPOLL
+    int nr;
+    
+    *err=0;
+    if ((nr=recv(tcpsvr->cli[i].sock,(char *)buff,n,0))>0) return nr;
+    if (nr==0) return -1;
+    if (is_again(errsock())) return 0;
+    *err=errsock();
+    return -1;
+#else
+    return recv_nb(tcpsvr->cli[i].sock,buff,n,err);
+#endif
+}
+/* send to tcp server client -------------------------------------------------*/
+static int sendcli(tcpsvr_t *tcpsvr, int i, uint8_t *buff, int n, int *err)
+{
+#ifdef STR_EPOLL
+    tcp_t *cli=tcpsvr->cli+i;
+    int j,m,wp,ns=0,nq;
+    
+    /* send directly if output queue empty */
+    if (cli->oqn>0&&flushcli(tcpsvr,i,err)<0) return -1;
+    *err=0;
+    if (cli->oqn<=0) {
+        if ((ns=send(cli->sock,(char *)buff,n,0))<0) {
+            if (!is_again(errsock())) {
+                *err=errsock();
+                return -1;
+            }
+            ns=0;
+        }
+        if (ns>=n) return n;
+    }
+    /* queue remaining data */
+    if (!cli->oq) {
+        if (!(cli->oq=(uint8_t *)malloc(buffsize))) return -1;
+        cli->oqsize=buffsize;
+        cli->oqr=cli->oqn=0;
+    }
+    if (cli->oqn+n-ns>cli->oqsize) {
+        tracet(2,"sendcli: output queue overflow sock=%d n=%d\n",cli->sock,
+               cli->oqn+n-ns);
+        return -1;
+    }
+    for (j=ns,nq=cli->oqn;j<n;j+=m) {
+        wp=(cli->oqr+cli->oqn)%cli->oqsize;
+        m=MIN(n-j,cli->oqsize-wp);
+        memcpy(cli->oq+wp,buff+j,m);
+        cli->oqn+=m;
+    }
+    if (cli->oqn>cli->oqpeak) cli->oqpeak=cli->oqn;
+    if (nq<=0) setevcli(tcpsvr,i,EPOLL_CTL_MOD);
+    return n;
+#else
+    return send_nb(tcpsvr->cli[i].sock,buff,n,err);
+#endif
 }
 /* open tcp server -----------------------------------------------------------*/
 static tcpsvr_t *opentcpsvr(const char *path, char *msg)
 {
     tcpsvr_t *tcpsvr,tcpsvr0={{0}};
     char port[256]="";
+#ifdef STR_EPOLL
+    struct epoll_event ev={0};
+#endif
     
     tracet(3,"opentcpsvr: path=%s\n",path);
     
     if (!(tcpsvr=(tcpsvr_t *)malloc(sizeof(tcpsvr_t)))) return NULL;
     *tcpsvr=tcpsvr0;
+    tcpsvr->cli=NULL;
+    tcpsvr->nmax=MAXCLI;
+    tcpsvr->epfd=tcpsvr->spare=-1;
     decodetcppath(path,tcpsvr->svr.saddr,port,NULL,NULL,NULL,NULL);
     if (sscanf(port,"%d",&tcpsvr->svr.port)<1) {
         sprintf(msg,"port error: %s",port);
@@ -1246,6 +1396,23 @@ static tcpsvr_t *opentcpsvr(const char *path, char *msg)
         free(tcpsvr);
         return NULL;
     }
+#ifdef STR_EPOLL
+    ev.events=EPOLLIN;
+    ev.data.u32=EPEV_SVR;
+    if (!setnonblock(tcpsvr->svr.sock)||
+        (tcpsvr->epfd=epoll_create1(0))==-1||
+        epoll_ctl(tcpsvr->epfd,EPOLL_CTL_ADD,tcpsvr->svr.sock,&ev)==-1) {
+        sprintf(msg,"epoll error (%d)",errsock());
+        tracet(1,"opentcpsvr: epoll error sock=%d err=%d\n",tcpsvr->svr.sock,
+               errsock());
+        if (tcpsvr->epfd!=-1) close(tcpsvr->epfd);
+        closesocket(tcpsvr->svr.sock);
+        free(tcpsvr);
+        return NULL;
+    }
+    tcpsvr->nmax=MAXCLI_EP;
+    tcpsvr->spare=open("/dev/null",O_RDONLY);
+#endif
     tcpsvr->svr.tcon=0;
     return tcpsvr;
 }
@@ -1256,10 +1423,16 @@ static void closetcpsvr(tcpsvr_t *tcpsvr)
     
     tracet(3,"closetcpsvr:\n");
     
-    for (i=0;i<MAXCLI;i++) {
+    for (i=0;i<tcpsvr->ncli;i++) {
         if (tcpsvr->cli[i].state) closesocket(tcpsvr->cli[i].sock);
+        free(tcpsvr->cli[i].oq);
     }
     closesocket(tcpsvr->svr.sock);
+#ifdef STR_EPOLL
+    if (tcpsvr->epfd!=-1) close(tcpsvr->epfd);
+    if (tcpsvr->spare!=-1) close(tcpsvr->spare);
+#endif
+    free(tcpsvr->cli);
     free(tcpsvr);
 }
 /* update tcp server ---------------------------------------------------------*/
@@ -1272,7 +1445,7 @@ static void updatetcpsvr(tcpsvr_t *tcpsvr, char *msg)
     
     if (tcpsvr->svr.state==0) return;
     
-    for (i=0;i<MAXCLI;i++) {
+    for (i=0;i<tcpsvr->ncli;i++) {
         if (!tcpsvr->cli[i].state) continue;
         strcpy(saddr,tcpsvr->cli[i].saddr);
         n++;
@@ -1285,6 +1458,57 @@ static void updatetcpsvr(tcpsvr_t *tcpsvr, char *msg)
     tcpsvr->svr.state=2;
     if (n==1) sprintf(msg,"%s",saddr); else sprintf(msg,"%d clients",n);
 }
+/* get free client slot of tcp server ----------------------------------------*/
+static int newcli(tcpsvr_t *tcpsvr)
+{
+    tcp_t *cli,cli0={0};
+    int i,n;
+    
+    for (i=0;i<tcpsvr->ncli;i++) {
+        if (tcpsvr->cli[i].state==0) return i;
+    }
+    if (tcpsvr->ncli>=tcpsvr->nmax) return -1;
+    n=tcpsvr->ncli<=0?MIN(MAXCLI,tcpsvr->nmax):MIN(tcpsvr->ncli*2,tcpsvr->nmax);
+    if (!(cli=(tcp_t *)realloc(tcpsvr->cli,sizeof(tcp_t)*n))) return -1;
+    for (i=tcpsvr->ncli;i<n;i++) cli[i]=cli0;
+    tcpsvr->cli=cli;
+    i=tcpsvr->ncli;
+    tcpsvr->ncli=n;
+    return i;
+}
+#ifdef STR_EPOLL
+/* reject connection to tcp server ---------------------------------------------
+* accept and close a pending connection to clear readiness of server socket.
+* if no descriptor is left, the spare descriptor is closed to accept it. if
+* the spare is not available, the server socket is removed from epoll and
+* added again after TISVRWAIT ms by pollsvr().
+*-----------------------------------------------------------------------------*/
+static void rejectcli(tcpsvr_t *tcpsvr)
+{
+    struct epoll_event ev={0};
+    socket_t sock;
+    int err;
+    
+    if ((sock=accept(tcpsvr->svr.sock,NULL,NULL))!=(socket_t)-1) {
+        closesocket(sock);
+        return;
+    }
+    err=errsock();
+    if (err!=EMFILE&&err!=ENFILE) return;
+    
+    if (tcpsvr->spare==-1) tcpsvr->spare=open("/dev/null",O_RDONLY);
+    if (tcpsvr->spare!=-1) {
+        close(tcpsvr->spare);
+        sock=accept(tcpsvr->svr.sock,NULL,NULL);
+        if (sock!=(socket_t)-1) closesocket(sock);
+        tcpsvr->spare=open("/dev/null",O_RDONLY);
+        if (sock!=(socket_t)-1) return;
+    }
+    tracet(2,"rejectcli: no descriptor sock=%d err=%d\n",tcpsvr->svr.sock,err);
+    epoll_ctl(tcpsvr->epfd,EPOLL_CTL_DEL,tcpsvr->svr.sock,&ev);
+    tcpsvr->toff=tickget()|1;
+}
+#endif
 /* accept client connection --------------------------------------------------*/
 static int accsock(tcpsvr_t *tcpsvr, char *msg)
 {
@@ -1295,14 +1519,27 @@ static int accsock(tcpsvr_t *tcpsvr, char *msg)
     
     tracet(4,"accsock: sock=%d\n",tcpsvr->svr.sock);
     
-    for (i=0;i<MAXCLI;i++) {
-        if (tcpsvr->cli[i].state==0) break;
-    }
-    if (i>=MAXCLI) {
+    if ((i=newcli(tcpsvr))<0) {
+#ifdef STR_EPOLL
+        rejectcli(tcpsvr);
+#endif
         tracet(2,"accsock: too many clients sock=%d\n",tcpsvr->svr.sock);
         return 0;
     }
-    if ((sock=accept_nb(tcpsvr->svr.sock,(struct sockaddr *)&addr,&len,&err))==(socket_t)-1) {
+#ifdef STR_EPOLL
+    if ((sock=accept(tcpsvr->svr.sock,(struct sockaddr *)&addr,&len))==(socket_t)-1) {
+        err=errsock();
+        if (is_again(err)||err==ECONNABORTED) return 0;
+        if (err==EMFILE||err==ENFILE) { /* no descriptors */
+            tracet(2,"accsock: accept error sock=%d err=%d\n",tcpsvr->svr.sock,err);
+            rejectcli(tcpsvr);
+            return 0;
+        }
+    }
+#else
+    sock=accept_nb(tcpsvr->svr.sock,(struct sockaddr *)&addr,&len,&err);
+#endif
+    if (sock==(socket_t)-1) {
         sprintf(msg,"accept error (%d)",err);
         tracet(1,"accsock: accept error sock=%d err=%d\n",tcpsvr->svr.sock,err);
         closesocket(tcpsvr->svr.sock);
@@ -1311,7 +1548,13 @@ static int accsock(tcpsvr_t *tcpsvr, char *msg)
     }
     if (sock==0) return 0;
     if (!setsock(sock,msg)) return 0;
-    
+#ifdef STR_EPOLL
+    if (!setnonblock(sock)) {
+        tracet(2,"accsock: non-block error sock=%d err=%d\n",sock,errsock());
+        closesocket(sock);
+        return 0;
+    }
+#endif
     tcpsvr->cli[i].sock=sock;
     memcpy(&tcpsvr->cli[i].addr,&addr,sizeof(addr));
     strcpy(tcpsvr->cli[i].saddr,inet_ntoa(addr.sin_addr));
@@ -1320,8 +1563,81 @@ static int accsock(tcpsvr_t *tcpsvr, char *msg)
            tcpsvr->cli[i].sock,tcpsvr->cli[i].saddr,i);
     tcpsvr->cli[i].state=2;
     tcpsvr->cli[i].tact=tickget();
+    tcpsvr->cli[i].oqpeak=0;
+#ifdef STR_EPOLL
+    setevcli(tcpsvr,i,EPOLL_CTL_ADD);
+#endif
     return 1;
 }
+/* poll tcp server -------------------------------------------------------------
+* accept connections, flush output queues and collect clients ready to read.
+* with epoll, only the clients with events are collected. without, all of the
+* connected clients are collected and read by non-block receive.
+*-----------------------------------------------------------------------------*/
+static void pollsvr(tcpsvr_t *tcpsvr, char *msg)
+{
+#ifdef STR_EPOLL
+    struct epoll_event ev[MAXEPEV];
+    int i,j,n,err;
+    
+    tcpsvr->icli=tcpsvr->nrdy=0;
+    
+    /* add server socket to epoll again after no descriptor */
+    if (tcpsvr->toff&&(int)(tickget()-tcpsvr->toff)>=TISVRWAIT) {
+        ev[0].events=EPOLLIN;
+        ev[0].data.u32=EPEV_SVR;
+        if (epoll_ctl(tcpsvr->epfd,EPOLL_CTL_ADD,tcpsvr->svr.sock,ev)!=-1) {
+            tcpsvr->toff=0;
+        }
+    }
+    if ((n=epoll_wait(tcpsvr->epfd,ev,MAXEPEV,0))<0) {
+        if (!is_again(errsock())) {
+            tracet(2,"pollsvr: epoll_wait error epfd=%d err=%d\n",tcpsvr->epfd,
+                   errsock());
+        }
+        return;
+    }
+    for (j=0;j<n;j++) {
+        if (ev[j].data.u32==EPEV_SVR) {
+            while (accsock(tcpsvr,msg)) ;
+            continue;
+        }
+        i=(int)ev[j].data.u32;
+        if (i>=tcpsvr->ncli||tcpsvr->cli[i].state!=2) continue;
+        
+        /* errors are handled by the reader of the client */
+        if ((ev[j].events&EPOLLOUT)&&flushcli(tcpsvr,i,&err)<0) {
+            tracet(2,"pollsvr: send error sock=%d err=%d\n",
+                   tcpsvr->cli[i].sock,err);
+            ev[j].events|=EPOLLERR;
+        }
+        if (ev[j].events&(EPOLLIN|EPOLLHUP|EPOLLERR)) {
+            tcpsvr->rdy[tcpsvr->nrdy++]=i;
+        }
+    }
+#else
+    tcpsvr->icli=0;
+    while (accsock(tcpsvr,msg)) ;
+#endif
+}
+/* next client to read (-1: no client) ---------------------------------------*/
+static int nextcli(tcpsvr_t *tcpsvr)
+{
+    int i;
+    
+#ifdef STR_EPOLL
+    while (tcpsvr->icli<tcpsvr->nrdy) {
+        i=tcpsvr->rdy[tcpsvr->icli++];
+        if (tcpsvr->cli[i].state==2) return i;
+    }
+#else
+    while (tcpsvr->icli<tcpsvr->ncli) {
+        i=tcpsvr->icli++;
+        if (tcpsvr->cli[i].state==2) return i;
+    }
+#endif
+    return -1;
+}
 /* wait socket accept --------------------------------------------------------*/
 static int waittcpsvr(tcpsvr_t *tcpsvr, char *msg)
 {
@@ -1329,7 +1645,7 @@ static int waittcpsvr(tcpsvr_t *tcpsvr, char *msg)
     
     if (tcpsvr->svr.state<=0) return 0;
     
-    while (accsock(tcpsvr,msg)) ;
+    pollsvr(tcpsvr,msg);
     
     updatetcpsvr(tcpsvr,msg);
     return tcpsvr->svr.state==2;
@@ -1343,10 +1659,9 @@ static int readtcpsvr(tcpsvr_t *tcpsvr, uint8_t *buff, int n, char *msg)
     
     if (!waittcpsvr(tcpsvr,msg)) return 0;
     
-    for (i=0;i<MAXCLI;i++) {
-        if (tcpsvr->cli[i].state!=2) continue;
+    while ((i=nextcli(tcpsvr))>=0) {
         
-        if ((nr=recv_nb(tcpsvr->cli[i].sock,buff,n,&err))==-1) {
+        if ((nr=recvcli(tcpsvr,i,buff,n,&err))==-1) {
             if (err) {
                 tracet(2,"readtcpsvr: recv error sock=%d err=%d\n",
                        tcpsvr->cli[i].sock,err);
@@ -1370,10 +1685,10 @@ static int writetcpsvr(tcpsvr_t *tcpsvr, uint8_t *buff, int n, char *msg)
     
     if (!waittcpsvr(tcpsvr,msg)) return 0;
     
-    for (i=0;i<MAXCLI;i++) {
+    for (i=0;i<tcpsvr->ncli;i++) {
         if (tcpsvr->cli[i].state!=2) continue;
         
-        if ((ns=send_nb(tcpsvr->cli[i].sock,buff,n,&err))==-1) {
+        if ((ns=sendcli(tcpsvr,i,buff,n,&err))==-1) {
             if (err) {
                 tracet(2,"writetcpsvr: send error i=%d sock=%d err=%d\n",i,
                        tcpsvr->cli[i].sock,err);
@@ -1409,22 +1724,33 @@ static int statextcp(tcp_t *tcp, char *msg)
 #endif
     return (int)(p-msg);
 }
+/* print extended state tcp server client ------------------------------------*/
+static int statexcli(tcp_t *cli, char *msg)
+{
+    char *p=msg;
+    
+    p+=statextcp(cli,p);
+    p+=sprintf(p,"    qlen  = %d\n",cli->oqn);
+    p+=sprintf(p,"    qpeak = %d\n",cli->oqpeak);
+    return (int)(p-msg);
+}
 /* get extended state tcp server ---------------------------------------------*/
 static int statextcpsvr(tcpsvr_t *tcpsvr, char *msg)
 {
     char *p=msg;
-    int i,state=tcpsvr?tcpsvr->svr.state:0;
+    int i,n=0,state=tcpsvr?tcpsvr->svr.state:0;
     
     p+=sprintf(p,"tcpsvr:\n");
     p+=sprintf(p,"  state   = %d\n",state);
     if (!state) return 0;
     p+=sprintf(p,"  svr:\n");
     p+=statextcp(&tcpsvr->svr,p);
-    for (i=0;i<MAXCLI;i++) {
-        if (!tcpsvr->cli[i].state) continue;
+    for (i=0;i<tcpsvr->ncli;i++) {
+        if (!tcpsvr->cli[i].state||n++>=MAXCLI) continue;
         p+=sprintf(p,"  cli#%d:\n",i);
-        p+=statextcp(tcpsvr->cli+i,p);
+        p+=statexcli(tcpsvr->cli+i,p);
     }
+    if (n>MAXCLI) p+=sprintf(p,"  (%d more clients)\n",n-MAXCLI);
     return state;
 }
 /* connect server ------------------------------------------------------------*/
@@ -1875,7 +2201,6 @@ static int statexntrip(ntrip_t *ntrip, char *msg)
 static ntripc_t *openntripc(const char *path, char *msg)
 {
     ntripc_t *ntripc;
-    int i;
     char port[256]="",tpath[MAXSTRPATH];
     
     tracet(3,"openntripc: path=%s\n",path);
@@ -1884,11 +2209,8 @@ static ntripc_t *openntripc(const char *path, char *msg)
     
     ntripc->state=0;
     ntripc->mntpnt[0]=ntripc->user[0]=ntripc->passwd[0]=ntripc->srctbl[0]='\0';
-    for (i=0;i<MAXCLI;i++) {
-        ntripc->con[i].state=0;
-        ntripc->con[i].nb=0;
-        memset(ntripc->con[i].buff,0,NTRIP_MAXRSP);
-    }
+    ntripc->con=NULL;
+    ntripc->ncon=0;
     /* decode tcp/ntrip path */
     decodetcppath(path,NULL,port,ntripc->user,ntripc->passwd,ntripc->mntpnt,
                   ntripc->srctbl);
@@ -1915,9 +2237,13 @@ static ntripc_t *openntripc(const char *path, char *msg)
 /* close ntrip-caster --------------------------------------------------------*/
 static void closentripc(ntripc_t *ntripc)
 {
+    int i;
+    
     tracet(3,"closentripc: state=%d\n",ntripc->state);
     
     closetcpsvr(ntripc->tcp);
+    for (i=0;i<ntripc->ncon;i++) free(ntripc->con[i].buff);
+    free(ntripc->con);
     free(ntripc);
 }
 /* disconnect ntrip-caster connection ----------------------------------------*/
@@ -1927,11 +2253,31 @@ static void discon_ntripc(ntripc_t *ntripc, int i)
     
     discontcp(&ntripc->tcp->cli[i],ticonnect);
     ntripc->con[i].nb=0;
-    ntripc->con[i].buff[0]='\0';
+    free(ntripc->con[i].buff);
+    ntripc->con[i].buff=NULL;
     ntripc->con[i].state=0;
 }
+/* expand ntrip-caster connections to tcp server clients ---------------------*/
+static void expand_ntripc(ntripc_t *ntripc)
+{
+    ntripc_con_t *con,con0={0};
+    int i,n=ntripc->tcp->ncli;
+    
+    if (ntripc->ncon>=n) return;
+    
+    if (!(con=(ntripc_con_t *)realloc(ntripc->con,sizeof(ntripc_con_t)*n))) {
+        tracet(1,"expand_ntripc: memory allocation error n=%d\n",n);
+        for (i=ntripc->ncon;i<n;i++) {
+            if (ntripc->tcp->cli[i].state) discontcp(&ntripc->tcp->cli[i],ticonnect);
+        }
+        return;
+    }
+    for (i=ntripc->ncon;i<n;i++) con[i]=con0;
+    ntripc->con=con;
+    ntripc->ncon=n;
+}
 /* send ntrip source table ---------------------------------------------------*/
-static void send_srctbl(ntripc_t *ntripc, socket_t sock)
+static void send_srctbl(ntripc_t *ntripc, int i)
 {
     char srctbl[512+NTRIP_MAXSTR],buff[256],*p=buff;
 
@@ -1945,8 +2291,8 @@ static void send_srctbl(ntripc_t *ntripc, socket_t sock)
     p+=sprintf(p,"Content-Type: text/plain\r\n");
     p+=sprintf(p,"Content-Length: %d\r\n\r\n",(int)strlen(srctbl));
     int err;
-    send_nb(sock,(uint8_t *)buff,(int)(p-buff),&err);
-    send_nb(sock,(uint8_t *)srctbl,(int)strlen(srctbl),&err);
+    sendcli(ntripc->tcp,i,(uint8_t *)buff,(int)(p-buff),&err);
+    sendcli(ntripc->tcp,i,(uint8_t *)srctbl,(int)strlen(srctbl),&err);
 }
 /* test ntrip client request -------------------------------------------------*/
 static void rsp_ntripc(ntripc_t *ntripc, int i)
@@ -1985,7 +2331,7 @@ static void rsp_ntripc(ntripc_t *ntripc, int i)
         tracet(2,"rsp_ntripc_c: no mountpoint %s\n",mntpnt);
         
         /* send source table */
-        send_srctbl(ntripc,ntripc->tcp->cli[i].sock);
+        send_srctbl(ntripc,i);
         discon_ntripc(ntripc,i);
         return;
     }
@@ -2000,17 +2346,20 @@ static void rsp_ntripc(ntripc_t *ntripc, int i)
             strncmp(p,user_pwd,strlen(user_pwd))) {
             tracet(2,"rsp_ntripc_c: authroziation error\n");
             int err;
-            send_nb(ntripc->tcp->cli[i].sock,(uint8_t *)rsp1,strlen(rsp1),&err);
+            sendcli(ntripc->tcp,i,(uint8_t *)rsp1,strlen(rsp1),&err);
             discon_ntripc(ntripc,i);
             return;
         }
     }
     /* send OK response */
     int err;
-    send_nb(ntripc->tcp->cli[i].sock,(uint8_t *)rsp2,strlen(rsp2),&err);
+    sendcli(ntripc->tcp,i,(uint8_t *)rsp2,strlen(rsp2),&err);
     
     con->state=1;
     strcpy(con->mntpnt,mntpnt);
+    con->nb=0;
+    free(con->buff);
+    con->buff=NULL;
 }
 /* handle ntrip client connect request ---------------------------------------*/
 static void wait_ntripc(ntripc_t *ntripc, char *msg)
@@ -2024,14 +2373,21 @@ static void wait_ntripc(ntripc_t *ntripc, char *msg)
     
     if (!waittcpsvr(ntripc->tcp,msg)) return;
     
-    for (i=0;i<MAXCLI;i++) {
-        if (ntripc->tcp->cli[i].state!=2||ntripc->con[i].state) continue;
+    expand_ntripc(ntripc);
+    
+    while ((i=nextcli(ntripc->tcp))>=0) {
+        if (i>=ntripc->ncon||ntripc->con[i].state) continue;
         
+        if (!ntripc->con[i].buff&&
+            !(ntripc->con[i].buff=(uint8_t *)malloc(NTRIP_MAXRSP))) {
+            discon_ntripc(ntripc,i);
+            continue;
+        }
         /* receive ntrip client request */
         buff=ntripc->con[i].buff+ntripc->con[i].nb;
         nmax=NTRIP_MAXRSP-ntripc->con[i].nb-1;
         
-        if ((n=recv_nb(ntripc->tcp->cli[i].sock,buff,nmax,&err))==-1) {
+        if ((n=recvcli(ntripc->tcp,i,buff,nmax,&err))==-1) {
             if (err) {
                 tracet(2,"wait_ntripc: recv error sock=%d err=%d\n",
                        ntripc->tcp->cli[i].sock,err);
@@ -2045,6 +2401,7 @@ static void wait_ntripc(ntripc_t *ntripc, char *msg)
         ntripc->con[i].nb+=n;
         rsp_ntripc(ntripc,i);
     }
+    ntripc->tcp->icli=0; /* rewind ready clients */
 }
 /* read ntrip-caster ---------------------------------------------------------*/
 static int readntripc(ntripc_t *ntripc, uint8_t *buff, int n, char *msg)
@@ -2055,10 +2412,10 @@ static int readntripc(ntripc_t *ntripc, uint8_t *buff, int n, char *msg)
     
     wait_ntripc(ntripc,msg);
     
-    for (i=0;i<MAXCLI;i++) {
-        if (!ntripc->con[i].state) continue;
+    while ((i=nextcli(ntripc->tcp))>=0) {
+        if (i>=ntripc->ncon||!ntripc->con[i].state) continue;
         
-        nr=recv_nb(ntripc->tcp->cli[i].sock,buff,n,&err);
+        nr=recvcli(ntripc->tcp,i,buff,n,&err);
         
         if (nr<0) {
             if (err) {
@@ -2083,10 +2440,10 @@ static int writentripc(ntripc_t *ntripc, uint8_t *buff, int n, char *msg)
     
     wait_ntripc(ntripc,msg);
     
-    for (i=0;i<MAXCLI;i++) {
+    for (i=0;i<ntripc->ncon;i++) {
         if (!ntripc->con[i].state) continue;
         
-        ns=send_nb(ntripc->tcp->cli[i].sock,buff,n,&err);
+        ns=sendcli(ntripc->tcp,i,buff,n,&err);
         
         if (ns<n) {
             if (err) {
@@ -2110,7 +2467,7 @@ static int statentripc(ntripc_t *ntripc)
 static int statexntripc(ntripc_t *ntripc, char *msg)
 {
     char *p=msg;
-    int i,state=!ntripc?0:ntripc->state;
+    int i,n=0,state=!ntripc?0:ntripc->state;
     
     p+=sprintf(p,"ntripc:\n");
     p+=sprintf(p,"  state   = %d\n",ntripc->state);
@@ -2122,13 +2479,14 @@ static int statexntripc(ntripc_t *ntripc, char *msg)
     p+=sprintf(p,"  srctbl  = %s\n",ntripc->srctbl);
     p+=sprintf(p,"  svr:\n");
     p+=statextcp(&ntripc->tcp->svr,p);
-    for (i=0;i<MAXCLI;i++) {
-        if (!ntripc->tcp->cli[i].state) continue;
+    for (i=0;i<ntripc->ncon;i++) {
+        if (!ntripc->tcp->cli[i].state||n++>=MAXCLI) continue;
         p+=sprintf(p,"  cli#%d:\n",i);
-        p+=statextcp(ntripc->tcp->cli+i,p);
+        p+=statexcli(ntripc->tcp->cli+i,p);
         p+=sprintf(p,"    mntpnt= %s\n",ntripc->con[i].mntpnt);
         p+=sprintf(p,"    nb    = %d\n",ntripc->con[i].nb);
     }
+    if (n>MAXCLI) p+=sprintf(p,"  (%d more clients)\n",n-MAXCLI);
     return state;
 }
 /* generate udp socket -------------------------------------------------------*/
@@ -3096,6 +3454,104 @@ extern void strsum(stream_t *stream, int *inb, int *inr, int *outb, int *outr)
     if (outr) *outr=stream->outr;
     strunlock(stream);
 }
+#ifndef WIN32
+/* get descriptor to wait for stream (-1:no wait,-2:not available) -----------*/
+static int waitfd(stream_t *stream)
+{
+    tcpcli_t *tcpcli;
+    ntrip_t *ntrip;
+    
+    if (!stream->port) return -1;
+    
+    switch (stream->type) {
+#ifdef STR_EPOLL
+        case STR_TCPSVR  : return ((tcpsvr_t *)stream->port)->epfd;
+        case STR_NTRIPCAS: return ((ntripc_t *)stream->port)->tcp->epfd;
+#endif
+        case STR_SERIAL  : return ((serial_t *)stream->port)->dev;
+        case STR_UDPSVR  : return ((udp_t *)stream->port)->sock;
+        case STR_UDPCLI  : return -1;
+        case STR_TCPCLI  :
+            tcpcli=(tcpcli_t *)stream->port;
+            return tcpcli->svr.state==2?tcpcli->svr.sock:-2;
+        case STR_NTRIPSVR:
+        case STR_NTRIPCLI:
+            ntrip=(ntrip_t *)stream->port;
+            return ntrip->tcp->svr.state==2&&ntrip->nb==0?ntrip->tcp->svr.sock:-2;
+    }
+    return (stream->mode&STR_MODE_R)?-2:-1;
+}
+#endif
+/* wait for streams ------------------------------------------------------------
+* wait until any of streams is ready to read or has pending connections or
+* output queues, instead of sleeping for a fixed period
+* args   : stream_t *stream I   streams
+*          int    n         I   number of streams
+*          int    tmax      I   max wait time (ms)
+* return : number of ready streams (0:timeout)
+* notes  : if any input stream can not be waited for (file, memory buffer,
+*          ftp/http, connecting tcp/ntrip client or tcp server/ntrip caster
+*          without epoll), it just sleeps tmax ms as sleepms().
+*          connections and output queues of tcp server and ntrip caster are
+*          processed before return.
+*-----------------------------------------------------------------------------*/
+extern int strwait(stream_t *stream, int n, int tmax)
+{
+#ifndef WIN32
+    struct pollfd fds[MAXWAITSTR];
+    int i,j,fd,idx[MAXWAITSTR],nfd=0,nr,err=0;
+    
+    tracet(4,"strwait: n=%d tmax=%d\n",n,tmax);
+    
+    if (tmax<=0||n>MAXWAITSTR) {
+        sleepms(tmax);
+        return 0;
+    }
+    for (i=0;i<n;i++) {
+        strlock(stream+i);
+        fd=waitfd(stream+i);
+        strunlock(stream+i);
+        if (fd==-2) {
+            sleepms(tmax);
+            return 0;
+        }
+        if (fd<0) continue;
+        fds[nfd].fd=fd;
+        fds[nfd].events=POLLIN;
+        fds[nfd].revents=0;
+        idx[nfd++]=i;
+    }
+    if (nfd<=0) {
+        sleepms(tmax);
+        return 0;
+    }
+    if ((nr=poll(fds,nfd,tmax))<=0) return 0;
+    
+    for (j=0;j<nfd;j++) {
+        if (!fds[j].revents) continue;
+        if (fds[j].revents&(POLLERR|POLLHUP|POLLNVAL)) err=1;
+        i=idx[j];
+        strlock(stream+i);
+        if (stream[i].port) {
+            switch (stream[i].type) {
+                case STR_TCPSVR  :
+                    waittcpsvr((tcpsvr_t *)stream[i].port,stream[i].msg);
+                    break;
+                case STR_NTRIPCAS:
+                    wait_ntripc((ntripc_t *)stream[i].port,stream[i].msg);
+                    break;
+            }
+        }
+        strunlock(stream+i);
+    }
+    /* keep period on device or socket error */
+    if (err) sleepms(tmax);
+    return nr;
+#else
+    sleepms(tmax);
+    return 0;
+#endif
+}
 /* set global stream options ---------------------------------------------------
 * set global stream options
 * args   : int    *opt      I   options
@@ -31,6 +31,8 @@
 *                           support multiple ephemeris sets (e.g. I/NAV-F/NAV)
 *                           delete API strsvrsetsrctbl()
 *                           use integer types in stdint.h
+*           2026/10/16 1.16 wait for stream readiness by strwait() instead of
+*                           sleeping server cycle
 *-----------------------------------------------------------------------------*/
 #define _POSIX_C_SOURCE 199506
 #include "rtklib.h"
@@ -491,16 +493,16 @@ static void *strsvrthread(void *arg)
 {
     strsvr_t *svr=(strsvr_t *)arg;
     sol_t sol_nmea={{0}};
-    uint32_t tick,tick_nmea;
+    uint32_t tick,tick_nmea,tick_cyc;
     uint8_t buff[1024];
     int i,n,cyc;
     
     tracet(3,"strsvrthread:\n");
     
-    svr->tick=tickget();
+    svr->tick=tick_cyc=tickget();
     tick_nmea=svr->tick-1000;
     
-    for (cyc=0;svr->state;cyc++) {
+    for (cyc=0;svr->state;) {
         tick=tickget();
         
         /* read data from input stream */
@@ -537,9 +539,13 @@ static void *strsvrthread(void *arg)
                 strwrite(svr->strlog+i,buff,n);
             }
         }
-        /* write periodic command to input stream */
-        for (i=0;i<svr->nstr;i++) {
-            periodic_cmd(cyc*svr->cycle,svr->cmds_periodic[i],svr->stream+i);
+        /* write periodic command to input stream every server cycle */
+        if (cyc==0||(int)(tick-tick_cyc)>=svr->cycle) {
+            for (i=0;i<svr->nstr;i++) {
+                periodic_cmd(cyc*svr->cycle,svr->cmds_periodic[i],svr->stream+i);
+            }
+            tick_cyc=tick;
+            cyc++;
         }
         /* write nmea messages to input stream */
         if (svr->nmeacycle>0&&(int)(tick-tick_nmea)>=svr->nmeacycle) {
@@ -550,7 +556,8 @@ static void *strsvrthread(void *arg)
             strsendnmea(svr->stream,&sol_nmea);
             tick_nmea=tick;
         }
-        sleepms(svr->cycle-(int)(tickget()-tick));
+        /* wait for input or connections until next server cycle */
+        strwait(svr->stream,svr->nstr,svr->cycle-(int)(tickget()-tick_cyc));
     }
     for (i=0;i<svr->nstr;i++) strclose(svr->stream+i);
     for (i=0;i<svr->nstr;i++) strclose(svr->strlog+i);
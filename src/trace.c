@@ -1,13 +1,67 @@
-/* debug trace functions -----------------------------------------------------*/
+/* debug trace functions -------------------------------------------------------
+* notes: with traceasync(), each thread writes trace records into its own
+*        single-producer/single-consumer ring buffer without locks and a
+*        writer thread drains the buffers to the trace file. matrices,
+*        observation data and binary data are copied as they are and formatted
+*        by the writer thread. records not fitting in the buffer are dropped
+*        and the number of dropped records is written to the trace file.
+*-----------------------------------------------------------------------------*/
 #ifdef TRACE
 #include "rtklib.h"
 
+#define TRACE_MAXLINE 1024        /* max length of trace line on stack */
+#define TRACE_MINBUF  4096        /* min size of trace ring buffer (bytes) */
+#define TRACE_INTWR   10          /* interval of trace writer thread (ms) */
+
+#define TRREC_PAD     0           /* trace record type: padding */
+#define TRREC_TEXT    1           /* trace record type: formatted text */
+#define TRREC_MAT     2           /* trace record type: matrix */
+#define TRREC_OBS     3           /* trace record type: observation data */
+#define TRREC_BIN     4           /* trace record type: binary data */
+
+#if defined(__GNUC__)
+#define LOAD_ACQ(p)     __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define STORE_REL(p, v) __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#else /* volatile access with acquire/release semantics (msvc) */
+#define LOAD_ACQ(p)     (*(p))
+#define STORE_REL(p, v) (*(p) = (v))
+#endif
+
+typedef struct {                 /* trace record header type */
+    uint32_t len;                /* record length with header (bytes) */
+    uint32_t type;               /* record type (TRREC_???) */
+    int32_t n, m, p, q;          /* record parameters */
+} trrec_t;
+
+typedef struct trbuf_tag {       /* trace ring buffer type */
+    volatile uint32_t head;      /* write position (producer) */
+    volatile uint32_t tail;      /* read position (writer thread) */
+    volatile uint32_t drop;      /* number of dropped records (producer) */
+    volatile int inuse;          /* buffer owned by a thread */
+    uint32_t wpos;               /* reserved write position (producer) */
+    uint32_t drop_out;           /* number of reported dropped records */
+    uint32_t size;               /* buffer size (bytes, power of 2) */
+    uint8_t *buff;               /* buffer */
+    struct trbuf_tag *next;      /* next buffer */
+} trbuf_t;
+
 static FILE *fp_trace = NULL;    /* file pointer of trace */
 static char file_trace[1024];    /* trace file */
 static int level_trace = 0;      /* level of trace */
 static uint32_t tick_trace = 0;  /* tick time at traceopen (ms) */
 static gtime_t time_trace = {0}; /* time at traceopen */
 static rtklib_lock_t lock_trace; /* lock for trace */
+static uint32_t size_trace = 0;  /* size of trace ring buffer (0:sync output) */
+static volatile int async_trace = 0; /* async output enabled */
+static volatile int stop_trace = 0; /* stop request to writer thread */
+static trbuf_t *volatile buf_trace = NULL; /* trace ring buffers */
+static rtklib_thread_t thread_trace; /* trace writer thread */
+static int key_init = 0;         /* thread-local key initialized */
+#ifdef WIN32
+static DWORD key_trace;          /* thread-local key of trace ring buffer */
+#else
+static pthread_key_t key_trace;  /* thread-local key of trace ring buffer */
+#endif
 
 static void traceswap(void)
 {
@@ -34,6 +88,256 @@ static void traceswap(void)
     }
     rtklib_unlock(&lock_trace);
 }
+/* print observation data ----------------------------------------------------*/
+static void printobs(FILE *fp, const obsd_t *obs, int n)
+{
+    char str[40], id[8];
+    int i;
+
+    for (i = 0; i < n; i++) {
+        time2str(obs[i].time, str, 3);
+        satno2id(obs[i].sat, id);
+        fprintf(fp,
+                " (%2d) %s %-3s rcv%d %13.3f %13.3f %13.3f %13.3f %d %d %d %d "
+                "%3.4f %3.3f %3.1f %3.1f\n",
+                i + 1, str, id, obs[i].rcv, obs[i].L[0], obs[i].L[1],
+                obs[i].P[0], obs[i].P[1], obs[i].LLI[0], obs[i].LLI[1],
+                obs[i].code[0], obs[i].code[1], obs[i].Lstd[0], obs[i].Pstd[0],
+                obs[i].SNR[0], obs[i].SNR[1]);
+    }
+}
+/* print binary data ---------------------------------------------------------*/
+static void printb(FILE *fp, const uint8_t *p, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+        fprintf(fp, "%02X%s", *p++, i % 8 == 7 ? " " : "");
+    fprintf(fp, "\n");
+}
+/* release trace ring buffer at thread exit ----------------------------------*/
+#ifdef WIN32
+static VOID WINAPI relbuf(PVOID p)
+#else
+static void relbuf(void *p)
+#endif
+{
+    if (p) STORE_REL(&((trbuf_t *)p)->inuse, 0);
+}
+/* get trace ring buffer of current thread -----------------------------------*/
+static trbuf_t *getbuf(void)
+{
+    trbuf_t *b;
+
+#ifdef WIN32
+    if ((b = (trbuf_t *)FlsGetValue(key_trace))) return b;
+#else
+    if ((b = (trbuf_t *)pthread_getspecific(key_trace))) return b;
+#endif
+    rtklib_lock(&lock_trace);
+
+    /* reuse buffer released by exited thread */
+    for (b = buf_trace; b; b = b->next) {
+        if (!b->inuse) break;
+    }
+    if (!b) {
+        if (!(b = (trbuf_t *)calloc(1, sizeof(trbuf_t))) ||
+            !(b->buff = (uint8_t *)malloc(size_trace))) {
+            free(b);
+            rtklib_unlock(&lock_trace);
+            return NULL;
+        }
+        b->size = size_trace;
+        b->next = buf_trace;
+        STORE_REL(&buf_trace, b);
+    }
+    b->inuse = 1;
+    rtklib_unlock(&lock_trace);
+#ifdef WIN32
+    FlsSetValue(key_trace, b);
+#else
+    pthread_setspecific(key_trace, b);
+#endif
+    return b;
+}
+/* reserve trace record in ring buffer ---------------------------------------*/
+static trrec_t *reserve(trbuf_t *b, int type, size_t size)
+{
+    trrec_t *rec;
+    uint32_t len, pos, cont, need, head = b->head;
+
+    len = (uint32_t)((sizeof(trrec_t) + size + 7) & ~(size_t)7);
+    pos = head & (b->size - 1);
+    cont = b->size - pos;
+    need = len <= cont ? len : cont + len;
+
+    if (sizeof(trrec_t) + size > b->size / 2 ||
+        head - LOAD_ACQ(&b->tail) + need > b->size) {
+        STORE_REL(&b->drop, b->drop + 1);
+        return NULL;
+    }
+    if (len > cont) { /* pad to end of buffer */
+        rec = (trrec_t *)(b->buff + pos);
+        rec->len = cont;
+        rec->type = TRREC_PAD;
+        head += cont;
+        pos = 0;
+    }
+    rec = (trrec_t *)(b->buff + pos);
+    rec->len = len;
+    rec->type = type;
+    b->wpos = head + len;
+    return rec;
+}
+/* commit reserved trace record ----------------------------------------------*/
+static void commit(trbuf_t *b) { STORE_REL(&b->head, b->wpos); }
+
+/* put formatted text to trace -----------------------------------------------*/
+static void tracevprint(const char *head, const char *format, va_list ap)
+{
+    trbuf_t *b;
+    trrec_t *rec;
+    va_list aq;
+    char buff[TRACE_MAXLINE], *p = buff;
+    int n0 = (int)strlen(head), n;
+
+    if (!async_trace) {
+        fputs(head, fp_trace);
+        vfprintf(fp_trace, format, ap);
+        return;
+    }
+    if (!(b = getbuf())) return;
+    memcpy(buff, head, n0);
+    va_copy(aq, ap);
+    n = vsnprintf(buff + n0, sizeof(buff) - n0, format, aq);
+    va_end(aq);
+    if (n < 0) return;
+    if (n0 + n >= (int)sizeof(buff)) {
+        if (!(p = (char *)malloc(n0 + n + 1))) return;
+        memcpy(p, head, n0);
+        vsnprintf(p + n0, n + 1, format, ap);
+    }
+    if ((rec = reserve(b, TRREC_TEXT, n0 + n + 1))) {
+        memcpy(rec + 1, p, n0 + n + 1);
+        commit(b);
+    }
+    if (p != buff) free(p);
+}
+static void traceprint(const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    tracevprint("", format, ap);
+    va_end(ap);
+}
+/* drain trace ring buffers to trace file ------------------------------------*/
+static int drainbuf(void)
+{
+    trbuf_t *b, *b0 = LOAD_ACQ(&buf_trace);
+    trrec_t *rec;
+    uint32_t head, tail, drop;
+    int nrec = 0;
+
+    for (b = b0; b; b = b->next) {
+        if (LOAD_ACQ(&b->head) != b->tail || b->drop != b->drop_out) break;
+    }
+    if (!b) return 0;
+
+    traceswap();
+
+    for (b = b0; b; b = b->next) {
+        head = LOAD_ACQ(&b->head);
+        for (tail = b->tail; tail != head; tail += rec->len) {
+            rec = (trrec_t *)(b->buff + (tail & (b->size - 1)));
+            switch (rec->type) {
+                case TRREC_TEXT:
+                    fputs((const char *)(rec + 1), fp_trace);
+                    break;
+                case TRREC_MAT:
+                    matfprint((const double *)(rec + 1), rec->n, rec->m,
+                              rec->p, rec->q, fp_trace);
+                    break;
+                case TRREC_OBS:
+                    printobs(fp_trace, (const obsd_t *)(rec + 1), rec->n);
+                    break;
+                case TRREC_BIN:
+                    printb(fp_trace, (const uint8_t *)(rec + 1), rec->n);
+                    break;
+            }
+            nrec++;
+        }
+        STORE_REL(&b->tail, tail);
+
+        if ((drop = LOAD_ACQ(&b->drop)) != b->drop_out) {
+            fprintf(fp_trace, "2 trace buffer overflow: %u records dropped\n",
+                    drop - b->drop_out);
+            b->drop_out = drop;
+            nrec++;
+        }
+    }
+    fflush(fp_trace);
+    return nrec;
+}
+/* trace writer thread -------------------------------------------------------*/
+#ifdef WIN32
+static DWORD WINAPI tracethread(void *arg)
+#else
+static void *tracethread(void *arg)
+#endif
+{
+    int stop;
+
+    for (;;) {
+        stop = LOAD_ACQ(&stop_trace);
+        if (!drainbuf()) {
+            if (stop) break;
+            sleepms(TRACE_INTWR);
+        }
+    }
+    return 0;
+}
+/* start trace writer thread -------------------------------------------------*/
+static void startasync(void)
+{
+    trbuf_t *b;
+
+    if (!key_init) {
+#ifdef WIN32
+        if ((key_trace = FlsAlloc(relbuf)) == FLS_OUT_OF_INDEXES) return;
+#else
+        if (pthread_key_create(&key_trace, relbuf)) return;
+#endif
+        key_init = 1;
+    }
+    /* discard records left from previous trace */
+    for (b = buf_trace; b; b = b->next) {
+        b->tail = b->head;
+        b->drop_out = b->drop;
+    }
+    stop_trace = 0;
+#ifdef WIN32
+    if (!(thread_trace = CreateThread(NULL, 0, tracethread, NULL, 0, NULL))) {
+        return;
+    }
+#else
+    if (pthread_create(&thread_trace, NULL, tracethread, NULL)) return;
+#endif
+    STORE_REL(&async_trace, 1);
+}
+/* stop trace writer thread --------------------------------------------------*/
+static void stopasync(void)
+{
+    if (!async_trace) return;
+    STORE_REL(&async_trace, 0);
+    STORE_REL(&stop_trace, 1);
+#ifdef WIN32
+    WaitForSingleObject(thread_trace, INFINITE);
+    CloseHandle(thread_trace);
+#else
+    pthread_join(thread_trace, NULL);
+#endif
+}
 extern void traceopen(const char *file)
 {
     gtime_t time = utc2gpst(timeget());
@@ -45,18 +349,38 @@ extern void traceopen(const char *file)
     tick_trace = tickget();
     time_trace = time;
     rtklib_initlock(&lock_trace);
+    if (size_trace > 0) startasync();
 }
 extern void traceclose(void)
 {
+    stopasync();
     if (fp_trace && fp_trace != stderr) fclose(fp_trace);
     fp_trace = NULL;
     file_trace[0] = '\0';
 }
+/* set asynchronous trace output -----------------------------------------------
+* set size of per-thread ring buffer for asynchronous trace output. the size
+* is applied at next traceopen().
+* args   : int    size      I   buffer size per thread (bytes) (0:sync output)
+* return : none
+*-----------------------------------------------------------------------------*/
+extern void traceasync(int size)
+{
+    uint32_t n = TRACE_MINBUF;
+
+    if (size <= 0) {
+        size_trace = 0;
+        return;
+    }
+    while (n < (uint32_t)size && n < 0x40000000) n <<= 1;
+    size_trace = n;
+}
 extern void tracelevel(int level) { level_trace = level; }
 extern int gettracelevel(void) { return level_trace; }
 extern void trace_impl(int level, const char *format, ...)
 {
     va_list ap;
+    char head[8];
 
     /* print error message to stderr */
     if (level <= 1) {
@@ -65,50 +389,62 @@ extern void trace_impl(int level, const char *format, ...)
         va_end(ap);
     }
     if (!fp_trace || level > level_trace) return;
-    traceswap();
-    fprintf(fp_trace, "%d ", level);
+    if (!async_trace) traceswap();
+    sprintf(head, "%d ", level);
     va_start(ap, format);
-    vfprintf(fp_trace, format, ap);
+    tracevprint(head, format, ap);
     va_end(ap);
-    fflush(fp_trace);
+    if (!async_trace) fflush(fp_trace);
 }
 extern void tracet_impl(int level, const char *format, ...)
 {
     va_list ap;
+    char head[32];
 
     if (!fp_trace || level > level_trace) return;
-    traceswap();
-    fprintf(fp_trace, "%d %9.3f: ", level, (tickget() - tick_trace) / 1000.0);
+    if (!async_trace) traceswap();
+    sprintf(head, "%d %9.3f: ", level, (tickget() - tick_trace) / 1000.0);
     va_start(ap, format);
-    vfprintf(fp_trace, format, ap);
+    tracevprint(head, format, ap);
     va_end(ap);
-    fflush(fp_trace);
+    if (!async_trace) fflush(fp_trace);
 }
 extern void tracemat_impl(int level, const double *A, int n, int m, int p,
                           int q)
 {
+    trbuf_t *b;
+    trrec_t *rec;
+
     if (!fp_trace || level > level_trace) return;
-    matfprint(A, n, m, p, q, fp_trace);
-    fflush(fp_trace);
+    if (!async_trace) {
+        matfprint(A, n, m, p, q, fp_trace);
+        fflush(fp_trace);
+        return;
+    }
+    if (n <= 0 || m <= 0 || !(b = getbuf())) return;
+    if ((rec = reserve(b, TRREC_MAT, sizeof(double) * n * m))) {
+        rec->n = n; rec->m = m; rec->p = p; rec->q = q;
+        memcpy(rec + 1, A, sizeof(double) * n * m);
+        commit(b);
+    }
 }
 extern void traceobs_impl(int level, const obsd_t *obs, int n)
 {
-    char str[40], id[8];
-    int i;
+    trbuf_t *b;
+    trrec_t *rec;
 
     if (!fp_trace || level > level_trace) return;
-    for (i = 0; i < n; i++) {
-        time2str(obs[i].time, str, 3);
-        satno2id(obs[i].sat, id);
-        fprintf(fp_trace,
-                " (%2d) %s %-3s rcv%d %13.3f %13.3f %13.3f %13.3f %d %d %d %d "
-                "%3.4f %3.3f %3.1f %3.1f\n",
-                i + 1, str, id, obs[i].rcv, obs[i].L[0], obs[i].L[1],
-                obs[i].P[0], obs[i].P[1], obs[i].LLI[0], obs[i].LLI[1],
-                obs[i].code[0], obs[i].code[1], obs[i].Lstd[0], obs[i].Pstd[0],
-                obs[i].SNR[0], obs[i].SNR[1]);
+    if (!async_trace) {
+        printobs(fp_trace, obs, n);
+        fflush(fp_trace);
+        return;
+    }
+    if (n <= 0 || !(b = getbuf())) return;
+    if ((rec = reserve(b, TRREC_OBS, sizeof(obsd_t) * n))) {
+        rec->n = n;
+        memcpy(rec + 1, obs, sizeof(obsd_t) * n);
+        commit(b);
     }
-    fflush(fp_trace);
 }
 extern void tracenav_impl(int level, const nav_t *nav)
 {
@@ -120,14 +456,14 @@ extern void tracenav_impl(int level, const nav_t *nav)
         time2str(nav->eph[i].toe, s1, 0);
         time2str(nav->eph[i].ttr, s2, 0);
         satno2id(nav->eph[i].sat, id);
-        fprintf(fp_trace, "(%3d) %-3s : %s %s %3d %3d %02x\n", i + 1, id, s1,
+        traceprint("(%3d) %-3s : %s %s %3d %3d %02x\n", i + 1, id, s1,
                 s2, nav->eph[i].iode, nav->eph[i].iodc, nav->eph[i].svh);
     }
-    fprintf(fp_trace, "(ion) %9.4e %9.4e %9.4e %9.4e\n", nav->ion_gps[0],
+    traceprint("(ion) %9.4e %9.4e %9.4e %9.4e\n", nav->ion_gps[0],
             nav->ion_gps[1], nav->ion_gps[2], nav->ion_gps[3]);
-    fprintf(fp_trace, "(ion) %9.4e %9.4e %9.4e %9.4e\n", nav->ion_gps[4],
+    traceprint("(ion) %9.4e %9.4e %9.4e %9.4e\n", nav->ion_gps[4],
             nav->ion_gps[5], nav->ion_gps[6], nav->ion_gps[7]);
-    fprintf(fp_trace, "(ion) %9.4e %9.4e %9.4e %9.4e\n", nav->ion_gal[0],
+    traceprint("(ion) %9.4e %9.4e %9.4e %9.4e\n", nav->ion_gal[0],
             nav->ion_gal[1], nav->ion_gal[2], nav->ion_gal[3]);
 }
 extern void tracegnav_impl(int level, const nav_t *nav)
@@ -140,7 +476,7 @@ extern void tracegnav_impl(int level, const nav_t *nav)
         time2str(nav->geph[i].toe, s1, 0);
         time2str(nav->geph[i].tof, s2, 0);
         satno2id(nav->geph[i].sat, id);
-        fprintf(fp_trace, "(%3d) %-3s : %s %s %2d %2d %8.3f\n", i + 1, id, s1,
+        traceprint("(%3d) %-3s : %s %s %2d %2d %8.3f\n", i + 1, id, s1,
                 s2, nav->geph[i].frq, nav->geph[i].svh,
                 nav->geph[i].taun * 1E6);
     }
@@ -155,7 +491,7 @@ extern void tracehnav_impl(int level, const nav_t *nav)
         time2str(nav->seph[i].t0, s1, 0);
         time2str(nav->seph[i].tof, s2, 0);
         satno2id(nav->seph[i].sat, id);
-        fprintf(fp_trace, "(%3d) %-3s : %s %s %2d %2d\n", i + 1, id, s1, s2,
+        traceprint("(%3d) %-3s : %s %s %2d %2d\n", i + 1, id, s1, s2,
                 nav->seph[i].svh, nav->seph[i].sva);
     }
 }
@@ -170,7 +506,7 @@ extern void tracepeph_impl(int level, const nav_t *nav)
         time2str(nav->peph[i].time, s, 0);
         for (j = 0; j < MAXSAT; j++) {
             satno2id(j + 1, id);
-            fprintf(fp_trace,
+            traceprint(
                     "%-3s %d %-3s %13.3f %13.3f %13.3f %13.3f %6.3f %6.3f "
                     "%6.3f %6.3f\n",
                     s, nav->peph[i].index, id, nav->peph[i].pos[j][0],
@@ -192,7 +528,7 @@ extern void tracepclk_impl(int level, const nav_t *nav)
         time2str(nav->pclk[i].time, s, 0);
         for (j = 0; j < MAXSAT; j++) {
             satno2id(j + 1, id);
-            fprintf(fp_trace, "%-3s %d %-3s %13.3f %6.3f\n", s,
+            traceprint("%-3s %d %-3s %13.3f %6.3f\n", s,
                     nav->pclk[i].index, id, nav->pclk[i].clk[j][0] * 1E9,
                     nav->pclk[i].std[j][0] * 1E9);
         }
@@ -200,11 +536,20 @@ extern void tracepclk_impl(int level, const nav_t *nav)
 }
 extern void traceb_impl(int level, const uint8_t *p, int n)
 {
-    int i;
+    trbuf_t *b;
+    trrec_t *rec;
+
     if (!fp_trace || level > level_trace) return;
-    for (i = 0; i < n; i++)
-        fprintf(fp_trace, "%02X%s", *p++, i % 8 == 7 ? " " : "");
-    fprintf(fp_trace, "\n");
+    if (!async_trace) {
+        printb(fp_trace, p, n);
+        return;
+    }
+    if (n < 0 || !(b = getbuf())) return;
+    if ((rec = reserve(b, TRREC_BIN, n))) {
+        rec->n = n;
+        memcpy(rec + 1, p, n);
+        commit(b);
+    }
 }
 
 #endif /* TRACE */
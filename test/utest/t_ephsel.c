@@ -0,0 +1,259 @@
+/*------------------------------------------------------------------------------
+* rtklib unit test driver : broadcast ephemeris selection
+*-----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include "../../src/rtklib.h"
+
+/* compare satellite positions with and without ephemeris index */
+static void cmpsatpos(const nav_t *nav, gtime_t ts, double tspan, double tint)
+{
+    gtime_t time;
+    nav_t nav0=*nav;
+    double rs1[6],dts1[2],var1,rs2[6],dts2[2],var2;
+    int i,j,sat,svh1,svh2,stat1,stat2,n=0;
+
+    nav0.eidx=NULL; /* linear search */
+
+    for (i=0;i<tspan/tint;i++) {
+        time=timeadd(ts,tint*i);
+        for (sat=1;sat<=MAXSAT;sat++) {
+            stat1=satpos(time,time,sat,EPHOPT_BRDC,nav  ,rs1,dts1,&var1,&svh1);
+            stat2=satpos(time,time,sat,EPHOPT_BRDC,&nav0,rs2,dts2,&var2,&svh2);
+            assert(stat1==stat2);
+            if (!stat1) continue;
+            for (j=0;j<6;j++) assert(rs1[j]==rs2[j]);
+            assert(dts1[0]==dts2[0]&&var1==var2&&svh1==svh2);
+            n++;
+        }
+    }
+    assert(n>0);
+}
+/* idxnav() */
+void utest1(void)
+{
+    char file1[]="../data/rinex/brdc1820.10n";
+    char file2[]="../data/rinex/brdc0910.09g";
+    double ep1[]={2010,7,1,0,0,0},ep2[]={2009,4,1,0,0,0};
+    nav_t nav={0};
+    int i,n;
+
+    readrnx(file1,1,"",NULL,&nav,NULL);
+    readrnx(file2,1,"",NULL,&nav,NULL);
+        assert(nav.n>0&&nav.ng>0);
+    uniqnav(&nav);
+        assert(nav.eidx!=NULL);
+
+    for (i=n=0;i<MAXSAT;i++) n+=nav.eidx[i].n;
+        assert(n==nav.n+nav.ng+nav.ns);
+
+    cmpsatpos(&nav,epoch2time(ep1),86400.0,300.0);
+    cmpsatpos(&nav,epoch2time(ep2),86400.0,300.0);
+
+    freenav(&nav,0xFF);
+        assert(nav.eidx==NULL);
+
+    printf("%s utest1 : OK\n",__FILE__);
+}
+/* updidxnav() */
+void utest2(void)
+{
+    char file[]="../data/rinex/brdc1820.10n";
+    double ep[]={2010,7,1,0,0,0};
+    nav_t nav={0},slot={0};
+    eph_t eph0={0,-1,-1};
+    int i,j,sat;
+
+    readrnx(file,1,"",NULL,&nav,NULL);
+        assert(nav.n>0);
+
+    /* slot table as in rtk server: {current,previous} by satellite */
+    slot.eph=(eph_t *)malloc(sizeof(eph_t)*MAXSAT*2);
+    slot.n=slot.nmax=MAXSAT*2;
+    for (i=0;i<MAXSAT*2;i++) slot.eph[i]=eph0;
+        assert(idxnav(&slot));
+
+    for (i=0;i<nav.n;i++) {
+        sat=nav.eph[i].sat;
+        j=sat-1;
+        slot.eph[j+MAXSAT]=slot.eph[j];
+        slot.eph[j]=nav.eph[i];
+        updidxnav(&slot,sat,j);
+        updidxnav(&slot,sat,j+MAXSAT);
+            assert(slot.eidx[sat-1].n<=2);
+    }
+    cmpsatpos(&slot,epoch2time(ep),86400.0,300.0);
+
+    freenav(&nav,0xFF);
+    freenav(&slot,0xFF);
+
+    printf("%s utest2 : OK\n",__FILE__);
+}
+/* eph2poss() */
+void utest3(void)
+{
+    char file[]="../data/rinex/brdc1820.10n";
+    double ep[]={2010,7,1,0,0,0},tt=1E-3;
+    double rs[6*MAXSAT],dts[2*MAXSAT],var[MAXSAT];
+    double rs1[3],dts1,var1,rs2[3],dts2,var2,rs3[3],dts3,var3;
+    gtime_t time[MAXSAT],t0;
+    const eph_t *eph[MAXSAT];
+    nav_t nav={0};
+    eph_t ephs[3];
+    int i,j,k,n;
+
+    readrnx(file,1,"",NULL,&nav,NULL);
+        assert(nav.n>0);
+
+    /* galileo, beidou meo and beidou geo orbits from gps ephemerides */
+    for (i=0;i<3;i++) ephs[i]=nav.eph[i];
+    ephs[0].sat=satno(SYS_GAL,1);
+    ephs[1].sat=satno(SYS_CMP,10);
+    ephs[2].sat=satno(SYS_CMP,1);
+
+    t0=epoch2time(ep);
+    for (k=0;k<24;k++) {
+        for (i=n=0;i<nav.n&&n<MAXSAT-3;i++) {
+            eph[n]=nav.eph+i;
+            time[n++]=timeadd(t0,3600.0*k+0.123*i);
+        }
+        for (i=0;i<3;i++) {
+            eph[n]=ephs+i;
+            time[n++]=timeadd(t0,3600.0*k+7.0*i);
+        }
+        eph2poss(n,time,eph,rs,dts,var);
+
+        for (i=0;i<n;i++) {
+            eph2pos(time[i],eph[i],rs1,&dts1,&var1);
+            eph2pos(timeadd(time[i],-tt),eph[i],rs2,&dts2,&var2);
+            eph2pos(timeadd(time[i], tt),eph[i],rs3,&dts3,&var3);
+            for (j=0;j<3;j++) {
+                assert(fabs(rs[j+i*6]-rs1[j])<1E-6);
+                assert(fabs(rs[j+3+i*6]-(rs3[j]-rs2[j])/(2.0*tt))<1E-4);
+            }
+            assert(fabs(dts[i*2]-dts1)<1E-15);
+            assert(fabs(dts[1+i*2]-(dts3-dts2)/(2.0*tt))<1E-14);
+            assert(var[i]==var1);
+        }
+    }
+    freenav(&nav,0xFF);
+
+    printf("%s utest3 : OK\n",__FILE__);
+}
+/* satposs() with broadcast ephemerides in batch */
+void utest4(void)
+{
+    char file1[]="../data/rinex/07590920.05o";
+    char file2[]="../data/rinex/30400920.05n";
+    double rs[6*MAXOBS],dts[2*MAXOBS],var[MAXOBS],rs1[3],rs2[3],dts1,var1,tt;
+    double pr,tmin;
+    const eph_t *eph;
+    obs_t obs={0};
+    nav_t nav={0};
+    gtime_t time;
+    int i,j,k,l,m,svh[MAXOBS],nsat=0;
+
+    readrnx(file1,1,"",&obs,NULL,NULL);
+    readrnx(file2,1,"",NULL,&nav,NULL);
+        assert(obs.n>0&&nav.n>0);
+    sortobs(&obs);
+    uniqnav(&nav);
+
+    for (i=0;i<obs.n;i=j) {
+        for (j=i+1;j<obs.n;j++) {
+            if (timediff(obs.data[j].time,obs.data[i].time)>DTTOL) break;
+        }
+        m=j-i<MAXOBS?j-i:MAXOBS;
+        satposs(obs.data[i].time,obs.data+i,m,&nav,EPHOPT_BRDC,rs,dts,var,svh);
+
+        for (k=0;k<m;k++) {
+            const obsd_t *o=obs.data+i+k;
+            if ((pr=o->P[0])==0.0) continue;
+
+            /* ephemeris with nearest toe as seleph() */
+            for (l=0,eph=NULL,tmin=1E9;l<nav.n;l++) {
+                if (nav.eph[l].sat!=o->sat) continue;
+                if (fabs(tt=timediff(nav.eph[l].toe,o->time))>MAXDTOE) continue;
+                if (fabs(tt)<=tmin) {eph=nav.eph+l; tmin=fabs(tt);}
+            }
+            if (!eph) continue;
+            time=timeadd(o->time,-pr/CLIGHT);
+            time=timeadd(time,-eph2clk(time,eph));
+            eph2pos(time,eph,rs1,&dts1,&var1);
+            eph2pos(timeadd(time,1E-3),eph,rs2,&dts1,&var1);
+            for (l=0;l<3;l++) {
+                assert(fabs(rs[l+k*6]-rs1[l])<1E-6);
+                assert(fabs(rs[l+3+k*6]-(rs2[l]-rs1[l])/1E-3)<1E-2);
+            }
+            assert(svh[k]==eph->svh);
+            nsat++;
+        }
+    }
+    assert(nsat>0);
+    free(obs.data);
+    freenav(&nav,0xFF);
+
+    printf("%s utest4 : OK\n",__FILE__);
+}
+/* readnav() for slot table indexed before loading as rtk server */
+void utest5(void)
+{
+    char file[]="../data/rinex/brdc1820.10n",navfile[]="t_ephsel.nav";
+    double ep[]={2010,7,1,2,0,0};
+    nav_t nav={0},slot={0},load={0};
+    eph_t eph0={0,-1,-1};
+    geph_t geph0={0,-1};
+    gtime_t t0=epoch2time(ep);
+    int i,j,n;
+
+    readrnx(file,1,"",NULL,&nav,NULL);
+        assert(nav.n>0);
+
+    /* ephemerides nearest to t0 by satellite */
+    slot.eph=(eph_t *)malloc(sizeof(eph_t)*MAXSAT*2);
+    slot.geph=(geph_t *)malloc(sizeof(geph_t)*MAXPRNGLO*2);
+    slot.n=slot.nmax=MAXSAT*2;
+    slot.ng=slot.ngmax=MAXPRNGLO*2;
+    for (i=0;i<MAXSAT*2;i++) slot.eph[i]=eph0;
+    for (i=0;i<MAXPRNGLO*2;i++) slot.geph[i]=geph0;
+    for (i=0;i<nav.n;i++) {
+        j=nav.eph[i].sat-1;
+        if (slot.eph[j].sat&&fabs(timediff(nav.eph[i].toe,t0))>=
+            fabs(timediff(slot.eph[j].toe,t0))) continue;
+        slot.eph[j]=nav.eph[i];
+    }
+        assert(savenav(navfile,&slot));
+
+    /* load into empty slot table indexed at initialization */
+    load.eph=(eph_t *)malloc(sizeof(eph_t)*MAXSAT*2);
+    load.geph=(geph_t *)malloc(sizeof(geph_t)*MAXPRNGLO*2);
+    load.n=load.nmax=MAXSAT*2;
+    load.ng=load.ngmax=MAXPRNGLO*2;
+    for (i=0;i<MAXSAT*2;i++) load.eph[i]=eph0;
+    for (i=0;i<MAXPRNGLO*2;i++) load.geph[i]=geph0;
+        assert(idxnav(&load));
+        assert(readnav(navfile,&load));
+
+    for (i=n=0;i<MAXSAT;i++) n+=load.eidx[i].n;
+        assert(n>0);
+    cmpsatpos(&load,timeadd(t0,-7200.0),14400.0,300.0);
+
+    remove(navfile);
+    freenav(&nav,0xFF);
+    freenav(&slot,0xFF);
+    freenav(&load,0xFF);
+
+    printf("%s utest5 : OK\n",__FILE__);
+}
+/* unit test main */
+int main(int argc, char **argv)
+{
+    utest1();
+    utest2();
+    utest3();
+    utest4();
+    utest5();
+    return 0;
+}
@@ -2,6 +2,7 @@
 * rtklib unit test driver : geoid functions
 *-----------------------------------------------------------------------------*/
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 #include <assert.h>
 #include "../../src/rtklib.h"
@@ -166,10 +167,58 @@ void utest3(void)
     printf("\n");
     printf("%s utset3 : OK\n",__FILE__);
 }
+/* synthetic egm96 15x15" grid height (0.01m) */
+static int16_t hgrid(int i, int j)
+{
+    return (int16_t)((i*13+j*7)%20000-10000);
+}
+/* geoidh(), geoidh_n() with memory-mapped model file */
+void utest4(void)
+{
+    char file[]="t_geoid_tmp.dac";
+    FILE *fp;
+    double pos[3*100],h[100],hn[100],dh;
+    uint8_t v[2];
+    int i,j,k,n;
+    
+    fp=fopen(file,"wb"); assert(fp);
+    for (j=0;j<721;j++) for (i=0;i<1440;i++) {
+        v[0]=(uint8_t)(hgrid(i,j)>>8); v[1]=(uint8_t)(hgrid(i,j)&0xFF);
+        fwrite(v,2,1,fp);
+    }
+    fclose(fp);
+    
+    assert(opengeoid(GEOID_EGM96_M150,file));
+    
+    /* grid points */
+    for (k=0;k<100;k++) {
+        i=(k*137)%1440; j=(k*71)%721;
+        pos[k*3  ]=(90.0-j*0.25)*D2R;
+        pos[k*3+1]=i*0.25*D2R;
+        pos[k*3+2]=0.0;
+        h[k]=geoidh(pos+k*3);
+        dh=h[k]-hgrid(i,j)*0.01;
+            assert(fabs(dh)<1E-6);
+    }
+    n=geoidh_n(pos,100,hn);
+    for (k=0;k<100;k++) assert(hn[k]==h[k]);
+        assert(n==100-(h[0]==0.0));
+    
+    /* bilinear interpolation at center of grid */
+    pos[0]=(90.0-10.125)*D2R; pos[1]=20.125*D2R;
+    dh=geoidh(pos)-(hgrid(80,40)+hgrid(81,40)+hgrid(80,41)+hgrid(81,41))*0.0025;
+        assert(fabs(dh)<1E-6);
+    
+    closegeoid();
+    remove(file);
+    
+    printf("%s utset4 : OK\n",__FILE__);
+}
 int main(void)
 {
     utest1();
     utest2();
     utest3();
+    utest4();
     return 0;
 }
@@ -2,6 +2,8 @@
 * rtklib unit test driver : lambda/mlambda integer least square
 *-----------------------------------------------------------------------------*/
 #include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
 #include <assert.h>
 #include "../../src/rtklib.h"
 
@@ -106,9 +108,124 @@ void utest2(void)
     }
     printf("%s utest2 : OK\n",__FILE__);
 }
+/* random float ambiguities and covariance as double-difference ------------*/
+static void randamb(int n, double *a, double *Q)
+{
+    double *A=mat(n,n);
+    int i,j;
+
+    for (i=0;i<n*n;i++) A[i]=(rand()/(double)RAND_MAX-0.5)*0.02;
+    matmul("NT",n,n,n,A,A,Q);
+    for (i=0;i<n;i++) for (j=0;j<n;j++) {
+        Q[i+j*n]+=i==j?0.002:0.001; /* single-difference reference */
+    }
+    for (i=0;i<n;i++) a[i]=(rand()%2000-1000)+(rand()/(double)RAND_MAX-0.5)*0.2;
+    free(A);
+}
+/* squared residual of integer vector ((a-F)'*Qi*(a-F)) ----------------------*/
+static double resamb(int n, const double *a, const double *Qi, const double *F)
+{
+    double *v=mat(n,1),*w=mat(n,1),r;
+    int i;
+
+    for (i=0;i<n;i++) v[i]=a[i]-F[i];
+    matmul("NN",n,1,n,Qi,v,w);
+    for (i=0,r=0.0;i<n;i++) r+=v[i]*w[i];
+    free(v); free(w);
+    return r;
+}
+/* check fixed solutions by residuals and integer neighbors ------------------*/
+static void chkamb(int n, const double *a, const double *Q, const double *F,
+                   const double *s)
+{
+    double *Qi=mat(n,n),*G=mat(n,1),r;
+    int i,j,k;
+
+    matcpy(Qi,Q,n,n);
+    assert(!matinv(Qi,n));
+    assert(s[0]<=s[1]);
+
+    for (j=0;j<2;j++) {
+        for (i=0;i<n;i++) assert(F[i+j*n]==floor(F[i+j*n]));
+        r=resamb(n,a,Qi,F+j*n);
+        assert(fabs(r-s[j])<=1E-6*(1.0+s[j]));
+    }
+    /* no integer neighbor of the best other than the second is closer */
+    for (i=0;i<n;i++) for (k=-1;k<=1;k+=2) {
+        matcpy(G,F,n,1);
+        G[i]+=k;
+        r=resamb(n,a,Qi,G);
+        assert(r>=s[1]*(1.0-1E-9)-1E-9);
+    }
+    free(Qi); free(G);
+}
+/* lambda_ws() */
+void utest3(void)
+{
+    int i,j,k,n,info;
+    double a[60],Q[60*60],F[60*2],s[2];
+    lambda_ws_t ws;
+
+    lambda_initws(&ws);
+
+    /* baseline fixed solutions and residuals with reused workspace */
+    for (k=0;k<3;k++) {
+        const double *ak=k==1?a2:a1,*Qk=k==1?Q2:Q1,*Fk=k==1?F2:F1;
+        const double *sk=k==1?s2:s1;
+        n=k==1?10:6;
+        info=lambda_ws(&ws,n,2,ak,Qk,F,s);
+        assert(info==0);
+        for (j=0;j<2;j++) {
+            for (i=0;i<n;i++) assert(F[i+j*n]==Fk[j+i*2]);
+            assert(fabs(s[j]-sk[j])<1E-4);
+        }
+        chkamb(n,ak,Qk,F,s);
+    }
+    assert(ws.nmax==10&&ws.mmax==2);
+
+    /* residuals and optimality of fixed solutions for nb=2-60 */
+    srand(1234);
+    for (k=0;k<100;k++) {
+        n=2+rand()%59;
+        randamb(n,a,Q);
+        info=lambda_ws(&ws,n,2,a,Q,F,s);
+        assert(info==0);
+        chkamb(n,a,Q,F,s);
+    }
+    lambda_freews(&ws);
+    assert(ws.buff==NULL&&ws.nmax==0);
+
+    printf("%s utest3 : OK\n",__FILE__);
+}
+/* lambda()/lambda_ws() benchmark (nb=10-60) */
+void utest4(void)
+{
+    int i,n,nrep=200;
+    double a[60],Q[60*60],F[60*2],s[2],t1,t2;
+    clock_t c;
+    lambda_ws_t ws;
+
+    lambda_initws(&ws);
+    srand(5678);
+    for (n=10;n<=60;n+=10) {
+        randamb(n,a,Q);
+        c=clock();
+        for (i=0;i<nrep;i++) lambda(n,2,a,Q,F,s);
+        t1=(double)(clock()-c)/CLOCKS_PER_SEC/nrep*1E6;
+        c=clock();
+        for (i=0;i<nrep;i++) lambda_ws(&ws,n,2,a,Q,F,s);
+        t2=(double)(clock()-c)/CLOCKS_PER_SEC/nrep*1E6;
+        printf("lambda nb=%2d: lambda=%8.1f lambda_ws=%8.1f us/call\n",n,t1,t2);
+    }
+    lambda_freews(&ws);
+
+    printf("%s utest4 : OK\n",__FILE__);
+}
 int main(void)
 {
     utest1();
     utest2();
+    utest3();
+    utest4();
     return 0;
 }
@@ -2,6 +2,8 @@
 * rtklib unit test driver : matrix and vector functions
 *-----------------------------------------------------------------------------*/
 #include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
 #include <assert.h>
 #include "../../src/rtklib.h"
 
@@ -179,6 +181,121 @@ void utest6(void)
     }
     free(a); free(b);
 }
+/* random states, covariance and measurements for filter test -------------*/
+static void randfilt(double *x, double *P, double *H, double *v, double *R,
+                     int n, int m)
+{
+    double *A=mat(n,n);
+    int i,j;
+
+    for (i=0;i<n*n;i++) A[i]=rand()/(double)RAND_MAX-0.5;
+    matmul("NT",n,n,n,A,A,P); /* P=A*A'+I */
+    for (i=0;i<n;i++) P[i+i*n]+=1.0;
+    for (i=0;i<n;i++) x[i]=rand()/(double)RAND_MAX+1.0;
+    for (i=0;i<n*m;i++) H[i]=0.0;
+    for (j=0;j<m;j++) { /* sparse design matrix as double-difference */
+        for (i=0;i<3;i++) H[i+j*n]=rand()/(double)RAND_MAX-0.5;
+        H[3+(j*7)%(n-3)+j*n]=1.0;
+        H[3+(j*11+5)%(n-3)+j*n]=-1.0;
+        v[j]=rand()/(double)RAND_MAX-0.5;
+    }
+    for (i=0;i<m*m;i++) R[i]=0.0;
+    for (j=0;j<m;j++) R[j+j*m]=0.01+0.001*j;
+    free(A);
+}
+/* reference kalman filter: K=P*H*(H'*P*H+R)^-1, xp=x+K*v, Pp=(I-K*H')*P ---*/
+static int filtref(double *x, double *P, const double *H, const double *v,
+                   const double *R, int n, int m)
+{
+    double *F=mat(n,m),*Q=mat(m,m),*K=mat(n,m),*I=eye(n),*Pp=mat(n,n);
+    int info;
+
+    matcpy(Q,R,m,m);
+    matmul("NN",n,m,n,P,H,F);
+    matmulp("TN",m,m,n,H,F,Q);
+    if (!(info=matinv(Q,m))) {
+        matmul("NN",n,m,m,F,Q,K);
+        matmulp("NN",n,1,m,K,v,x);
+        matmulm("NT",n,n,m,K,H,I);
+        matmul("NN",n,n,n,I,P,Pp);
+        matcpy(P,Pp,n,n);
+    }
+    free(F); free(Q); free(K); free(I); free(Pp);
+    return info;
+}
+/* filter(), filterws() */
+void utest7(void)
+{
+    int i,j,k,n=50,m=12;
+    double *x=mat(n,1),*P=mat(n,n),*H=mat(n,m),*v=mat(m,1),*R=mat(m,m);
+    double *x1=mat(n,1),*P1=mat(n,n),*x2=mat(n,1),*P2=mat(n,n);
+    filtws_t ws;
+
+    initfiltws(&ws);
+    srand(1234);
+    for (k=0;k<3;k++) {
+        randfilt(x,P,H,v,R,n,m);
+        matcpy(x1,x,n,1); matcpy(P1,P,n,n);
+        matcpy(x2,x,n,1); matcpy(P2,P,n,n);
+        assert(filtref(x1,P1,H,v,R,n,m)==0);
+        assert(filterws(&ws,x2,P2,H,v,R,n,m)==0);
+        for (i=0;i<n;i++) assert(fabs(x1[i]-x2[i])<1E-9);
+        for (i=0;i<n;i++) for (j=0;j<n;j++) {
+            assert(fabs(P1[i+j*n]-P2[i+j*n])<1E-9);
+            assert(P2[i+j*n]==P2[j+i*n]);
+        }
+        matcpy(x1,x,n,1); matcpy(P1,P,n,n);
+        assert(filter(x1,P1,H,v,R,n,m)==0);
+        for (i=0;i<n;i++) assert(x1[i]==x2[i]);
+        for (i=0;i<n*n;i++) assert(P1[i]==P2[i]);
+
+        /* state x[i]==0 not updated */
+        matcpy(x2,x,n,1); matcpy(P2,P,n,n);
+        x2[0]=0.0;
+        assert(filterws(&ws,x2,P2,H,v,R,n,m)==0);
+        assert(x2[0]==0.0);
+        for (i=0;i<n;i++) assert(P2[i]==P[i]&&P2[i*n]==P[i*n]);
+    }
+    assert(ws.nmax==n&&ws.mmax==m);
+    freefiltws(&ws);
+        assert(ws.buff==NULL&&ws.nmax==0);
+
+    free(x); free(P); free(H); free(v); free(R);
+    free(x1); free(P1); free(x2); free(P2);
+
+    printf("%s utest7 : OK\n",__FILE__);
+}
+/* filter() benchmark (nx=200) */
+void utest8(void)
+{
+    int i,k,n=200,m=60,nep=20;
+    double *x=mat(n,1),*P=mat(n,n),*H=mat(n,m),*v=mat(m,1),*R=mat(m,m);
+    double *x0=mat(n,1),*P0=mat(n,n),t[3];
+    clock_t c;
+    filtws_t ws;
+
+    initfiltws(&ws);
+    srand(5678);
+    randfilt(x0,P0,H,v,R,n,m);
+
+    for (k=0;k<3;k++) {
+        c=clock();
+        for (i=0;i<nep;i++) {
+            matcpy(x,x0,n,1); matcpy(P,P0,n,n);
+            if      (k==0) filtref(x,P,H,v,R,n,m);
+            else if (k==1) filter(x,P,H,v,R,n,m);
+            else            filterws(&ws,x,P,H,v,R,n,m);
+        }
+        t[k]=(double)(clock()-c)/CLOCKS_PER_SEC/nep*1E3;
+    }
+    freefiltws(&ws);
+    printf("filter nx=%d nv=%d: (I-K*H')*P=%.3f filter=%.3f filterws=%.3f ms/epoch\n",
+           n,m,t[0],t[1],t[2]);
+
+    free(x); free(P); free(H); free(v); free(R); free(x0); free(P0);
+
+    printf("%s utest8 : OK\n",__FILE__);
+}
 int main(void)
 {
     utest1();
@@ -187,5 +304,7 @@ int main(void)
     utest4();
     utest5();
     utest6();
+    utest7();
+    utest8();
     return 0;
 }
@@ -2,6 +2,8 @@
 * rtklib unit test driver : misc functions
 *-----------------------------------------------------------------------------*/
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include "../../src/rtklib.h"
 
@@ -182,11 +184,223 @@ void utest4(void)
     
     printf("%s utset4 : OK\n",__FILE__);
 }
+/* getc_fbuf(),read_fbuf(),fopen_fbuf(),fclose_fbuf() */
+void utest5(void)
+{
+    char file[]="../data/rcvraw/GMSD7_20121014.rtcm3";
+    FILE *fp1,*fp2;
+    fbuf_t fb;
+    uint8_t buff1[5000],buff2[5000];
+    int i,c,n1,n2,n=0;
+    
+    init_fbuf(&fb);
+    fp1=fopen(file,"rb"); assert(fp1);
+    fp2=fopen(file,"rb"); assert(fp2);
+    for (i=0;;i++) {
+        if (i%3) {
+            c=getc_fbuf(&fb,fp1); assert(c==fgetc(fp2));
+            if (c==EOF) break;
+            n++;
+        }
+        else {
+            n1=read_fbuf(&fb,fp1,buff1,i%5000);
+            n2=(int)fread(buff2,1,i%5000,fp2);
+            assert(n1==n2&&!memcmp(buff1,buff2,n1));
+            n+=n1;
+        }
+    }
+    assert(n==262144);
+    fclose(fp1); fclose(fp2);
+    
+    /* no data of closed file for next file (with same file pointer) */
+    fp1=fopen_fbuf(&fb,file,"rb"); assert(fp1&&fb.fp==fp1&&fb.n==0);
+    for (i=0;i<100;i++) assert(getc_fbuf(&fb,fp1)!=EOF);
+    fclose_fbuf(&fb,fp1);
+    assert(fb.fp==NULL&&fb.n==0&&fb.p==0&&fb.buff);
+    fp1=fopen_fbuf(&fb,"../data/rinex/07590920.05o","rb"); assert(fp1);
+    fp2=fopen("../data/rinex/07590920.05o","rb"); assert(fp2);
+    for (i=0;i<100000;i++) {
+        c=getc_fbuf(&fb,fp1); assert(c==fgetc(fp2));
+        if (c==EOF) break;
+    }
+    fclose_fbuf(&fb,fp1); fclose(fp2);
+    free_fbuf(&fb);
+    assert(fb.buff==NULL&&fb.n==0);
+    
+    printf("%s utest5 : OK\n",__FILE__);
+}
+/* trace records for utest6 */
+static void tracerec(void)
+{
+    double A[12];
+    obsd_t obs[3]={{{0}}};
+    uint8_t b[20];
+    int i;
+    
+    for (i=0;i<12;i++) A[i]=i*1.234-5.0;
+    for (i=0;i<3;i++) {
+        obs[i].time=epoch2time((double []){2026,10,16,1,2,3.0+i});
+        obs[i].sat=i+1; obs[i].rcv=1;
+        obs[i].L[0]=1E8+i; obs[i].P[0]=2E7+i; obs[i].SNR[0]=45.0f;
+    }
+    for (i=0;i<20;i++) b[i]=(uint8_t)(i*13);
+    for (i=0;i<2000;i++) {
+        trace(2,"line %d %.3f %s\n",i,i*0.5,i%100?"":"long-long-long-long-line");
+        if (i%100==0) tracemat(2,A,3,4,10,4);
+        if (i%250==0) traceobs(2,obs,3);
+        if (i%300==0) traceb(2,b,20);
+        trace(4,"not output %d\n",i);
+    }
+}
+/* trace thread for utest6 */
+static void *tracethr(void *arg)
+{
+    int i,id=*(int *)arg;
+    
+    for (i=0;i<20000;i++) trace(3,"thr %d %d\n",id,i);
+    return NULL;
+}
+/* read file to memory for utest6 */
+static char *readall(const char *file, long *n)
+{
+    FILE *fp=fopen(file,"rb");
+    char *p;
+    
+    assert(fp);
+    fseek(fp,0,SEEK_END); *n=ftell(fp); fseek(fp,0,SEEK_SET);
+    p=(char *)malloc(*n+1); assert(p);
+    assert(fread(p,1,*n,fp)==(size_t)*n); p[*n]='\0';
+    fclose(fp);
+    return p;
+}
+/* traceasync() */
+void utest6(void)
+{
+#ifdef TRACE
+    pthread_t thr[4];
+    char *p,*q,*s1,*s2,line[256];
+    long n1,n2;
+    int i,id,seq,last[4]={-1,-1,-1,-1},ids[4]={0,1,2,3},nrec=0,ndrop=0,d;
+    
+    /* synchronous and asynchronous outputs should be identical */
+    traceasync(0);
+    traceopen("utest6_s.trace"); tracelevel(3);
+    tracerec();
+    traceclose();
+    traceasync(1<<20);
+    traceopen("utest6_a.trace"); tracelevel(3);
+    tracerec();
+    traceclose();
+    s1=readall("utest6_s.trace",&n1);
+    s2=readall("utest6_a.trace",&n2);
+    assert(n1>0&&n1==n2&&!memcmp(s1,s2,n1));
+    free(s1); free(s2);
+    
+    /* concurrent threads with small buffers: records of each thread are in
+       order and output or counted as dropped */
+    traceasync(4096);
+    traceopen("utest6_t.trace"); tracelevel(3);
+    for (i=0;i<4;i++) assert(!pthread_create(thr+i,NULL,tracethr,ids+i));
+    for (i=0;i<4;i++) pthread_join(thr[i],NULL);
+    traceclose();
+    traceasync(0);
+    tracelevel(0);
+    s1=readall("utest6_t.trace",&n1);
+    for (p=s1;*p;p=q+1) {
+        if (!(q=strchr(p,'\n'))) break;
+        sprintf(line,"%.*s",(int)(q-p<255?q-p:255),p);
+        if (sscanf(line,"3 thr %d %d",&id,&seq)==2) {
+            assert(0<=id&&id<4&&seq>last[id]);
+            last[id]=seq;
+            nrec++;
+        }
+        else if (sscanf(line,"2 trace buffer overflow: %d records dropped",&d)==1) {
+            ndrop+=d;
+        }
+        else assert(0);
+    }
+    assert(nrec+ndrop==80000);
+    free(s1);
+    remove("utest6_s.trace");
+    remove("utest6_a.trace");
+    remove("utest6_t.trace");
+    printf("%s utest6 : OK (output=%d dropped=%d)\n",__FILE__,nrec,ndrop);
+#endif
+}
+/* outsolstatrec(), readsolstat(), convsolstat() */
+static void writestat(const char *file, int fmt)
+{
+    static const double v1[]={5,-1.0,2.5,-0.0,1.23456,0,0}; /* $POS */
+    uint8_t buff[1024];
+    double v2[17];
+    FILE *fp;
+    int i,j,n;
+    
+    fp=fopen(file,"wb");
+    assert(fp);
+    if (fmt==SSTATF_BIN) fwrite(buff,outsolstathb(buff),1,fp);
+    for (i=0;i<5;i++) {
+        n=outsolstatrec(buff,fmt,SSTAT_EPOCH,2000,100.0+i*0.1,NULL,0);
+        n+=outsolstatrec(buff+n,fmt,SSTAT_POS,2000,100.0+i*0.1,v1,7);
+        fwrite(buff,n,1,fp);
+        for (j=0;j<3;j++) {
+            v2[0]=j*7+1; v2[1]=1; v2[2]=123.4+i; v2[3]=45.6-j;
+            v2[4]=-0.1234; v2[5]=0.0056; v2[6]=1; v2[7]=45; v2[8]=2;
+            v2[9]=j%2; v2[10]=-3+i; v2[11]=70000+i; v2[12]=j; v2[13]=7;
+            v2[14]=1E10; v2[15]=1E-7; v2[16]=-1.5;
+            n=outsolstatrec(buff,fmt,SSTAT_SAT,2000,100.0+i*0.1,v2,17);
+            fwrite(buff,n,1,fp);
+        }
+    }
+    fclose(fp);
+}
+void utest7(void)
+{
+    solstatbuf_t st1={0},st2={0};
+    const char *file1[]={"utest7_t.stat"},*file2[]={"utest7_b.stat"};
+    char *s1,*s2;
+    long n1,n2;
+    int i;
+    
+    writestat(file1[0],SSTATF_TEXT);
+    writestat(file2[0],SSTATF_BIN);
+    
+    /* binary converted to text is identical to text output */
+    assert(convsolstat(file2[0],"utest7_c.stat")==0);
+    s1=readall(file1[0],&n1);
+    s2=readall("utest7_c.stat",&n2);
+    assert(n1>0&&n1==n2&&!memcmp(s1,s2,n1));
+    assert(strstr(s1,"$POS,2000,100.000,5,-1.0000,2.5000,-0.0000,1.2346,0.0000"));
+    free(s1); free(s2);
+    
+    /* binary and text are read as same status */
+    assert(readsolstat(file1,1,&st1));
+    assert(readsolstat(file2,1,&st2));
+    assert(st1.n==15&&st1.n==st2.n);
+    for (i=0;i<st1.n;i++) {
+        assert(timediff(st1.data[i].time,st2.data[i].time)==0.0);
+        assert(st1.data[i].sat==st2.data[i].sat&&st1.data[i].flag==st2.data[i].flag);
+        assert(st1.data[i].az==st2.data[i].az&&st1.data[i].el==st2.data[i].el);
+        assert(st1.data[i].resp==st2.data[i].resp&&st1.data[i].resc==st2.data[i].resc);
+        assert(st1.data[i].lock==st2.data[i].lock&&st1.data[i].outc==st2.data[i].outc);
+    }
+    freesolstatbuf(&st1);
+    freesolstatbuf(&st2);
+    
+    assert(convsolstat(file1[0],"utest7_c.stat")==-2); /* not binary */
+    remove(file1[0]);
+    remove(file2[0]);
+    remove("utest7_c.stat");
+    printf("%s utest7 : OK\n",__FILE__);
+}
 int main(void)
 {
     utest1();
     utest2();
     utest3();
     utest4();
+    utest5();
+    utest6();
+    utest7();
     return 0;
 }
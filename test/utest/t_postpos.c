@@ -0,0 +1,585 @@
+/*------------------------------------------------------------------------------
+* rtklib unit test driver : post-processing functions
+*-----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include "../../src/rtklib.h"
+
+#define FILESP3A "../data/sp3/igs15904.sp3"
+#define FILESP3B "../data/sp3/igs15905.sp3"
+#define FILENAV  "../data/rinex/brdc1820.10n"
+#define FILEOBS  "t_postpos_sim.obs"
+#define FILEROV  "../data/rinex/07590920.05o"
+#define FILEBAS  "../data/rinex/30400920.05o"
+#define FILEBNAV "../data/rinex/30400920.05n"
+#define NEPOCH   240                    /* number of simulated epochs */
+
+static const double rr0[]={-3957199.237,3310199.667,3737711.700};
+
+/* dummy application functions for postpos() */
+extern int showmsg(const char *format, ...) {return 0;}
+extern void settspan(gtime_t ts, gtime_t te) {}
+extern void settime(gtime_t time) {}
+
+/* read precise and broadcast ephemeris --------------------------------------*/
+static void readpeph(nav_t *nav)
+{
+    memset(nav,0,sizeof(nav_t));
+    readsp3(FILESP3A,nav,0);
+    readsp3(FILESP3B,nav,0);
+    readrnx(FILENAV,0,"",NULL,nav,NULL);
+    assert(nav->ne>0&&nav->n>0);
+}
+/* write rinex 2.11 gps observation header and epoch ---------------------------*/
+static void outobsh(FILE *fp, const double *rr, gtime_t time)
+{
+    double ep[6];
+
+    time2epoch(time,ep);
+    fprintf(fp,"%9.2f%11s%-20s%-20s%-20s\n",2.11,"","OBSERVATION DATA","G (GPS)",
+            "RINEX VERSION / TYPE");
+    fprintf(fp,"%-60s%-20s\n","SIM","MARKER NAME");
+    fprintf(fp,"%14.4f%14.4f%14.4f%18s%-20s\n",rr[0],rr[1],rr[2],"",
+            "APPROX POSITION XYZ");
+    fprintf(fp,"%6d    C1    P2    L1    L2%30s%-20s\n",4,"","# / TYPES OF OBSERV");
+    fprintf(fp,"%6d%6d%6d%6d%6d%13.7f%5s%3s%9s%-20s\n",(int)ep[0],(int)ep[1],
+            (int)ep[2],(int)ep[3],(int)ep[4],ep[5],"","GPS","","TIME OF FIRST OBS");
+    fprintf(fp,"%60s%-20s\n","","END OF HEADER");
+}
+static void outobse(FILE *fp, gtime_t time, const int *sat, int n)
+{
+    double ep[6];
+    int i,prn;
+
+    time2epoch(time,ep);
+    fprintf(fp," %02d %2.0f %2.0f %2.0f %2.0f%11.7f  0%3d",(int)ep[0]%100,
+            ep[1],ep[2],ep[3],ep[4],ep[5],n);
+    for (i=0;i<n;i++) {
+        if (i>0&&i%12==0) fprintf(fp,"\n%32s","");
+        satsys(sat[i],&prn);
+        fprintf(fp,"G%02d",prn);
+    }
+    fprintf(fp,"\n");
+}
+/* write simulated gps dual-frequency observation data by precise ephemeris --*/
+static void simobs(const char *file, const nav_t *nav)
+{
+    double ep[]={2010,7,1,1,0,0},pos[3],rs[6],dts[2],var,e[3],azel[2],r,tau,P;
+    double I[MAXPRNGPS],P1[MAXPRNGPS],g=(FREQL1/FREQL2)*(FREQL1/FREQL2);
+    gtime_t t0=epoch2time(ep),time,ts;
+    FILE *fp;
+    int i,j,k,n,sat[MAXPRNGPS];
+
+    assert((fp=fopen(file,"w")));
+    outobsh(fp,rr0,t0);
+
+    ecef2pos(rr0,pos);
+
+    for (i=0;i<NEPOCH;i++) {
+        time=timeadd(t0,30.0*i);
+        for (j=n=0;j<MAXPRNGPS;j++) {
+            for (k=0,tau=0.075;k<3;k++) {
+                ts=timeadd(time,-tau);
+                if (!peph2pos(ts,j+1,nav,1,rs,dts,&var)) break;
+                r=geodist(rs,rr0,e);
+                tau=r/CLIGHT;
+            }
+            if (k<3||dts[0]==0.0||satazel(pos,e,azel)<15.0*D2R) continue;
+            P=r+tropmodel(time,pos,azel,0.7)-CLIGHT*dts[0];
+            I[n]=ionmodel(time,nav->ion_gps,pos,azel);
+            sat[n]=j+1; P1[n++]=P;
+        }
+        outobse(fp,time,sat,n);
+        for (j=0;j<n;j++) {
+            fprintf(fp,"%14.3f  %14.3f  %14.3f  %14.3f  \n",P1[j]+I[j],
+                    P1[j]+g*I[j],(P1[j]-I[j])*FREQL1/CLIGHT,
+                    (P1[j]-g*I[j])*FREQL2/CLIGHT);
+        }
+    }
+    fclose(fp);
+}
+/* write observation data with cycle slips every nslip epochs ----------------*/
+static void slipobs(const char *infile, const char *file, int nslip)
+{
+    obs_t obs={0};
+    sta_t sta={{0}};
+    FILE *fp;
+    int i,j,k,m,sat[MAXOBS];
+
+    assert(readrnx(infile,1,"",&obs,NULL,&sta)>0);
+    sortobs(&obs);
+    assert((fp=fopen(file,"w")));
+    outobsh(fp,sta.pos,obs.data[0].time);
+
+    for (i=k=0;i<obs.n;i=j,k++) {
+        for (j=i+1;j<obs.n;j++) {
+            if (timediff(obs.data[j].time,obs.data[i].time)>DTTOL) break;
+        }
+        for (m=0;m<j-i&&m<MAXOBS;m++) sat[m]=obs.data[i+m].sat;
+        outobse(fp,obs.data[i].time,sat,m);
+
+        /* slip of 7/5 cycles in L1/L2 of a satellite by turns */
+        for (m=0;m<j-i&&m<MAXOBS;m++) {
+            const obsd_t *o=obs.data+i+m;
+            int slip=k%nslip==nslip/2&&m==(k/nslip)%(j-i);
+            fprintf(fp,"%14.3f  %14.3f  %14.3f%d %14.3f  \n",o->P[0],o->P[1],
+                    o->L[0]+(slip?7.0:0.0),slip?LLI_SLIP:0,o->L[1]+(slip?5.0:0.0));
+        }
+    }
+    fclose(fp);
+    free(obs.data);
+}
+/* copy file -----------------------------------------------------------------*/
+static void copyfile(const char *infile, const char *file)
+{
+    FILE *fp1,*fp2;
+    char buff[4096];
+    size_t n;
+
+    assert((fp1=fopen(infile,"rb"))&&(fp2=fopen(file,"wb")));
+    while ((n=fread(buff,1,sizeof(buff),fp1))>0) fwrite(buff,1,n,fp2);
+    fclose(fp1); fclose(fp2);
+}
+/* size of file --------------------------------------------------------------*/
+static long filesize(const char *file)
+{
+    FILE *fp;
+    long size;
+
+    assert((fp=fopen(file,"rb")));
+    fseek(fp,0,SEEK_END);
+    size=ftell(fp);
+    fclose(fp);
+    return size;
+}
+/* overwrite data in file (off<0: append, n<0: truncate to off) --------------*/
+static void patchfile(const char *file, long off, const void *data, int n)
+{
+    FILE *fp;
+    char *buff;
+
+    if (n<0) {
+        assert((buff=(char *)malloc(off))&&(fp=fopen(file,"rb")));
+        assert(fread(buff,off,1,fp)==1);
+        fclose(fp);
+        assert((fp=fopen(file,"wb")));
+        fwrite(buff,off,1,fp);
+        fclose(fp);
+        free(buff);
+        return;
+    }
+    assert((fp=fopen(file,off<0?"ab":"r+b")));
+    if (off>=0) fseek(fp,off,SEEK_SET);
+    fwrite(data,n,1,fp);
+    fclose(fp);
+}
+/* ppp options ---------------------------------------------------------------*/
+static prcopt_t pppopt(void)
+{
+    prcopt_t opt=prcopt_default;
+
+    opt.mode=PMODE_PPP_KINEMA;
+    opt.nf=2;
+    opt.navsys=SYS_GPS;
+    opt.elmin=15.0*D2R;
+    opt.ionoopt=IONOOPT_IFLC;
+    opt.tropopt=TROPOPT_EST;
+    opt.sateph=EPHOPT_PREC;
+    opt.modear=ARMODE_OFF;
+    return opt;
+}
+/* compare solution files without header -------------------------------------*/
+static int cmpsol(const char *file1, const char *file2)
+{
+    FILE *fp1,*fp2;
+    char buff1[1024],buff2[1024];
+    int n=0;
+
+    assert((fp1=fopen(file1,"r"))&&(fp2=fopen(file2,"r")));
+    for (;;) {
+        while (fgets(buff1,sizeof(buff1),fp1)&&buff1[0]=='%') ;
+        while (fgets(buff2,sizeof(buff2),fp2)&&buff2[0]=='%') ;
+        if (feof(fp1)||feof(fp2)) break;
+        if (strcmp(buff1,buff2)) {
+            printf("%s%s",buff1,buff2);
+            n=-1;
+            break;
+        }
+        n++;
+    }
+    if (n>=0&&(!feof(fp1)||!feof(fp2))) n=-1;
+    fclose(fp1); fclose(fp2);
+    return n;
+}
+static int cmpfile(const char *file1, const char *file2)
+{
+    FILE *fp1,*fp2;
+    int c1,c2,n=0;
+
+    assert((fp1=fopen(file1,"rb"))&&(fp2=fopen(file2,"rb")));
+    do {
+        c1=fgetc(fp1); c2=fgetc(fp2);
+        if (c1!=c2) {n=-1; break;}
+        n++;
+    } while (c1!=EOF);
+    fclose(fp1); fclose(fp2);
+    return n;
+}
+/* postpos() combined ppp with forward/backward in parallel */
+void utest1(void)
+{
+    gtime_t ts={0},te={0};
+    prcopt_t opt=pppopt();
+    solopt_t sopt=solopt_default;
+    filopt_t fopt={""};
+    const char *infile[]={FILEOBS,FILENAV,FILESP3A,FILESP3B};
+    nav_t nav;
+    int n;
+
+    readpeph(&nav);
+    simobs(FILEOBS,&nav);
+    freenav(&nav,0xFF);
+
+    opt.soltype=SOLTYPE_COMBINED;
+    opt.combpar=0;
+    assert(!postpos(ts,te,0.0,0.0,&opt,&sopt,&fopt,infile,4,"t_postpos1.pos",
+                    "",""));
+    opt.combpar=1;
+    assert(!postpos(ts,te,0.0,0.0,&opt,&sopt,&fopt,infile,4,"t_postpos2.pos",
+                    "",""));
+    n=cmpsol("t_postpos1.pos","t_postpos2.pos");
+    printf("combined ppp: sequential/parallel solutions: %d\n",n);
+    assert(n>=NEPOCH/2);
+
+    remove("t_postpos1.pos");
+    remove("t_postpos2.pos");
+    remove("t_postpos1_events.pos");
+    remove("t_postpos2_events.pos");
+
+    printf("%s utest1 : OK\n",__FILE__);
+}
+/* forward or backward ppp pass ----------------------------------------------*/
+typedef struct {
+    const obs_t *obs;
+    const nav_t *nav;
+    int reverse;
+    double rr[NEPOCH*2][3];
+    int n;
+} pass_t;
+
+static void *procpass(void *arg)
+{
+    pass_t *pass=(pass_t *)arg;
+    prcopt_t opt=pppopt();
+    rtk_t rtk;
+    int i,j,k,m,ne=pass->obs->n;
+
+    rtkinit(&rtk,&opt);
+    for (k=pass->n=0;k<ne;k+=m) {
+        i=pass->reverse?ne-1-k:k;
+        for (m=1;k+m<ne;m++) {
+            j=pass->reverse?i-m:i+m;
+            if (timediff(pass->obs->data[j].time,pass->obs->data[i].time)!=0.0) break;
+        }
+        rtkpos(&rtk,pass->obs->data+(pass->reverse?i-m+1:i),m,pass->nav);
+        if (rtk.sol.stat==SOLQ_NONE||pass->n>=NEPOCH*2) continue;
+        matcpy(pass->rr[pass->n++],rtk.sol.rr,3,1);
+    }
+    rtkfree(&rtk);
+    return NULL;
+}
+/* ppp forward/backward passes with and without interpolation cache */
+void utest2(void)
+{
+    static pass_t pass[6];
+    pthread_t thread[2];
+    obs_t obs={0};
+    nav_t nav,navf,navb;
+    double d,dmax=0.0;
+    int i,j,k,stat;
+
+    readpeph(&nav);
+    assert(readrnx(FILEOBS,1,"",&obs,NULL,NULL)>0);
+    sortobs(&obs);
+
+    for (i=0;i<6;i++) {
+        pass[i].obs=&obs; pass[i].reverse=i%2;
+    }
+    /* sequential passes without cache and with a shared cache */
+    for (i=0;i<2;i++) {
+        pass[i].nav=&nav;
+        procpass(pass+i);
+    }
+    assert(initpephc(&nav));
+    for (i=2;i<4;i++) {
+        pass[i].nav=&nav;
+        procpass(pass+i);
+    }
+    /* parallel passes with own cache on copies of nav */
+    navf=navb=nav;
+    navf.pephc=navb.pephc=NULL;
+    assert(initpephc(&navf)&&initpephc(&navb));
+    pass[4].nav=&navf;
+    pass[5].nav=&navb;
+    for (i=0;i<2;i++) {
+        stat=pthread_create(thread+i,NULL,procpass,pass+4+i);
+        assert(!stat);
+    }
+    for (i=0;i<2;i++) pthread_join(thread[i],NULL);
+
+    for (i=0;i<2;i++) {
+        printf("%s: solutions=%d %d %d\n",i?"backward":"forward",pass[i].n,
+               pass[i+2].n,pass[i+4].n);
+        assert(pass[i].n>=NEPOCH/2);
+        assert(pass[i].n==pass[i+2].n&&pass[i].n==pass[i+4].n);
+
+        for (j=0;j<pass[i].n;j++) {
+            for (k=0;k<3;k++) {
+                d=fabs(pass[i].rr[j][k]-pass[i+2].rr[j][k]);
+                if (d>dmax) dmax=d;
+            }
+            assert(!memcmp(pass[i+2].rr[j],pass[i+4].rr[j],sizeof(double)*3));
+        }
+    }
+    printf("max diff with/without cache=%.3e m\n",dmax);
+    assert(dmax<1E-3);
+
+    freepephc(&navf);
+    freepephc(&navb);
+    free(obs.data);
+    freenav(&nav,0xFF);
+
+    remove(FILEOBS);
+
+    printf("%s utest2 : OK\n",__FILE__);
+}
+/* postpos() kinematic with partial ar candidates sequential/in parallel */
+void utest3(void)
+{
+    gtime_t ts={0},te={0};
+    prcopt_t opt=prcopt_default;
+    solopt_t sopt=solopt_default;
+    filopt_t fopt={""};
+    const char *infile[]={"t_postpos_slip.obs",FILEBNAV,FILEBAS};
+    const double rb[]={-3978241.958,3382840.234,3649900.853};
+    char buff[1024];
+    FILE *fp;
+    int i,n,nfix=0;
+
+    opt.mode=PMODE_KINEMA;
+    opt.nf=2;
+    opt.navsys=SYS_GPS;
+    opt.modear=ARMODE_CONT;
+    opt.arfilter=1;
+    opt.mindropsats=5;
+    opt.minlock=3;
+    opt.refpos=POSOPT_POS_XYZ;
+    for (i=0;i<3;i++) opt.rb[i]=rb[i];
+
+    /* slips to try ar candidates without newly locked satellites */
+    slipobs(FILEROV,"t_postpos_slip.obs",10);
+
+    opt.arpar=0;
+    assert(!postpos(ts,te,0.0,0.0,&opt,&sopt,&fopt,infile,3,"t_postpos3.pos",
+                    "",""));
+    opt.arpar=1;
+    assert(!postpos(ts,te,0.0,0.0,&opt,&sopt,&fopt,infile,3,"t_postpos4.pos",
+                    "",""));
+    n=cmpsol("t_postpos3.pos","t_postpos4.pos");
+
+    assert((fp=fopen("t_postpos3.pos","r")));
+    while (fgets(buff,sizeof(buff),fp)) {
+        if (buff[0]!='%'&&strlen(buff)>64&&atoi(buff+64)==SOLQ_FIX) nfix++;
+    }
+    fclose(fp);
+    printf("kinematic: sequential/parallel partial ar: %d fix=%d\n",n,nfix);
+    assert(n>0&&nfix>0);
+
+    remove("t_postpos_slip.obs");
+    remove("t_postpos3.pos");
+    remove("t_postpos4.pos");
+    remove("t_postpos3_events.pos");
+    remove("t_postpos4_events.pos");
+
+    printf("%s utest3 : OK\n",__FILE__);
+}
+/* postpos() with obs/nav cache of rinex files -------------------------------*/
+static void runcache(prcopt_t *opt, const char **infile, int obscache,
+                     const char *outfile)
+{
+    gtime_t ts={0},te={0};
+    solopt_t sopt=solopt_default;
+    filopt_t fopt={""};
+
+    opt->obscache=obscache;
+    assert(!postpos(ts,te,0.0,0.0,opt,&sopt,&fopt,infile,3,outfile,"",""));
+}
+/* postpos() kinematic with obs/nav cache: round trip, rebuild and rejection */
+void utest4(void)
+{
+    prcopt_t opt=prcopt_default;
+    const char *infile[]={"t_postpos_c.obs",FILEBNAV,FILEBAS};
+    const double rb[]={-3978241.958,3382840.234,3649900.853};
+    const int32_t nbad=0x7FFFFFFF;
+    const char pad[64]={0};
+    char *paths[1],path[1024];
+    long size;
+    int i,n;
+
+    opt.mode=PMODE_KINEMA;
+    opt.nf=2;
+    opt.navsys=SYS_GPS;
+    opt.modear=ARMODE_CONT;
+    opt.refpos=POSOPT_POS_XYZ;
+    for (i=0;i<3;i++) opt.rb[i]=rb[i];
+
+    copyfile(FILEROV,"t_postpos_c.obs");
+
+    /* direct read of rinex files */
+    runcache(&opt,infile,0,"t_postpos5.pos");
+
+    /* cache written on first run */
+    runcache(&opt,infile,1,"t_postpos6.pos");
+    paths[0]=path;
+    assert(expath("t_postpos_c.obs.*.rtkc",paths,1)==1);
+    size=filesize(path);
+    n=cmpsol("t_postpos5.pos","t_postpos6.pos");
+    printf("obs cache: path=%s size=%ld written: %d\n",path,size,n);
+    assert(n>0);
+
+    /* cache mapped on next run (padding appended is kept if not rebuilt) */
+    patchfile(path,-1,pad,64);
+    runcache(&opt,infile,1,"t_postpos6.pos");
+    n=cmpsol("t_postpos5.pos","t_postpos6.pos");
+    printf("obs cache: mapped: %d\n",n);
+    assert(n>0&&filesize(path)==size+64);
+
+    /* cache rebuilt by modification time of input file */
+    sleepms(1100);
+    copyfile(FILEROV,"t_postpos_c.obs");
+    runcache(&opt,infile,1,"t_postpos6.pos");
+    n=cmpsol("t_postpos5.pos","t_postpos6.pos");
+    printf("obs cache: input time changed: %d\n",n);
+    assert(n>0&&filesize(path)==size);
+
+    /* cache rebuilt by size of input file */
+    patchfile(path,-1,pad,64);
+    patchfile("t_postpos_c.obs",-1,"\n",1);
+    runcache(&opt,infile,1,"t_postpos6.pos");
+    n=cmpsol("t_postpos5.pos","t_postpos6.pos");
+    printf("obs cache: input size changed: %d\n",n);
+    assert(n>0&&filesize(path)==size);
+
+    /* truncated cache rejected */
+    patchfile(path,size/2,NULL,-1);
+    runcache(&opt,infile,1,"t_postpos6.pos");
+    n=cmpsol("t_postpos5.pos","t_postpos6.pos");
+    printf("obs cache: truncated: %d\n",n);
+    assert(n>0&&filesize(path)==size);
+
+    /* corrupt cache rejected: file id (offset 0), signature (32), number of
+       obs data (40) in cache header */
+    for (i=0;i<3;i++) {
+        patchfile(path,-1,pad,64);
+        if      (i==0) patchfile(path,0,"X",1);
+        else if (i==1) patchfile(path,32,"X",1);
+        else           patchfile(path,40,&nbad,4);
+        runcache(&opt,infile,1,"t_postpos6.pos");
+        n=cmpsol("t_postpos5.pos","t_postpos6.pos");
+        printf("obs cache: corrupt header %d: %d\n",i,n);
+        assert(n>0&&filesize(path)==size);
+    }
+    remove(path);
+    remove("t_postpos_c.obs");
+    remove("t_postpos5.pos");
+    remove("t_postpos6.pos");
+    remove("t_postpos5_events.pos");
+    remove("t_postpos6_events.pos");
+
+    printf("%s utest4 : OK\n",__FILE__);
+}
+/* postpos_ctx() sessions in parallel with shared data ----------------------*/
+typedef struct {
+    const ppshr_t *shr;
+    const prcopt_t *opt;
+    const char **infile;
+    char outfile[64];
+    int stat;
+} sess_t;
+
+static void *procsess(void *arg)
+{
+    sess_t *sess=(sess_t *)arg;
+    gtime_t ts={0},te={0};
+    solopt_t sopt=solopt_default;
+    filopt_t fopt={""};
+
+    sess->stat=postpos_ctx(sess->shr,ts,te,0.0,0.0,sess->opt,&sopt,&fopt,
+                           sess->infile,3,sess->outfile,"","");
+    return NULL;
+}
+/* postpos_ctx() kinematic sessions in parallel compared with postpos() */
+void utest5(void)
+{
+    gtime_t ts={0},te={0};
+    prcopt_t opt=prcopt_default;
+    solopt_t sopt=solopt_default;
+    filopt_t fopt={""};
+    const char *infile[]={FILEROV,FILEBNAV,FILEBAS};
+    const double rb[]={-3978241.958,3382840.234,3649900.853};
+    static sess_t sess[3];
+    pthread_t thread[3];
+    ppshr_t shr;
+    char file[64];
+    int i,n,stat;
+
+    opt.mode=PMODE_KINEMA;
+    opt.nf=2;
+    opt.navsys=SYS_GPS;
+    opt.modear=ARMODE_CONT;
+    opt.refpos=POSOPT_POS_XYZ;
+    for (i=0;i<3;i++) opt.rb[i]=rb[i];
+
+    assert(!postpos(ts,te,0.0,0.0,&opt,&sopt,&fopt,infile,3,"t_postpos7.pos",
+                    "",""));
+    assert(ppshrinit(&shr,&sopt,&fopt,NULL,0));
+
+    for (i=0;i<3;i++) {
+        sess[i].shr=&shr;
+        sess[i].opt=&opt;
+        sess[i].infile=infile;
+        sprintf(sess[i].outfile,"t_postpos8_%d.pos",i);
+        stat=pthread_create(thread+i,NULL,procsess,sess+i);
+        assert(!stat);
+    }
+    for (i=0;i<3;i++) pthread_join(thread[i],NULL);
+
+    for (i=0;i<3;i++) {
+        n=cmpfile("t_postpos7.pos",sess[i].outfile);
+        printf("postpos_ctx: session %d stat=%d postpos/session: %d\n",i,
+               sess[i].stat,n);
+        assert(!sess[i].stat&&n>0);
+    }
+    ppshrfree(&shr);
+
+    remove("t_postpos7.pos");
+    remove("t_postpos7_events.pos");
+    for (i=0;i<3;i++) {
+        remove(sess[i].outfile);
+        sprintf(file,"t_postpos8_%d_events.pos",i);
+        remove(file);
+    }
+    printf("%s utest5 : OK\n",__FILE__);
+}
+int main(void)
+{
+    utest1();
+    utest2();
+    utest3();
+    utest4();
+    utest5();
+    return 0;
+}
@@ -3,6 +3,7 @@
 *-----------------------------------------------------------------------------*/
 #include <stdio.h>
 #include <assert.h>
+#include <math.h>
 #include "../../src/rtklib.h"
 
 static void dumpeph(peph_t *peph, int n)
@@ -198,9 +199,174 @@ void utest5(void)
     fclose(fp);
     printf("%s utest5 : OK\n",__FILE__);
 }
+/* peph2pos() with interpolation cache */
+void utest6(void)
+{
+    char *file1="../data/sp3/igs1590*.sp3"; /* 2010/7/1 15 min */
+    char *file2="../data/sp3/igs1590*.clk"; /* 2010/7/1 */
+    nav_t nav={0},nav0;
+    double ep[]={2010,7,1,0,0,0};
+    double rs1[6],dts1[2],var1,rs2[6],dts2[2],var2,ext;
+    gtime_t t,time;
+    uint32_t tick;
+    int i,j,sat,stat1,stat2,n=0,tt[2];
+
+    time=epoch2time(ep);
+
+    readsp3(file1,&nav,0);
+        assert(nav.ne>0);
+    readrnxc(file2,&nav);
+        assert(nav.nc>0);
+    nav0=nav;
+        assert(initpephc(&nav));
+
+    for (i=-1800;i<86400*2+1800;i+=30) {
+        t=timeadd(time,i+0.5);
+
+        /* looser tolerance for extrapolation out of precise ephemeris */
+        ext=timediff(t,nav.peph[0].time)<0.0||
+            timediff(t,nav.peph[nav.ne-1].time)>0.0?10.0:1.0;
+
+        for (sat=1;sat<=MAXSAT;sat++) {
+            stat1=peph2pos(t,sat,&nav0,0,rs1,dts1,&var1);
+            stat2=peph2pos(t,sat,&nav ,0,rs2,dts2,&var2);
+                assert(stat1==stat2);
+            if (!stat1) continue;
+            for (j=0;j<3;j++) {
+                assert(fabs(rs1[j]-rs2[j])<1E-6*ext);
+                assert(fabs(rs1[j+3]-rs2[j+3])<1E-3*ext);
+            }
+                assert(fabs(dts1[0]-dts2[0])<1E-12*ext);
+                assert(fabs(var1-var2)<=1E-9*var1);
+            n++;
+        }
+    }
+        assert(n>0);
+
+    /* throughput of ppp orbits and clocks (1 Hz, all satellites) */
+    for (j=0;j<2;j++) {
+        tick=tickget();
+        for (i=0;i<3600*2;i++) {
+            t=timeadd(time,(double)i);
+            for (sat=1;sat<=MAXSAT;sat++) {
+                peph2pos(t,sat,j?&nav:&nav0,0,rs1,dts1,&var1);
+            }
+        }
+        tt[j]=(int)(tickget()-tick);
+    }
+    printf("peph2pos 2h 1Hz: no cache=%d ms cache=%d ms\n",tt[0],tt[1]);
+
+    freepephc(&nav);
+        assert(nav.pephc==NULL);
+    free(nav.peph);
+    free(nav.pclk);
+
+    printf("%s utest6 : OK\n",__FILE__);
+}
+/* searchpcv() with index */
+static void writeatx(const char *file)
+{
+    FILE *fp;
+    const char *blk[]={"BLOCK IIA","BLOCK IIR-M","BLOCK IIF"};
+    const char *rcv[]={"TRM59800.00C    NONE","TRM59800.00     SCIS",
+                       "TRM59800.00     NONE","XANT1           NONE",
+                       "ANT1            SCIT"};
+    int i,j,y;
+
+    fp=fopen(file,"w");
+    assert(fp);
+    fprintf(fp,"%-60s%-20s\n","     1.4            M","ANTEX VERSION / SYST");
+    for (i=0;i<32;i++) for (j=0;j<3;j++) {
+        y=2000+j*5+i%3;
+        fprintf(fp,"%60s%-20s\n","","START OF ANTENNA");
+        fprintf(fp,"%-20sG%02d%57s%-20s\n",blk[j],i+1,"","TYPE / SERIAL NO");
+        fprintf(fp,"%6d%6d%6d%6d%6d%13.7f%17s%-20s\n",y,1,1,0,0,0.0,"","VALID FROM");
+        if (j<2) {
+            fprintf(fp,"%6d%6d%6d%6d%6d%13.7f%17s%-20s\n",y+6,1,1,0,0,0.0,"",
+                    "VALID UNTIL");
+        }
+        fprintf(fp,"%60s%-20s\n","","END OF ANTENNA");
+    }
+    for (i=0;i<(int)(sizeof(rcv)/sizeof(char *));i++) {
+        fprintf(fp,"%60s%-20s\n","","START OF ANTENNA");
+        fprintf(fp,"%-60s%-20s\n",rcv[i],"TYPE / SERIAL NO");
+        fprintf(fp,"%60s%-20s\n","","END OF ANTENNA");
+    }
+    fclose(fp);
+}
+static void utest7(void)
+{
+    char *file1="../../data/ant/ngs_abs.pcv";
+    char *file2="../../data/ant/gnssant_ext.atx";
+    char *file3="testpcv.atx";
+    char *types[]={"","NONE","AOAD/M_T","AOAD/M_T NONE","AOAD/M_T XXXX",
+                   "ASH700936D_M    SCIS","HXCCGX601A      HXCS","HXCCGX601A NONE",
+                   "ANN_MB_00_C","XXXX"};
+    char *rtypes[]={"TRM59800.00 NONE","TRM59800.00","TRM59800.00 SCI",
+                    "TRM59800.00 SCIS","ANT1 SCIS","ANT1","XANT1 SCIT"};
+    const int rexp[]={0,0,1,1,4,3,3};
+    char type[MAXANT],*p;
+    double ep[]={1998,1,1,0,0,0};
+    pcvs_t pcvs={0},pcvs0;
+    pcv_t *pcv1,*pcv2;
+    gtime_t time;
+    int i,j,n=0;
+
+    assert(readpcv(file1,&pcvs));
+    assert(readpcv(file2,&pcvs));
+    assert(pcvs.idx&&pcvs.idx->n==pcvs.n);
+    pcvs0=pcvs; pcvs0.idx=NULL;
+    time=epoch2time(ep);
+
+    for (i=0;i<(int)(sizeof(types)/sizeof(char *));i++) {
+        pcv1=searchpcv(0,types[i],time,&pcvs);
+        pcv2=searchpcv(0,types[i],time,&pcvs0);
+        assert(pcv1==pcv2);
+    }
+    for (i=0;i<pcvs.n;i++) {
+        for (j=0;j<2;j++) {
+            strcpy(type,pcvs.pcv[i].type);
+            if (j==0&&(p=strchr(type,' '))) *p='\0';
+            pcv1=searchpcv(0,type,time,&pcvs);
+            pcv2=searchpcv(0,type,time,&pcvs0);
+            assert(pcv1&&pcv2);
+            if (pcv1!=pcv2) n++;
+        }
+    }
+    printf("receiver antennas: n=%d diff=%d\n",pcvs.n,n);
+    assert(n==0);
+    free_pcvs(&pcvs);
+    assert(!pcvs.idx&&!pcvs.pcv);
+
+    writeatx(file3);
+    assert(readpcv(file3,&pcvs));
+    assert(pcvs.n==101&&pcvs.idx);
+    pcvs0=pcvs; pcvs0.idx=NULL;
+
+    /* substrings searched before exact names in file order */
+    for (i=0;i<(int)(sizeof(rtypes)/sizeof(char *));i++) {
+        pcv1=searchpcv(0,rtypes[i],time,&pcvs);
+        pcv2=searchpcv(0,rtypes[i],time,&pcvs0);
+        assert(pcv1==pcv2&&pcv1==pcvs.pcv+96+rexp[i]);
+    }
+    for (i=-1;i<=MAXSAT+1;i++) for (j=0;j<25;j++) {
+        ep[0]=1998+j;
+        time=epoch2time(ep);
+        pcv1=searchpcv(i,"",time,&pcvs);
+        pcv2=searchpcv(i,"",time,&pcvs0);
+        assert(pcv1==pcv2);
+        if (i==1&&j==10) assert(pcv1&&!strcmp(pcv1->type,"BLOCK IIR-M"));
+    }
+    free_pcvs(&pcvs);
+    remove(file3);
+
+    printf("%s utest7 : OK\n",__FILE__);
+}
 int main(int argc, char **argv)
 {
     utest1();
+    utest6();
+    utest7();
     utest2();
     utest3();
     utest4();
@@ -208,6 +208,187 @@ void utest6(void)
     }
     printf("%s utest6 : OK\n",__FILE__);
 }
+/* write synthetic rinex 3 observation data --------------------------------*/
+static void writeobs3(const char *file, int nep, int hdrec)
+{
+    FILE *fp;
+    int i,j,k,n,sec;
+
+    assert((fp=fopen(file,"w"))!=NULL);
+    fprintf(fp,"%9.2f%11s%-20s%-20s%-20s\n",3.04,"","OBSERVATION DATA",
+            "G (GPS)","RINEX VERSION / TYPE");
+    fprintf(fp,"%-60s%-20s\n","G    6 C1C L1C D1C S1C C2W L2W",
+            "SYS / # / OBS TYPES");
+    fprintf(fp,"%-60s%-20s\n","  2020     1     1     0     0    0.0000000     GPS",
+            "TIME OF FIRST OBS");
+    fprintf(fp,"%-60s%-20s\n","","END OF HEADER");
+    if (hdrec) {
+        fprintf(fp,"> %04d %02d %02d %02d %02d%11.7f  %d%3d\n",2020,1,1,0,0,0.0,4,1);
+        fprintf(fp,"%-60s%-20s\n","header record","COMMENT");
+    }
+    for (i=0;i<nep;i++) {
+        sec=i*5;
+        if (i%997==500) { /* event epoch */
+            fprintf(fp,"> %04d %02d %02d %02d %02d%11.7f  %d%3d\n",2020,1,1+sec/86400,
+                    sec/3600%24,sec/60%60,sec%60+2.5,5,0);
+        }
+        n=8+i%5;
+        fprintf(fp,"> %04d %02d %02d %02d %02d%11.7f  %d%3d\n",2020,1,1+sec/86400,
+                sec/3600%24,sec/60%60,(double)(sec%60),0,n);
+        for (j=0;j<n;j++) {
+            fprintf(fp,"G%02d",1+(j*7+i/300)%32);
+            for (k=0;k<6;k++) {
+                if ((i+j+k)%53==0) {fprintf(fp,"%16s","");continue;}
+                fprintf(fp,"%14.3f%c%c",2E7+i*1.234+j*1001.0+k*17.0,
+                        (k==1||k==5)&&(i+j)%31==0?'1':' ','0'+(i+j+k)%10);
+            }
+            fprintf(fp,"\n");
+        }
+    }
+    fclose(fp);
+}
+/* compare observation data --------------------------------------------------*/
+static void cmpobs(const obs_t *a, const obs_t *b)
+{
+    int i,j;
+
+    assert(a->n==b->n);
+    for (i=0;i<a->n;i++) {
+        assert(timediff(a->data[i].time,b->data[i].time)==0.0);
+        assert(timediff(a->data[i].eventime,b->data[i].eventime)==0.0);
+        assert(a->data[i].sat==b->data[i].sat&&a->data[i].rcv==b->data[i].rcv);
+        for (j=0;j<NFREQ+NEXOBS;j++) {
+            assert(a->data[i].P[j]==b->data[i].P[j]);
+            assert(a->data[i].L[j]==b->data[i].L[j]);
+            assert(a->data[i].D[j]==b->data[i].D[j]);
+            assert(a->data[i].SNR[j]==b->data[i].SNR[j]);
+            assert(a->data[i].LLI[j]==b->data[i].LLI[j]);
+            assert(a->data[i].code[j]==b->data[i].code[j]);
+        }
+    }
+}
+/* readrnx() rinex 3 obs by parallel epoch chunks */
+void utest7(void)
+{
+    char file1[]="testobs1.obs",file2[]="testobs2.obs";
+    gtime_t t0={0};
+    obs_t obs1={0},obs2={0};
+    double t[2];
+    int nep=30000;
+
+    writeobs3(file1,nep,1); /* header record forces sequential read */
+    writeobs3(file2,nep,0);
+
+    t[0]=tickget();
+    readrnxt(file1,1,t0,t0,0.0,"",&obs1,NULL,NULL);
+    t[0]=tickget()-t[0];
+    t[1]=tickget();
+    readrnxt(file2,1,t0,t0,0.0,"",&obs2,NULL,NULL);
+    t[1]=tickget()-t[1];
+    printf("n=%d sequential=%.0fms parallel=%.0fms\n",obs1.n,t[0],t[1]);
+    assert(obs1.n>nep*8);
+    cmpobs(&obs1,&obs2);
+    free(obs1.data); free(obs2.data);
+    obs1.data=obs2.data=NULL; obs1.n=obs1.nmax=obs2.n=obs2.nmax=0;
+
+    /* time screening with slip restore */
+    readrnxt(file1,1,t0,t0,30.0,"",&obs1,NULL,NULL);
+    readrnxt(file2,1,t0,t0,30.0,"",&obs2,NULL,NULL);
+    assert(obs1.n>0);
+    cmpobs(&obs1,&obs2);
+    free(obs1.data); free(obs2.data);
+
+    remove(file1);
+    remove(file2);
+    printf("%s utest7 : OK\n",__FILE__);
+}
+/* parsing benchmark of rinex and sp3 files */
+void utest8(void)
+{
+    const char *files[]={
+        "../data/rinex/07590920.05o","../data/rinex/30400920.05o",
+        "../data/rinex/07590920.05n","../data/rinex/brdc0910.09g",
+        "../data/rinex/brdc1820.10n","../data/sp3/igs15904.clk",
+        "../data/sp3/esa15253.clk",NULL
+    };
+    const char *sp3s[]={
+        "../data/sp3/igs15904.sp3","../data/sp3/igs15905.sp3",
+        "../data/sp3/esa15253.sp3","../data/sp3/igl15253.sp3",NULL
+    };
+    FILE *fp;
+    obs_t obs={0};
+    nav_t nav={0};
+    double size[2]={0},tt[2]={0};
+    uint32_t tick;
+    int i,j,nrep=5;
+
+    for (i=0;files[i];i++) {
+        assert((fp=fopen(files[i],"r"))!=NULL);
+        fseek(fp,0,SEEK_END); size[0]+=ftell(fp)*nrep; fclose(fp);
+        tick=tickget();
+        for (j=0;j<nrep;j++) {
+            if (strstr(files[i],".clk")) assert(readrnxc(files[i],&nav)>0);
+            else assert(readrnx(files[i],1,"",&obs,&nav,NULL)>0);
+            freeobs(&obs); freenav(&nav,0xFF);
+        }
+        tt[0]+=(tickget()-tick)*1E-3;
+    }
+    for (i=0;sp3s[i];i++) {
+        assert((fp=fopen(sp3s[i],"r"))!=NULL);
+        fseek(fp,0,SEEK_END); size[1]+=ftell(fp)*nrep; fclose(fp);
+        tick=tickget();
+        for (j=0;j<nrep;j++) {
+            readsp3(sp3s[i],&nav,0);
+            assert(nav.ne>0);
+            freenav(&nav,0xFF);
+        }
+        tt[1]+=(tickget()-tick)*1E-3;
+    }
+    printf("rinex: %6.1f MB %6.3f s %7.1f MB/s\n",size[0]/1E6,tt[0],
+           size[0]/1E6/(tt[0]>0.0?tt[0]:1E-3));
+    printf("sp3  : %6.1f MB %6.3f s %7.1f MB/s\n",size[1]/1E6,tt[1],
+           size[1]/1E6/(tt[1]>0.0?tt[1]:1E-3));
+    printf("%s utest8 : OK\n",__FILE__);
+}
+/* open_rnxobs(),input_rnxobs(),close_rnxobs() */
+void utest9(void)
+{
+    const char *files[]={"../data/rinex/07590920.05o","../data/rinex/30400920.05n"};
+    const char *file3[]={"testobs2.obs"};
+    gtime_t t0={0},ts,te;
+    double ep1[]={2005,4,2,0,10,0},ep2[]={2005,4,2,0,40,0};
+    double tint[]={0.0,60.0,0.0};
+    obs_t obs1={0},obs2={0};
+    rnxobs_t rnx;
+    int i,n;
+
+    for (i=0;i<3;i++) {
+        ts=i<2?t0:epoch2time(ep1);
+        te=i<2?t0:epoch2time(ep2);
+        readrnxt(files[0],1,ts,te,tint[i],"",&obs1,NULL,NULL);
+        sortobs(&obs1);
+        assert(open_rnxobs(&rnx,files,2,1,ts,te,tint[i],"")==2);
+        while ((n=input_rnxobs(&rnx,&obs2))>0) {
+            assert(timediff(obs2.data[obs2.n-n].time,obs2.data[obs2.n-1].time)==0.0);
+        }
+        close_rnxobs(&rnx);
+        assert(obs1.n>0);
+        cmpobs(&obs1,&obs2);
+        freeobs(&obs1); freeobs(&obs2);
+    }
+    /* rinex 3 with event epochs */
+    writeobs3(file3[0],3000,0);
+    readrnxt(file3[0],1,t0,t0,0.0,"",&obs1,NULL,NULL);
+    sortobs(&obs1);
+    assert(open_rnxobs(&rnx,file3,1,1,t0,t0,0.0,"")==1);
+    while (input_rnxobs(&rnx,&obs2)>0) ;
+    close_rnxobs(&rnx);
+    cmpobs(&obs1,&obs2);
+    freeobs(&obs1); freeobs(&obs2);
+    remove(file3[0]);
+
+    printf("%s utest9 : OK\n",__FILE__);
+}
 int main(int argc, char **argv)
 {
     utest1();
@@ -216,5 +397,8 @@ int main(int argc, char **argv)
     utest4();
     utest5();
     utest6();
+    utest7();
+    utest8();
+    utest9();
     return 0;
 }
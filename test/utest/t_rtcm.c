@@ -0,0 +1,55 @@
+/*------------------------------------------------------------------------------
+* rtklib unit test driver : rtcm functions
+*-----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "../../src/rtklib.h"
+
+/* compare input_rtcm3f() by blocks with input_rtcm3() by bytes */
+static void cmprtcm3(const char *file)
+{
+    FILE *fp;
+    rtcm_t *rtcm1,*rtcm2;
+    int i,j,ret,data,n1=0,n2=0,type1[4096],type2[4096];
+    
+    rtcm1=(rtcm_t *)malloc(sizeof(rtcm_t));
+    rtcm2=(rtcm_t *)malloc(sizeof(rtcm_t));
+    assert(rtcm1&&rtcm2&&init_rtcm(rtcm1)&&init_rtcm(rtcm2));
+    
+    fp=fopen(file,"rb"); assert(fp);
+    while ((ret=input_rtcm3f(rtcm1,fp))>=-1) {
+        if (ret>0&&n1<4096) type1[n1++]=ret;
+    }
+    assert(ret==-2);
+    fclose(fp);
+    
+    fp=fopen(file,"rb"); assert(fp);
+    while ((data=fgetc(fp))!=EOF) {
+        if ((ret=input_rtcm3(rtcm2,(uint8_t)data))>0&&n2<4096) type2[n2++]=ret;
+    }
+    fclose(fp);
+    
+    assert(n1>0&&n1==n2);
+    for (i=0;i<n1;i++) assert(type1[i]==type2[i]);
+    for (i=0;i<400;i++) assert(rtcm1->nmsg3[i]==rtcm2->nmsg3[i]);
+    for (i=j=0;i<400;i++) j+=rtcm1->nmsg3[i];
+    assert(j>0);
+    free_rtcm(rtcm1); free_rtcm(rtcm2);
+    assert(rtcm1->fbuf.buff==NULL);
+    free(rtcm1); free(rtcm2);
+}
+/* input_rtcm3f() */
+void utest1(void)
+{
+    cmprtcm3("../data/rcvraw/GMSD7_20121014.rtcm3");
+    cmprtcm3("../data/rcvraw/testglo.rtcm3");
+    
+    printf("%s utest1 : OK\n",__FILE__);
+}
+/* unit test main */
+int main(int argc, char **argv)
+{
+    utest1();
+    return 0;
+}
@@ -294,6 +294,37 @@ void utest11(void)
     
     printf("%s utset11 : OK\n",__FILE__);
 }
+/* str2num(),str2int() compared with strtod() */
+void utest12(void)
+{
+    const char *fmt[]={"%14.3f","%19.12E","%12.6f","%9.2E","%.17G","%5.0f"};
+    char s[64],t[64],*p;
+    double a,b,x;
+    int i,j,n;
+
+    srand(1);
+    for (i=0;i<600000;i++) {
+        x=(rand()-RAND_MAX/2)*pow(10.0,rand()%40-20)/RAND_MAX;
+        n=sprintf(s,fmt[i%6],x);
+        strcpy(t,s);
+        if (i%2&&(p=strchr(s,'E'))) *p='D';
+        a=str2num(s,0,n);
+        b=strtod(t,NULL);
+        assert(!memcmp(&a,&b,sizeof(double)));
+    }
+    a=str2num("  -0.123456789012D+04",0,21); assert(a==-1234.56789012);
+    a=str2num(" 1.5E",0,5);      assert(a==1.5);
+    a=str2num(" 1.5D+",0,6);     assert(a==1.5);
+    a=str2num("   .",0,4);       assert(a==0.0);
+    a=str2num("12345678901234567890123",0,23); assert(a==12345678901234567890123.0);
+    a=str2num("1.23456789",0,4); assert(a==1.23);
+    j=str2int("  -12 ",0,6);    assert(j==-12);
+    j=str2int("G05",1,2);       assert(j==5);
+    j=str2int("G05",4,2);       assert(j==0);
+    j=str2int("   ",0,3);       assert(j==0);
+
+    printf("%s utset12 : OK\n",__FILE__);
+}
 int main(void)
 {
     utest1();
@@ -307,5 +338,6 @@ int main(void)
     utest9();
     utest10();
     utest11();
+    utest12();
     return 0;
 }